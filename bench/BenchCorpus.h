@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_BENCHCORPUS_H
+#define GOLEM_BENCHCORPUS_H
+
+#include "ChcGenerator.h"
+
+#include <benchmark/benchmark.h>
+
+/** Registers the shapes of the generated corpus as the arguments of the benchmark */
+inline void preprocessingCorpus(benchmark::internal::Benchmark * benchmark) {
+    benchmark->ArgNames({"depth", "predicates", "edges"})->ArgsProduct({{1, 2, 4}, {1, 8, 32}, {1, 4}});
+}
+
+/** Smaller shapes for the engines, which must solve every system of the corpus in reasonable time */
+inline void engineCorpus(benchmark::internal::Benchmark * benchmark) {
+    benchmark->ArgNames({"depth", "predicates", "edges"})->ArgsProduct({{1, 2}, {1, 2, 4}, {1, 2}});
+    benchmark->Unit(benchmark::kMillisecond);
+}
+
+inline ChcShape shapeOf(benchmark::State const & state, bool safe) {
+    return ChcShape{static_cast<unsigned>(state.range(0)), static_cast<unsigned>(state.range(1)),
+                    static_cast<unsigned>(state.range(2)), safe};
+}
+
+#endif // GOLEM_BENCHCORPUS_H
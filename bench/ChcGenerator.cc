@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ChcGenerator.h"
+
+#include "ChcInterpreter.h"
+#include "Normalizer.h"
+#include "graph/ChcGraphBuilder.h"
+#include "transformers/BasicTransformationPipelines.h"
+
+#include "osmt_parser.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::string conjunction(std::vector<std::string> const & conjuncts) {
+    if (conjuncts.empty()) { return "true"; }
+    if (conjuncts.size() == 1) { return conjuncts[0]; }
+    std::string result = "(and";
+    for (auto const & conjunct : conjuncts) {
+        result += ' ';
+        result += conjunct;
+    }
+    return result + ')';
+}
+
+class ScriptWriter {
+    std::ostringstream out;
+    unsigned depth;
+
+public:
+    explicit ScriptWriter(unsigned depth) : depth(depth) {}
+
+    std::string var(unsigned counter) const { return "x" + std::to_string(counter); }
+    std::string nextVar(unsigned counter) const { return "y" + std::to_string(counter); }
+
+    std::string predicate(unsigned index, bool next) const {
+        std::string result = "(P" + std::to_string(index);
+        for (unsigned j = 1; j <= depth; ++j) {
+            result += ' ';
+            result += next ? nextVar(j) : var(j);
+        }
+        return result + ')';
+    }
+
+    void declare(unsigned index) {
+        out << "(declare-fun P" << index << " (";
+        for (unsigned j = 1; j <= depth; ++j) {
+            out << (j > 1 ? " " : "") << "Int";
+        }
+        out << ") Bool)\n";
+    }
+
+    void clause(std::string const & body, std::string const & head) {
+        out << "(assert (forall (";
+        for (unsigned j = 1; j <= depth; ++j) {
+            out << '(' << var(j) << " Int)(" << nextVar(j) << " Int)";
+        }
+        out << ") (=> " << body << ' ' << head << ")))\n";
+    }
+
+    std::string script() const { return "(set-logic HORN)\n" + out.str(); }
+};
+} // namespace
+
+std::string generateChcScript(ChcShape const & shape) {
+    if (shape.loopDepth == 0 or shape.predicates == 0 or shape.edges == 0) {
+        throw std::invalid_argument("Generated CHC system must have at least one counter, predicate and edge");
+    }
+    ScriptWriter writer(shape.loopDepth);
+    for (unsigned i = 0; i < shape.predicates; ++i) {
+        writer.declare(i);
+    }
+    // Initial states: all counters are zero
+    std::vector<std::string> initial;
+    for (unsigned j = 1; j <= shape.loopDepth; ++j) {
+        initial.push_back("(= " + writer.nextVar(j) + " 0)");
+    }
+    writer.clause(conjunction(initial), writer.predicate(0, true));
+    for (unsigned i = 0; i < shape.predicates; ++i) {
+        // Loop of counter j: increment it, reset the nested counters and keep the outer ones
+        for (unsigned j = 1; j <= shape.loopDepth; ++j) {
+            std::vector<std::string> body{writer.predicate(i, false)};
+            for (unsigned k = 1; k <= shape.loopDepth; ++k) {
+                std::string value = k < j    ? writer.var(k)
+                                    : k == j ? "(+ " + writer.var(k) + " 1)"
+                                             : std::string("0");
+                body.push_back("(= " + writer.nextVar(k) + ' ' + value + ')');
+            }
+            writer.clause(conjunction(body), writer.predicate(i, true));
+        }
+        if (i + 1 == shape.predicates) { break; }
+        // Parallel edges to the next predicate that differ in the guard on the outermost counter
+        for (unsigned e = 0; e < shape.edges; ++e) {
+            std::vector<std::string> body{writer.predicate(i, false),
+                                          "(>= " + writer.var(1) + ' ' + std::to_string(i + e) + ')'};
+            for (unsigned k = 1; k <= shape.loopDepth; ++k) {
+                body.push_back("(= " + writer.nextVar(k) + ' ' + writer.var(k) + ')');
+            }
+            writer.clause(conjunction(body), writer.predicate(i + 1, true));
+        }
+    }
+    // The outermost counter never decreases, so it can never be negative; any other bound on it is reachable
+    std::string violation = shape.safe ? "(< " + writer.var(1) + " 0)"
+                                       : "(>= " + writer.var(1) + ' ' + std::to_string(shape.predicates + 1) + ')';
+    writer.clause(conjunction({writer.predicate(shape.predicates - 1, false), violation}), "false");
+    return writer.script();
+}
+
+std::unique_ptr<ChcSystem> parseChcScript(Logic & logic, std::string script) {
+    Smt2newContext context(script.data());
+    if (smt2newparse(&context) != 0) { throw std::logic_error("Error when parsing generated CHC system"); }
+    Options options;
+    return ChcInterpreter(options).interpretSystemAst(logic, context.getRoot());
+}
+
+std::unique_ptr<ChcDirectedHyperGraph> buildGraph(Logic & logic, ChcSystem const & system) {
+    auto normalizedSystem = Normalizer(logic).normalize(system);
+    return ChcGraphBuilder(logic).buildGraph(normalizedSystem);
+}
+
+std::unique_ptr<ChcDirectedHyperGraph> preprocess(std::unique_ptr<ChcDirectedHyperGraph> graph) {
+    return Transformations::defaultPreprocessing().transform(std::move(graph)).first;
+}
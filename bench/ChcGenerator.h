@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_CHCGENERATOR_H
+#define GOLEM_CHCGENERATOR_H
+
+#include "ChcSystem.h"
+#include "graph/ChcGraph.h"
+
+#include <memory>
+#include <string>
+
+/**
+ * Shape of a generated CHC system.
+ *
+ * The system is a chain of predicates P0, ..., P(predicates-1) over the integer counters x1, ..., x(loopDepth).
+ * Every predicate has a self-loop for each counter that models a nest of loops: the loop of counter j increments it
+ * and resets all the counters nested in it. Consecutive predicates are connected by `edges` parallel edges with
+ * different guards. The query on the last predicate is unreachable for safe systems and reachable otherwise.
+ */
+struct ChcShape {
+    unsigned loopDepth;
+    unsigned predicates;
+    unsigned edges;
+    bool safe;
+};
+
+/** Generates the SMT-LIB script of the CHC system of the given shape; the script does not contain check-sat */
+std::string generateChcScript(ChcShape const & shape);
+
+/** Parses the given script into a CHC system over the given logic */
+std::unique_ptr<ChcSystem> parseChcScript(Logic & logic, std::string script);
+
+/** Normalizes the system and builds its graph, as the first steps of the solving process */
+std::unique_ptr<ChcDirectedHyperGraph> buildGraph(Logic & logic, ChcSystem const & system);
+
+/** Applies the preprocessing pipeline used before the system is passed to an engine */
+std::unique_ptr<ChcDirectedHyperGraph> preprocess(std::unique_ptr<ChcDirectedHyperGraph> graph);
+
+#endif // GOLEM_CHCGENERATOR_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "BenchCorpus.h"
+
+#include "engine/Bmc.h"
+#include "engine/IMC.h"
+#include "engine/Kind.h"
+#include "engine/Lawi.h"
+#include "engine/Spacer.h"
+#include "engine/TPA.h"
+
+namespace {
+std::unique_ptr<Engine> makeEngine(std::string const & name, Logic & logic, Options const & options) {
+    if (name == TPAEngine::TPA or name == TPAEngine::SPLIT_TPA) { return std::make_unique<TPAEngine>(logic, options); }
+    if (name == "bmc") { return std::make_unique<BMC>(logic, options); }
+    if (name == "imc") { return std::make_unique<IMC>(logic, options); }
+    if (name == "kind") { return std::make_unique<Kind>(logic, options); }
+    if (name == "lawi") { return std::make_unique<Lawi>(logic, options); }
+    if (name == "spacer") { return std::make_unique<Spacer>(logic, options); }
+    throw std::invalid_argument("Unknown engine " + name);
+}
+
+/*
+ * Solves the preprocessed system, as golem does after parsing. Each iteration works in a fresh logic, so that the
+ * engine cannot profit from the terms created in the previous iterations.
+ */
+void BM_Engine(benchmark::State & state, std::string engineName, bool safe) {
+    auto script = generateChcScript(shapeOf(state, safe));
+    Options options;
+    options.addOption(Options::ENGINE, engineName);
+    auto expected = safe ? VerificationAnswer::SAFE : VerificationAnswer::UNSAFE;
+    std::unique_ptr<ArithLogic> logic;
+    std::unique_ptr<ChcDirectedHyperGraph> graph;
+    std::unique_ptr<Engine> engine;
+    for (auto _ : state) {
+        state.PauseTiming();
+        // The engine and the graph of the previous iteration refer to the old logic
+        engine.reset();
+        graph.reset();
+        logic = std::make_unique<ArithLogic>(opensmt::Logic_t::QF_LIA);
+        graph = preprocess(buildGraph(*logic, *parseChcScript(*logic, script)));
+        engine = makeEngine(engineName, *logic, options);
+        state.ResumeTiming();
+        auto result = engine->solve(*graph);
+        if (result.getAnswer() != expected) {
+            state.SkipWithError("Engine returned unexpected answer");
+            break;
+        }
+    }
+}
+} // namespace
+
+// BMC cannot prove safety, it is only measured on the unsafe systems
+BENCHMARK_CAPTURE(BM_Engine, bmc_unsafe, "bmc", false)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, imc_safe, "imc", true)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, imc_unsafe, "imc", false)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, kind_safe, "kind", true)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, kind_unsafe, "kind", false)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, lawi_safe, "lawi", true)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, lawi_unsafe, "lawi", false)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, spacer_safe, "spacer", true)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, spacer_unsafe, "spacer", false)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, tpa_safe, "tpa", true)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, tpa_unsafe, "tpa", false)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, split_tpa_safe, "split-tpa", true)->Apply(engineCorpus);
+BENCHMARK_CAPTURE(BM_Engine, split_tpa_unsafe, "split-tpa", false)->Apply(engineCorpus);
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "BenchCorpus.h"
+
+#include "transformers/BasicTransformationPipelines.h"
+#include "transformers/SingleLoopTransformation.h"
+
+namespace {
+void BM_Parse(benchmark::State & state) {
+    auto script = generateChcScript(shapeOf(state, true));
+    std::unique_ptr<ArithLogic> logic;
+    std::unique_ptr<ChcSystem> system;
+    for (auto _ : state) {
+        // Fresh logic, so that no term is already known from the previous iteration
+        state.PauseTiming();
+        system.reset();
+        logic = std::make_unique<ArithLogic>(opensmt::Logic_t::QF_LIA);
+        state.ResumeTiming();
+        system = parseChcScript(*logic, script);
+        benchmark::DoNotOptimize(system);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * script.size()));
+}
+
+void BM_Normalize(benchmark::State & state) {
+    ArithLogic logic{opensmt::Logic_t::QF_LIA};
+    auto system = parseChcScript(logic, generateChcScript(shapeOf(state, true)));
+    for (auto _ : state) {
+        auto graph = buildGraph(logic, *system);
+        benchmark::DoNotOptimize(graph);
+    }
+}
+
+template<typename TTransformer> void BM_Transformer(benchmark::State & state) {
+    ArithLogic logic{opensmt::Logic_t::QF_LIA};
+    auto system = parseChcScript(logic, generateChcScript(shapeOf(state, true)));
+    auto const graph = buildGraph(logic, *system);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto input = std::make_unique<ChcDirectedHyperGraph>(*graph);
+        TTransformer transformer;
+        state.ResumeTiming();
+        auto result = transformer.transform(std::move(input));
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void BM_DefaultPreprocessing(benchmark::State & state) {
+    ArithLogic logic{opensmt::Logic_t::QF_LIA};
+    auto system = parseChcScript(logic, generateChcScript(shapeOf(state, true)));
+    auto const graph = buildGraph(logic, *system);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto input = std::make_unique<ChcDirectedHyperGraph>(*graph);
+        state.ResumeTiming();
+        auto result = Transformations::defaultPreprocessing().transform(std::move(input));
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void BM_SingleLoopTransformation(benchmark::State & state) {
+    ArithLogic logic{opensmt::Logic_t::QF_LIA};
+    auto system = parseChcScript(logic, generateChcScript(shapeOf(state, true)));
+    auto graph = Transformations::towardsTransitionSystems().transform(buildGraph(logic, *system)).first;
+    if (not graph->isNormalGraph()) {
+        state.SkipWithError("Generated system is not linear");
+        return;
+    }
+    auto const normalGraph = graph->toNormalGraph();
+    for (auto _ : state) {
+        auto result = SingleLoopTransformation{}.transform(*normalGraph);
+        benchmark::DoNotOptimize(result);
+    }
+}
+} // namespace
+
+BENCHMARK(BM_Parse)->Apply(preprocessingCorpus);
+BENCHMARK(BM_Normalize)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, ConstraintSimplifier)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, SimpleChainSummarizer)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, RemoveUnreachableNodes)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, SimpleNodeEliminator)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, NonLoopEliminator)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, MultiEdgeMerger)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, FalseClauseRemoval)->Apply(preprocessingCorpus);
+BENCHMARK_TEMPLATE(BM_Transformer, TrivialEdgePruner)->Apply(preprocessingCorpus);
+BENCHMARK(BM_DefaultPreprocessing)->Apply(preprocessingCorpus);
+BENCHMARK(BM_SingleLoopTransformation)->Apply(preprocessingCorpus);
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ModelBasedProjection.h"
+#include "QuantifierElimination.h"
+#include "utils/SmtSolver.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+/*
+ * Generated formula x_0 = 0 /\ x_{i+1} = x_i + y_i /\ 0 <= y_i <= i + 1 for i < n, i.e., a sequence of steps of bounded
+ * length; only x_0 and x_n are kept by the projection.
+ */
+struct SteppingFormula {
+    PTRef formula;
+    vec<PTRef> toEliminate;
+    vec<PTRef> toKeep;
+
+    SteppingFormula(ArithLogic & logic, std::size_t steps) {
+        vec<PTRef> conjuncts;
+        bool integral = logic.hasIntegers();
+        auto mkVar = [&](char const * prefix, std::size_t index) {
+            std::string name = prefix + std::to_string(index);
+            return integral ? logic.mkIntVar(name.c_str()) : logic.mkRealVar(name.c_str());
+        };
+        auto mkConst = [&](int value) { return integral ? logic.mkIntConst(value) : logic.mkRealConst(value); };
+        PTRef current = mkVar("x", 0);
+        toKeep.push(current);
+        conjuncts.push(logic.mkEq(current, mkConst(0)));
+        for (std::size_t i = 0; i < steps; ++i) {
+            PTRef step = mkVar("y", i);
+            PTRef next = mkVar("x", i + 1);
+            conjuncts.push(logic.mkEq(next, logic.mkPlus(current, step)));
+            conjuncts.push(logic.mkGeq(step, mkConst(0)));
+            conjuncts.push(logic.mkLeq(step, mkConst(static_cast<int>(i + 1))));
+            toEliminate.push(step);
+            if (i + 1 < steps) { toEliminate.push(next); }
+            current = next;
+        }
+        toKeep.push(current);
+        formula = logic.mkAnd(std::move(conjuncts));
+    }
+};
+
+template<opensmt::Logic_t theory> void BM_MBP(benchmark::State & state) {
+    ArithLogic logic{theory};
+    SteppingFormula input(logic, static_cast<std::size_t>(state.range(0)));
+    SMTSolver solver(logic, SMTSolver::WitnessProduction::ONLY_MODEL);
+    solver.getCoreSolver().insertFormula(input.formula);
+    if (solver.check() != s_True) {
+        state.SkipWithError("Generated formula is not satisfiable");
+        return;
+    }
+    auto model = solver.getCoreSolver().getModel();
+    for (auto _ : state) {
+        PTRef projection = ModelBasedProjection(logic).project(input.formula, input.toEliminate, *model);
+        benchmark::DoNotOptimize(projection);
+    }
+}
+
+template<opensmt::Logic_t theory> void BM_QE(benchmark::State & state) {
+    ArithLogic logic{theory};
+    SteppingFormula input(logic, static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        PTRef result = QuantifierElimination(logic).keepOnly(input.formula, input.toKeep);
+        benchmark::DoNotOptimize(result);
+    }
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MBP, opensmt::Logic_t::QF_LRA)->ArgName("steps")->RangeMultiplier(4)->Range(2, 128);
+BENCHMARK_TEMPLATE(BM_MBP, opensmt::Logic_t::QF_LIA)->ArgName("steps")->RangeMultiplier(4)->Range(2, 128);
+BENCHMARK_TEMPLATE(BM_QE, opensmt::Logic_t::QF_LRA)->ArgName("steps")->RangeMultiplier(2)->Range(2, 16);
+BENCHMARK_TEMPLATE(BM_QE, opensmt::Logic_t::QF_LIA)->ArgName("steps")->RangeMultiplier(2)->Range(2, 16);
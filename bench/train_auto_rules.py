@@ -0,0 +1,103 @@
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+# Fits the rule table of engine auto (see src/engine/Auto.h) to the results of the engines on a set of benchmarks.
+# Every engine is run on every benchmark with the given time limit; the table is printed to the standard output and
+# can be passed to golem with --auto.rules, or pasted into the built-in rules in src/engine/Auto.cc.
+# Usage: python3 train_auto_rules.py <golem executable> <time limit in seconds> <benchmark.smt2> [...]
+
+golem_exec = sys.argv[1]
+time_limit = float(sys.argv[2])
+benchmarks = sys.argv[3:]
+
+engines = ["spacer", "lawi", "kind", "imc", "bmc", "tpa", "split-tpa"]
+
+# Conditions of the rules, from the most specific; each benchmark is assigned to the first condition it satisfies
+conditions = [
+    "transition-system=1",
+    "transition-system-dag=1",
+    "linear=1 predicates>=20",
+    "linear=1",
+    "*",
+]
+
+
+def run(benchmark, engine):
+    with tempfile.TemporaryDirectory() as directory:
+        result_file = os.path.join(directory, "result.json")
+        features_file = os.path.join(directory, "features.json")
+        start = time.perf_counter()
+        subprocess.call([golem_exec, "--engine", engine, "--time-limit", str(time_limit), "--result-json",
+                         result_file, "--auto.features", features_file, benchmark],
+                        stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, timeout=2 * time_limit + 10)
+        elapsed = time.perf_counter() - start
+        solved = False
+        if os.path.exists(result_file):
+            with open(result_file) as f:
+                solved = json.load(f)["answer"] != "unknown"
+        features = None
+        if os.path.exists(features_file):
+            with open(features_file) as f:
+                features = json.load(f)
+        return solved, elapsed, features
+
+
+def holds(condition, features):
+    for part in condition.split():
+        if part == "*":
+            continue
+        for relation, test in (("<=", lambda a, b: a <= b), (">=", lambda a, b: a >= b), ("=", lambda a, b: a == b)):
+            if relation in part:
+                name, value = part.split(relation)
+                if not test(features[name], int(value)):
+                    return False
+                break
+    return True
+
+
+def par2(results, engine):
+    return sum(r[engine][1] if r[engine][0] else 2 * time_limit for r in results)
+
+
+def schedule_for(results):
+    def score(engine):
+        return -sum(r[engine][0] for r in results), par2(results, engine)
+
+    ranked = sorted(engines, key=score)
+    best, second = ranked[0], ranked[1]
+    # The second engine is worth a slot only if it solves something the best one does not
+    if not any(r[second][0] and not r[best][0] for r in results):
+        return best
+    solved_times = [r[best][1] for r in results if r[best][0]]
+    if not solved_times:
+        return second
+    slice_length = max(1, round(1.2 * max(solved_times)))
+    return f"{best}:{slice_length} {second}"
+
+
+results = []
+auto_solved = 0
+for benchmark in benchmarks:
+    solved, _, features = run(benchmark, "auto")
+    auto_solved += solved
+    if features is None:
+        print("No features computed for", benchmark, file=sys.stderr)
+        continue
+    entry = {"features": features}
+    for engine in engines:
+        solved, elapsed, _ = run(benchmark, engine)
+        entry[engine] = (solved, elapsed)
+    results.append(entry)
+
+print("# Generated by bench/train_auto_rules.py from", len(results), "benchmarks with time limit", time_limit, "s")
+remaining = results
+for condition in conditions:
+    matching = [r for r in remaining if holds(condition, r["features"])]
+    remaining = [r for r in remaining if not holds(condition, r["features"])]
+    if matching or condition == "*":
+        print(condition, "->", schedule_for(matching or results))
+print("Current rules solved", auto_solved, "of", len(benchmarks), "benchmarks", file=sys.stderr)
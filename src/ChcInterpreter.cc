@@ -10,18 +10,14 @@
 #include "graph/ChcGraph.h"
 #include "graph/ChcGraphBuilder.h"
 #include "proofs/Term.h"
-#include "transformers/ConstraintSimplifier.h"
-#include "transformers/MultiEdgeMerger.h"
-#include "transformers/NodeEliminator.h"
-#include "transformers/RemoveUnreachableNodes.h"
-#include "transformers/SimpleChainSummarizer.h"
-#include "transformers/TransformationPipeline.h"
-#include <engine/Bmc.h>
-#include <engine/IMC.h>
-#include <engine/Kind.h>
-#include <engine/Lawi.h>
-#include <engine/Spacer.h>
-#include <engine/TPA.h>
+#include "transformers/BasicTransformationPipelines.h"
+#include "utils/ResourceGovernor.h"
+#include "utils/SmtLibCommandReader.h"
+#include "utils/Statistics.h"
+#include "osmt_parser.h"
+#include <engine/EngineFactory.h>
+#include <engine/Modular.h>
+#include <fstream>
 #include <memory>
 #include <signal.h>
 #include <sys/types.h>
@@ -45,13 +41,48 @@ bool addLetFrame(const vec<char *> & names, vec<PTRef> const & args, Logic & log
     }
     return true;
 }
+
+/** Explains an UNKNOWN answer, including the partial result established by the engine */
+void reportPartialResult(VerificationResult const & result) {
+    if (not result.hasWitness() and not result.getNoWitnessReason().empty()) {
+        std::cerr << ";Reason: " << result.getNoWitnessReason() << std::endl;
+    }
+    if (auto bound = result.getSafeBound()) {
+        std::cerr << ";System is safe up to " << *bound << " transitions" << std::endl;
+    }
+}
 } // namespace
 
+void ChcInterpreter::writeResultJson(Options const & opts, std::string_view engine, VerificationResult const & result) {
+    if (not opts.hasOption(Options::RESULT_JSON)) { return; }
+    auto path = opts.getOption(Options::RESULT_JSON);
+    if (path == "-") {
+        result.printJson(std::cout, engine);
+        return;
+    }
+    std::ofstream out(path);
+    if (out) {
+        result.printJson(out, engine);
+    } else {
+        std::cerr << "Could not write result to " << path << '\n';
+    }
+}
+
 std::unique_ptr<ChcSystem> ChcInterpreter::interpretSystemAst(Logic & logic, const ASTNode * root) {
-    ChcInterpreterContext ctx(logic, opts);
+    ChcInterpreterContext ctx(logic, opts, cache);
     return ctx.interpretSystemAst(root);
 }
 
+std::unique_ptr<ChcSystem> ChcInterpreter::interpretSystemStream(Logic & logic, SmtLibCommandReader & reader) {
+    ChcInterpreterContext ctx(logic, opts, cache);
+    return ctx.interpretSystemStream(reader);
+}
+
+void ChcInterpreter::solvePreprocessed(Logic & logic, PreprocessingCache::Entry & entry) {
+    ChcInterpreterContext ctx(logic, opts);
+    ctx.solvePreprocessed(entry);
+}
+
 std::unique_ptr<ChcSystem> ChcInterpreterContext::interpretSystemAst(const ASTNode * root) {
     if (not root) { return std::unique_ptr<ChcSystem>(); }
     this->system.reset();
@@ -64,6 +95,24 @@ std::unique_ptr<ChcSystem> ChcInterpreterContext::interpretSystemAst(const ASTNo
     return std::move(this->system);
 }
 
+std::unique_ptr<ChcSystem> ChcInterpreterContext::interpretSystemStream(SmtLibCommandReader & reader) {
+    this->system.reset();
+    while (not this->doExit) {
+        auto commandText = reader.nextCommand();
+        if (not commandText) { break; }
+        // The parser needs its own null-terminated buffer; it lives only as long as the syntax tree of the command
+        std::string buffer(*commandText);
+        Smt2newContext context(buffer.data());
+        if (smt2newparse(&context) != 0) { throw ChcInterpreter::ParseError("Error when parsing input file"); }
+        ASTNode const * root = context.getRoot();
+        if (not root or not root->children) { continue; }
+        for (auto it = root->children->begin(); it != root->children->end() && not this->doExit; ++it) {
+            interpretCommand(**it);
+        }
+    }
+    return std::move(this->system);
+}
+
 void ChcInterpreterContext::interpretCommand(ASTNode & node) {
     assert(node.getType() == CMD_T);
     const smt2token cmd = node.getToken();
@@ -193,74 +242,85 @@ void ChcInterpreterContext::interpretAssert(ASTNode & node) {
     if (logic.getTerm_true() == term) { return; }
     auto chclause = chclauseFromPTRef(term);
     system->addClause(std::move(chclause));
-    if (opts.hasOption(Options::PRINT_WITNESS)) { originalAssertions.push_back(ASTtoTerm(termNode)); }
+    if (needsOriginalAssertions()) { originalAssertions.push_back(ASTtoTerm(termNode)); }
+}
+
+/*
+ * Original form of the assertions is needed only for the proof formats that refer to the input clauses.
+ */
+bool ChcInterpreter::needsOriginalAssertions(Options const & opts) {
+    if (not opts.hasOption(Options::PRINT_WITNESS)) { return false; }
+    auto format = opts.getOption(Options::PROOF_FORMAT);
+    return format == "alethe" or format == "intermediate";
+}
+
+bool ChcInterpreterContext::needsOriginalAssertions() const {
+    return ChcInterpreter::needsOriginalAssertions(opts);
 }
 
-std::shared_ptr<Term> ChcInterpreterContext::ASTtoTerm(const ASTNode & node) {
+TermRef ChcInterpreterContext::ASTtoTerm(const ASTNode & node) {
 
     ASTType t = node.getType();
     if (t == TERM_T) {
         std::string name = (**(node.children->begin())).getValue();
         if (name.find('.') != std::string::npos) {
-            return std::make_shared<Terminal>(name, Term::REAL);
+            return proofTerms.mkTerminal(name, TerminalType::REAL);
         } else {
-            return std::make_shared<Terminal>(name, Term::INT);
+            return proofTerms.mkTerminal(name, TerminalType::INT);
         }
     } else if (t == FORALL_T) { // Forall has two children: sorted_var_list and term
         auto it = node.children->begin();
         ASTNode & qvars = **it;
         assert(qvars.getType() == SVL_T);
-        std::vector<std::shared_ptr<Term>> vars;
-        std::vector<std::shared_ptr<Term>> sorts;
+        std::vector<TermRef> vars;
+        std::vector<TermRef> sorts;
         for (ASTNode * var : *qvars.children) {
             assert(var && var->getType() == SV_T);
             // make sure the term store know about these variables
             std::string name = var->getValue();
-            auto var_term = std::make_shared<Terminal>(name, Term::VAR);
             std::string sort = (*var->children->begin())->getValue();
-            auto sort_term = std::make_shared<Terminal>(sort, Term::SORT);
-            vars.push_back(var_term);
-            sorts.push_back(sort_term);
+            vars.push_back(proofTerms.mkTerminal(name, TerminalType::VAR));
+            sorts.push_back(proofTerms.mkTerminal(sort, TerminalType::SORT));
         }
         assert(vars.size() == sorts.size());
         ASTNode & innerTerm = **(++it);
-        return std::make_shared<Quant>("forall", vars, sorts, ASTtoTerm(innerTerm));
+        return proofTerms.mkQuant("forall", vars, sorts, ASTtoTerm(innerTerm));
     } else if (t == QID_T) {
         std::string name = (**(node.children->begin())).getValue();
         if (name == "true" or name == "false") {
-            return std::make_shared<Terminal>(name, Term::BOOL);
+            return proofTerms.mkTerminal(name, TerminalType::BOOL);
         } else {
-            return std::make_shared<Terminal>(logic.protectName(name, false), Term::VAR);
+            return proofTerms.mkTerminal(logic.protectName(name, false), TerminalType::VAR);
         }
     } else if (t == LQID_T) {
         auto it = node.children->begin();
         std::string op = (**it).getValue();
         it++;
-        std::vector<std::shared_ptr<Term>> args;
+        std::vector<TermRef> args;
         for (; it != node.children->end(); it++) {
-            std::shared_ptr arg_term = ASTtoTerm(**it);
-            args.push_back(arg_term);
+            args.push_back(ASTtoTerm(**it));
         }
         assert(args.size() > 0);
 
-        if (op == "-" or op == "+") {
-            if (args.size() <= 1) { return std::make_shared<Terminal>("(- " + args[0]->printTerm() + ")", Term::INT); }
+        if (op == "-" and args.size() == 1 and proofTerms.isNumeral(args[0])) {
+            // Negative literal, kept as written in the input
+            auto literal = "(- " + proofTerms.printTerm(args[0]) + ")";
+            return proofTerms.mkTerminal(literal, proofTerms.getTerminalType(args[0]));
         }
         if (isOperator(op)) {
-            return std::make_shared<Op>(op, args);
+            return proofTerms.mkOp(op, args);
         } else {
-            return std::make_shared<App>(logic.protectName(op, false), args);
+            return proofTerms.mkApp(logic.protectName(op, false), args);
         }
     } else if (t == LET_T) {
         auto ch = node.children->begin();
         auto vbl = (**ch).children->begin();
-        std::vector<std::shared_ptr<Term>> declarations;
+        std::vector<TermRef> declarations;
         std::vector<std::string> termNames;
 
         // First read the term declarations in the let statement
         while (vbl != (**ch).children->end()) {
-            std::shared_ptr<Term> declaration = ASTtoTerm(**((**vbl).children->begin()));
-            declarations.push_back(declaration);
+            declarations.push_back(ASTtoTerm(**((**vbl).children->begin())));
             std::string name = (**vbl).getValue();
             termNames.push_back(name);
             vbl++;
@@ -268,8 +328,8 @@ std::shared_ptr<Term> ChcInterpreterContext::ASTtoTerm(const ASTNode & node) {
 
         ch++;
         // This is now constructed with the let declarations context in let_branch
-        std::shared_ptr<Term> application = ASTtoTerm(**(ch));
-        return std::make_shared<Let>(termNames, declarations, application);
+        TermRef application = ASTtoTerm(**(ch));
+        return proofTerms.mkLet(termNames, declarations, application);
     }
 
     throw std::logic_error("Unknown term encountered!");
@@ -388,7 +448,16 @@ PTRef ChcInterpreterContext::parseTerm(const ASTNode & termNode) {
 
 VerificationResult ChcInterpreterContext::solve(std::string engine_s, ChcDirectedHyperGraph const & hypergraph) {
     auto engine = getEngine(engine_s);
-    auto result = engine->solve(hypergraph);
+    auto result = [&]() {
+        try {
+            return engine->solve(hypergraph);
+        } catch (ResourceGovernor::LimitReached const & limit) {
+            // The limit has been reached outside of the engine's main loop, e.g., in its own preprocessing
+            return VerificationResult(VerificationAnswer::UNKNOWN, NoWitness(limit.what()));
+        }
+    }();
+    // Once the answer is known, processing the witness is not limited
+    if (result.getAnswer() != VerificationAnswer::UNKNOWN) { ResourceGovernor::release(); }
     switch (result.getAnswer()) {
         case VerificationAnswer::SAFE: {
             std::cout << "sat" << std::endl;
@@ -415,11 +484,14 @@ void ChcInterpreterContext::validate(VerificationResult result, ChcDirectedHyper
         return;
     }
 
+    if (result.getAnswer() == VerificationAnswer::UNSAFE) { result.getInvalidityWitness().compact(); }
+    std::size_t threads = opts.hasOption(Options::THREADS) ? std::stoul(opts.getOption(Options::THREADS)) : 1;
     if (printWitness) {
-        result.printWitness(std::cout, logic, originalGraph, originalAssertions, normalizingEqualities, format);
+        result.printWitness(std::cout, logic, originalGraph, proofTerms, originalAssertions, normalizingEqualities,
+                            format, threads);
     }
     if (validateWitness) {
-        auto validationResult = Validator(logic).validate(originalGraph, result);
+        auto validationResult = Validator(logic, threads).validate(originalGraph, result);
         switch (validationResult) {
             case Validator::Result::VALIDATED: {
                 std::cout << "Internal witness validation successful!" << std::endl;
@@ -436,57 +508,76 @@ void ChcInterpreterContext::validate(VerificationResult result, ChcDirectedHyper
 }
 
 void ChcInterpreterContext::interpretCheckSat() {
-
     bool validateWitness = opts.hasOption(Options::VALIDATE_RESULT);
-    assert(not validateWitness || opts.getOption(Options::VALIDATE_RESULT) == std::string("true"));
     bool printWitness = opts.hasOption(Options::PRINT_WITNESS);
-    std::string format = "legacy";
-    if (opts.hasOption(Options::PROOF_FORMAT)) { format = opts.getOption(Options::PROOF_FORMAT); }
-    assert(not printWitness || opts.getOption(Options::PRINT_WITNESS) == std::string("true"));
+    // The cached entry always contains the original graph, so that it can be reused with any options
+    bool storeToCache = cache != nullptr and not needsOriginalAssertions();
 
-    Normalizer normalizer(logic);
+    std::size_t threads = opts.hasOption(Options::THREADS) ? std::stoul(opts.getOption(Options::THREADS)) : 0;
+    Normalizer normalizer(logic, threads);
     auto normalizedSystem = normalizer.normalize(*system);
     auto const & normalizingEqualities = normalizer.getNormalizingEqualities();
 
     auto hypergraph = ChcGraphBuilder(logic).buildGraph(normalizedSystem);
     std::unique_ptr<ChcDirectedHyperGraph> originalGraph{nullptr};
-    if (validateWitness or printWitness) { // Store copy of the original graph for validating purposes
+    if (validateWitness or printWitness or storeToCache) { // Store copy of the original graph for validating purposes
         originalGraph = std::make_unique<ChcDirectedHyperGraph>(*hypergraph);
     }
 
-    TransformationPipeline::pipeline_t transformations;
-    transformations.push_back(std::make_unique<ConstraintSimplifier>());
-    transformations.push_back(std::make_unique<SimpleChainSummarizer>());
-    transformations.push_back(std::make_unique<RemoveUnreachableNodes>());
-    transformations.push_back(std::make_unique<SimpleNodeEliminator>());
-    transformations.push_back(std::make_unique<MultiEdgeMerger>());
-    // TODO: Try following MultiEdgeMerger by another round of SimpleChainSummarizer and/or SimpleNodeEliminator?
-    auto [newGraph, translator] = TransformationPipeline(std::move(transformations)).transform(std::move(hypergraph));
+    auto [newGraph, translator] = Transformations::defaultPreprocessing(threads).transform(std::move(hypergraph));
     hypergraph = std::move(newGraph);
-    // This if is needed to run the portfolio of multiple engines
-    if (opts.getOption(Options::ENGINE).find(',') != std::string::npos) {
-        std::string tmp;
-        std::vector<std::string> engines;
-        std::stringstream ss(opts.getOption(Options::ENGINE));
-        while (getline(ss, tmp, ',')) {
-            engines.push_back(tmp);
-        }
+    if (storeToCache) {
+        // Failure to store the entry is not an error, the next run simply preprocesses the system again
+        cache->store(logic, *originalGraph, *hypergraph, *translator);
+    }
+    solveAndReport(*hypergraph, originalGraph.get(), *translator, normalizingEqualities);
+}
+
+void ChcInterpreterContext::solvePreprocessed(PreprocessingCache::Entry & entry) {
+    assert(entry.originalGraph and entry.graph and entry.translator);
+    // Normalizing equalities are needed only for the proof formats that bypass the cache
+    solveAndReport(*entry.graph, entry.originalGraph.get(), *entry.translator, {});
+}
+
+void ChcInterpreterContext::solveAndReport(ChcDirectedHyperGraph const & graph,
+                                           ChcDirectedHyperGraph const * originalGraph,
+                                           WitnessBackTranslator & translator,
+                                           Normalizer::Equalities const & normalizingEqualities) {
+    bool validateWitness = opts.hasOption(Options::VALIDATE_RESULT);
+    assert(not validateWitness || opts.getOption(Options::VALIDATE_RESULT) == std::string("true"));
+    bool printWitness = opts.hasOption(Options::PRINT_WITNESS);
+    std::string format = "legacy";
+    if (opts.hasOption(Options::PROOF_FORMAT)) { format = opts.getOption(Options::PROOF_FORMAT); }
+    assert(not printWitness || opts.getOption(Options::PRINT_WITNESS) == std::string("true"));
+    assert(not (validateWitness or printWitness) or originalGraph);
+
+    std::string portfolio = opts.hasOption(Options::PORTFOLIO) ? opts.getOption(Options::PORTFOLIO) : "parallel";
+    if (portfolio != "parallel" and portfolio != "sequential") {
+        throw std::invalid_argument("Unknown portfolio mode specified");
+    }
+    // This if is needed to run the portfolio of multiple engines; the sequential portfolio is an engine on its own
+    if (opts.getOption(Options::ENGINE).find(',') != std::string::npos and portfolio == "parallel") {
+        auto engines = splitEngines(opts.getOption(Options::ENGINE));
 
         pid_t parent = getpid();
         std::vector<pid_t> processes;
         for (uint i = 0; i < engines.size(); i++) {
             if (getpid() == parent) { processes.push_back(fork()); }
             if (processes[i] == 0) {
-                auto result = solve(engines[i], *hypergraph);
+                auto result = solve(engines[i], graph);
                 if (result.getAnswer() == VerificationAnswer::UNKNOWN) { exit(1); }
+                // Only the winning engine reports its result
+                ChcInterpreter::writeResultJson(opts, engines[i], result);
                 if (validateWitness || printWitness) {
-                    validate(std::move(result), *originalGraph, validateWitness, printWitness, *translator,
+                    validate(std::move(result), *originalGraph, validateWitness, printWitness, translator,
                              normalizingEqualities, format);
                 }
                 return;
             }
         }
 
+        // The statistics are reported by the process of the winning engine
+        Statistics::disable();
         while (true) {
             int status;
             // Parent process waits until at least one child finishes
@@ -506,14 +597,16 @@ void ChcInterpreterContext::interpretCheckSat() {
         }
     }
 
-    auto result = solve(opts.hasOption(Options::ENGINE) ? opts.getOption(Options::ENGINE) : "spacer", *hypergraph);
+    auto engine = opts.hasOption(Options::ENGINE) ? opts.getOption(Options::ENGINE) : "spacer";
+    auto result = solve(engine, graph);
+    ChcInterpreter::writeResultJson(opts, engine, result);
     if (result.getAnswer() == VerificationAnswer::UNKNOWN) {
         std::cout << "unknown" << std::endl;
+        reportPartialResult(result);
         return;
     }
     if (validateWitness || printWitness) {
-
-        validate(std::move(result), *originalGraph, validateWitness, printWitness, *translator, normalizingEqualities,
+        validate(std::move(result), *originalGraph, validateWitness, printWitness, translator, normalizingEqualities,
                  format);
     }
 }
@@ -584,19 +677,10 @@ bool ChcInterpreterContext::isUninterpretedPredicate(PTRef ref) const {
 }
 
 std::unique_ptr<Engine> ChcInterpreterContext::getEngine(std::string const & engineStr) const {
-    if (engineStr == TPAEngine::TPA or engineStr == TPAEngine::SPLIT_TPA) {
-        return std::unique_ptr<Engine>(new TPAEngine(logic, opts));
-    } else if (engineStr == "bmc") {
-        return std::unique_ptr<Engine>(new BMC(logic, opts));
-    } else if (engineStr == "lawi") {
-        return std::unique_ptr<Engine>(new Lawi(logic, opts));
-    } else if (engineStr == "spacer") {
-        return std::unique_ptr<Engine>(new Spacer(logic, opts));
-    } else if (engineStr == "kind") {
-        return std::unique_ptr<Engine>(new Kind(logic, opts));
-    } else if (engineStr == "imc") {
-        return std::unique_ptr<Engine>(new IMC(logic, opts));
-    } else {
-        throw std::invalid_argument("Unknown engine specified");
+    if (opts.hasOption(Options::MODULAR)) {
+        return std::make_unique<ModularEngine>(logic, opts, [engineStr](Logic & logic, Options const & options) {
+            return makeEngine(engineStr, logic, options);
+        });
     }
+    return makeEngine(engineStr, logic, opts);
 }
@@ -10,10 +10,15 @@
 #include "ChcSystem.h"
 #include "Normalizer.h"
 #include "Options.h"
+#include "PreprocessingCache.h"
 #include "proofs/Term.h"
 #include "transformers/Transformer.h"
 #include <engine/Engine.h> // TODO: remove this and create an engine factory
 #include <memory>
+#include <stdexcept>
+#include <string_view>
+
+class SmtLibCommandReader;
 
 class LetBinder {
     PTRef currentValue;
@@ -83,7 +88,11 @@ public:
 class ChcInterpreterContext {
 public:
     std::unique_ptr<ChcSystem> interpretSystemAst(const ASTNode * root);
-    ChcInterpreterContext(Logic & logic, Options const & opts) : logic(logic), opts(opts) {}
+    std::unique_ptr<ChcSystem> interpretSystemStream(SmtLibCommandReader & reader);
+    ChcInterpreterContext(Logic & logic, Options const & opts, PreprocessingCache const * cache = nullptr)
+        : logic(logic), opts(opts), cache(cache) {}
+
+    void solvePreprocessed(PreprocessingCache::Entry & entry);
 
     std::vector<std::string> operators = {"+", "-",  "/",  "*", "and", "or",  "=>",  "not",
                                           "=", ">=", "<=", ">", "<",   "ite", "mod", "div"};
@@ -98,8 +107,10 @@ public:
 private:
     Logic & logic;
     Options const & opts;
+    PreprocessingCache const * cache;
     std::unique_ptr<ChcSystem> system;
-    std::vector<std::shared_ptr<Term>> originalAssertions;
+    TermStore proofTerms;
+    std::vector<TermRef> originalAssertions;
     bool doExit = false;
     LetRecords letRecords;
 
@@ -111,8 +122,13 @@ private:
 
     void interpretCheckSat();
 
+    bool needsOriginalAssertions() const;
+
     void reportError(std::string const & msg);
 
+    void solveAndReport(ChcDirectedHyperGraph const & graph, ChcDirectedHyperGraph const * originalGraph,
+                        WitnessBackTranslator & translator, Normalizer::Equalities const & normalizingEqualities);
+
     VerificationResult solve(std::string engine, ChcDirectedHyperGraph const & hyperGraph);
 
     void validate(VerificationResult result, ChcDirectedHyperGraph const & originalGraph, bool validateWitness,
@@ -123,7 +139,7 @@ private:
 
     PTRef parseTerm(ASTNode const & node);
 
-    std::shared_ptr<Term> ASTtoTerm(ASTNode const & node);
+    TermRef ASTtoTerm(ASTNode const & node);
 
     // Building CHCs and helper methods
 
@@ -136,12 +152,40 @@ private:
 
 class ChcInterpreter {
 public:
+    struct ParseError : public std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
     std::unique_ptr<ChcSystem> interpretSystemAst(Logic & logic, const ASTNode * root);
 
+    /**
+     * Parses and interprets the commands one by one; the syntax tree of each command is released before the next
+     * command is read. This keeps the memory footprint low for very large inputs.
+     *
+     * @throws ParseError if a command cannot be parsed
+     */
+    std::unique_ptr<ChcSystem> interpretSystemStream(Logic & logic, SmtLibCommandReader & reader);
+
     ChcInterpreter(Options const & opts) : opts(opts) {}
 
+    /**
+     * After preprocessing, the preprocessed system is stored in the given cache (if set).
+     * The cache must outlive the interpretation.
+     */
+    void setPreprocessingCache(PreprocessingCache const * preprocessingCache) { cache = preprocessingCache; }
+
+    /** Solves the system loaded from the preprocessing cache, skipping parsing and preprocessing */
+    void solvePreprocessed(Logic & logic, PreprocessingCache::Entry & entry);
+
+    /** Returns true if the options require the original input assertions, i.e., the input must be interpreted */
+    static bool needsOriginalAssertions(Options const & opts);
+
+    /** Writes the result as JSON to the file given by option RESULT_JSON, if the option is set */
+    static void writeResultJson(Options const & opts, std::string_view engine, VerificationResult const & result);
+
 private:
     Options const & opts;
+    PreprocessingCache const * cache{nullptr};
 };
 
 #endif // OPENSMT_CHCINTERPRETER_H
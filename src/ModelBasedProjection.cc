@@ -5,6 +5,7 @@
 #include "ModelBasedProjection.h"
 
 #include "TermUtils.h"
+#include "utils/Statistics.h"
 
 #include <memory>
 
@@ -433,6 +434,8 @@ PTRef ModelBasedProjection::keepOnly(PTRef fla, const vec<PTRef> & varsToKeep, M
 }
 
 PTRef ModelBasedProjection::project(PTRef fla, const vec<PTRef> & varsToEliminate, Model & model) {
+    ScopedTimer timer("mbp");
+    Statistics::recordValue("mbp.eliminated-vars", varsToEliminate.size());
     vec<PTRef> tmp;
     varsToEliminate.copyTo(tmp);
     auto boolEndIt = std::stable_partition(tmp.begin(), tmp.end(), [&](PTRef var) {
@@ -6,7 +6,52 @@
 
 #include "Normalizer.h"
 
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+using Equality = Normalizer::Equality;
+
+// Number of clauses normalized in one private logic
+constexpr std::size_t clausesPerBatch = 64;
+
+/*
+ * Replaces the original arguments of the predicates in the interpreted part by the normalized variables.
+ * Arguments that are not variables, or variables occurring repeatedly, are bound by equalities instead.
+ */
+PTRef normalizeInterpretedPart(Logic & logic, PTRef interpretedPart, vec<Equality> const & topLevelEqualities) {
+    vec<PTRef> equalities;
+    equalities.capacity(topLevelEqualities.size());
+    TermUtils::substitutions_map subst;
+    for (auto [normalizedVar, originalArg] : topLevelEqualities) {
+        if (logic.isVar(originalArg) and subst.find(originalArg) == subst.end()) {
+            subst.insert({originalArg, normalizedVar});
+        } else { // originalArg is not variable or it has substitution assigned already
+            // MB: We try to avoid creating equalities with original arguments, which would need to be rewritten later
+            PTRef value = logic.isVar(originalArg) ? subst.at(originalArg) : originalArg;
+            equalities.push(logic.mkEq(normalizedVar, value));
+        }
+    }
+    if (equalities.size() > 0) {
+        interpretedPart = logic.mkAnd(interpretedPart, logic.mkAnd(std::move(equalities)));
+    }
+    return TermUtils(logic).varSubstitute(interpretedPart, subst);
+}
+
+// Variables of the formula that do not occur in the predicates of the clause
+vec<PTRef> localVariables(Logic & logic, PTRef fla, std::unordered_set<PTRef, PTRefHash> const & predicateVars) {
+    auto isVarToNormalize = [&](PTRef var) {
+        return logic.isVar(var) and predicateVars.find(var) == predicateVars.end();
+    };
+    return matchingSubTerms(logic, fla, isVarToNormalize);
+}
+} // namespace
+
 NormalizedChcSystem Normalizer::normalize(const ChcSystem & system) {
+    if (auto * arithLogic = dynamic_cast<ArithLogic *>(&logic); arithLogic and threads > 0) {
+        return normalizeInIsolation(system, *arithLogic);
+    }
     this->canonicalPredicateRepresentation.addRepresentation(logic.getSym_true(), {});
     std::vector<ChClause> normalized;
     auto const& clauses = system.getClauses();
@@ -49,10 +94,7 @@ ChClause Normalizer::normalizeAuxiliaryVariables(ChClause && clause) {
     }
 
     PTRef newInterpretedBody = clause.body.interpretedPart.fla;
-    auto isVarToNormalize = [&](PTRef var) {
-        return logic.isVar(var) and predicateVars.find(var) == predicateVars.end();
-    };
-    auto localVars = matchingSubTerms(logic, newInterpretedBody, isVarToNormalize);
+    auto localVars = localVariables(logic, newInterpretedBody, predicateVars);
     if (localVars.size() > 0) {
         // there are some local variables left, rename them and make them versioned
         TermUtils::substitutions_map subst;
@@ -88,7 +130,12 @@ ChcHead Normalizer::normalize(ChcHead const& head) {
 }
 
 ChcBody Normalizer::normalize(const ChcBody & body) {
-    // uninterpreted part
+    auto newUninterpretedPart = normalizeUninterpretedPart(body);
+    PTRef newInterpretedPart = normalizeInterpretedPart(logic, body.interpretedPart.fla, topLevelEqualities);
+    return ChcBody{InterpretedFla{newInterpretedPart}, std::move(newUninterpretedPart)};
+}
+
+std::vector<UninterpretedPredicate> Normalizer::normalizeUninterpretedPart(ChcBody const & body) {
     std::vector<UninterpretedPredicate> newUninterpretedPart;
     auto const& uninterpreted = body.uninterpretedPart;
     auto proxy = canonicalPredicateRepresentation.createCountingProxy();
@@ -109,26 +156,82 @@ ChcBody Normalizer::normalize(const ChcBody & body) {
         }
         newUninterpretedPart.push_back(UninterpretedPredicate{sourceTerm});
     }
-    // interpreted part
-    PTRef newInterpretedPart = body.interpretedPart.fla;
+    return newUninterpretedPart;
+}
 
-    vec<PTRef> equalities;
-    equalities.capacity(topLevelEqualities.size());
-    TermUtils::substitutions_map subst;
-    for (auto [normalizedVar, originalArg] : topLevelEqualities) {
-        if (logic.isVar(originalArg) and subst.find(originalArg) == subst.end()) {
-            subst.insert({originalArg, normalizedVar});
-        } else { // originalArg is not variable or it has substitution assigned already
-            // MB: We try to avoid creating equalities with original arguments, which would need to be rewritten later
-            PTRef value = logic.isVar(originalArg) ? subst.at(originalArg) : originalArg;
-            equalities.push(logic.mkEq(normalizedVar, value));
-        }
-    }
-    if (equalities.size() > 0) {
-        newInterpretedPart = logic.mkAnd(newInterpretedPart, logic.mkAnd(std::move(equalities)));
+/*
+ * The predicates of all clauses are normalized first, sequentially, which fixes the canonical representation of the
+ * predicates and the equalities between their arguments.
+ * The interpreted parts are then normalized in parallel. The clauses are split into fixed batches, each batch is copied
+ * to its own private logic by a worker; the shared logic is only read during this phase.
+ * Finally, the results are imported back in the order of the clauses. Each clause reserves the next range of aux#
+ * names for its local variables right before its import, so the names depend neither on the number of threads nor
+ * on the order in which the batches were processed.
+ */
+NormalizedChcSystem Normalizer::normalizeInIsolation(ChcSystem const & system, ArithLogic & arithLogic) {
+    this->canonicalPredicateRepresentation.addRepresentation(logic.getSym_true(), {});
+    auto const & clauses = system.getClauses();
+    std::vector<ChcHead> heads;
+    std::vector<std::vector<UninterpretedPredicate>> bodies;
+    for (auto const & clause : clauses) {
+        topLevelEqualities.clear();
+        heads.push_back(normalize(clause.head));
+        bodies.push_back(normalizeUninterpretedPart(clause.body));
+        normalizingEqualities.push_back(std::move(topLevelEqualities));
     }
-    newInterpretedPart = TermUtils(logic).varSubstitute(newInterpretedPart, subst);
-    return ChcBody{InterpretedFla{newInterpretedPart}, std::move(newUninterpretedPart)};
-}
+    topLevelEqualities.clear();
 
+    auto const logicType = arithLogic.hasReals() ? opensmt::Logic_t::QF_LRA : opensmt::Logic_t::QF_LIA;
+    struct Batch {
+        std::unique_ptr<ArithLogic> privateLogic;
+        std::vector<PTRef> interpretedParts;
+        std::vector<vec<PTRef>> localVars;
+    };
+    std::vector<Batch> batches((clauses.size() + clausesPerBatch - 1) / clausesPerBatch);
+    parallelFor(batches.size(), threads, [&](std::size_t batchIndex) {
+        auto & batch = batches[batchIndex];
+        batch.privateLogic = std::make_unique<ArithLogic>(logicType);
+        TermImporter toPrivate(arithLogic, *batch.privateLogic);
+        std::size_t const end = std::min((batchIndex + 1) * clausesPerBatch, clauses.size());
+        for (std::size_t i = batchIndex * clausesPerBatch; i < end; ++i) {
+            vec<Equality> equalities;
+            for (auto [normalizedVar, originalArg] : normalizingEqualities[i]) {
+                equalities.push({.normalizedVar = toPrivate.import(normalizedVar),
+                                 .originalArg = toPrivate.import(originalArg)});
+            }
+            std::unordered_set<PTRef, PTRefHash> predicateVars;
+            auto addPredicateVars = [&](PTRef predicate) {
+                for (PTRef arg : arithLogic.getPterm(predicate)) {
+                    predicateVars.insert(toPrivate.import(arg));
+                }
+            };
+            addPredicateVars(heads[i].predicate.predicate);
+            for (auto const & predicate : bodies[i]) {
+                addPredicateVars(predicate.predicate);
+            }
+            PTRef interpretedPart = toPrivate.import(clauses[i].body.interpretedPart.fla);
+            interpretedPart = normalizeInterpretedPart(*batch.privateLogic, interpretedPart, equalities);
+            batch.localVars.push_back(localVariables(*batch.privateLogic, interpretedPart, predicateVars));
+            batch.interpretedParts.push_back(interpretedPart);
+        }
+    });
 
+    auto newSystem = std::make_unique<ChcSystem>();
+    for (std::size_t i = 0; i < clauses.size(); ++i) {
+        auto const & batch = batches[i / clausesPerBatch];
+        std::size_t const indexInBatch = i % clausesPerBatch;
+        // Local variables are shared by the clauses of the batch, each clause needs its own renaming
+        TermImporter toShared(*batch.privateLogic, arithLogic);
+        for (PTRef localVar : batch.localVars[indexInBatch]) {
+            PTRef originalVar = toShared.import(localVar);
+            std::string uniq_name = "aux#" + std::to_string(counter++);
+            PTRef renamed = timeMachine.getVarVersionZero(uniq_name, logic.getSortRef(originalVar));
+            toShared.importAs(localVar, renamed);
+            normalizingEqualities[i].push({.normalizedVar = renamed, .originalArg = originalVar});
+        }
+        PTRef interpretedPart = toShared.import(batch.interpretedParts[indexInBatch]);
+        newSystem->addClause(ChClause{heads[i], ChcBody{{interpretedPart}, std::move(bodies[i])}});
+    }
+    return NormalizedChcSystem{.normalizedSystem = std::move(newSystem),
+                               .canonicalPredicateRepresentation = getCanonicalPredicateRepresentation()};
+}
@@ -28,6 +28,7 @@ public:
     using Equalities = std::vector<vec<Equality>>;
 private:
     Logic& logic;
+    std::size_t threads{0};
     TimeMachine timeMachine;
     NonlinearCanonicalPredicateRepresentation canonicalPredicateRepresentation;
     long long counter = 0;
@@ -41,6 +42,10 @@ private:
 
     ChcBody normalize(ChcBody const & body);
 
+    std::vector<UninterpretedPredicate> normalizeUninterpretedPart(ChcBody const & body);
+
+    NormalizedChcSystem normalizeInIsolation(ChcSystem const & system, ArithLogic & arithLogic);
+
     void createUniqueRepresentation(PTRef predicate) {
         auto size = logic.getPterm(predicate).size();
         std::vector<PTRef> repre; repre.reserve(size);
@@ -64,6 +69,15 @@ private:
 public:
     Normalizer(Logic& logic) : logic(logic), timeMachine(logic), canonicalPredicateRepresentation(logic) {}
 
+    /**
+     * With a positive number of threads, the interpreted parts of the clauses over arithmetic are normalized in
+     * parallel, in batches of private logics. The names of the auxiliary variables are reserved sequentially in the
+     * order of the clauses, so the result does not depend on the number of threads. Note that the numbering of the
+     * fresh variables differs from the default sequential normalization.
+     */
+    Normalizer(Logic& logic, std::size_t threads)
+        : logic(logic), threads(threads), timeMachine(logic), canonicalPredicateRepresentation(logic) {}
+
     NormalizedChcSystem normalize(ChcSystem const & system);
 
     const vec<Equality> & getNormalizingEqualities(std::size_t index) const { return std::move(normalizingEqualities.at(index)); }
@@ -22,7 +22,22 @@ const std::string Options::LRA_ITP_ALG = "lra-itp-algorithm";
 const std::string Options::FORCED_COVERING = "forced-covering";
 const std::string Options::VERBOSE = "verbose";
 const std::string Options::TPA_USE_QE = "tpa.use-qe";
+const std::string Options::TPA_SNAPSHOT_DIR = "tpa.snapshot-dir";
+const std::string Options::SPACER_GENERALIZE_LEMMAS = "spacer.generalize-lemmas";
 const std::string Options::PROOF_FORMAT = "proof-format";
+const std::string Options::THREADS = "threads";
+const std::string Options::CACHE_DIR = "cache-dir";
+const std::string Options::MODULAR = "modular";
+const std::string Options::STATISTICS = "statistics";
+const std::string Options::TIME_LIMIT = "time-limit";
+const std::string Options::MEMORY_LIMIT = "memory-limit";
+const std::string Options::QUERY_LIMIT = "query-limit";
+const std::string Options::RESULT_JSON = "result-json";
+const std::string Options::CHECKPOINT = "checkpoint";
+const std::string Options::AUTO_RULES = "auto.rules";
+const std::string Options::AUTO_FEATURES = "auto.features";
+const std::string Options::PORTFOLIO = "portfolio";
+const std::string Options::PORTFOLIO_SLICE = "portfolio.slice";
 
 namespace{
 
@@ -34,6 +49,7 @@ void printUsage() {
         "--version                  Print version number of Golem\n"
         "-l,--logic <name>          SMT-LIB logic to use (required); possible values: QF_LRA, QF_LIA\n"
         "-e,--engine <name>         Select engine to use; supported engines:\n"
+        "                               auto - select the engines by the structure of the system (see --auto.rules)\n"
         "                               bmc - Bounded Model Checking (only transition systems)\n"
         "                               imc - McMillan's original Interpolation-based model checking (only transition systems)\n"
         "                               kind - basic k-induction algorithm (only transition systems)\n"
@@ -47,6 +63,26 @@ void printUsage() {
         "                               legacy (default) - golem's original proof format\n"
         "                               intermediate - intermediate proof format (includes variable instantiation)\n"
         "                               alethe (verifiable) - alethe proof format\n"
+        "--threads <n>              Number of threads used in preprocessing of the CHC system, witness validation\n"
+        "                           and proof production, and by TPA on networks of transition systems\n"
+        "                           (default: sequential)\n"
+        "--cache-dir <dir>          Directory for caching preprocessed CHC systems between runs\n"
+        "--spacer.generalize-lemmas Strengthen lemmas learnt by Spacer by inductive generalization\n"
+        "--tpa.snapshot-dir <dir>   Directory for storing the powers learnt by TPA; later runs resume from them\n"
+        "--modular                  Solve strongly connected components of the CHC graph as separate subproblems\n"
+        "--portfolio <mode>         How to run a comma-separated list of engines; possible values:\n"
+        "                               parallel (default) - every engine in its own process\n"
+        "                               sequential - interleave the engines in growing time slices on one thread\n"
+        "--portfolio.slice <sec>    Length of the first time slice of the sequential portfolio (default: 1)\n"
+        "--auto.rules <file>        Rules for selecting the engines by engine auto, instead of the built-in rules\n"
+        "--auto.features <file>     Write the features of the system used by engine auto as JSON to the file\n"
+        "--statistics <file>        Write solver statistics as JSON to the file at exit (- for stdout)\n"
+        "--time-limit <seconds>     Give up and answer unknown after the given wall-clock time\n"
+        "--memory-limit <MB>        Give up and answer unknown once the process uses more memory\n"
+        "--query-limit <n>          Give up and answer unknown after the given number of SMT queries\n"
+        "--result-json <file>       Write the answer and the number of transitions proven safe as JSON (- for stdout)\n"
+        "--checkpoint <file>        File for storing the progress of bmc, imc, kind and spacer; later runs resume\n"
+        "                           from the stored bound\n"
         "-v                         Increase verbosity (can be applied multiple times)\n"
         "-i,--input <file>          Input file (option not required)\n"
         ;
@@ -68,7 +104,10 @@ Options CommandLineParser::parse(int argc, char ** argv) {
     int forcedCovering = 0;
     int verbose = 0;
     int tpaUseQE = 0;
+    int spacerGeneralizeLemmas = 0;
     int printVersion = 0;
+    int threads = 0;
+    int modular = 0;
 
     struct option long_options[] =
         {
@@ -85,7 +124,22 @@ Options CommandLineParser::parse(int argc, char ** argv) {
             {Options::FORCED_COVERING.c_str(), optional_argument, &forcedCovering, 1},
             {Options::VERBOSE.c_str(), optional_argument, &verbose, 1},
             {Options::TPA_USE_QE.c_str(), optional_argument, &tpaUseQE, 1},
+            {Options::SPACER_GENERALIZE_LEMMAS.c_str(), optional_argument, &spacerGeneralizeLemmas, 1},
             {Options::PROOF_FORMAT.c_str(), required_argument, nullptr, 'p'},
+            {Options::THREADS.c_str(), required_argument, &threads, 0},
+            {Options::CACHE_DIR.c_str(), required_argument, nullptr, 'c'},
+            {Options::TPA_SNAPSHOT_DIR.c_str(), required_argument, nullptr, 's'},
+            {Options::MODULAR.c_str(), no_argument, &modular, 1},
+            {Options::STATISTICS.c_str(), required_argument, nullptr, 'S'},
+            {Options::TIME_LIMIT.c_str(), required_argument, nullptr, 'T'},
+            {Options::MEMORY_LIMIT.c_str(), required_argument, nullptr, 'M'},
+            {Options::QUERY_LIMIT.c_str(), required_argument, nullptr, 'Q'},
+            {Options::RESULT_JSON.c_str(), required_argument, nullptr, 'R'},
+            {Options::CHECKPOINT.c_str(), required_argument, nullptr, 'C'},
+            {Options::AUTO_RULES.c_str(), required_argument, nullptr, 'r'},
+            {Options::AUTO_FEATURES.c_str(), required_argument, nullptr, 'F'},
+            {Options::PORTFOLIO.c_str(), required_argument, nullptr, 'P'},
+            {Options::PORTFOLIO_SLICE.c_str(), required_argument, nullptr, 'L'},
             {0, 0, 0, 0}
         };
 
@@ -113,6 +167,8 @@ Options CommandLineParser::parse(int argc, char ** argv) {
                     }
                 } else if (long_options[option_index].flag == &tpaUseQE) {
                     tpaUseQE = 1;
+                } else if (long_options[option_index].flag == &spacerGeneralizeLemmas and optarg) {
+                    spacerGeneralizeLemmas = isDisableKeyword(optarg) ? 0 : 1;
                 } else if (long_options[option_index].flag == &lraItpAlg) {
                     assert(optarg);
                     lraItpAlg = std::atoi(optarg);
@@ -120,6 +176,9 @@ Options CommandLineParser::parse(int argc, char ** argv) {
                 else if (long_options[option_index].flag == &verbose) {
                     assert(optarg);
                     verbose = std::atoi(optarg);
+                } else if (long_options[option_index].flag == &threads) {
+                    assert(optarg);
+                    threads = std::atoi(optarg);
                 }
                 break;
             case 'e':
@@ -137,6 +196,42 @@ Options CommandLineParser::parse(int argc, char ** argv) {
             case 'p':
                 res.addOption(Options::PROOF_FORMAT, optarg);
                 break;
+            case 'c':
+                res.addOption(Options::CACHE_DIR, optarg);
+                break;
+            case 's':
+                res.addOption(Options::TPA_SNAPSHOT_DIR, optarg);
+                break;
+            case 'S':
+                res.addOption(Options::STATISTICS, optarg);
+                break;
+            case 'T':
+                res.addOption(Options::TIME_LIMIT, optarg);
+                break;
+            case 'M':
+                res.addOption(Options::MEMORY_LIMIT, optarg);
+                break;
+            case 'Q':
+                res.addOption(Options::QUERY_LIMIT, optarg);
+                break;
+            case 'R':
+                res.addOption(Options::RESULT_JSON, optarg);
+                break;
+            case 'C':
+                res.addOption(Options::CHECKPOINT, optarg);
+                break;
+            case 'r':
+                res.addOption(Options::AUTO_RULES, optarg);
+                break;
+            case 'F':
+                res.addOption(Options::AUTO_FEATURES, optarg);
+                break;
+            case 'P':
+                res.addOption(Options::PORTFOLIO, optarg);
+                break;
+            case 'L':
+                res.addOption(Options::PORTFOLIO_SLICE, optarg);
+                break;
             case 'v':
                 ++verbose;
                 break;
@@ -171,6 +266,15 @@ Options CommandLineParser::parse(int argc, char ** argv) {
     if (tpaUseQE) {
         res.addOption(Options::TPA_USE_QE, "true");
     }
+    if (spacerGeneralizeLemmas) {
+        res.addOption(Options::SPACER_GENERALIZE_LEMMAS, "true");
+    }
+    if (threads > 0) {
+        res.addOption(Options::THREADS, std::to_string(threads));
+    }
+    if (modular) {
+        res.addOption(Options::MODULAR, "true");
+    }
     res.addOption(Options::LRA_ITP_ALG, std::to_string(lraItpAlg));
     res.addOption(Options::VERBOSE, std::to_string(verbose));
 
@@ -17,6 +17,11 @@ public:
         options.emplace(std::move(key), std::move(value));
     }
 
+    /** Like addOption, but replaces the value if the option is already present */
+    void setOption(std::string key, std::string value) {
+        options.insert_or_assign(std::move(key), std::move(value));
+    }
+
     std::string getOption(std::string const & key) const {
         auto it = options.find(key);
         return it == options.end() ? "" : it->second;
@@ -39,6 +44,21 @@ public:
     static const std::string FORCED_COVERING;
     static const std::string VERBOSE;
     static const std::string TPA_USE_QE;
+    static const std::string TPA_SNAPSHOT_DIR;
+    static const std::string SPACER_GENERALIZE_LEMMAS;
+    static const std::string THREADS;
+    static const std::string CACHE_DIR;
+    static const std::string MODULAR;
+    static const std::string STATISTICS;
+    static const std::string TIME_LIMIT;
+    static const std::string MEMORY_LIMIT;
+    static const std::string QUERY_LIMIT;
+    static const std::string RESULT_JSON;
+    static const std::string CHECKPOINT;
+    static const std::string AUTO_RULES;
+    static const std::string AUTO_FEATURES;
+    static const std::string PORTFOLIO;
+    static const std::string PORTFOLIO_SLICE;
 };
 
 class CommandLineParser {
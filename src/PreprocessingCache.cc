@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "PreprocessingCache.h"
+
+#include "graph/GraphSerialization.h"
+#include "utils/FnvHash.h"
+#include "utils/VersionedFile.h"
+
+#ifndef GOLEM_BUILD_ID
+#define GOLEM_BUILD_ID GOLEM_VERSION
+#endif
+
+namespace {
+// Must be changed whenever the preprocessing or the serialization format changes
+constexpr std::string_view magic = "golem-preprocessed-v1\n";
+
+// Options that influence parsing or preprocessing; the other options only influence solving and reporting
+std::string const * const keyOptions[] = {&Options::LOGIC, &Options::THREADS};
+
+/*
+ * Splits the content of the cache file into the name of the logic and the serialized data.
+ * Returns empty optional if the header is not valid.
+ */
+std::optional<std::pair<std::string_view, std::string_view>> parseHeader(VersionedFile const & file) {
+    if (not file.isValid()) { return std::nullopt; }
+    auto contents = file.contents();
+    auto newLine = contents.find('\n');
+    if (newLine == std::string_view::npos) { return std::nullopt; }
+    return std::make_pair(contents.substr(0, newLine), contents.substr(newLine + 1));
+}
+} // namespace
+
+PreprocessingCache::PreprocessingCache(std::string const & directory, std::string_view input,
+                                       Options const & options) {
+    FnvHash hash;
+    hash.update(magic);
+    // Entries written by other builds are not reused, their preprocessing may differ even with the same magic
+    hash.update(GOLEM_VERSION "\n" GOLEM_BUILD_ID "\n");
+    for (auto const * option : keyOptions) {
+        hash.update(*option);
+        // Unset options are distinguished from options set to the empty string
+        hash.update(options.hasOption(*option) ? "=" + options.getOption(*option) : std::string("\0", 1));
+        hash.update(std::string_view("\n"));
+    }
+    hash.update(input);
+    path = directory + "/" + hash.toHex() + ".gcache";
+}
+
+std::optional<std::string> PreprocessingCache::storedLogic() const {
+    VersionedFile file(path, magic);
+    auto header = parseHeader(file);
+    if (not header) { return std::nullopt; }
+    auto logic = std::string(header->first);
+    if (logic != "QF_LRA" and logic != "QF_LIA") { return std::nullopt; }
+    return logic;
+}
+
+std::optional<PreprocessingCache::Entry> PreprocessingCache::load(Logic & logic) const {
+    VersionedFile file(path, magic);
+    auto header = parseHeader(file);
+    if (not header) { return std::nullopt; }
+    try {
+        GraphDeserializer deserializer(logic, header->second);
+        Entry entry;
+        entry.originalGraph = deserializer.readGraph();
+        entry.graph = deserializer.readGraph();
+        entry.translator = deserializer.readBackTranslator();
+        if (not deserializer.atEnd()) { return std::nullopt; }
+        return entry;
+    } catch (std::logic_error const &) {
+        return std::nullopt;
+    }
+}
+
+bool PreprocessingCache::store(Logic & logic, ChcDirectedHyperGraph const & originalGraph,
+                               ChcDirectedHyperGraph const & graph, WitnessBackTranslator const & translator) const {
+    auto * arithLogic = dynamic_cast<ArithLogic *>(&logic);
+    if (not arithLogic) { return false; }
+    std::string data;
+    try {
+        GraphSerializer serializer(logic);
+        serializer.writeGraph(originalGraph);
+        serializer.writeGraph(graph);
+        if (not serializer.writeBackTranslator(translator)) { return false; }
+        data = serializer.finish();
+    } catch (std::logic_error const &) { // Unsupported terms
+        return false;
+    }
+    return VersionedFile::write(path, magic, {arithLogic->hasReals() ? "QF_LRA\n" : "QF_LIA\n", data});
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_PREPROCESSINGCACHE_H
+#define GOLEM_PREPROCESSINGCACHE_H
+
+#include "Options.h"
+#include "graph/ChcGraph.h"
+#include "transformers/Transformer.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * On-disk cache of preprocessed CHC systems.
+ *
+ * An entry stores the graph built from the input (needed for validation of witnesses), the graph after
+ * the preprocessing pipeline and the state of the witness back-translator of the pipeline.
+ * Entries are addressed by a hash of the input script, of the options that influence parsing and preprocessing
+ * (the logic and the number of threads) and of the version and build of Golem, so repeated runs of the same build
+ * on the same input (e.g., with different engines) can skip parsing and preprocessing.
+ *
+ * Entries are stored in a compact binary format (see GraphSerializer) and loaded from a memory-mapped file.
+ * Corrupted or incompatible entries are treated as missing.
+ */
+class PreprocessingCache {
+    std::string path;
+
+public:
+    PreprocessingCache(std::string const & directory, std::string_view input, Options const & options);
+
+    std::string const & getPath() const { return path; }
+
+    struct Entry {
+        std::unique_ptr<ChcDirectedHyperGraph> originalGraph;
+        std::unique_ptr<ChcDirectedHyperGraph> graph;
+        std::unique_ptr<WitnessBackTranslator> translator;
+    };
+
+    /** Name of the logic of the stored entry, or an empty optional if there is no usable entry */
+    std::optional<std::string> storedLogic() const;
+
+    /** Loads the stored entry into the given logic; returns an empty optional if the entry cannot be loaded */
+    std::optional<Entry> load(Logic & logic) const;
+
+    /**
+     * Stores the entry; returns false if the translator cannot be serialized or the file cannot be written.
+     * The entry is written to a temporary file first, so concurrent runs never observe partially written entries.
+     */
+    bool store(Logic & logic, ChcDirectedHyperGraph const & originalGraph, ChcDirectedHyperGraph const & graph,
+               WitnessBackTranslator const & translator) const;
+};
+
+#endif // GOLEM_PREPROCESSINGCACHE_H
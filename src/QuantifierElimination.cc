@@ -9,6 +9,7 @@
 #include "ModelBasedProjection.h"
 #include "TermUtils.h"
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
 
 PTRef QuantifierElimination::keepOnly(PTRef fla, const vec<PTRef> & varsToKeep) {
     auto allVars = TermUtils(logic).getVars(fla);
@@ -30,6 +31,7 @@ PTRef QuantifierElimination::eliminate(PTRef fla, vec<PTRef> const & vars) {
         throw std::invalid_argument("Invalid arguments to quantifier elimination");
     }
 
+    ScopedTimer timer("qe");
     fla = TermUtils(logic).toNNF(fla);
     vec<PTRef> projections;
 
@@ -37,7 +39,7 @@ PTRef QuantifierElimination::eliminate(PTRef fla, vec<PTRef> const & vars) {
     auto & solver = solverWrapper.getCoreSolver();
     solver.insertFormula(fla);
     while(true) {
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_False) {
             break;
         } else if (res == s_True) {
@@ -52,6 +54,7 @@ PTRef QuantifierElimination::eliminate(PTRef fla, vec<PTRef> const & vars) {
             throw std::logic_error("Error in solver during quantifier elimination");
         }
     }
+    Statistics::recordValue("qe.projections", projections.size());
     PTRef result = logic.mkOr(projections);
     if (logic.isBooleanOperator(result) and not logic.isNot(result)) {
         result = ::rewriteMaxArityAggresive(logic, result);
@@ -200,6 +200,93 @@ TermUtils::SimplificationResult TermUtils::extractSubstitutionsAndSimplify(PTRef
     return result;
 }
 
+SRef TermImporter::importSort(SRef sort) const {
+    if (sort == source.getSort_bool()) { return target.getSort_bool(); }
+    if (sort == source.getSort_int()) { return target.getSort_int(); }
+    if (sort == source.getSort_real()) { return target.getSort_real(); }
+    throw std::logic_error("Unsupported sort encountered when copying terms between logics");
+}
+
+PTRef TermImporter::importNode(PTRef term) {
+    if (term == source.getTerm_true()) { return target.getTerm_true(); }
+    if (term == source.getTerm_false()) { return target.getTerm_false(); }
+    SRef sort = importSort(source.getSortRef(term));
+    if (source.isVar(term)) { return target.mkVar(sort, source.getSymName(term)); }
+    if (source.isNumConst(term)) { return target.mkConst(sort, source.getNumConst(term)); }
+    vec<PTRef> args;
+    for (PTRef arg : source.getPterm(term)) {
+        args.push(imported.at(arg));
+    }
+    if (source.isUP(term)) { return target.insertTerm(importSymbol(source.getSymRef(term)), std::move(args)); }
+    if (source.isUF(term)) {
+        throw std::logic_error("Uninterpreted functions cannot be copied between logics");
+    }
+    return target.resolveTerm(source.getSymName(term), std::move(args));
+}
+
+SymRef TermImporter::importSymbol(SymRef sym) {
+    if (sym == source.getSym_true()) { return target.getSym_true(); }
+    if (sym == source.getSym_false()) { return target.getSym_false(); }
+    auto it = importedSymbols.find(sym);
+    if (it != importedSymbols.end()) { return it->second; }
+    auto const & symbol = source.getSym(sym);
+    if (importSort(symbol.rsort()) != target.getSort_bool()) {
+        throw std::logic_error("Uninterpreted functions cannot be copied between logics");
+    }
+    vec<SRef> argSorts;
+    for (SRef argSort : symbol) {
+        argSorts.push(importSort(argSort));
+    }
+    char const * name = source.getSymName(sym);
+    SymRef result = SymRef_Undef;
+    if (target.hasSym(name)) {
+        for (SymRef candidate : target.symNameToRef(name)) {
+            auto const & candidateSymbol = target.getSym(candidate);
+            if (candidateSymbol.nargs() != static_cast<unsigned>(argSorts.size())) { continue; }
+            bool sameSignature = true;
+            for (int i = 0; i < argSorts.size(); ++i) {
+                sameSignature = sameSignature and candidateSymbol[i] == argSorts[i];
+            }
+            if (sameSignature) {
+                result = candidate;
+                break;
+            }
+        }
+    }
+    if (result == SymRef_Undef) { result = target.declareFun(name, target.getSort_bool(), argSorts); }
+    importedSymbols.insert({sym, result});
+    return result;
+}
+
+PTRef TermImporter::import(PTRef root) {
+    // Iterative post-order traversal; terms can be too deep for recursion
+    struct QueueEntry {
+        PTRef term;
+        bool argsProcessed;
+    };
+    std::vector<QueueEntry> queue;
+    queue.push_back({root, false});
+    while (not queue.empty()) {
+        auto & entry = queue.back();
+        if (imported.count(entry.term) > 0) {
+            queue.pop_back();
+            continue;
+        }
+        if (not entry.argsProcessed) {
+            entry.argsProcessed = true;
+            PTRef term = entry.term; // Pushing to the queue invalidates the reference
+            for (PTRef arg : source.getPterm(term)) {
+                if (imported.count(arg) == 0) { queue.push_back({arg, false}); }
+            }
+            continue;
+        }
+        PTRef term = entry.term;
+        queue.pop_back();
+        imported.emplace(term, importNode(term));
+    }
+    return imported.at(root);
+}
+
 class NNFTransformer {
     Logic & logic;
 
@@ -8,6 +8,7 @@
 #define OPENSMT_TERMUTILS_H
 
 #include "osmt_terms.h"
+#include "utils/Statistics.h"
 
 #include <algorithm>
 #include <iostream>
@@ -273,6 +274,7 @@ public:
 
     PTRef sendFlaThroughTime(PTRef fla, int steps) {
         if (steps == 0) { return fla; }
+        ScopedTimer timer("time-machine");
         config.setVersioningNumber(steps);
         VersioningRewriter rewriter(logic, config);
         return rewriter.rewrite(fla);
@@ -453,6 +455,13 @@ public:
 
     PTRef getSourceTermFor(SymRef sym, unsigned instanceCount = 0) const;
 
+    template<typename TAction>
+    void forEachRepresentation(TAction action) const {
+        for (auto const & [sym, vars] : representation) {
+            action(sym, vars);
+        }
+    }
+
     class CountingProxy {
         NonlinearCanonicalPredicateRepresentation & parent;
         std::unordered_map<SymRef, unsigned, SymRefHash> counts;
@@ -478,6 +487,34 @@ public:
     PTRef tryEliminateVarsExcept(vec<PTRef> const & vars, PTRef fla) const;
 };
 
+/**
+ * Copies terms between two independent instances of ArithLogic.
+ *
+ * Variables are identified by their names (and sorts), numerical constants by their values, and all other terms are
+ * rebuilt in the target logic from their symbol names. This allows to do expensive term manipulation in a private
+ * logic (e.g., in a separate thread) and import only the final result back into the shared logic.
+ * Uninterpreted predicates are identified by their names and signatures; they are declared in the target logic
+ * when needed. Other uninterpreted functions must not occur in the copied terms.
+ */
+class TermImporter {
+    ArithLogic & source;
+    ArithLogic & target;
+    std::unordered_map<PTRef, PTRef, PTRefHash> imported;
+    std::unordered_map<SymRef, SymRef, SymRefHash> importedSymbols;
+
+    SRef importSort(SRef sort) const;
+    PTRef importNode(PTRef term);
+public:
+    TermImporter(ArithLogic & source, ArithLogic & target) : source(source), target(target) {}
+
+    PTRef import(PTRef term);
+
+    /** The given term of the source logic is replaced by the given term of the target logic in subsequent imports */
+    void importAs(PTRef term, PTRef importedTerm) { imported[term] = importedTerm; }
+
+    SymRef importSymbol(SymRef sym);
+};
+
 inline vec<PTRef> operator+(vec<PTRef> const & first, vec<PTRef> const & second) {
     vec<PTRef> res;
     first.copyTo(res);
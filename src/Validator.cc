@@ -7,6 +7,94 @@
 #include "Validator.h"
 
 #include "utils/SmtSolver.h"
+#include "utils/ThreadPool.h"
+
+#include <atomic>
+#include <cassert>
+
+namespace {
+bool hasExpectedStatus(Logic & logic, PTRef formula, bool shouldBeSatisfiable) {
+    if (formula == logic.getTerm_true()) { return shouldBeSatisfiable; }
+    if (formula == logic.getTerm_false()) { return not shouldBeSatisfiable; }
+    SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
+    auto & solver = solverWrapper.getCoreSolver();
+    solver.insertFormula(formula);
+    auto res = SMTSolver::check(solver);
+    return shouldBeSatisfiable ? res == s_True : res == s_False;
+}
+
+std::string describeEdge(Logic & logic, DirectedHyperEdge const & edge) {
+    std::string description = std::to_string(edge.id.id) + " (";
+    for (std::size_t i = 0; i < edge.from.size(); ++i) {
+        if (i > 0) { description += ", "; }
+        description += logic.printSym(edge.from[i]);
+    }
+    return description + " -> " + logic.printSym(edge.to) + ")";
+}
+} // namespace
+
+/*
+ * Checks the formulas produced by `produce(i)` for i in [0, count), each must be satisfiable or each must be
+ * unsatisfiable. The formulas are produced in the calling thread. With more than one thread, each formula is copied
+ * to its own private logic and checked by a worker; once a check fails, only the checks of the formulas with lower
+ * indices are still performed. Returns the index of the first failing formula, the same for any number of threads.
+ */
+template<typename TProducer>
+std::optional<std::size_t> Validator::findFirstFailure(std::size_t count, bool shouldBeSatisfiable,
+                                                       TProducer produce) const {
+    auto * arithLogic = dynamic_cast<ArithLogic *>(&logic);
+    if (threads < 2 or not arithLogic) {
+        for (std::size_t i = 0; i < count; ++i) {
+            PTRef formula = produce(i);
+            if (formula == PTRef_Undef or not hasExpectedStatus(logic, formula, shouldBeSatisfiable)) { return i; }
+        }
+        return std::nullopt;
+    }
+
+    auto const logicType = arithLogic->hasReals() ? opensmt::Logic_t::QF_LRA : opensmt::Logic_t::QF_LIA;
+    // The lowest index of a failure found so far, count if there is none
+    std::atomic<std::size_t> lowestFailure{count};
+    auto recordFailure = [&lowestFailure](std::size_t index) {
+        auto current = lowestFailure.load();
+        while (index < current and not lowestFailure.compare_exchange_weak(current, index)) {}
+    };
+    std::optional<std::size_t> failure;
+    auto prepare = [&](std::size_t index) {
+        std::unique_ptr<ArithLogic> privateLogic;
+        PTRef privateFormula = PTRef_Undef;
+        bool missing = false;
+        // Formulas after a known failure are not needed
+        if (index < lowestFailure) {
+            PTRef formula = produce(index);
+            if (formula == PTRef_Undef) {
+                missing = true;
+                recordFailure(index);
+            } else {
+                privateLogic = std::make_unique<ArithLogic>(logicType);
+                privateFormula = TermImporter(*arithLogic, *privateLogic).import(formula);
+            }
+        }
+        // The result is empty if the check has been skipped
+        return [&lowestFailure, &recordFailure, index, privateLogic = std::move(privateLogic), privateFormula, missing,
+                shouldBeSatisfiable]() -> std::optional<bool> {
+            if (missing) { return false; }
+            if (index > lowestFailure or not privateLogic) { return std::nullopt; }
+            bool result = hasExpectedStatus(*privateLogic, privateFormula, shouldBeSatisfiable);
+            if (not result) { recordFailure(index); }
+            return result;
+        };
+    };
+    parallelMap(count, threads, prepare, [&](std::size_t index, std::optional<bool> && passed) {
+        // Only checks after a failure with a lower index are skipped, that failure has been reported already
+        assert(passed.has_value() or index > lowestFailure);
+        if (passed.has_value() and not passed.value()) {
+            failure = index;
+            return false;
+        }
+        return true;
+    });
+    return failure;
+}
 
 Validator::Result Validator::validate(ChcDirectedHyperGraph const & graph, VerificationResult const & result) {
     if (not result.hasWitness()) { return Validator::Result::NOT_VALIDATED; }
@@ -22,34 +110,37 @@ Validator::Result Validator::validate(ChcDirectedHyperGraph const & graph, Verif
 }
 
 Validator::Result Validator::validateValidityWitness(ChcDirectedHyperGraph const & graph, ValidityWitness const & witness) {
-    auto definitions = witness.getDefinitions();
-    if (definitions.find(logic.getTerm_false()) == definitions.end()) {
-        definitions.insert({logic.getTerm_false(), logic.getTerm_false()});
-        definitions.insert({logic.getTerm_true(), logic.getTerm_true()});
+    // Index the definitions by the predicate symbol
+    std::unordered_map<SymRef, std::pair<PTRef, PTRef>, SymRefHash> definitions;
+    witness.run([&](auto const & entry) {
+        definitions.insert({logic.getSymRef(entry.first), {entry.first, entry.second}});
+    });
+    if (definitions.find(logic.getSym_false()) == definitions.end()) {
+        definitions.insert({logic.getSym_false(), {logic.getTerm_false(), logic.getTerm_false()}});
+        definitions.insert({logic.getSym_true(), {logic.getTerm_true(), logic.getTerm_true()}});
     }
     TermUtils utils(logic);
     ChcDirectedHyperGraph::VertexInstances vertexInstances(graph);
     // get correct interpretation for each node
     auto getInterpretation = [&](PTRef nodePredicate) -> PTRef {
         auto symbol = logic.getSymRef(nodePredicate);
-        auto it = std::find_if(definitions.begin(), definitions.end(),
-                               [this,symbol](auto const & entry) {
-                                   return logic.getSymRef(entry.first) == symbol;
-                               });
+        auto it = definitions.find(symbol);
         if (it == definitions.end()) {
             std::cerr << ";Missing definition of a predicate " << logic.printSym(symbol) << std::endl;
             return PTRef_Undef;
         }
         // we need to substitute real arguments in the definition of the predicate
-        PTRef definitionTemplate = it->second;
+        auto [predicate, definitionTemplate] = it->second;
         // build the substitution map
         std::unordered_map<PTRef, PTRef, PTRefHash> subst;
-        utils.mapFromPredicate(it->first, nodePredicate, subst);
+        utils.mapFromPredicate(predicate, nodePredicate, subst);
         return utils.varSubstitute(definitionTemplate, subst);
     };
 
     auto edges = graph.getEdges();
-    for (auto const & edge : edges) {
+    // The edge is valid if its body together with the negated head is unsatisfiable
+    auto failedEdge = findFirstFailure(edges.size(), false, [&](std::size_t index) -> PTRef {
+        auto const & edge = edges[index];
         vec<PTRef> bodyComponents;
         PTRef constraint = edge.fla.fla;
         bodyComponents.push(constraint);
@@ -57,30 +148,26 @@ Validator::Result Validator::validateValidityWitness(ChcDirectedHyperGraph const
             auto source = edge.from[i];
             PTRef predicate = graph.getStateVersion(source, vertexInstances.getInstanceNumber(edge.id, i));
             PTRef interpreted = getInterpretation(predicate);
-            if (interpreted == PTRef_Undef) { return Result::NOT_VALIDATED; }
+            if (interpreted == PTRef_Undef) { return PTRef_Undef; }
             bodyComponents.push(interpreted);
         }
         PTRef interpretedBody = logic.mkAnd(std::move(bodyComponents));
         PTRef interpretedHead = getInterpretation(graph.getNextStateVersion(edge.to));
-        if (interpretedHead == PTRef_Undef) { return Result::NOT_VALIDATED; }
-        PTRef query = logic.mkAnd(interpretedBody, logic.mkNot(interpretedHead));
-        {
-            SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
-            auto & solver = solverWrapper.getCoreSolver();
-            solver.insertFormula(query);
-            auto res = solver.check();
-            if (res != s_False) {
-                std::cerr << ";Edge not validated!";
-                // TODO: print edge
-                return Validator::Result::NOT_VALIDATED;
-            }
-        }
+        if (interpretedHead == PTRef_Undef) { return PTRef_Undef; }
+        return logic.mkAnd(interpretedBody, logic.mkNot(interpretedHead));
+    });
+    if (failedEdge) {
+        std::cerr << ";Edge " << describeEdge(logic, edges[*failedEdge]) << " not validated!" << std::endl;
+        return Validator::Result::NOT_VALIDATED;
     }
     return Validator::Result::VALIDATED;
 }
 
-
-Validator::Result validateStep(
+/*
+ * Instantiates the constraint of the edge used in the derivation step with the values from the derived facts.
+ * The step is valid if the result is satisfiable.
+ */
+PTRef instantiateStep(
     std::size_t stepIndex,
     InvalidityWitness::Derivation const & derivation,
     ChcDirectedHyperGraph const & graph,
@@ -107,15 +194,7 @@ Validator::Result validateStep(
     }
     auto target = graph.getTarget(edge);
     fillVariables(step.derivedFact, graph.getNextStateVersion(target));
-    PTRef constraintAfterSubstitution = utils.varSubstitute(graph.getEdgeLabel(edge), subst);
-    if (constraintAfterSubstitution == logic.getTerm_true()) { return Validator::Result::VALIDATED; }
-    if (constraintAfterSubstitution == logic.getTerm_false()) { return Validator::Result::NOT_VALIDATED; }
-    SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
-    auto & solver = solverWrapper.getCoreSolver();
-    solver.insertFormula(constraintAfterSubstitution);
-    auto res = solver.check();
-    if (res == s_True) { return Validator::Result::VALIDATED; }
-    return Validator::Result::NOT_VALIDATED;
+    return utils.varSubstitute(graph.getEdgeLabel(edge), subst);
 }
 
 Validator::Result
@@ -133,10 +212,14 @@ Validator::validateInvalidityWitness(ChcDirectedHyperGraph const & graph, Invali
         std::cerr << "; Validator: Root of the invalidity witness is not FALSE!\n";
         return Result::NOT_VALIDATED;
     }
-    for (std::size_t i = 1; i < derivationSize; ++i) {
-        auto result = validateStep(i, derivation, graph, vertexInstances);
-        if (result == Validator::Result::NOT_VALIDATED) { return result; }
+    auto failedStep = findFirstFailure(derivationSize - 1, true, [&](std::size_t index) {
+        return instantiateStep(index + 1, derivation, graph, vertexInstances);
+    });
+    if (failedStep) {
+        auto const & step = derivation[*failedStep + 1];
+        std::cerr << "; Validator: Derivation step " << step.index << " using edge "
+                  << describeEdge(logic, graph.getEdge(step.clauseId)) << " not validated!" << std::endl;
+        return Validator::Result::NOT_VALIDATED;
     }
     return Validator::Result::VALIDATED;
 }
-
@@ -11,16 +11,24 @@
 #include "engine/Engine.h"
 #include "graph/ChcGraph.h"
 
+#include <optional>
+
 struct ValidationException : public std::runtime_error {
 public:
     ValidationException(const std::string & msg) : std::runtime_error(msg) {}
     ValidationException(const char * msg) : std::runtime_error(msg) {}
 };
 
+/*
+ * Checks the witness against the graph clause by clause.
+ * The individual checks are independent; with more than one thread they are dispatched to a thread pool, each in
+ * its own private copy of the logic. Validation stops at the first failure, which is reported on the error output.
+ */
 class Validator {
     Logic & logic;
+    std::size_t threads;
 public:
-    Validator(Logic & logic) : logic(logic) {}
+    explicit Validator(Logic & logic, std::size_t threads = 1) : logic(logic), threads(threads) {}
 
     enum class Result {VALIDATED, NOT_VALIDATED};
     Result validate(ChcDirectedHyperGraph const & system, VerificationResult const & result);
@@ -28,6 +36,9 @@ public:
 private:
     Result validateValidityWitness(ChcDirectedHyperGraph const & graph, ValidityWitness const & witness);
     Result validateInvalidityWitness(ChcDirectedHyperGraph const & graph, InvalidityWitness const & witness);
+
+    template<typename TProducer>
+    std::optional<std::size_t> findFirstFailure(std::size_t count, bool shouldBeSatisfiable, TProducer produce) const;
 };
 
 
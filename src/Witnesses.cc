@@ -7,12 +7,15 @@
 #include "Witnesses.h"
 #include "TransformationUtils.h"
 #include "proofs/ProofSteps.h"
+#include "utils/Json.h"
 #include "utils/SmtSolver.h"
 #include <memory>
 #include <utility>
 
 void VerificationResult::printWitness(std::ostream & out, Logic & logic, const ChcDirectedHyperGraph & originalGraph,
-                                       std::vector<std::shared_ptr<Term>> originalAssertions, Normalizer::Equalities const & normalizingEqualities, const std::string& format) const {
+                                      TermStore & proofTerms, std::vector<TermRef> originalAssertions,
+                                      Normalizer::Equalities const & normalizingEqualities,
+                                      const std::string & format, std::size_t threads) const {
 
     if (not hasWitness()) { return; }
     switch (answer) {
@@ -24,9 +27,9 @@ void VerificationResult::printWitness(std::ostream & out, Logic & logic, const C
             if (format == "legacy") {
                 getInvalidityWitness().print(out, logic);
             } else {
-                StepHandler stepHandler(getInvalidityWitness().getDerivation(), std::move(originalAssertions),
-                                        normalizingEqualities,
-                                        logic, originalGraph);
+                StepHandler stepHandler(proofTerms, getInvalidityWitness().getDerivation(),
+                                        std::move(originalAssertions), normalizingEqualities, logic, originalGraph,
+                                        threads);
                 if (format == "alethe") {
                     AlethePrintObserver alethePrintObserver(out);
                     stepHandler.registerObserver(&alethePrintObserver);
@@ -44,6 +47,36 @@ void VerificationResult::printWitness(std::ostream & out, Logic & logic, const C
     }
 }
 
+void VerificationResult::printJson(std::ostream & out, std::string_view engine) const {
+    out << "{\"engine\": ";
+    printJsonString(out, engine);
+    out << ", \"answer\": ";
+    switch (answer) {
+        case VerificationAnswer::SAFE:
+            out << "\"sat\"";
+            break;
+        case VerificationAnswer::UNSAFE:
+            out << "\"unsat\"";
+            break;
+        case VerificationAnswer::UNKNOWN:
+            out << "\"unknown\"";
+            break;
+    }
+    out << ", \"safe-bound\": ";
+    if (safeBound) {
+        out << *safeBound;
+    } else {
+        out << "null";
+    }
+    out << ", \"reason\": ";
+    if (answer == VerificationAnswer::UNKNOWN and not hasWitness() and not getNoWitnessReason().empty()) {
+        printJsonString(out, getNoWitnessReason());
+    } else {
+        out << "null";
+    }
+    out << "}\n";
+}
+
 InvalidityWitness InvalidityWitness::fromErrorPath(ErrorPath const & errorPath, ChcDirectedGraph const & graph) {
     using Derivation = InvalidityWitness::Derivation;
     Logic & logic = graph.getLogic();
@@ -61,7 +94,7 @@ InvalidityWitness InvalidityWitness::fromErrorPath(ErrorPath const & errorPath,
             fla = TimeMachine(logic).sendFlaThroughTime(fla, i);
             solver.insertFormula(fla);
         }
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res != s_True) { throw std::logic_error("Error in computing model for the error path"); }
         return solver.getModel();
     }();
@@ -120,6 +153,40 @@ InvalidityWitness InvalidityWitness::fromTransitionSystem(const ChcDirectedGraph
     return fromErrorPath(ErrorPath::fromTransitionSystem(graph, unrollings), graph);
 }
 
+void InvalidityWitness::compact() {
+    auto const size = derivation.size();
+    if (size == 0) { return; }
+    // Each step is represented by the first step deriving the same fact
+    std::unordered_map<PTRef, std::size_t, PTRefHash> firstDerivation;
+    std::vector<std::size_t> representative(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        representative[i] = firstDerivation.insert({derivation[i].derivedFact, i}).first->second;
+    }
+    // Premises precede the steps, a single backward pass finds all steps needed for the last one
+    std::vector<bool> needed(size, false);
+    needed[0] = true; // The initial fact is kept even if unused
+    needed[representative[size - 1]] = true;
+    for (std::size_t i = size; i-- > 0;) {
+        if (not needed[i]) { continue; }
+        for (std::size_t premise : derivation[i].premises) {
+            needed[representative[premise]] = true;
+        }
+    }
+    std::vector<std::size_t> newIndex(size);
+    std::vector<Derivation::DerivationStep> steps;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (not needed[i]) { continue; }
+        newIndex[i] = steps.size();
+        auto step = derivation[i];
+        step.index = steps.size();
+        for (std::size_t & premise : step.premises) {
+            premise = newIndex[representative[premise]];
+        }
+        steps.push_back(std::move(step));
+    }
+    derivation = Derivation(std::move(steps));
+}
+
 void InvalidityWitness::print(std::ostream & out, Logic & logic) const {
     auto derivationSize = derivation.size();
     for (std::size_t i = 0; i < derivationSize; ++i) {
@@ -201,6 +268,11 @@ ValidityWitness::fromTransitionSystem(Logic & logic, ChcDirectedGraph const & gr
     return ValidityWitness(std::move(definitions));
 }
 
+std::optional<std::size_t> transitionsBetweenEntryAndExit(std::optional<std::size_t> steps) {
+    if (not steps or *steps < 2) { return std::nullopt; }
+    return *steps - 2;
+}
+
 VerificationResult
 translateTransitionSystemResult(TransitionSystemVerificationResult result, ChcDirectedGraph const & graph, TransitionSystem const & transitionSystem) {
     switch (result.answer) {
@@ -208,8 +280,11 @@ translateTransitionSystemResult(TransitionSystemVerificationResult result, ChcDi
             return {VerificationAnswer::SAFE, ValidityWitness::fromTransitionSystem(graph.getLogic(), graph, transitionSystem, std::get<PTRef>(result.witness))};
         case VerificationAnswer::UNSAFE:
             return {VerificationAnswer::UNSAFE, InvalidityWitness::fromTransitionSystem(graph, std::get<std::size_t>(result.witness))};
-        case VerificationAnswer::UNKNOWN:
-            return VerificationResult(VerificationAnswer::UNKNOWN);
+        case VerificationAnswer::UNKNOWN: {
+            VerificationResult unknown(VerificationAnswer::UNKNOWN, NoWitness(result.reason));
+            unknown.setSafeBound(result.safeBound);
+            return unknown;
+        }
     }
     assert(false);
     return VerificationResult(VerificationAnswer::UNKNOWN);
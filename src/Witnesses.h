@@ -13,6 +13,8 @@
 #include "proofs/Term.h"
 #include "Normalizer.h"
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <variant>
 
 class ErrorPath {
@@ -78,6 +80,12 @@ public:
     [[nodiscard]] Derivation const & getDerivation() const { return derivation; }
     [[nodiscard]] Derivation & getDerivation() { return derivation; }
 
+    /*
+     * Removes the steps that re-derive an already derived fact and the steps not needed to derive the last fact.
+     * The premises of the remaining steps are redirected to the first derivation of the fact.
+     */
+    void compact();
+
     static InvalidityWitness fromErrorPath(ErrorPath const & errorPath, ChcDirectedGraph const & graph);
     static InvalidityWitness fromTransitionSystem(ChcDirectedGraph const & graph, std::size_t unrollings);
 
@@ -126,6 +134,7 @@ enum class VerificationAnswer : char {SAFE, UNSAFE, UNKNOWN};
 class VerificationResult {
     VerificationAnswer answer;
     std::variant<NoWitness, ValidityWitness, InvalidityWitness> witness;
+    std::optional<std::size_t> safeBound;
 
 public:
     VerificationResult(VerificationAnswer answer, ValidityWitness validityWitness)
@@ -145,20 +154,50 @@ public:
 
     [[nodiscard]] ValidityWitness const & getValidityWitness() const & { assert(answer == VerificationAnswer::SAFE); return std::get<ValidityWitness>(witness); }
     [[nodiscard]] InvalidityWitness const & getInvalidityWitness() const & { assert(answer == VerificationAnswer::UNSAFE); return std::get<InvalidityWitness>(witness); }
+    [[nodiscard]] InvalidityWitness & getInvalidityWitness() & { assert(answer == VerificationAnswer::UNSAFE); return std::get<InvalidityWitness>(witness); }
     [[nodiscard]] std::string_view getNoWitnessReason() const & { assert(not hasWitness()); return std::get<NoWitness>(witness).getReason(); }
 
+    /**
+     * For UNKNOWN results, the number of transitions up to which the engine has proven that the query is not
+     * reachable: no derivation of the query whose branches contain at most this many transitions exists. Transitions
+     * are the edges that neither start in the entry nor end in the exit, so the bound is 0 if the query cannot be
+     * derived from the facts directly. Engines that count their steps differently convert them to this unit (see
+     * transitionsBetweenEntryAndExit). The transitions are those of the system given to the engine; preprocessing
+     * only merges transitions, so the bound is also a safe bound of the input system.
+     */
+    [[nodiscard]] std::optional<std::size_t> getSafeBound() const { return safeBound; }
+    void setSafeBound(std::optional<std::size_t> bound) { safeBound = bound; }
+
     ValidityWitness && getValidityWitness() && { assert(answer == VerificationAnswer::SAFE); return std::move(std::get<ValidityWitness>(witness)); }
     InvalidityWitness && getInvalidityWitness() && { assert(answer == VerificationAnswer::UNSAFE); return std::move(std::get<InvalidityWitness>(witness)); }
 
-    void printWitness(std::ostream & out, Logic & logic, ChcDirectedHyperGraph const & originalGraph, std::vector<std::shared_ptr<Term>> originalAssertions,
-                       Normalizer::Equalities const & normalizingEqualities, std::string const & format) const;
+    void printWitness(std::ostream & out, Logic & logic, ChcDirectedHyperGraph const & originalGraph,
+                      TermStore & proofTerms, std::vector<TermRef> originalAssertions,
+                      Normalizer::Equalities const & normalizingEqualities, std::string const & format,
+                      std::size_t threads = 1) const;
+
+    /**
+     * Prints the answer as a single JSON object, in the same format for every engine:
+     * {"engine": "bmc", "answer": "unknown", "safe-bound": 12, "reason": "time limit reached"}
+     * The answer is one of "sat", "unsat" and "unknown"; safe-bound and reason are null if not known.
+     * The safe bound is a number of transitions for every engine, see getSafeBound.
+     */
+    void printJson(std::ostream & out, std::string_view engine) const;
 };
 
 struct TransitionSystemVerificationResult {
     VerificationAnswer answer;
     std::variant<std::size_t, PTRef> witness; // Unrolling number or state inductive invariant
+    std::optional<std::size_t> safeBound{}; // See VerificationResult::getSafeBound
+    std::string reason{}; // Why the result is UNKNOWN
 };
 
+/**
+ * Converts a bound on steps that also count the edge from the entry and the edge into the exit (e.g., the depth of
+ * Spacer's derivations or the steps of the single-loop encoding) to the transitions in between; see getSafeBound.
+ */
+std::optional<std::size_t> transitionsBetweenEntryAndExit(std::optional<std::size_t> steps);
+
 VerificationResult translateTransitionSystemResult(TransitionSystemVerificationResult result, ChcDirectedGraph const & graph, TransitionSystem const & ts);
 
 #endif // GOLEM_WITNESSES_H
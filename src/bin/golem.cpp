@@ -6,16 +6,24 @@
 
 #include "ChcInterpreter.h"
 #include "Options.h"
+#include "PreprocessingCache.h"
+#include "utils/ResourceGovernor.h"
+#include "utils/SmtLibCommandReader.h"
+#include "utils/Statistics.h"
 
 #include "osmt_terms.h"
 #include "osmt_parser.h"
 
+#include <fstream>
 #include <memory>
+#include <optional>
 
 namespace{
-std::string tryDetectLogic(ASTNode const * root) {
-    if (not root or not root->children) { return ""; }
-    auto const & children = *(root->children);
+/*
+ * Looks at the sorts of the first few declared predicates; the reader is rewound afterwards.
+ * Parsing errors are ignored here, they are reported when the script is interpreted.
+ */
+std::string tryDetectLogic(SmtLibCommandReader & reader) {
     bool hasReals = false;
     bool hasIntegers = false;
     unsigned short examined = 0;
@@ -26,16 +34,17 @@ std::string tryDetectLogic(ASTNode const * root) {
         }
         return "";
     };
-    for (ASTNode * child : children) {
-        const osmttokens::smt2token token = child->getToken();
+    // Returns true if enough commands have been examined
+    auto examine = [&](ASTNode const & command) {
+        const osmttokens::smt2token token = command.getToken();
         switch (token.x) {
             case osmttokens::t_declarefun:
             {
-                auto it = child->children->begin();
+                auto it = command.children->begin();
                 ASTNode const & name_node = **(it++); (void)name_node;
                 ASTNode const & args_node = **(it++);
                 ASTNode const & ret_node  = **(it++); (void)ret_node;
-                assert(it == child->children->end());
+                assert(it == command.children->end());
                 for (auto argNode : *(args_node.children)) {
                     if (argNode->getType() == SYM_T) {
                         hasReals = hasReals or strcmp(argNode->getValue(), "Real") == 0;
@@ -43,17 +52,60 @@ std::string tryDetectLogic(ASTNode const * root) {
                     }
                 }
                 ++examined;
-                if (examined == limit) { return decide(); }
-                break;
+                return examined == limit;
             }
             case osmttokens::t_assert:
-                return decide();
+                return true;
             default:
-                ;
+                return false;
+        }
+    };
+    bool done = false;
+    while (not done) {
+        auto commandText = reader.nextCommand();
+        if (not commandText) { break; }
+        std::string buffer(*commandText);
+        Smt2newContext context(buffer.data());
+        if (smt2newparse(&context) != 0) { break; }
+        ASTNode const * root = context.getRoot();
+        if (not root or not root->children) { continue; }
+        for (ASTNode * child : *(root->children)) {
+            if (examine(*child)) {
+                done = true;
+                break;
+            }
         }
     }
-    return "";
+    reader.rewind();
+    return decide();
 }
+
+/*
+ * Writes the collected statistics when leaving main.
+ * Processes that terminate by calling exit do not report anything.
+ */
+class StatisticsReport {
+    std::string path;
+
+public:
+    explicit StatisticsReport(std::string path) : path(std::move(path)) {}
+    StatisticsReport(StatisticsReport const &) = delete;
+    StatisticsReport & operator=(StatisticsReport const &) = delete;
+
+    ~StatisticsReport() {
+        if (not Statistics::isEnabled()) { return; }
+        if (path == "-") {
+            Statistics::printJson(std::cout);
+            return;
+        }
+        std::ofstream out(path);
+        if (out) {
+            Statistics::printJson(out);
+        } else {
+            std::cerr << "Could not write statistics to " << path << '\n';
+        }
+    }
+};
 }
 
 void error(std::string const & msg) {
@@ -61,6 +113,25 @@ void error(std::string const & msg) {
     exit(1);
 }
 
+ResourceGovernor::Limits limitsFromOptions(Options const & options) {
+    ResourceGovernor::Limits limits;
+    try {
+        if (options.hasOption(Options::TIME_LIMIT)) {
+            auto seconds = std::stod(options.getOption(Options::TIME_LIMIT));
+            limits.time = std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+        }
+        if (options.hasOption(Options::MEMORY_LIMIT)) {
+            limits.memoryMB = std::stoul(options.getOption(Options::MEMORY_LIMIT));
+        }
+        if (options.hasOption(Options::QUERY_LIMIT)) {
+            limits.queries = std::stoull(options.getOption(Options::QUERY_LIMIT));
+        }
+    } catch (std::logic_error const &) {
+        error("Invalid resource limit");
+    }
+    return limits;
+}
+
 int main( int argc, char * argv[] ) {
     SMTConfig c;
 
@@ -80,34 +151,60 @@ int main( int argc, char * argv[] ) {
     if (inputFile.empty()) {
         error("No input file provided");
     }
-    {
-        FILE * fin = nullptr;
-        // check the file
-        const char * filename = inputFile.c_str();
-        assert(filename);
-
-        if ((fin = fopen(filename, "rt")) == nullptr) {
+    std::optional<StatisticsReport> statisticsReport;
+    if (options.hasOption(Options::STATISTICS)) {
+        Statistics::enable();
+        statisticsReport.emplace(options.getOption(Options::STATISTICS));
+    }
+    ResourceGovernor::configure(limitsFromOptions(options));
+    try {
+        SmtLibCommandReader reader(inputFile);
+        if (not reader.isValid()) {
             error("can't open file");
         }
-
+        const char * filename = inputFile.c_str();
+        assert(filename);
         const char * extension = strrchr( filename, '.' );
-        if (extension != nullptr && strcmp(extension, ".smt2") == 0) {
-            Smt2newContext context(fin);
-            int rval = smt2newparse(&context);
-            if (rval != 0) {
-                fclose(fin);
-                error("Error when parsing input file");
-            }
-            auto logicStr = options.hasOption(Options::LOGIC) ? options.getOption(Options::LOGIC) : tryDetectLogic(context.getRoot());
-            auto logic = logicFromString(logicStr);
-            ChcInterpreter interpreter(options);
-            interpreter.interpretSystemAst(*logic, context.getRoot());
-            fclose(fin);
-        }
-        else {
-            fclose(fin);
+        if (extension == nullptr || strcmp(extension, ".smt2") != 0) {
             error(inputFile + " extension not recognized. File must be in smt-lib2 format (extension .smt2)");
         }
+        ChcInterpreter interpreter(options);
+        std::optional<PreprocessingCache> cache;
+        // Returns true if the system has been solved from its cached entry
+        auto solveCached = [&]() {
+            auto cachedLogic = cache->storedLogic();
+            bool logicMatches = cachedLogic and (not options.hasOption(Options::LOGIC) or
+                                                 options.getOption(Options::LOGIC) == *cachedLogic);
+            if (not logicMatches) { return false; }
+            auto logic = logicFromString(*cachedLogic);
+            auto entry = cache->load(*logic);
+            if (not entry) { return false; }
+            interpreter.solvePreprocessed(*logic, *entry);
+            return true;
+        };
+        bool solved = false;
+        if (options.hasOption(Options::CACHE_DIR) and not ChcInterpreter::needsOriginalAssertions(options)) {
+            cache.emplace(options.getOption(Options::CACHE_DIR), reader.contents(), options);
+            solved = solveCached();
+            if (not solved) { interpreter.setPreprocessingCache(&*cache); }
+        }
+        if (not solved) {
+            auto logicStr =
+                options.hasOption(Options::LOGIC) ? options.getOption(Options::LOGIC) : tryDetectLogic(reader);
+            auto logic = logicFromString(logicStr);
+            try {
+                interpreter.interpretSystemStream(*logic, reader);
+            } catch (ChcInterpreter::ParseError const & e) {
+                error(e.what());
+            }
+        }
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        // Engines handle the limits themselves, this is reached only if the limit runs out during preprocessing
+        std::cout << "unknown" << std::endl;
+        std::cerr << ";Reason: " << limit.what() << std::endl;
+        auto engine = options.hasOption(Options::ENGINE) ? options.getOption(Options::ENGINE) : "spacer";
+        ChcInterpreter::writeResultJson(options, engine,
+                                        VerificationResult(VerificationAnswer::UNKNOWN, NoWitness(limit.what())));
     }
     if (options.hasOption(Options::PROOF_FORMAT)) {
         auto formatStr = options.getOption(Options::PROOF_FORMAT);
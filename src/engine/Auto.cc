@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Auto.h"
+
+#include "TransformationUtils.h"
+#include "utils/ResourceGovernor.h"
+#include "utils/Statistics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Hand-written defaults; a table fitted to benchmark results can be generated by bench/train_auto_rules.py
+constexpr std::string_view builtInRules = R"(
+# TPA finds long counterexamples quickly, k-induction and Spacer prove safety
+transition-system=1 -> split-tpa:10 kind:5 spacer
+transition-system-dag=1 -> split-tpa:20 spacer
+# LAWI is sometimes faster on large linear systems where Spacer struggles
+linear=1 predicates>=20 -> spacer:60 lawi
+linear=1 -> spacer
+# Only Spacer supports nonlinear systems
+* -> spacer
+)";
+
+std::string_view trim(std::string_view str) {
+    auto begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) { return {}; }
+    auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string_view> splitWords(std::string_view str) {
+    std::vector<std::string_view> words;
+    while (true) {
+        str = trim(str);
+        if (str.empty()) { return words; }
+        auto end = str.find_first_of(" \t");
+        words.push_back(str.substr(0, end));
+        if (end == std::string_view::npos) { return words; }
+        str.remove_prefix(end);
+    }
+}
+
+void printSchedule(std::ostream & out, EngineRules::Schedule const & schedule) {
+    for (auto const & slice : schedule) {
+        out << ' ' << slice.engine;
+        if (slice.time) { out << ':' << std::chrono::duration<double>(*slice.time).count(); }
+    }
+}
+} // namespace
+
+GraphFeatures GraphFeatures::of(ChcDirectedHyperGraph const & graph) {
+    GraphFeatures features;
+    Logic & logic = graph.getLogic();
+    auto const * arithLogic = dynamic_cast<ArithLogic const *>(&logic);
+    features.integers = arithLogic and arithLogic->hasIntegers();
+    for (SymRef vertex : graph.getVertices()) {
+        if (vertex == graph.getEntry() or vertex == graph.getExit()) { continue; }
+        ++features.predicates;
+        std::size_t arity = logic.getPterm(graph.getStateVersion(vertex)).size();
+        features.maxVariables = std::max(features.maxVariables, arity);
+        features.variables += arity;
+    }
+    auto const edges = graph.getEdges();
+    features.edges = edges.size();
+    for (auto const & edge : edges) {
+        features.maxSources = std::max(features.maxSources, edge.from.size());
+        if (edge.from.size() == 1 and edge.from[0] == edge.to) { ++features.loops; }
+    }
+    features.linear = graph.isNormalGraph();
+    if (features.linear) {
+        auto normalGraph = graph.toNormalGraph();
+        features.transitionSystem = isTransitionSystem(*normalGraph);
+        features.transitionSystemDAG = isTransitionSystemDAG(*normalGraph);
+    }
+    return features;
+}
+
+std::optional<std::size_t> GraphFeatures::get(std::string_view name) const {
+    if (name == "linear") { return linear; }
+    if (name == "transition-system") { return transitionSystem; }
+    if (name == "transition-system-dag") { return transitionSystemDAG; }
+    if (name == "integers") { return integers; }
+    if (name == "predicates") { return predicates; }
+    if (name == "edges") { return edges; }
+    if (name == "loops") { return loops; }
+    if (name == "max-sources") { return maxSources; }
+    if (name == "max-variables") { return maxVariables; }
+    if (name == "variables") { return variables; }
+    return std::nullopt;
+}
+
+void GraphFeatures::printJson(std::ostream & out) const {
+    out << "{\"linear\": " << linear << ", \"transition-system\": " << transitionSystem
+        << ", \"transition-system-dag\": " << transitionSystemDAG << ", \"integers\": " << integers
+        << ", \"predicates\": " << predicates << ", \"edges\": " << edges << ", \"loops\": " << loops
+        << ", \"max-sources\": " << maxSources << ", \"max-variables\": " << maxVariables
+        << ", \"variables\": " << variables << "}\n";
+}
+
+EngineRules EngineRules::parse(std::string_view table) {
+    EngineRules result;
+    std::size_t lineNumber = 0;
+    while (not table.empty()) {
+        auto end = table.find('\n');
+        auto line = trim(table.substr(0, end));
+        table.remove_prefix(end == std::string_view::npos ? table.size() : end + 1);
+        ++lineNumber;
+        if (line.empty() or line[0] == '#') { continue; }
+        auto malformed = [&](std::string_view what) {
+            return std::logic_error("Invalid engine rule on line " + std::to_string(lineNumber) + ": " +
+                                    std::string(what));
+        };
+        auto arrow = line.find("->");
+        if (arrow == std::string_view::npos) { throw malformed("missing ->"); }
+        Rule rule;
+        for (auto word : splitWords(line.substr(0, arrow))) {
+            if (word == "*") { continue; }
+            auto position = word.find_first_of("<>=");
+            if (position == std::string_view::npos or position == 0) { throw malformed(word); }
+            Condition condition;
+            condition.feature = std::string(word.substr(0, position));
+            if (not GraphFeatures{}.get(condition.feature)) { throw malformed("unknown feature " + condition.feature); }
+            auto rest = word.substr(position);
+            if (rest.substr(0, 2) == "<=") {
+                condition.relation = Condition::Relation::LEQ;
+                rest.remove_prefix(2);
+            } else if (rest.substr(0, 2) == ">=") {
+                condition.relation = Condition::Relation::GEQ;
+                rest.remove_prefix(2);
+            } else if (rest[0] == '=') {
+                condition.relation = Condition::Relation::EQ;
+                rest.remove_prefix(1);
+            } else {
+                throw malformed(word);
+            }
+            if (rest.empty() or rest.find_first_not_of("0123456789") != std::string_view::npos) {
+                throw malformed(word);
+            }
+            condition.value = std::stoull(std::string(rest));
+            rule.conditions.push_back(std::move(condition));
+        }
+        for (auto word : splitWords(line.substr(arrow + 2))) {
+            if (not rule.schedule.empty() and not rule.schedule.back().time) {
+                throw malformed("only the last engine can run without a time slice");
+            }
+            auto colon = word.find(':');
+            Slice slice{std::string(word.substr(0, colon)), std::nullopt};
+            if (colon != std::string_view::npos) {
+                double seconds = 0;
+                std::istringstream in{std::string(word.substr(colon + 1))};
+                if (not(in >> seconds) or not in.eof() or seconds <= 0) { throw malformed(word); }
+                slice.time = std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+            }
+            if (slice.engine.empty() or slice.engine == "auto") { throw malformed(word); }
+            rule.schedule.push_back(std::move(slice));
+        }
+        if (rule.schedule.empty()) { throw malformed("empty schedule"); }
+        result.rules.push_back(std::move(rule));
+    }
+    return result;
+}
+
+EngineRules EngineRules::builtIn() {
+    return parse(builtInRules);
+}
+
+EngineRules::Schedule EngineRules::select(GraphFeatures const & features) const {
+    auto holds = [&](Condition const & condition) {
+        auto value = features.get(condition.feature).value();
+        switch (condition.relation) {
+            case Condition::Relation::EQ:
+                return value == condition.value;
+            case Condition::Relation::LEQ:
+                return value <= condition.value;
+            case Condition::Relation::GEQ:
+                return value >= condition.value;
+        }
+        return false;
+    };
+    for (auto const & rule : rules) {
+        if (std::all_of(rule.conditions.begin(), rule.conditions.end(), holds)) { return rule.schedule; }
+    }
+    return {};
+}
+
+AutoEngine::AutoEngine(Logic & logic, Options const & options, EngineFactory factory)
+    : logic(logic), options(options), factory(std::move(factory)) {
+    if (options.hasOption(Options::VERBOSE)) { verbosity = std::stoi(options.getOption(Options::VERBOSE)); }
+    if (options.hasOption(Options::AUTO_RULES)) {
+        auto path = options.getOption(Options::AUTO_RULES);
+        std::ifstream in(path);
+        if (not in) { throw std::logic_error("Could not read engine rules from " + path); }
+        std::stringstream contents;
+        contents << in.rdbuf();
+        rules = EngineRules::parse(contents.str());
+    } else {
+        rules = EngineRules::builtIn();
+    }
+}
+
+VerificationResult AutoEngine::solve(ChcDirectedHyperGraph const & graph) {
+    auto features = GraphFeatures::of(graph);
+    if (options.hasOption(Options::AUTO_FEATURES)) {
+        auto path = options.getOption(Options::AUTO_FEATURES);
+        if (path == "-") {
+            features.printJson(std::cout);
+        } else if (std::ofstream out(path); out) {
+            features.printJson(out);
+        }
+    }
+    auto schedule = rules.select(features);
+    if (verbosity > 0) {
+        std::cout << "; auto: features ";
+        features.printJson(std::cout);
+        std::cout << "; auto: schedule";
+        printSchedule(std::cout, schedule);
+        std::cout << std::endl;
+    }
+    std::optional<VerificationResult> result;
+    for (auto const & slice : schedule) {
+        Statistics::increment("auto.slices");
+        // Engines such as TPA choose their variant by the engine option, which is "auto" here
+        Options engineOptions = options;
+        engineOptions.setOption(Options::ENGINE, slice.engine);
+        auto engine = factory(slice.engine, logic, engineOptions);
+        std::optional<ResourceGovernor::Slice> timeSlice;
+        if (slice.time) { timeSlice.emplace(*slice.time); }
+        try {
+            result = engine->solve(graph);
+        } catch (ResourceGovernor::LimitReached const & limit) {
+            result = VerificationResult(VerificationAnswer::UNKNOWN, NoWitness(limit.what()));
+        }
+        if (result->getAnswer() != VerificationAnswer::UNKNOWN) { return std::move(*result); }
+        // The budget of the whole run has run out, there is no time left for the remaining engines
+        if (ResourceGovernor::isExhausted()) { break; }
+        if (verbosity > 0) { std::cout << "; auto: " << slice.engine << " did not solve the system" << std::endl; }
+    }
+    if (not result) { return VerificationResult(VerificationAnswer::UNKNOWN, NoWitness("No engine rule matches")); }
+    return std::move(*result);
+}
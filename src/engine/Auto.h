@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_AUTO_H
+#define GOLEM_AUTO_H
+
+#include "Engine.h"
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Structural features of a preprocessed CHC graph, used to select the engine.
+ */
+struct GraphFeatures {
+    bool linear{false};              // Every edge has at most one source
+    bool transitionSystem{false};    // A single predicate with a single loop
+    bool transitionSystemDAG{false}; // A DAG of transition systems: acyclic apart from self-loops
+    bool integers{false};            // The theory is LIA (otherwise LRA)
+    std::size_t predicates{0};       // Without entry and exit
+    std::size_t edges{0};
+    std::size_t loops{0};            // Edges from a predicate to itself
+    std::size_t maxSources{0};       // The highest number of sources of an edge
+    std::size_t maxVariables{0};     // The highest arity of a predicate
+    std::size_t variables{0};        // The sum of the arities of all predicates
+
+    static GraphFeatures of(ChcDirectedHyperGraph const & graph);
+
+    /** Value of the feature with the given name (booleans are 0 or 1), or nothing if there is no such feature */
+    std::optional<std::size_t> get(std::string_view name) const;
+
+    void printJson(std::ostream & out) const;
+};
+
+/**
+ * Rule table mapping the features of a graph to a schedule of engines; the first rule whose conditions all hold
+ * is selected. Every line contains one rule; empty lines and lines starting with '#' are ignored:
+ *
+ *     transition-system=1 predicates<=3 -> split-tpa:10 kind:5 spacer
+ *     * -> spacer
+ *
+ * A condition compares a feature (see GraphFeatures::get) with a number using '=', '<=' or '>=', '*' matches every
+ * graph. The schedule lists the engines to run one after another; the number after ':' is the time slice of the
+ * engine in seconds, an engine without a time slice runs until it finishes. Only the last engine may run without a
+ * time slice. The table can be regenerated from benchmark results with bench/train_auto_rules.py.
+ */
+class EngineRules {
+public:
+    struct Slice {
+        std::string engine;
+        std::optional<std::chrono::milliseconds> time;
+    };
+    using Schedule = std::vector<Slice>;
+
+    /** @throws std::logic_error if the table is malformed */
+    static EngineRules parse(std::string_view table);
+
+    static EngineRules builtIn();
+
+    /** Schedule of the first matching rule; empty if no rule matches */
+    Schedule select(GraphFeatures const & features) const;
+
+private:
+    struct Condition {
+        enum class Relation { EQ, LEQ, GEQ };
+        std::string feature;
+        Relation relation;
+        std::size_t value;
+    };
+
+    struct Rule {
+        std::vector<Condition> conditions;
+        Schedule schedule;
+    };
+
+    std::vector<Rule> rules;
+};
+
+/*
+ * Selects the engines for the given graph by the rules from option AUTO_RULES (or the built-in rules) and runs them
+ * as scheduled. The answer of the first engine that solves the system is returned. When an engine gives up or its
+ * time slice expires, the next engine of the schedule starts from scratch.
+ */
+class AutoEngine : public Engine {
+public:
+    using EngineFactory = std::function<std::unique_ptr<Engine>(std::string const &, Logic &, Options const &)>;
+
+    AutoEngine(Logic & logic, Options const & options, EngineFactory factory);
+
+    VerificationResult solve(ChcDirectedHyperGraph const & graph) override;
+
+private:
+    Logic & logic;
+    Options const & options;
+    EngineFactory factory;
+    EngineRules rules;
+    int verbosity{0};
+};
+
+#endif // GOLEM_AUTO_H
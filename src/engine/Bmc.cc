@@ -11,7 +11,9 @@
 #include "TermUtils.h"
 #include "TransformationUtils.h"
 #include "transformers/SingleLoopTransformation.h"
+#include "utils/ResourceGovernor.h"
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
 
 VerificationResult BMC::solve(ChcDirectedGraph const & graph) {
     if (isTrivial(graph)) {
@@ -35,6 +37,7 @@ VerificationResult BMC::solveTransitionSystem(ChcDirectedGraph const & graph) {
 }
 
 TransitionSystemVerificationResult BMC::solveTransitionSystemInternal(TransitionSystem const & system) {
+    ScopedTimer timer("engine.bmc");
     std::size_t maxLoopUnrollings = std::numeric_limits<std::size_t>::max();
     PTRef init = system.getInit();
     PTRef query = system.getQuery();
@@ -44,33 +47,50 @@ TransitionSystemVerificationResult BMC::solveTransitionSystemInternal(Transition
     auto & solver = solverWrapper.getCoreSolver();
 //    std::cout << "Adding initial states: " << logic.pp(init) << std::endl;
     solver.insertFormula(init);
-    { // Check for system with empty initial states
-        auto res = solver.check();
-        if (res == s_False) {
-            return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_false()};
-        }
+    std::optional<std::size_t> safeBound;
+    // Paths up to the restored bound are known not to reach the query, only the transitions are unrolled for them
+    auto key = checkpoint.makeKey(Checkpoint::keyOf(system));
+    auto restoredBound = checkpoint.restore(key);
+    if (restoredBound and verbosity > 0) {
+        std::cout << "; BMC: Resuming from depth " << *restoredBound + 1 << std::endl;
     }
+    try {
+        { // Check for system with empty initial states
+            auto res = SMTSolver::check(solver);
+            if (res == s_False) {
+                return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_false()};
+            }
+        }
 
-    TimeMachine tm{logic};
-    for (std::size_t currentUnrolling = 0; currentUnrolling < maxLoopUnrollings; ++currentUnrolling) {
-        PTRef versionedQuery = tm.sendFlaThroughTime(query, currentUnrolling);
+        TimeMachine tm{logic};
+        for (std::size_t currentUnrolling = 0; currentUnrolling < maxLoopUnrollings; ++currentUnrolling) {
+            ResourceGovernor::checkpoint();
+            Statistics::increment("bmc.unrollings");
+            if (not restoredBound or currentUnrolling > *restoredBound) {
+                PTRef versionedQuery = tm.sendFlaThroughTime(query, currentUnrolling);
 //        std::cout << "Adding query: " << logic.pp(versionedQuery) << std::endl;
-        solver.push();
-        solver.insertFormula(versionedQuery);
-        auto res = solver.check();
-        if (res == s_True) {
-            if (verbosity > 0) {
-                std::cout << "; BMC: Bug found in depth: " << currentUnrolling << std::endl;
+                solver.push();
+                solver.insertFormula(versionedQuery);
+                auto res = SMTSolver::check(solver);
+                if (res == s_True) {
+                    if (verbosity > 0) {
+                        std::cout << "; BMC: Bug found in depth: " << currentUnrolling << std::endl;
+                    }
+                    return TransitionSystemVerificationResult{.answer = VerificationAnswer::UNSAFE, .witness = static_cast<std::size_t>(currentUnrolling)};
+                }
+                if (verbosity > 1) {
+                    std::cout << "; BMC: No path of length " << currentUnrolling << " found!" << std::endl;
+                }
+                solver.pop();
+                checkpoint.save(key, currentUnrolling);
             }
-            return TransitionSystemVerificationResult{.answer = VerificationAnswer::UNSAFE, .witness = static_cast<std::size_t>(currentUnrolling)};
-        }
-        if (verbosity > 1) {
-            std::cout << "; BMC: No path of length " << currentUnrolling << " found!" << std::endl;
-        }
-        solver.pop();
-        PTRef versionedTransition = tm.sendFlaThroughTime(transition, currentUnrolling);
+            safeBound = currentUnrolling;
+            PTRef versionedTransition = tm.sendFlaThroughTime(transition, currentUnrolling);
 //        std::cout << "Adding transition: " << logic.pp(versionedTransition) << std::endl;
-        solver.insertFormula(versionedTransition);
+            solver.insertFormula(versionedTransition);
+        }
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u, safeBound, limit.what()};
     }
     return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u};
 }
@@ -7,6 +7,7 @@
 #ifndef GOLEM_BMC_H
 #define GOLEM_BMC_H
 
+#include "Checkpoint.h"
 #include "Engine.h"
 #include "TransitionSystem.h"
 
@@ -14,9 +15,10 @@ class BMC : public Engine {
     Logic & logic;
 //    Options const & options;
     int verbosity = 0;
+    Checkpoint checkpoint;
 public:
 
-    BMC(Logic & logic, Options const & options) : logic(logic) {
+    BMC(Logic & logic, Options const & options) : logic(logic), checkpoint(logic, options, "bmc") {
         if (options.hasOption(Options::VERBOSE)) {
             verbosity = std::stoi(options.getOption(Options::VERBOSE));
         }
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Checkpoint.h"
+
+#include "utils/VersionedFile.h"
+
+namespace {
+// Must be changed whenever the layout of the checkpoint changes
+constexpr std::string_view checkpointMagic = "golem-checkpoint-v1\n";
+
+/*
+ * The header (engine name and key) is stored as plain text in front of the serialized state, so that it can be
+ * compared without recreating the terms of a checkpoint that belongs to a different system.
+ */
+std::optional<std::string_view> takeLine(std::string_view & contents) {
+    auto end = contents.find('\n');
+    if (end == std::string_view::npos) { return std::nullopt; }
+    auto line = contents.substr(0, end);
+    contents.remove_prefix(end + 1);
+    return line;
+}
+} // namespace
+
+Checkpoint::Checkpoint(Logic & logic, Options const & options, std::string engine)
+    : logic(logic), engine(std::move(engine)) {
+    if (options.hasOption(Options::CHECKPOINT)) { path = options.getOption(Options::CHECKPOINT); }
+}
+
+Checkpoint::Writer Checkpoint::keyOf(TransitionSystem const & system) {
+    return [&system](GraphSerializer & serializer) {
+        auto stateVars = system.getStateVars();
+        serializer.writeUnsigned(stateVars.size());
+        for (PTRef var : stateVars) {
+            serializer.writeTerm(var);
+        }
+        serializer.writeTerm(system.getInit());
+        serializer.writeTerm(system.getTransition());
+        serializer.writeTerm(system.getQuery());
+    };
+}
+
+std::string Checkpoint::makeKey(Writer const & writeKey) const {
+    if (not isEnabled()) { return {}; }
+    try {
+        GraphSerializer serializer(logic);
+        writeKey(serializer);
+        return serializer.finish();
+    } catch (std::logic_error const &) { // Unsupported terms, the checkpoint is not used
+        return {};
+    }
+}
+
+void Checkpoint::save(std::string const & key, std::size_t bound, Writer const & writeState) const {
+    if (not isEnabled() or key.empty()) { return; }
+    std::string state;
+    try {
+        GraphSerializer serializer(logic);
+        serializer.writeUnsigned(bound);
+        if (writeState) { writeState(serializer); }
+        state = serializer.finish();
+    } catch (std::logic_error const &) { // Unsupported terms
+        return;
+    }
+    std::string header = engine + '\n' + std::to_string(key.size()) + '\n';
+    VersionedFile::write(path, checkpointMagic, {header, key, state});
+}
+
+std::optional<std::size_t> Checkpoint::restore(std::string const & key, Reader const & readState) const {
+    if (not isEnabled() or key.empty()) { return std::nullopt; }
+    VersionedFile file(path, checkpointMagic);
+    if (not file.isValid()) { return std::nullopt; }
+    auto contents = file.contents();
+    auto storedEngine = takeLine(contents);
+    auto keySize = takeLine(contents);
+    if (not storedEngine or not keySize or *storedEngine != engine) { return std::nullopt; }
+    if (*keySize != std::to_string(key.size()) or contents.substr(0, key.size()) != key) { return std::nullopt; }
+    contents.remove_prefix(key.size());
+    try {
+        GraphDeserializer deserializer(logic, contents);
+        auto bound = deserializer.readUnsigned();
+        if (readState) { readState(deserializer); }
+        return bound;
+    } catch (std::logic_error const &) { // Unsupported terms or malformed checkpoint
+        return std::nullopt;
+    }
+}
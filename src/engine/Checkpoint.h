@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_CHECKPOINT_H
+#define GOLEM_CHECKPOINT_H
+
+#include "Options.h"
+#include "TransitionSystem.h"
+#include "graph/GraphSerialization.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+
+/**
+ * Progress of an engine stored in the file given by option CHECKPOINT, so that a later run can resume from it.
+ *
+ * A checkpoint records the bound up to which the engine has proven the system safe, together with the state the
+ * engine needs to continue from that bound. The checkpoint is keyed by the name of the engine and by data that
+ * identify the system (e.g., its serialized terms); a checkpoint of a different engine or system is ignored.
+ * The checkpoint is replaced atomically, so that a run killed while saving leaves the previous checkpoint intact.
+ */
+class Checkpoint {
+    Logic & logic;
+    std::string path;
+    std::string engine;
+
+public:
+    using Writer = std::function<void(GraphSerializer &)>;
+    using Reader = std::function<void(GraphDeserializer &)>;
+
+    Checkpoint(Logic & logic, Options const & options, std::string engine);
+
+    bool isEnabled() const { return not path.empty(); }
+
+    /** Key of a transition system: its state variables, initial states, transition relation and query */
+    static Writer keyOf(TransitionSystem const & system);
+
+    /** Serializes the key once, so that it does not have to be recomputed for every save; empty if disabled */
+    std::string makeKey(Writer const & writeKey) const;
+
+    /** Stores the bound and the state written by the engine; failures are ignored, the checkpoint is optional */
+    void save(std::string const & key, std::size_t bound, Writer const & writeState = {}) const;
+
+    /**
+     * Returns the stored bound if the checkpoint matches the key; the engine's state is read by the given reader.
+     * If the reader throws std::logic_error, the checkpoint is treated as malformed and nothing is returned.
+     */
+    std::optional<std::size_t> restore(std::string const & key, Reader const & readState = {}) const;
+};
+
+#endif // GOLEM_CHECKPOINT_H
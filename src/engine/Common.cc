@@ -14,7 +14,7 @@ VerificationResult solveTrivial(ChcDirectedGraph const & graph) {
         SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
         auto & solver = solverWrapper.getCoreSolver();
         solver.insertFormula(label);
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_False) {
             continue;
         } else if (res == s_True) {
@@ -34,3 +34,10 @@ VerificationResult solveTrivial(ChcDirectedGraph const & graph) {
     // Here we know that no edge is satisfiable
     return VerificationResult(VerificationAnswer::SAFE, ValidityWitness{});
 }
+
+VerificationResult limitReachedResult(ResourceGovernor::LimitReached const & limit,
+                                      std::optional<std::size_t> safeBound) {
+    VerificationResult result(VerificationAnswer::UNKNOWN, NoWitness(limit.what()));
+    result.setSafeBound(safeBound);
+    return result;
+}
@@ -3,7 +3,12 @@
 
 #include "Witnesses.h"
 #include "graph/ChcGraph.h"
+#include "utils/ResourceGovernor.h"
 
 VerificationResult solveTrivial(ChcDirectedGraph const & graph);
 
+/** UNKNOWN result of an engine run stopped by the resource governor, with the bound proven safe so far */
+VerificationResult limitReachedResult(ResourceGovernor::LimitReached const & limit,
+                                      std::optional<std::size_t> safeBound = std::nullopt);
+
 #endif // GOLEM_COMMON_H
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "EngineFactory.h"
+
+#include "Auto.h"
+#include "Bmc.h"
+#include "IMC.h"
+#include "Kind.h"
+#include "Lawi.h"
+#include "Portfolio.h"
+#include "Spacer.h"
+#include "TPA.h"
+
+#include <sstream>
+
+std::vector<std::string> splitEngines(std::string const & engineStr) {
+    std::string tmp;
+    std::vector<std::string> engines;
+    std::stringstream ss(engineStr);
+    while (getline(ss, tmp, ',')) {
+        engines.push_back(tmp);
+    }
+    return engines;
+}
+
+std::unique_ptr<Engine> makeEngine(std::string const & engineStr, Logic & logic, Options const & opts) {
+    if (engineStr.find(',') != std::string::npos) {
+        // The parallel portfolio is handled by forking in ChcInterpreterContext::solveAndReport
+        return std::unique_ptr<Engine>(new SequentialPortfolio(logic, opts, splitEngines(engineStr), makeEngine));
+    } else if (engineStr == TPAEngine::TPA or engineStr == TPAEngine::SPLIT_TPA) {
+        return std::unique_ptr<Engine>(new TPAEngine(logic, opts));
+    } else if (engineStr == "bmc") {
+        return std::unique_ptr<Engine>(new BMC(logic, opts));
+    } else if (engineStr == "lawi") {
+        return std::unique_ptr<Engine>(new Lawi(logic, opts));
+    } else if (engineStr == "spacer") {
+        return std::unique_ptr<Engine>(new Spacer(logic, opts));
+    } else if (engineStr == "kind") {
+        return std::unique_ptr<Engine>(new Kind(logic, opts));
+    } else if (engineStr == "imc") {
+        return std::unique_ptr<Engine>(new IMC(logic, opts));
+    } else if (engineStr == "auto") {
+        return std::unique_ptr<Engine>(new AutoEngine(logic, opts, makeEngine));
+    } else {
+        throw std::invalid_argument("Unknown engine specified");
+    }
+}
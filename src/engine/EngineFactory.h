@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_ENGINEFACTORY_H
+#define GOLEM_ENGINEFACTORY_H
+
+#include "Engine.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Splits a comma-separated list of engines */
+std::vector<std::string> splitEngines(std::string const & engineStr);
+
+/**
+ * Creates the engine with the given name; a comma-separated list of engines creates the sequential portfolio.
+ * The engine is configured by the given options, which must outlive it.
+ *
+ * @throws std::invalid_argument if the engine is unknown
+ */
+std::unique_ptr<Engine> makeEngine(std::string const & engineStr, Logic & logic, Options const & opts);
+
+#endif // GOLEM_ENGINEFACTORY_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Houdini.h"
+
+#include <string>
+
+Houdini::Houdini(Logic & logic, PTRef context)
+    : logic(logic), context(context), solverWrapper(logic, SMTSolver::WitnessProduction::ONLY_MODEL) {
+    solverWrapper.getCoreSolver().insertFormula(context);
+}
+
+PTRef Houdini::activationLiteral(std::size_t index) {
+    while (static_cast<std::size_t>(activationLiterals.size()) <= index) {
+        std::string name = ".houdini" + std::to_string(activationLiterals.size());
+        activationLiterals.push(logic.mkBoolVar(name.c_str()));
+    }
+    return activationLiterals[index];
+}
+
+std::vector<std::size_t> Houdini::filter(std::vector<Candidate> const & candidates) {
+    if (candidates.empty()) { return {}; }
+    auto & solver = solverWrapper.getCoreSolver();
+    // Only the context stays in the solver, the candidates of this call are popped at the end
+    solver.push();
+    vec<PTRef> violations;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        PTRef literal = activationLiteral(i);
+        solver.insertFormula(logic.mkOr(logic.mkNot(literal), candidates[i].premise));
+        violations.push(logic.mkAnd(literal, logic.mkNot(candidates[i].conclusion)));
+    }
+    PTRef query = activationLiteral(candidates.size());
+    solver.insertFormula(logic.mkOr(logic.mkNot(query), logic.mkOr(violations)));
+
+    std::vector<bool> active(candidates.size(), true);
+    std::size_t disabled = 0;
+    while (disabled < candidates.size()) {
+        solver.push();
+        vec<PTRef> assumptions;
+        assumptions.push(query);
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            assumptions.push(active[i] ? activationLiteral(i) : logic.mkNot(activationLiteral(i)));
+        }
+        solver.insertFormula(logic.mkAnd(std::move(assumptions)));
+        auto res = SMTSolver::check(solver);
+        if (res == s_False) {
+            solver.pop();
+            break;
+        }
+        if (res != s_True) { throw std::logic_error("Solver could not decide inductiveness of candidates!"); }
+        auto model = solver.getModel();
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (active[i] and model->evaluate(violations[i]) == logic.getTerm_true()) {
+                active[i] = false;
+                ++disabled;
+            }
+        }
+        solver.pop();
+    }
+    solver.pop();
+
+    std::vector<std::size_t> kept;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (active[i]) { kept.push_back(i); }
+    }
+    return kept;
+}
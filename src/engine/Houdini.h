@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_HOUDINI_H
+#define GOLEM_HOUDINI_H
+
+#include "utils/SmtSolver.h"
+
+#include <vector>
+
+/**
+ * Incremental Houdini: computes the largest subset of candidates that is inductive relative to a fixed context.
+ *
+ * A candidate consists of a premise and a conclusion (typically the same formula over different versions of
+ * the variables). A set of candidates is kept if the context together with the premises of all the kept candidates
+ * implies the conclusion of each of them. Candidates with trivial premises just check which conclusions follow from
+ * the context.
+ *
+ * The context is asserted only once into a single solver, which is reused for all the checks, including those of later
+ * calls. Every candidate is guarded by an activation literal. A model of a failed check is a counterexample to
+ * induction, and all the candidates it falsifies are dropped at once. The candidates of a call are removed from the
+ * solver when the call returns, and their activation literals are reused by later calls.
+ */
+class Houdini {
+    Logic & logic;
+    PTRef context;
+    SMTSolver solverWrapper;
+    vec<PTRef> activationLiterals;
+
+    PTRef activationLiteral(std::size_t index);
+
+public:
+    struct Candidate {
+        PTRef premise;
+        PTRef conclusion;
+    };
+
+    Houdini(Logic & logic, PTRef context);
+
+    PTRef getContext() const { return context; }
+
+    /**
+     * @return indices of the candidates that form the largest relatively inductive subset, in increasing order
+     */
+    std::vector<std::size_t> filter(std::vector<Candidate> const & candidates);
+};
+
+#endif // GOLEM_HOUDINI_H
@@ -11,7 +11,9 @@
 #include "TermUtils.h"
 #include "TransformationUtils.h"
 #include "transformers/SingleLoopTransformation.h"
+#include "utils/ResourceGovernor.h"
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
 
 VerificationResult IMC::solve(ChcDirectedGraph const & graph) {
     if (isTrivial(graph)) {
@@ -24,16 +26,20 @@ VerificationResult IMC::solve(ChcDirectedGraph const & graph) {
     auto[ts, backtranslator] = transformation.transform(graph);
     assert(ts);
     auto res = solveTransitionSystemInternal(*ts);
-    return computeWitness ? backtranslator->translate(res) : VerificationResult(res.answer);
+    // The UNKNOWN result carries the safe bound, which needs no witness
+    bool translate = computeWitness or res.answer == VerificationAnswer::UNKNOWN;
+    return translate ? backtranslator->translate(res) : VerificationResult(res.answer);
 }
 
 VerificationResult IMC::solveTransitionSystem(ChcDirectedGraph const & graph) {
     auto ts = toTransitionSystem(graph);
     auto res = solveTransitionSystemInternal(*ts);
-    return computeWitness ? translateTransitionSystemResult(res, graph, *ts) : VerificationResult(res.answer);
+    bool translate = computeWitness or res.answer == VerificationAnswer::UNKNOWN;
+    return translate ? translateTransitionSystemResult(res, graph, *ts) : VerificationResult(res.answer);
 }
 
 TransitionSystemVerificationResult IMC::solveTransitionSystemInternal(TransitionSystem const & system) {
+    ScopedTimer timer("engine.imc");
     std::size_t maxLoopUnrollings = std::numeric_limits<std::size_t>::max();
 
     SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
@@ -42,13 +48,34 @@ TransitionSystemVerificationResult IMC::solveTransitionSystemInternal(Transition
     TimeMachine tm{logic};
     solver.insertFormula(system.getInit());
     solver.insertFormula(system.getQuery());
-    //if I /\ F is Satisfiable, return true
-    if (solver.check() == s_True) {
-        return TransitionSystemVerificationResult{VerificationAnswer::UNSAFE, 0u};
+    std::optional<std::size_t> safeBound;
+    // The finite runs up to the restored bound have been aborted before, the search continues with the next one
+    auto key = checkpoint.makeKey(Checkpoint::keyOf(system));
+    auto restoredBound = checkpoint.restore(key);
+    if (restoredBound and verbosity > 0) {
+        std::cout << "; IMC: Resuming from unrolling " << *restoredBound + 1 << std::endl;
     }
-    for (uint32_t k = 1; k < maxLoopUnrollings; ++k) {
-        auto res = finiteRun(system, k);
-        if (res.answer != VerificationAnswer::UNKNOWN) { return res; }
+    try {
+        if (restoredBound) {
+            safeBound = restoredBound;
+        } else {
+            //if I /\ F is Satisfiable, return true
+            if (SMTSolver::check(solver) == s_True) {
+                return TransitionSystemVerificationResult{VerificationAnswer::UNSAFE, 0u};
+            }
+            safeBound = 0;
+        }
+        for (std::size_t k = *safeBound + 1; k < maxLoopUnrollings; ++k) {
+            ResourceGovernor::checkpoint();
+            Statistics::increment("imc.unrollings");
+            auto res = finiteRun(system, static_cast<unsigned>(k));
+            if (res.answer != VerificationAnswer::UNKNOWN) { return res; }
+            // The first query of the finite run rules out the counterexamples of length k
+            safeBound = k;
+            checkpoint.save(key, k);
+        }
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u, safeBound, limit.what()};
     }
     return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u};
 }
@@ -84,7 +111,7 @@ TransitionSystemVerificationResult IMC::finiteRun(TransitionSystem const & ts, u
         }
         solver.insertFormula(B);
         // Run SAT on A U B.
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         // if A U B is satisfiable
         if (res == s_True) {
             if (movingInit == ts.getInit()) {
@@ -122,7 +149,7 @@ sstat IMC::checkItp(PTRef itp, PTRef itpsOld) {
     SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
     PTRef cmp = logic.mkAnd(itp, logic.mkNot(itpsOld));
     solverWrapper.getCoreSolver().insertFormula(cmp);
-    return solverWrapper.getCoreSolver().check();
+    return solverWrapper.check();
 }
 
 /**
@@ -142,7 +169,7 @@ PTRef IMC::computeFinalInductiveInvariant(PTRef inductiveInvariant, unsigned k,
     auto & solver = solverWrapper.getCoreSolver();
     solver.insertFormula(inductiveInvariant);
     solver.insertFormula(ts.getQuery());
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res == s_False) { return inductiveInvariant; }
     // Otherwise compute safe inductive invariant from k-inductive invariant
     PTRef kinductive = logic.mkAnd(inductiveInvariant, logic.mkNot(ts.getQuery()));
@@ -8,6 +8,7 @@
 #ifndef GOLEM_IMC_H
 #define GOLEM_IMC_H
 
+#include "Checkpoint.h"
 #include "Engine.h"
 #include "TransitionSystem.h"
 
@@ -16,9 +17,10 @@ class IMC : public Engine {
 //    Options const & options;
     int verbosity = 0;
     bool computeWitness = false;
+    Checkpoint checkpoint;
 
 public:
-    IMC(Logic & logic, Options const & options) : logic(logic) {
+    IMC(Logic & logic, Options const & options) : logic(logic), checkpoint(logic, options, "imc") {
         if (options.hasOption(Options::VERBOSE)) {
             verbosity = std::stoi(options.getOption(Options::VERBOSE));
         }
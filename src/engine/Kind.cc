@@ -7,11 +7,17 @@
 #include "Kind.h"
 
 #include "Common.h"
+#include "Houdini.h"
 #include "QuantifierElimination.h"
 #include "TermUtils.h"
 #include "transformers/BasicTransformationPipelines.h"
 #include "TransformationUtils.h"
+#include "utils/ResourceGovernor.h"
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
+
+#include <algorithm>
+#include <unordered_set>
 
 VerificationResult Kind::solve(ChcDirectedHyperGraph const & graph) {
     auto pipeline = Transformations::towardsTransitionSystems();
@@ -43,6 +49,7 @@ VerificationResult Kind::solveTransitionSystem(ChcDirectedGraph const & graph) {
 }
 
 TransitionSystemVerificationResult Kind::solveTransitionSystemInternal(TransitionSystem const & system) {
+    ScopedTimer timer("engine.kind");
     std::size_t maxK = std::numeric_limits<std::size_t>::max();
     PTRef init = system.getInit();
     PTRef query = system.getQuery();
@@ -61,80 +68,168 @@ TransitionSystemVerificationResult Kind::solveTransitionSystemInternal(Transitio
 
     PTRef negQuery = logic.mkNot(query);
     PTRef negInit = logic.mkNot(init);
+    // Invariant lemmas strengthen the forward induction step, they hold in every state of the unrolling
+    PTRef lemmas = logic.getTerm_true();
     // starting point
     solverBase.getCoreSolver().insertFormula(init);
     solverStepBackward.getCoreSolver().insertFormula(init);
     solverStepForward.getCoreSolver().insertFormula(query);
-    { // Check for system with empty initial states
-        auto res = solverBase.getCoreSolver().check();
-        if (res == s_False) {
-            return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_false()};
-        }
+    std::optional<std::size_t> safeBound;
+    /*
+     * The base case holds up to the restored bound and the induction steps have failed below it, so the checks are
+     * skipped there; only the formulas are unrolled. The induction steps for the restored bound itself may not have
+     * been checked before the checkpoint was written.
+     */
+    auto key = checkpoint.makeKey(Checkpoint::keyOf(system));
+    auto restoredBound = checkpoint.restore(key);
+    if (restoredBound and verbosity > 0) {
+        std::cout << "; KIND: Resuming from depth " << *restoredBound << std::endl;
     }
-
-    TimeMachine tm{logic};
-    for (std::size_t k = 0; k < maxK; ++k) {
-        PTRef versionedQuery = tm.sendFlaThroughTime(query, k);
-        // Base case
-        solverBase.getCoreSolver().push();
-        solverBase.getCoreSolver().insertFormula(versionedQuery);
-        auto res = solverBase.getCoreSolver().check();
-        if (res == s_True) {
-            if (verbosity > 0) {
-                 std::cout << "; KIND: Bug found in depth: " << k << std::endl;
-            }
-            if (computeWitness) {
-                return TransitionSystemVerificationResult{VerificationAnswer::UNSAFE, k};
-            } else {
-                return TransitionSystemVerificationResult{VerificationAnswer::UNSAFE, 0u};
+    try {
+        { // Check for system with empty initial states
+            auto res = solverBase.check();
+            if (res == s_False) {
+                return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_false()};
             }
         }
-        if (verbosity > 1) {
-            std::cout << "; KIND: No path of length " << k << " found!" << std::endl;
-        }
-        solverBase.getCoreSolver().pop();
-        PTRef versionedTransition = tm.sendFlaThroughTime(transition, k);
+        lemmas = inductiveLemmas(system);
+        solverStepForward.getCoreSolver().insertFormula(lemmas);
+
+        TimeMachine tm{logic};
+        for (std::size_t k = 0; k < maxK; ++k) {
+            ResourceGovernor::checkpoint();
+            Statistics::increment("kind.iterations");
+            bool knownSafe = restoredBound and k <= *restoredBound;
+            if (not knownSafe) {
+                PTRef versionedQuery = tm.sendFlaThroughTime(query, k);
+                // Base case
+                solverBase.getCoreSolver().push();
+                solverBase.getCoreSolver().insertFormula(versionedQuery);
+                auto res = solverBase.check();
+                if (res == s_True) {
+                    if (verbosity > 0) {
+                         std::cout << "; KIND: Bug found in depth: " << k << std::endl;
+                    }
+                    if (computeWitness) {
+                        return TransitionSystemVerificationResult{VerificationAnswer::UNSAFE, k};
+                    } else {
+                        return TransitionSystemVerificationResult{VerificationAnswer::UNSAFE, 0u};
+                    }
+                }
+                if (verbosity > 1) {
+                    std::cout << "; KIND: No path of length " << k << " found!" << std::endl;
+                }
+                solverBase.getCoreSolver().pop();
+                checkpoint.save(key, k);
+            }
+            safeBound = k;
+            PTRef versionedTransition = tm.sendFlaThroughTime(transition, k);
 //        std::cout << "Adding transition: " << logic.pp(versionedTransition) << std::endl;
-        solverBase.getCoreSolver().insertFormula(versionedTransition);
+            solverBase.getCoreSolver().insertFormula(versionedTransition);
 
-        // step forward
-        res = solverStepForward.getCoreSolver().check();
-        if (res == s_False) {
-            if (verbosity > 0) {
-                std::cout << "; KIND: Found invariant with forward induction, which is " << k << "-inductive" << std::endl;
+            bool knownNotInductive = restoredBound and k < *restoredBound;
+            // step forward
+            auto res = knownNotInductive ? s_True : solverStepForward.check();
+            if (res == s_False) {
+                if (verbosity > 0) {
+                    std::cout << "; KIND: Found invariant with forward induction, which is " << k << "-inductive" << std::endl;
+                }
+                if (computeWitness) {
+                    return TransitionSystemVerificationResult{VerificationAnswer::SAFE, invariantFromForwardInduction(system, k, lemmas)};
+                } else {
+                    return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_true()};
+                }
             }
-            if (computeWitness) {
-                return TransitionSystemVerificationResult{VerificationAnswer::SAFE, invariantFromForwardInduction(system, k)};
-            } else {
-                return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_true()};
+            PTRef versionedBackwardTransition = tm.sendFlaThroughTime(backwardTransition, k);
+            solverStepForward.getCoreSolver().push();
+            solverStepForward.getCoreSolver().insertFormula(versionedBackwardTransition);
+            solverStepForward.getCoreSolver().insertFormula(tm.sendFlaThroughTime(negQuery,k+1));
+            solverStepForward.getCoreSolver().insertFormula(tm.sendFlaThroughTime(lemmas, k + 1));
+
+            // step backward
+            res = knownNotInductive ? s_True : solverStepBackward.check();
+            if (res == s_False) {
+                if (verbosity > 0) {
+                    std::cout << "; KIND: Found invariant with backward induction, which is " << k << "-inductive" << std::endl;
+                }
+                if (computeWitness) {
+                    return TransitionSystemVerificationResult{VerificationAnswer::SAFE, invariantFromBackwardInduction(system, k)};
+                } else {
+                    return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_true()};
+                }
             }
+            solverStepBackward.getCoreSolver().push();
+            solverStepBackward.getCoreSolver().insertFormula(versionedTransition);
+            solverStepBackward.getCoreSolver().insertFormula(tm.sendFlaThroughTime(negInit, k+1));
         }
-        PTRef versionedBackwardTransition = tm.sendFlaThroughTime(backwardTransition, k);
-        solverStepForward.getCoreSolver().push();
-        solverStepForward.getCoreSolver().insertFormula(versionedBackwardTransition);
-        solverStepForward.getCoreSolver().insertFormula(tm.sendFlaThroughTime(negQuery,k+1));
-
-        // step backward
-        res = solverStepBackward.getCoreSolver().check();
-        if (res == s_False) {
-            if (verbosity > 0) {
-                std::cout << "; KIND: Found invariant with backward induction, which is " << k << "-inductive" << std::endl;
-            }
-            if (computeWitness) {
-                return TransitionSystemVerificationResult{VerificationAnswer::SAFE, invariantFromBackwardInduction(system, k)};
-            } else {
-                return TransitionSystemVerificationResult{VerificationAnswer::SAFE, logic.getTerm_true()};
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u, safeBound, limit.what()};
+    }
+    return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u};
+}
+
+/*
+ * Candidate lemmas are the inequalities of the initial and the bad states (equalities are split in two inequalities).
+ * The lemmas are those candidates that hold in the initial states and form the largest inductive subset (Houdini).
+ */
+PTRef Kind::inductiveLemmas(TransitionSystem const & system) const {
+    auto * arithLogic = dynamic_cast<ArithLogic *>(&logic);
+    if (not arithLogic) { return logic.getTerm_true(); }
+    auto stateVars = system.getStateVars();
+    std::unordered_set<PTRef, PTRefHash> allowed(stateVars.begin(), stateVars.end());
+    TermUtils utils(logic);
+    std::vector<PTRef> candidates;
+    auto addCandidate = [&](PTRef atom) {
+        if (std::find(candidates.begin(), candidates.end(), atom) == candidates.end()) { candidates.push_back(atom); }
+    };
+    std::unordered_set<PTRef, PTRefHash> seen;
+    std::vector<PTRef> queue{system.getInit(), system.getQuery()};
+    while (not queue.empty()) {
+        PTRef term = queue.back();
+        queue.pop_back();
+        if (not seen.insert(term).second) { continue; }
+        if (logic.isAnd(term) or logic.isOr(term) or logic.isNot(term)) {
+            for (PTRef arg : logic.getPterm(term)) {
+                queue.push_back(arg);
             }
+            continue;
+        }
+        if (not arithLogic->isLeq(term) and not arithLogic->isNumEq(term)) { continue; }
+        auto vars = utils.getVars(term);
+        bool onlyState = std::all_of(vars.begin(), vars.end(), [&](PTRef var) { return allowed.count(var) > 0; });
+        if (vars.size() == 0 or not onlyState) { continue; }
+        if (arithLogic->isNumEq(term)) {
+            PTRef lhs = logic.getPterm(term)[0];
+            PTRef rhs = logic.getPterm(term)[1];
+            addCandidate(arithLogic->mkLeq(lhs, rhs));
+            addCandidate(arithLogic->mkGeq(lhs, rhs));
+        } else {
+            addCandidate(term);
         }
-        solverStepBackward.getCoreSolver().push();
-        solverStepBackward.getCoreSolver().insertFormula(versionedTransition);
-        solverStepBackward.getCoreSolver().insertFormula(tm.sendFlaThroughTime(negInit, k+1));
     }
-    return TransitionSystemVerificationResult{VerificationAnswer::UNKNOWN, 0u};
+    if (candidates.empty()) { return logic.getTerm_true(); }
+
+    std::vector<Houdini::Candidate> initial;
+    for (PTRef candidate : candidates) {
+        initial.push_back({logic.getTerm_true(), candidate});
+    }
+    std::vector<Houdini::Candidate> inductive;
+    TimeMachine tm{logic};
+    for (auto index : Houdini(logic, system.getInit()).filter(initial)) {
+        inductive.push_back({candidates[index], tm.sendFlaThroughTime(candidates[index], 1)});
+    }
+    vec<PTRef> lemmas;
+    for (auto index : Houdini(logic, system.getTransition()).filter(inductive)) {
+        lemmas.push(inductive[index].premise);
+    }
+    Statistics::increment("kind.lemmas", lemmas.size());
+    return logic.mkAnd(std::move(lemmas));
 }
 
-PTRef Kind::invariantFromForwardInduction(TransitionSystem const & transitionSystem, unsigned long k) const {
-    PTRef kinductiveInvariant = logic.mkNot(transitionSystem.getQuery());
+PTRef Kind::invariantFromForwardInduction(TransitionSystem const & transitionSystem, unsigned long k,
+                                          PTRef lemmas) const {
+    // The lemmas are inductive, so together with them the negated query stays k-inductive
+    PTRef kinductiveInvariant = logic.mkAnd(lemmas, logic.mkNot(transitionSystem.getQuery()));
     PTRef inductiveInvariant = kinductiveToInductive(kinductiveInvariant, k, transitionSystem);
     return inductiveInvariant;
 }
@@ -9,6 +9,7 @@
 
 
 
+#include "Checkpoint.h"
 #include "Engine.h"
 #include "TransitionSystem.h"
 
@@ -17,9 +18,10 @@ class Kind : public Engine {
 //    Options const & options;
     int verbosity {0};
     bool computeWitness {false};
+    Checkpoint checkpoint;
 public:
 
-    Kind(Logic & logic, Options const & options) : logic(logic) {
+    Kind(Logic & logic, Options const & options) : logic(logic), checkpoint(logic, options, "kind") {
         if (options.hasOption(Options::VERBOSE)) {
             verbosity = std::stoi(options.getOption(Options::VERBOSE));
         }
@@ -36,7 +38,9 @@ private:
     VerificationResult solveTransitionSystem(ChcDirectedGraph const & graph);
     TransitionSystemVerificationResult solveTransitionSystemInternal(TransitionSystem const & system);
 
-    PTRef invariantFromForwardInduction(TransitionSystem const & transitionSystem, unsigned long k) const;
+    PTRef inductiveLemmas(TransitionSystem const & system) const;
+    PTRef invariantFromForwardInduction(TransitionSystem const & transitionSystem, unsigned long k,
+                                        PTRef lemmas) const;
     PTRef invariantFromBackwardInduction(TransitionSystem const & transitionSystem, unsigned long k) const;
 
 };
@@ -6,7 +6,9 @@
 
 #include "Lawi.h"
 
+#include "Common.h"
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
 
 #include <functional>
 #include <optional>
@@ -211,7 +213,7 @@ public:
         PTRef negImpl = logic.mkAnd(antecedent, logic.mkNot(consequent)); // not(A->B) iff A and (not B)
 //        std::cout << logic.printTerm(negImpl) << std::endl;
         solver.insertFormula(negImpl);
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_True) {
             cache.insert({pair, QueryResult::INVALID});
             return QueryResult::INVALID;
@@ -254,7 +256,7 @@ public:
         PTRef negImpl = logic.mkAnd(antecedent, logic.mkNot(consequent)); // not(A->B) iff A and (not B)
 //        std::cout << logic.printTerm(negImpl) << std::endl;
         solver.insertFormula(negImpl);
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_True) {
             cache.insert({pair, QueryResult::INVALID});
             antecedentModels.push_back(solver.getModel());
@@ -389,9 +391,12 @@ void LawiContext::close(VId vertex) {
 
 // Main method
 VerificationResult LawiContext::unwind() {
+    ScopedTimer timer("engine.lawi");
     bool computeWitness = options.hasOption(Options::COMPUTE_WITNESS);
     auto optionalVertex = getUncoveredLeaf();
     while (optionalVertex.has_value()) {
+        ResourceGovernor::checkpoint();
+        Statistics::increment("lawi.iterations");
         auto uncoveredVertex = optionalVertex.value();
         closeAllAncestors(uncoveredVertex);
         auto res = DFS(uncoveredVertex);
@@ -497,7 +502,7 @@ void LawiContext::applyForcedCovering(VId vertex) {
         solver.insertFormula(logic.mkNot(labelToTest));
 //        PTRef fla = logic.mkAnd({labels.getLabel(nca), logic.mkAnd(edgeFormulas), logic.mkNot(labelToTest)});
 //        std::cout << logic.printTerm(fla) << std::endl;
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_False) {
             // this vertex is covered by the candidate
             // compute interpolants, strenthen the labels
@@ -544,7 +549,7 @@ LawiContext::RefinementResult LawiContext::refine(VId errVertex) {
 //    	std::cout << logic.printTerm(segment) << std::endl;
         solver.insertFormula(segment);
     }
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res == s_True) {
         errorPath = buildGraphPathFromTreePath(path);
         return RefinementResult{VerificationAnswer::UNSAFE, {}};
@@ -862,5 +867,10 @@ VerificationResult Lawi::solve(ChcDirectedHyperGraph const & graph) {
 
 VerificationResult Lawi::solve(ChcDirectedGraph const & graph) {
     LawiContext ctx(logic, graph, options);
-    return ctx.unwind();
+    try {
+        return ctx.unwind();
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        // The abstract reachability tree has no meaningful bound that could be reported
+        return limitReachedResult(limit);
+    }
 }
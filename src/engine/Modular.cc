@@ -0,0 +1,518 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Modular.h"
+
+#include "Houdini.h"
+#include "TermUtils.h"
+#include "utils/Statistics.h"
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+
+namespace {
+constexpr std::size_t noComponent = std::numeric_limits<std::size_t>::max();
+
+using Interpretations = std::unordered_map<SymRef, PTRef, SymRefHash>;
+
+/*
+ * Predicates in the order of their first occurrence in the edges of the graph; used for deterministic traversals.
+ */
+std::vector<SymRef> predicatesInOrder(ChcDirectedHyperGraph const & graph) {
+    std::vector<SymRef> result;
+    std::unordered_set<SymRef, SymRefHash> seen;
+    auto add = [&](SymRef sym) {
+        if (sym == graph.getEntry() or sym == graph.getExit()) { return; }
+        if (seen.insert(sym).second) { result.push_back(sym); }
+    };
+    graph.forEachEdge([&](DirectedHyperEdge const & edge) {
+        for (SymRef source : edge.from) {
+            add(source);
+        }
+        add(edge.to);
+    });
+    return result;
+}
+
+/*
+ * Copies the given edges into the target logic, together with the representation of the predicates they use.
+ * The identifiers of the edges are preserved.
+ */
+std::unique_ptr<ChcDirectedHyperGraph> exportEdges(std::vector<DirectedHyperEdge> const & edges,
+                                                   ChcDirectedHyperGraph const & graph, ArithLogic & target) {
+    auto & logic = dynamic_cast<ArithLogic &>(graph.getLogic());
+    std::unordered_map<SymRef, std::vector<PTRef> const *, SymRefHash> variables;
+    graph.predicateRepresentation().forEachRepresentation(
+        [&](SymRef sym, std::vector<PTRef> const & vars) { variables.insert({sym, &vars}); });
+
+    TermImporter importer(logic, target);
+    NonlinearCanonicalPredicateRepresentation representation(target);
+    representation.addRepresentation(target.getSym_true(), {});
+    representation.addRepresentation(target.getSym_false(), {});
+    auto importPredicate = [&](SymRef sym) {
+        SymRef imported = importer.importSymbol(sym);
+        if (not representation.hasRepresentationFor(imported)) {
+            std::vector<PTRef> vars;
+            for (PTRef var : *variables.at(sym)) {
+                vars.push_back(importer.import(var));
+            }
+            representation.addRepresentation(imported, std::move(vars));
+        }
+        return imported;
+    };
+    std::vector<DirectedHyperEdge> exported;
+    exported.reserve(edges.size());
+    for (auto const & edge : edges) {
+        std::vector<SymRef> from;
+        for (SymRef source : edge.from) {
+            from.push_back(importPredicate(source));
+        }
+        SymRef to = importPredicate(edge.to);
+        exported.push_back(DirectedHyperEdge{.from = std::move(from), .to = to,
+                                             .fla = InterpretedFla{importer.import(edge.fla.fla)}, .id = edge.id});
+    }
+    return ChcDirectedHyperGraph::withEdgeIds(exported, std::move(representation), target);
+}
+
+InvalidityWitness importInvalidityWitness(InvalidityWitness const & witness, ArithLogic & source, ArithLogic & target) {
+    TermImporter importer(source, target);
+    InvalidityWitness::Derivation derivation;
+    for (auto step : witness.getDerivation()) {
+        step.derivedFact = importer.import(step.derivedFact);
+        derivation.addDerivationStep(std::move(step));
+    }
+    InvalidityWitness result;
+    result.setDerivation(std::move(derivation));
+    return result;
+}
+
+/*
+ * Imports the definitions of the predicates and conjoins them with the interpretations computed so far.
+ */
+void addInterpretations(ValidityWitness const & witness, ArithLogic & source, ChcDirectedHyperGraph const & graph,
+                        Interpretations & interpretations) {
+    auto & logic = dynamic_cast<ArithLogic &>(graph.getLogic());
+    TermImporter importer(source, logic);
+    TermUtils utils(logic);
+    // Iterate in a fixed order to keep the shape of the resulting terms deterministic
+    std::vector<std::pair<PTRef, PTRef>> definitions;
+    witness.run([&](auto const & entry) {
+        PTRef predicate = importer.import(entry.first);
+        SymRef sym = logic.getSymRef(predicate);
+        if (sym == graph.getEntry() or sym == graph.getExit()) { return; }
+        definitions.emplace_back(predicate, importer.import(entry.second));
+    });
+    std::sort(definitions.begin(), definitions.end(),
+              [](auto const & first, auto const & second) { return first.first.x < second.first.x; });
+    for (auto [predicate, definition] : definitions) {
+        SymRef sym = logic.getSymRef(predicate);
+        PTRef canonical = graph.getStateVersion(sym);
+        if (predicate != canonical) {
+            TermUtils::substitutions_map subst;
+            utils.mapFromPredicate(predicate, canonical, subst);
+            definition = utils.varSubstitute(definition, subst);
+        }
+        auto it = interpretations.find(sym);
+        if (it == interpretations.end()) {
+            interpretations.insert({sym, definition});
+        } else {
+            it->second = logic.mkAnd(it->second, definition);
+        }
+    }
+}
+
+/*
+ * Over-approximates the states reachable in a component without queries, where an engine has no property to prove
+ * and cannot compute anything stronger than true. The candidates are the bounds from the atoms of the incoming edges
+ * that constrain only the variables of the target; the largest subset that is inductive for the edges of the
+ * component is kept (Houdini). Sources from other components must already be replaced by their summaries.
+ */
+void overApproximate(std::vector<DirectedHyperEdge> const & edges, ChcDirectedHyperGraph const & graph,
+                     Interpretations & interpretations) {
+    auto & logic = dynamic_cast<ArithLogic &>(graph.getLogic());
+    TermUtils utils(logic);
+    std::unordered_map<SymRef, std::vector<PTRef>, SymRefHash> candidates;
+    std::vector<SymRef> predicates; // In the order of their first incoming edge, for determinism
+    for (auto const & edge : edges) {
+        PTRef target = graph.getNextStateVersion(edge.to);
+        auto targetVars = utils.predicateArgsInOrder(target);
+        std::unordered_set<PTRef, PTRefHash> allowed(targetVars.begin(), targetVars.end());
+        TermUtils::substitutions_map toState;
+        utils.mapFromPredicate(target, graph.getStateVersion(edge.to), toState);
+        if (candidates.count(edge.to) == 0) { predicates.push_back(edge.to); }
+        auto & lemmas = candidates[edge.to];
+        auto addCandidate = [&](PTRef atom) {
+            PTRef lemma = utils.varSubstitute(atom, toState);
+            if (std::find(lemmas.begin(), lemmas.end(), lemma) == lemmas.end()) { lemmas.push_back(lemma); }
+        };
+        std::unordered_set<PTRef, PTRefHash> seen;
+        std::vector<PTRef> queue{edge.fla.fla};
+        while (not queue.empty()) {
+            PTRef term = queue.back();
+            queue.pop_back();
+            if (not seen.insert(term).second) { continue; }
+            if (logic.isAnd(term) or logic.isOr(term) or logic.isNot(term)) {
+                for (PTRef arg : logic.getPterm(term)) {
+                    queue.push_back(arg);
+                }
+                continue;
+            }
+            if (not logic.isLeq(term) and not logic.isNumEq(term)) { continue; }
+            auto vars = utils.getVars(term);
+            bool onlyTarget = std::all_of(vars.begin(), vars.end(), [&](PTRef var) { return allowed.count(var) > 0; });
+            if (vars.size() == 0 or not onlyTarget) { continue; }
+            if (logic.isNumEq(term)) {
+                PTRef lhs = logic.getPterm(term)[0];
+                PTRef rhs = logic.getPterm(term)[1];
+                addCandidate(logic.mkLeq(lhs, rhs));
+                addCandidate(logic.mkGeq(lhs, rhs));
+            } else {
+                addCandidate(term);
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto const & edge : edges) {
+            auto & lemmas = candidates.at(edge.to);
+            if (lemmas.empty()) { continue; }
+            vec<PTRef> context;
+            context.push(edge.fla.fla);
+            std::unordered_map<SymRef, unsigned, SymRefHash> instanceCounts;
+            for (SymRef source : edge.from) {
+                if (source == graph.getEntry()) { continue; }
+                unsigned instance = instanceCounts[source]++;
+                // A predicate without incoming edges has no reachable states, but assuming nothing is also sound
+                auto it = candidates.find(source);
+                if (it == candidates.end()) { continue; }
+                TermUtils::substitutions_map subst;
+                utils.mapFromPredicate(graph.getStateVersion(source), graph.getStateVersion(source, instance), subst);
+                for (PTRef lemma : it->second) {
+                    context.push(utils.varSubstitute(lemma, subst));
+                }
+            }
+            TermUtils::substitutions_map toNext;
+            utils.mapFromPredicate(graph.getStateVersion(edge.to), graph.getNextStateVersion(edge.to), toNext);
+            std::vector<Houdini::Candidate> houdiniCandidates;
+            for (PTRef lemma : lemmas) {
+                houdiniCandidates.push_back({logic.getTerm_true(), utils.varSubstitute(lemma, toNext)});
+            }
+            auto kept = Houdini(logic, logic.mkAnd(std::move(context))).filter(houdiniCandidates);
+            if (kept.size() == lemmas.size()) { continue; }
+            std::vector<PTRef> remaining;
+            for (auto i : kept) {
+                remaining.push_back(lemmas[i]);
+            }
+            lemmas = std::move(remaining);
+            changed = true;
+        }
+    }
+
+    for (SymRef sym : predicates) {
+        auto const & lemmas = candidates.at(sym);
+        if (lemmas.empty()) { continue; }
+        vec<PTRef> conjuncts;
+        for (PTRef lemma : lemmas) {
+            conjuncts.push(lemma);
+        }
+        PTRef summary = logic.mkAnd(std::move(conjuncts));
+        auto it = interpretations.find(sym);
+        if (it == interpretations.end()) {
+            interpretations.insert({sym, summary});
+        } else {
+            it->second = logic.mkAnd(it->second, summary);
+        }
+    }
+}
+} // namespace
+
+ModularEngine::ModularEngine(Logic & logic, Options const & options, EngineFactory factory)
+    : logic(logic), innerOptions(options), factory(std::move(factory)) {
+    // Summaries of the components are obtained from the witnesses of the subproblems
+    innerOptions.addOption(Options::COMPUTE_WITNESS, "true");
+    if (options.hasOption(Options::THREADS)) { threads = std::stoul(options.getOption(Options::THREADS)); }
+    if (options.hasOption(Options::COMPUTE_WITNESS)) {
+        computeWitness = options.getOption(Options::COMPUTE_WITNESS) == "true";
+    }
+}
+
+/*
+ * Iterative version of Tarjan's algorithm; the components are discovered in reverse topological order.
+ */
+std::vector<std::vector<SymRef>> ModularEngine::stronglyConnectedComponents(ChcDirectedHyperGraph const & graph) {
+    auto adjacencyLists = AdjacencyListsGraphRepresentation::from(graph);
+    auto successors = [&](SymRef sym) {
+        std::vector<SymRef> result;
+        for (EId eid : adjacencyLists.getOutgoingEdgesFor(sym)) {
+            SymRef target = graph.getTarget(eid);
+            if (target != graph.getExit()) { result.push_back(target); }
+        }
+        return result;
+    };
+
+    struct NodeInfo {
+        std::size_t index;
+        std::size_t lowLink;
+        bool onStack;
+    };
+    std::unordered_map<SymRef, NodeInfo, SymRefHash> info;
+    std::vector<SymRef> stack;
+    struct Frame {
+        SymRef node;
+        std::vector<SymRef> successors;
+        std::size_t next;
+    };
+    std::vector<Frame> frames;
+    std::vector<std::vector<SymRef>> components;
+    std::size_t counter = 0;
+
+    auto visit = [&](SymRef node) {
+        info.insert({node, NodeInfo{counter, counter, true}});
+        ++counter;
+        stack.push_back(node);
+        frames.push_back(Frame{node, successors(node), 0});
+    };
+
+    for (SymRef root : predicatesInOrder(graph)) {
+        if (info.count(root) > 0) { continue; }
+        visit(root);
+        while (not frames.empty()) {
+            auto & frame = frames.back();
+            if (frame.next < frame.successors.size()) {
+                SymRef next = frame.successors[frame.next++];
+                auto it = info.find(next);
+                if (it == info.end()) {
+                    visit(next); // Invalidates the reference to the frame
+                } else if (it->second.onStack) {
+                    auto & nodeInfo = info.at(frame.node);
+                    nodeInfo.lowLink = std::min(nodeInfo.lowLink, it->second.index);
+                }
+                continue;
+            }
+            SymRef node = frame.node;
+            frames.pop_back();
+            auto const & nodeInfo = info.at(node);
+            if (nodeInfo.lowLink == nodeInfo.index) {
+                std::vector<SymRef> component;
+                SymRef member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    info.at(member).onStack = false;
+                    component.push_back(member);
+                } while (member != node);
+                components.push_back(std::move(component));
+            }
+            if (not frames.empty()) {
+                auto & parentInfo = info.at(frames.back().node);
+                parentInfo.lowLink = std::min(parentInfo.lowLink, nodeInfo.lowLink);
+            }
+        }
+    }
+    std::reverse(components.begin(), components.end());
+    return components;
+}
+
+VerificationResult ModularEngine::solve(ChcDirectedHyperGraph const & graph) {
+    ScopedTimer timer("engine.modular");
+    auto * arithLogic = dynamic_cast<ArithLogic *>(&logic);
+    auto components = stronglyConnectedComponents(graph);
+    Statistics::recordValue("modular.components", components.size());
+    auto solveMonolithic = [&]() { return factory(logic, innerOptions)->solve(graph); };
+    if (not arithLogic or components.size() < 2) { return solveMonolithic(); }
+
+    std::unordered_map<SymRef, std::size_t, SymRefHash> componentOf;
+    for (std::size_t i = 0; i < components.size(); ++i) {
+        for (SymRef sym : components[i]) {
+            componentOf.insert({sym, i});
+        }
+    }
+    // Every edge belongs to the component of its target; query edges belong to the last component of their sources
+    auto const edges = graph.getEdges();
+    std::vector<std::vector<std::size_t>> ownedEdges(components.size());
+    std::vector<bool> hasQuery(components.size(), false);
+    std::vector<std::vector<std::size_t>> dependencies(components.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        auto const & edge = edges[i];
+        std::size_t owner = noComponent;
+        if (edge.to != graph.getExit()) {
+            owner = componentOf.at(edge.to);
+        } else {
+            for (SymRef source : edge.from) {
+                if (source == graph.getEntry()) { continue; }
+                auto component = componentOf.at(source);
+                owner = owner == noComponent ? component : std::max(owner, component);
+            }
+            // Edge from entry to exit; nothing to decompose
+            if (owner == noComponent) { return solveMonolithic(); }
+            hasQuery[owner] = true;
+        }
+        ownedEdges[owner].push_back(i);
+        for (SymRef source : edge.from) {
+            if (source == graph.getEntry()) { continue; }
+            auto component = componentOf.at(source);
+            if (component != owner) { dependencies[owner].push_back(component); }
+        }
+    }
+    // Components on the same level do not depend on each other
+    std::vector<std::size_t> levelOf(components.size(), 0);
+    std::size_t levelCount = 0;
+    for (std::size_t i = 0; i < components.size(); ++i) {
+        for (auto dependency : dependencies[i]) {
+            assert(dependency < i);
+            levelOf[i] = std::max(levelOf[i], levelOf[dependency] + 1);
+        }
+        levelCount = std::max(levelCount, levelOf[i] + 1);
+    }
+
+    auto const logicType = arithLogic->hasReals() ? opensmt::Logic_t::QF_LRA : opensmt::Logic_t::QF_LIA;
+    struct Subproblem {
+        std::size_t component;
+        std::vector<DirectedHyperEdge> edges;
+        bool usesSummaries;
+    };
+    struct Solved {
+        std::unique_ptr<ArithLogic> privateLogic;
+        VerificationResult result;
+    };
+    // Each subproblem is solved in its own private logic; the results are processed in the order of the subproblems
+    auto solveAll = [&](std::vector<Subproblem> const & subproblems, auto process) {
+        auto prepare = [&](std::size_t index) {
+            struct Private {
+                std::unique_ptr<ArithLogic> logic;
+                std::unique_ptr<ChcDirectedHyperGraph> subgraph; // Destroyed before its logic
+            } isolated;
+            isolated.logic = std::make_unique<ArithLogic>(logicType);
+            isolated.subgraph = exportEdges(subproblems[index].edges, graph, *isolated.logic);
+            return [this, isolated = std::move(isolated)]() mutable {
+                auto result = factory(*isolated.logic, innerOptions)->solve(*isolated.subgraph);
+                isolated.subgraph.reset();
+                return Solved{std::move(isolated.logic), std::move(result)};
+            };
+        };
+        parallelMap(subproblems.size(), threads, prepare, [&](std::size_t index, Solved && solved) {
+            process(subproblems[index], solved);
+        });
+    };
+    auto unsafe = [&](Solved & solved) -> VerificationResult {
+        auto & result = solved.result;
+        if (not computeWitness or not result.hasWitness()) { return VerificationResult(VerificationAnswer::UNSAFE); }
+        auto witness = importInvalidityWitness(result.getInvalidityWitness(), *solved.privateLogic, *arithLogic);
+        return VerificationResult(VerificationAnswer::UNSAFE, std::move(witness));
+    };
+
+    // First pass: components in topological order, predecessors replaced by their summaries
+    Interpretations interpretations;
+    std::vector<std::size_t> failed;
+    TermUtils utils(logic);
+    for (std::size_t level = 0; level < levelCount; ++level) {
+        std::vector<Subproblem> subproblems;
+        for (std::size_t component = 0; component < components.size(); ++component) {
+            if (levelOf[component] != level) { continue; }
+            std::vector<DirectedHyperEdge> subproblem;
+            bool usesSummaries = false;
+            for (auto index : ownedEdges[component]) {
+                auto const & edge = edges[index];
+                vec<PTRef> constraint;
+                constraint.push(edge.fla.fla);
+                std::vector<SymRef> from;
+                std::unordered_map<SymRef, unsigned, SymRefHash> instanceCounts;
+                for (SymRef source : edge.from) {
+                    unsigned instance = instanceCounts[source]++;
+                    if (source == graph.getEntry() or componentOf.at(source) == component) {
+                        from.push_back(source);
+                        continue;
+                    }
+                    usesSummaries = true;
+                    auto it = interpretations.find(source);
+                    if (it == interpretations.end()) { continue; } // Summary is true
+                    TermUtils::substitutions_map subst;
+                    utils.mapFromPredicate(graph.getStateVersion(source), graph.getStateVersion(source, instance),
+                                           subst);
+                    constraint.push(utils.varSubstitute(it->second, subst));
+                }
+                if (from.empty()) { from.push_back(graph.getEntry()); }
+                subproblem.push_back(DirectedHyperEdge{.from = std::move(from), .to = edge.to,
+                                                       .fla = InterpretedFla{logic.mkAnd(std::move(constraint))},
+                                                       .id = edge.id});
+            }
+            if (hasQuery[component]) {
+                subproblems.push_back(Subproblem{component, std::move(subproblem), usesSummaries});
+            } else {
+                // Components of the same level do not depend on each other, the summary can be added right away
+                Statistics::increment("modular.overapproximated");
+                overApproximate(subproblem, graph, interpretations);
+            }
+        }
+        std::optional<VerificationResult> conclusive;
+        solveAll(subproblems, [&](Subproblem const & subproblem, Solved & solved) {
+            auto & result = solved.result;
+            if (result.getAnswer() == VerificationAnswer::SAFE and result.hasWitness()) {
+                addInterpretations(result.getValidityWitness(), *solved.privateLogic, graph, interpretations);
+            } else if (result.getAnswer() == VerificationAnswer::UNSAFE and not subproblem.usesSummaries and
+                       not conclusive) {
+                conclusive = unsafe(solved);
+            } else {
+                failed.push_back(subproblem.component);
+            }
+        });
+        if (conclusive) { return std::move(conclusive.value()); }
+    }
+
+    // Second pass: each failed component is solved together with all its predecessors, using the original edges
+    std::vector<Subproblem> cones;
+    for (auto component : failed) {
+        std::vector<bool> inCone(components.size(), false);
+        inCone[component] = true;
+        for (std::size_t i = component + 1; i-- > 0;) {
+            if (not inCone[i]) { continue; }
+            for (auto dependency : dependencies[i]) {
+                inCone[dependency] = true;
+            }
+        }
+        std::vector<DirectedHyperEdge> subproblem;
+        for (std::size_t i = 0; i <= component; ++i) {
+            if (not inCone[i]) { continue; }
+            for (auto index : ownedEdges[i]) {
+                // Queries of the predecessors have been handled separately
+                if (i != component and edges[index].to == graph.getExit()) { continue; }
+                subproblem.push_back(edges[index]);
+            }
+        }
+        cones.push_back(Subproblem{component, std::move(subproblem), false});
+    }
+    bool unknown = false;
+    std::optional<VerificationResult> conclusive;
+    solveAll(cones, [&](Subproblem const &, Solved & solved) {
+        auto & result = solved.result;
+        if (result.getAnswer() == VerificationAnswer::SAFE and result.hasWitness()) {
+            addInterpretations(result.getValidityWitness(), *solved.privateLogic, graph, interpretations);
+        } else if (result.getAnswer() == VerificationAnswer::UNSAFE and not conclusive) {
+            conclusive = unsafe(solved);
+        } else {
+            unknown = true;
+        }
+    });
+    if (conclusive) { return std::move(conclusive.value()); }
+    if (unknown) { return VerificationResult(VerificationAnswer::UNKNOWN); }
+
+    if (not computeWitness) { return VerificationResult(VerificationAnswer::SAFE); }
+    // Predicates that were never part of a subproblem are not restricted
+    ValidityWitness::definitions_t definitions;
+    for (auto const & component : components) {
+        for (SymRef sym : component) {
+            auto it = interpretations.find(sym);
+            PTRef interpretation = it == interpretations.end() ? logic.getTerm_true() : it->second;
+            definitions.insert({graph.getStateVersion(sym), interpretation});
+        }
+    }
+    return VerificationResult(VerificationAnswer::SAFE, ValidityWitness(std::move(definitions)));
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_MODULAR_H
+#define GOLEM_MODULAR_H
+
+#include "Engine.h"
+
+#include <functional>
+
+/*
+ * Decomposes the CHC graph into strongly connected components and solves them as separate subproblems.
+ *
+ * The components are processed in topological order, and every component gets a summary that is passed downstream:
+ * The predicates of the preceding components are replaced by their summaries (the interpretations computed for them
+ * so far, or true). A component with query edges is solved by the engine; components that do not depend on each
+ * other are solved in parallel, each in its own private logic. A component without queries has no property to prove,
+ * so its reachable states are over-approximated by inductive bounds instead (see Houdini).
+ *
+ * Summaries over-approximate reachable states, so a safe subproblem is conclusive, but a counterexample that relies
+ * on a summary is not. Such a component is solved again together with all its predecessors, using the original
+ * edges only. The final interpretation of a predicate is the conjunction of all interpretations computed for it,
+ * which is a valid solution of the whole system.
+ */
+class ModularEngine : public Engine {
+public:
+    using EngineFactory = std::function<std::unique_ptr<Engine>(Logic &, Options const &)>;
+
+    ModularEngine(Logic & logic, Options const & options, EngineFactory factory);
+
+    VerificationResult solve(ChcDirectedHyperGraph const & graph) override;
+
+    /*
+     * Strongly connected components of the graph (without entry and exit) in topological order.
+     */
+    static std::vector<std::vector<SymRef>> stronglyConnectedComponents(ChcDirectedHyperGraph const & graph);
+
+private:
+    Logic & logic;
+    Options innerOptions;
+    EngineFactory factory;
+    std::size_t threads{1};
+    bool computeWitness{false};
+};
+
+#endif // GOLEM_MODULAR_H
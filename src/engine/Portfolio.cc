@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Portfolio.h"
+
+#include "Common.h"
+#include "utils/ResourceGovernor.h"
+#include "utils/Statistics.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+// Holds the checkpoints of the engines for the duration of one run
+class TemporaryDirectory {
+    std::string path;
+
+public:
+    TemporaryDirectory() {
+        std::string pattern = (std::filesystem::temp_directory_path() / "golem-portfolio-XXXXXX").string();
+        if (mkdtemp(pattern.data()) != nullptr) { path = std::move(pattern); }
+    }
+    ~TemporaryDirectory() {
+        std::error_code ignored;
+        if (not path.empty()) { std::filesystem::remove_all(path, ignored); }
+    }
+    TemporaryDirectory(TemporaryDirectory const &) = delete;
+    TemporaryDirectory & operator=(TemporaryDirectory const &) = delete;
+
+    std::string const & getPath() const { return path; }
+};
+} // namespace
+
+SequentialPortfolio::SequentialPortfolio(Logic & logic, Options const & options, std::vector<std::string> engines,
+                                         EngineFactory factory)
+    : logic(logic), options(options), engines(std::move(engines)), factory(std::move(factory)) {
+    if (options.hasOption(Options::VERBOSE)) { verbosity = std::stoi(options.getOption(Options::VERBOSE)); }
+    if (options.hasOption(Options::PORTFOLIO_SLICE)) {
+        double seconds = std::stod(options.getOption(Options::PORTFOLIO_SLICE));
+        if (not(seconds > 0)) { throw std::logic_error("The time slice of the portfolio must be positive"); }
+        initialSlice = std::chrono::milliseconds(std::max(1LL, static_cast<long long>(seconds * 1000)));
+    }
+}
+
+Options SequentialPortfolio::engineOptions(std::string const & engine, std::string const & prefix) const {
+    Options result = options;
+    // Engines such as TPA choose their variant by the engine option, which lists the whole portfolio here
+    result.setOption(Options::ENGINE, engine);
+    if (prefix.empty()) { return result; }
+    // Every engine needs its own checkpoint file, otherwise the engines would overwrite each other's progress
+    result.setOption(Options::CHECKPOINT, prefix + "." + engine);
+    if (not options.hasOption(Options::TPA_SNAPSHOT_DIR)) {
+        std::error_code ignored;
+        std::filesystem::create_directories(prefix + ".tpa", ignored);
+        result.setOption(Options::TPA_SNAPSHOT_DIR, prefix + ".tpa");
+    }
+    return result;
+}
+
+VerificationResult SequentialPortfolio::solve(ChcDirectedHyperGraph const & graph) {
+    // With option CHECKPOINT the progress is kept also for later runs, otherwise only until the end of this run
+    std::optional<TemporaryDirectory> directory;
+    std::string prefix;
+    if (options.hasOption(Options::CHECKPOINT)) {
+        prefix = options.getOption(Options::CHECKPOINT);
+    } else {
+        directory.emplace();
+        if (not directory->getPath().empty()) { prefix = directory->getPath() + "/progress"; }
+    }
+    struct Participant {
+        std::string name;
+        Options options;
+        bool active;
+        // Progress of the engine, in the engine's own unit of steps
+        std::optional<std::size_t> safeBound;
+    };
+    std::vector<Participant> participants;
+    for (auto const & engine : engines) {
+        participants.push_back({engine, engineOptions(engine, prefix), true, std::nullopt});
+    }
+    auto isActive = [](Participant const & participant) { return participant.active; };
+    // The bounds of different engines are not comparable, so none of them is reported for the portfolio
+    auto giveUp = [](std::string_view reason) {
+        return VerificationResult(VerificationAnswer::UNKNOWN, NoWitness(reason));
+    };
+    auto slice = initialSlice;
+    while (std::any_of(participants.begin(), participants.end(), isActive)) {
+        for (auto & participant : participants) {
+            if (not participant.active) { continue; }
+            Statistics::increment("portfolio.slices");
+            auto engine = factory(participant.name, logic, participant.options);
+            ResourceGovernor::Slice timeSlice(slice);
+            auto result = [&]() {
+                try {
+                    return engine->solve(graph);
+                } catch (ResourceGovernor::LimitReached const & limit) {
+                    return limitReachedResult(limit);
+                }
+            }();
+            if (result.getAnswer() != VerificationAnswer::UNKNOWN) { return result; }
+            if (auto bound = result.getSafeBound()) { participant.safeBound = bound; }
+            if (ResourceGovernor::isExhausted()) { return giveUp(result.getNoWitnessReason()); }
+            // An engine that stops before its slice expires has given up on the system
+            participant.active = timeSlice.isExpired();
+            if (verbosity > 0) {
+                std::cout << "; portfolio: " << participant.name
+                          << (participant.active ? " preempted after " : " gave up within ")
+                          << std::chrono::duration<double>(slice).count() << " s";
+                if (participant.safeBound) { std::cout << ", safe up to " << *participant.safeBound << " transitions"; }
+                std::cout << std::endl;
+            }
+        }
+        slice *= sliceGrowth;
+    }
+    return giveUp("All engines of the portfolio gave up");
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_PORTFOLIO_H
+#define GOLEM_PORTFOLIO_H
+
+#include "Engine.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Portfolio of engines running on a single thread, for machines where the engines of the parallel portfolio would
+ * compete for one core.
+ *
+ * The engines take turns in rounds. In every round, each engine that has not given up runs for the current time
+ * slice, which grows geometrically from round to round. An engine whose slice expires is stopped by the resource
+ * governor. Its progress is kept in a checkpoint of its own (see Checkpoint; TPA uses its snapshot directory), so in
+ * the next round it resumes from the last completed bound instead of starting over. Engines without checkpoints
+ * (LAWI) start from scratch, but with a longer slice every time.
+ *
+ * The answer of the first engine that solves the system is returned. The time slices are enforced by the process-wide
+ * ResourceGovernor, so the portfolio must not run in several threads at once.
+ */
+class SequentialPortfolio : public Engine {
+public:
+    using EngineFactory = std::function<std::unique_ptr<Engine>(std::string const &, Logic &, Options const &)>;
+
+    static constexpr unsigned sliceGrowth = 2;
+
+    SequentialPortfolio(Logic & logic, Options const & options, std::vector<std::string> engines,
+                        EngineFactory factory);
+
+    VerificationResult solve(ChcDirectedHyperGraph const & graph) override;
+
+private:
+    /**
+     * Options of the given engine, with the engine option set to the engine; unless the prefix is empty, with the
+     * checkpoint and snapshot directory of the engine under the given prefix.
+     */
+    Options engineOptions(std::string const & engine, std::string const & prefix) const;
+
+    Logic & logic;
+    Options const & options;
+    std::vector<std::string> engines;
+    EngineFactory factory;
+    std::chrono::milliseconds initialSlice{1000};
+    int verbosity{0};
+};
+
+#endif // GOLEM_PORTFOLIO_H
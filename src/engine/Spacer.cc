@@ -5,75 +5,23 @@
  */
 
 #include "Spacer.h"
+#include "Checkpoint.h"
+#include "Common.h"
+#include "Houdini.h"
+#include "SpacerFrames.h"
 
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
 #include "ModelBasedProjection.h"
 
+#include <optional>
 #include <queue>
 #include <unordered_map>
-#include <unordered_set>
 
 #define TRACE_LEVEL 0
 
 #define TRACE(l,m) if (TRACE_LEVEL >= l) { std::cout << m << std::endl; }
 
-class ApproxMap {
-public:
-    vec<PTRef> getComponents(SymRef vid, std::size_t bound) const {
-        vec<PTRef> res;
-        (const_cast<ApproxMap*>(this))->ensureBound(bound);
-        auto const& boundMap = innerMap[bound];
-        auto it = boundMap.find(vid);
-        if (it != boundMap.end()) {
-            res.capacity(it->second.size());
-            for (PTRef component : it->second) {
-                res.push(component);
-            }
-        }
-        return res;
-    }
-
-    void insert(SymRef vid, std::size_t bound, PTRef summary) {
-        ensureBound(bound);
-        auto & boundMap = innerMap[bound];
-        auto & components = boundMap[vid];
-        components.insert(summary);
-    }
-
-    bool has(SymRef vid, std::size_t bound, PTRef summary) {
-        ensureBound(bound);
-        auto const & boundMap = innerMap[bound];
-        auto it = boundMap.find(vid);
-        if (it != boundMap.end()) {
-            return it->second.find(summary) != it->second.end();
-        }
-        return false;
-    }
-
-private:
-    std::vector<std::unordered_map<SymRef, std::unordered_set<PTRef, PTRefHash>, SymRefHash>> innerMap; // bound -> vertex -> elements of approximation
-
-    void ensureBound(std::size_t bound) {
-        while (innerMap.size() <= bound) {
-            innerMap.emplace_back();
-        }
-    }
-};
-
-class UnderApproxMap : public ApproxMap {
-
-};
-
-class OverApproxMap : public ApproxMap {
-
-};
-
-struct ProofObligation {
-    SymRef vertex;
-    std::size_t bound;
-    PTRef constraint;
-};
-
 bool operator<(ProofObligation const& pob1, ProofObligation const& pob2) {
     // TODO: Does it make sense to break ties using vertices?
     return pob1.bound < pob2.bound or
@@ -96,65 +44,6 @@ private:
     std::priority_queue<ProofObligation, std::vector<ProofObligation>, std::greater<>> pqueue;
 };
 
-class DerivationDatabase {
-public:
-    using ID = std::size_t;
-    struct DerivedFact {
-        PTRef fact;
-        SymRef node;
-    };
-
-    [[nodiscard]] ID getIdFor(DerivedFact fact) const;
-
-    struct Entry {
-        DerivedFact derivedFact;
-        EId incomingEdge;
-        std::vector<ID> premises;
-    };
-
-    void newDerivation(DerivedFact fact, EId edge, std::vector<ID> premises);
-
-    Entry const & getEntry(ID index) const { assert(index < table.size()); return table.at(index); }
-
-    // DEBUG
-    void print(Logic & logic) const {
-        for (auto const & entry : *this) {
-            std::cout << logic.printSym(entry.derivedFact.node) << " " << logic.pp(entry.derivedFact.fact) << " " << entry.incomingEdge.id << " | ";
-            for (auto premise : entry.premises) {
-                std::cout << premise << " ";
-            }
-            std::cout << std::endl;
-        }
-    }
-
-private:
-    std::vector<Entry> table;
-
-public:
-    using const_iterator = decltype(table)::const_iterator;
-
-    const_iterator begin() const { return table.begin(); }
-    const_iterator end() const { return table.end(); }
-
-};
-
-bool operator==(DerivationDatabase::DerivedFact const & first, DerivationDatabase::DerivedFact const & second) {
-    return first.node == second.node and first.fact == second.fact;
-}
-
-DerivationDatabase::ID DerivationDatabase::getIdFor(DerivationDatabase::DerivedFact fact) const {
-    for (std::size_t i = 0u; i < table.size(); ++i) {
-        if (table[i].derivedFact == fact) {
-            return i;
-        }
-    }
-    throw std::logic_error("Given fact not found in the database of derived facts");
-}
-
-void DerivationDatabase::newDerivation(DerivationDatabase::DerivedFact fact, EId edge, std::vector<ID> premises) {
-    table.push_back({.derivedFact = fact, .incomingEdge = edge, .premises = std::move(premises)});
-}
-
 class SpacerContext {
     Logic & logic;
     ChcDirectedHyperGraph const & graph;
@@ -164,22 +53,40 @@ class SpacerContext {
 
     DerivationDatabase database;
     bool logProof;
+    bool generalizeLemmas;
 
     std::size_t lowestChangedLevel = 0;
+    // Highest bound (depth of derivations, counting the edges from the entry and into the exit) for which the query
+    // has been proven unreachable
+    std::optional<std::size_t> safeBound;
+
+    // Proof obligations blocked so far, re-enqueued at higher levels in later bounded safety checks
+    static constexpr std::size_t maxBlockedObligations = 10000;
+    BlockedObligations blockedObligations{maxBlockedObligations};
+
+    // Frames are stored after each bound proven safe; a later run restores them and continues with the next bound
+    Checkpoint const & checkpoint;
 
     // Helper data structures to get the versioning right
     ChcDirectedHyperGraph::VertexInstances vertexInstances;
 
     void addMaySummary(SymRef vid, std::size_t bound, PTRef summary) {
+        Statistics::increment("spacer.lemmas");
         over.insert(vid, bound, summary);
     }
 
     PTRef getMustSummary(SymRef vid, std::size_t bound) const {
-        return logic.mkOr(under.getComponents(vid, bound));
+        auto const & components = under.getComponents(vid, bound);
+        vec<PTRef> disjuncts;
+        disjuncts.capacity(static_cast<int>(components.size()));
+        for (auto const & entry : components) {
+            disjuncts.push(entry.first);
+        }
+        return logic.mkOr(std::move(disjuncts));
     }
 
     PTRef getMaySummary(SymRef vid, std::size_t bound) const {
-        return logic.mkAnd(over.getComponents(vid, bound));
+        return over.getSummary(vid, bound, logic);
     }
 
     PTRef getEdgeMustSummary(EId eid, std::size_t bound) const;
@@ -203,6 +110,10 @@ class SpacerContext {
 
     bool tryPushComponents(SymRef, std::size_t, PTRef);
 
+    PTRef generalizeLemma(SymRef vid, std::size_t level, PTRef lemma);
+
+    bool blockCounterexampleToGeneralization(EId eid, std::size_t level, Model & model);
+
 
     enum class QueryAnswer : char {UNKNOWN, VALID, INVALID, ERROR};
     struct QueryResult {
@@ -225,42 +136,68 @@ class SpacerContext {
 
     PTRef projectFormula(PTRef fla, vec<PTRef> const & vars, Model & model) const;
 
-    void logNewFactIntoDatabase(PTRef fact, SymRef vertex, std::size_t sourceLevel, EId eid, Model & model);
+    DerivationDatabase::ID logNewFactIntoDatabase(PTRef fact, SymRef vertex, std::size_t sourceLevel, EId eid,
+                                                  Model & model);
 
     InvalidityWitness reconstructInvalidityWitness() const;
+
+    void saveFrames(std::string const & key, std::size_t bound) const;
+    std::size_t restoreFrames(std::string const & key);
 public:
-    SpacerContext(Logic & logic, ChcDirectedHyperGraph const & graph, bool logProof);
+    SpacerContext(Logic & logic, ChcDirectedHyperGraph const & graph, bool logProof, bool generalizeLemmas,
+                  Checkpoint const & checkpoint);
 
     VerificationResult run();
+
+    /** Number of transitions up to which the query is known to be unreachable, see VerificationResult::getSafeBound */
+    std::optional<std::size_t> getSafeBound() const { return transitionsBetweenEntryAndExit(safeBound); }
 };
 
 VerificationResult Spacer::solve(ChcDirectedHyperGraph const & system) {
     bool logProof = options.hasOption(Options::COMPUTE_WITNESS) and options.getOption(Options::COMPUTE_WITNESS) == "true";
-    return SpacerContext(logic, system, logProof).run();
+    bool generalizeLemmas = options.hasOption(Options::SPACER_GENERALIZE_LEMMAS) and
+                            options.getOption(Options::SPACER_GENERALIZE_LEMMAS) == "true";
+    Checkpoint checkpoint(logic, options, "spacer");
+    SpacerContext context(logic, system, logProof, generalizeLemmas, checkpoint);
+    try {
+        return context.run();
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        return limitReachedResult(limit, context.getSafeBound());
+    }
 }
 
-SpacerContext::SpacerContext(Logic & logic, ChcDirectedHyperGraph const & graph, bool logProof)
-    : logic(logic), graph(graph), logProof(logProof), vertexInstances(graph) {
+SpacerContext::SpacerContext(Logic & logic, ChcDirectedHyperGraph const & graph, bool logProof, bool generalizeLemmas,
+                             Checkpoint const & checkpoint)
+    : logic(logic), graph(graph), logProof(logProof), generalizeLemmas(generalizeLemmas), checkpoint(checkpoint),
+      vertexInstances(graph) {
+    auto entryId = database.newDerivation({.fact = logic.getTerm_true(), .node = graph.getEntry()},
+                                          {static_cast<std::size_t>(-1)}, {});
     auto vertices = graph.getVertices();
     for (auto vid : vertices) {
-        PTRef toInsert = vid == graph.getEntry() ? logic.getTerm_true() : logic.getTerm_false();
+        bool isEntry = vid == graph.getEntry();
+        PTRef toInsert = isEntry ? logic.getTerm_true() : logic.getTerm_false();
         addMaySummary(vid, 0, toInsert);
-        under.insert(vid, 0, toInsert);
+        under.insert(vid, 0, toInsert, isEntry ? entryId : DerivationDatabase::NoID);
     }
-    database.newDerivation({.fact = logic.getTerm_true(), .node = graph.getEntry()}, {static_cast<std::size_t>(-1)}, {});
 }
 
 VerificationResult SpacerContext::run() {
-    std::size_t currentBound = 1;
+    ScopedTimer timer("engine.spacer");
+    auto key = checkpoint.makeKey([this](GraphSerializer & serializer) { serializer.writeGraph(graph); });
+    std::size_t currentBound = restoreFrames(key) + 1;
     while(true) {
+        ResourceGovernor::checkpoint();
+        Statistics::increment("spacer.bounds");
         addMaySummary(graph.getEntry(), currentBound, logic.getTerm_true());
-        under.insert(graph.getEntry(), currentBound, logic.getTerm_true());
+        auto entryId = database.getIdFor({logic.getTerm_true(), graph.getEntry()});
+        under.insert(graph.getEntry(), currentBound, logic.getTerm_true(), entryId);
         TRACE(1, "Checking bound safety for " << currentBound)
         auto boundedResult = boundSafety(currentBound);
         switch (boundedResult) {
             case BoundedSafetyResult::UNSAFE:
                 return VerificationResult(VerificationAnswer::UNSAFE, reconstructInvalidityWitness());
             case BoundedSafetyResult::SAFE: {
+                safeBound = currentBound;
                 auto inductiveResult = isInductive(currentBound);
                 if (inductiveResult.answer == InductiveCheckAnswer::INDUCTIVE) {
                     std::unordered_map<PTRef, PTRef, PTRefHash> solution;
@@ -270,7 +207,7 @@ VerificationResult SpacerContext::run() {
                         if (vid == graph.getEntry() or vid == graph.getExit()) { continue; }
                         // MB: 0-ary predicate would be treated as variables in VersionManager, not what we want
                         PTRef predicate = logic.getPterm(statePredicate).size() > 0 ? VersionManager(logic).sourceFormulaToBase(statePredicate) : statePredicate;
-                        PTRef invariantSummary = logic.mkAnd(over.getComponents(vid, inductiveLevel));
+                        PTRef invariantSummary = over.getSummary(vid, inductiveLevel, logic);
                         if (logic.isOr(invariantSummary) or logic.isAnd(invariantSummary)) {
                             invariantSummary = simplifyUnderAssignment_Aggressive(invariantSummary, logic);
                         }
@@ -282,6 +219,7 @@ VerificationResult SpacerContext::run() {
                     }
                     return {VerificationAnswer::SAFE, ValidityWitness(std::move(solution))};
                 }
+                saveFrames(key, currentBound);
                 ++currentBound;
                 break;
             }
@@ -293,6 +231,57 @@ VerificationResult SpacerContext::run() {
 }
 
 
+/*
+ * Vertices are stored by name, so that restoring the frames does not need to declare the predicate symbols again.
+ * Only the may-summaries are stored; must-summaries and blocked obligations are rediscovered when needed.
+ */
+void SpacerContext::saveFrames(std::string const & key, std::size_t bound) const {
+    checkpoint.save(key, bound, [this](GraphSerializer & serializer) {
+        std::size_t count = 0;
+        over.forEachLemma([&](SymRef, PTRef, std::size_t) { ++count; });
+        serializer.writeUnsigned(count);
+        over.forEachLemma([&](SymRef vid, PTRef lemma, std::size_t level) {
+            serializer.writeString(logic.getSymName(vid));
+            serializer.writeUnsigned(level);
+            serializer.writeTerm(lemma);
+        });
+    });
+}
+
+std::size_t SpacerContext::restoreFrames(std::string const & key) {
+    struct Lemma {
+        SymRef vertex;
+        std::size_t level;
+        PTRef lemma;
+    };
+    std::vector<Lemma> lemmas;
+    auto bound = checkpoint.restore(key, [&](GraphDeserializer & deserializer) {
+        std::unordered_map<std::string, SymRef> vertices;
+        for (auto vid : graph.getVertices()) {
+            vertices.emplace(logic.getSymName(vid), vid);
+        }
+        auto count = deserializer.readUnsigned();
+        for (std::uint64_t i = 0; i < count; ++i) {
+            auto it = vertices.find(deserializer.readString());
+            if (it == vertices.end()) { throw std::logic_error("Unknown vertex in checkpoint"); }
+            auto level = deserializer.readUnsigned();
+            lemmas.push_back({it->second, level, deserializer.readTerm()});
+        }
+    });
+    if (not bound) { return 0; }
+    for (auto const & [vertex, level, lemma] : lemmas) {
+        over.insert(vertex, level, lemma);
+    }
+    // The entry is reachable at every bound, as in the bounds explored by this run
+    auto entryId = database.getIdFor({logic.getTerm_true(), graph.getEntry()});
+    for (std::size_t level = 1; level <= *bound; ++level) {
+        under.insert(graph.getEntry(), level, logic.getTerm_true(), entryId);
+    }
+    safeBound = *bound;
+    TRACE(1, "Frames restored from checkpoint up to bound " << *bound)
+    return *bound;
+}
+
 std::vector<EId> incomingEdges(SymRef v, ChcDirectedHyperGraph const & graph) {
     // TODO: Remember the adjacency representation and do not recompute this all the time
     std::vector<EId> incoming;
@@ -307,20 +296,31 @@ SpacerContext::BoundedSafetyResult SpacerContext::boundSafety(std::size_t curren
     auto query = graph.getExit();
     PriorityQueue pqueue;
     pqueue.push(ProofObligation{query, currentBound, logic.getTerm_true()});
+    // Obligations blocked in previous checks are likely to be relevant again one level higher
+    for (auto const & pob : blockedObligations.pushedBelow(currentBound)) {
+        pqueue.push(pob);
+    }
     lowestChangedLevel = currentBound;
     while(not pqueue.empty()) {
         TRACE(2, "Examining proof obligation " << pqueue.peek().vertex.x)
+        ResourceGovernor::checkpoint();
+        Statistics::increment("spacer.obligations");
         auto const & pob = pqueue.peek();
         if (pob.vertex == graph.getEntry()) {
             assert(false); // With the must summaries, we actually never finish here
             return BoundedSafetyResult::UNSAFE;
         }
+        if (blockedObligations.isBlocked(pob)) { // Duplicate of an obligation that has already been blocked
+            pqueue.pop();
+            continue;
+        }
         auto edges = incomingEdges(pob.vertex, graph);
         bool mustReached = checkMustReachability(edges, pob);
         if (mustReached) {
             if (pob.vertex == query) {
                 return BoundedSafetyResult::UNSAFE; // query is reachable
             }
+            blockedObligations.forget(pob);
             pqueue.pop();
             continue;
         }
@@ -344,12 +344,19 @@ SpacerContext::BoundedSafetyResult SpacerContext::boundSafety(std::size_t curren
                 throw std::logic_error("All edges should have been blocked, but they are not!");
             }
             PTRef newLemma = VersionManager(logic).targetFormulaToBase(res.interpolant);
+            if (generalizeLemmas) { newLemma = generalizeLemma(pob.vertex, pob.bound, newLemma); }
             TRACE(2, "Learnt new lemma for " << pob.vertex.x << " at level " << pob.bound << " - " << logic.pp(newLemma))
             addMaySummary(pob.vertex, pob.bound, newLemma);
             if (pob.bound < lowestChangedLevel) {
                 lowestChangedLevel = pob.bound;
             }
-            pqueue.pop(); // This POB has been successfully blocked
+            // This POB has been successfully blocked; re-enqueue it one level higher, as long as it is within the bound
+            ProofObligation blocked = pob;
+            blockedObligations.markBlocked(blocked);
+            pqueue.pop();
+            if (blocked.bound < currentBound) {
+                pqueue.push(ProofObligation{blocked.vertex, blocked.bound + 1, blocked.constraint});
+            }
         } else {
             for (auto const& npob : newProofObligations) {
                 TRACE(2,"Pushing new proof obligation " << logic.pp(npob.constraint) << " for " << npob.vertex.x << " at level " << npob.bound)
@@ -370,7 +377,7 @@ SpacerContext::QueryResult SpacerContext::implies(PTRef antecedent, PTRef conseq
     auto & solver = solverWrapper.getCoreSolver();
     solver.insertFormula(antecedent);
     solver.insertFormula(logic.mkNot(consequent));
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res == s_True) {
         qres.answer = QueryAnswer::INVALID;
         qres.model = solver.getModel();
@@ -397,7 +404,7 @@ SpacerContext::ItpQueryResult SpacerContext::interpolatingImplies(PTRef antecede
     auto & solver = solverWrapper.getCoreSolver();
     solver.insertFormula(antecedent);
     solver.insertFormula(logic.mkNot(consequent));
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     ItpQueryResult qres;
     if (res == s_True) {
         qres.answer = QueryAnswer::INVALID;
@@ -445,10 +452,10 @@ bool SpacerContext::checkMustReachability(std::vector<EId> const & edges, ProofO
                 PTRef newMustSummary = projectFormula(summary, predicateVars, *implCheckRes.model);
                 assert(newMustSummary != PTRef_Undef);
                 PTRef definitelyReachable = VersionManager(logic).targetFormulaToBase(newMustSummary);
-                under.insert(pob.vertex, pob.bound, definitelyReachable);
-                if (logProof) {
-                    logNewFactIntoDatabase(definitelyReachable, pob.vertex, pob.bound - 1, edges[counter], *implCheckRes.model);
-                }
+                auto id = logProof ? logNewFactIntoDatabase(definitelyReachable, pob.vertex, pob.bound - 1,
+                                                            edges[counter], *implCheckRes.model)
+                                   : DerivationDatabase::NoID;
+                under.insert(pob.vertex, pob.bound, definitelyReachable, id);
                 return true;
             }
             ++counter;
@@ -561,7 +568,7 @@ SpacerContext::InductiveCheckResult SpacerContext::isInductive(std::size_t maxLe
 /* This is the original tryPushComponents implementation that tries to push the lemmas one by one */
 #if 0
 bool SpacerContext::tryPushComponents(SymRef vid, std::size_t level, PTRef body) {
-    auto maySummaryComponents = over.getComponents(vid, level);
+    auto maySummaryComponents = over.getDelta(vid, level);
     bool allPushed = true;
     SMTConfig config;
     const char* msg = "ok";
@@ -570,14 +577,11 @@ bool SpacerContext::tryPushComponents(SymRef vid, std::size_t level, PTRef body)
     MainSolver solver(logic, config, "inductive checker");
     solver.insertFormula(body);
     for (PTRef component : maySummaryComponents) {
-        if (over.has(vid, level + 1, component)) {
-            continue;
-        }
         PTRef nextStateComponent = VersionManager(logic).baseFormulaToTarget(component);
 //        std::cout << " Checking component " << logic.printTerm(nextStateComponent) << std::endl;
         solver.push();
         solver.insertFormula(logic.mkNot(nextStateComponent));
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_False) {
             addMaySummary(vid, level + 1, component);
         } else {
@@ -590,62 +594,179 @@ bool SpacerContext::tryPushComponents(SymRef vid, std::size_t level, PTRef body)
 #endif
 
 bool SpacerContext::tryPushComponents(SymRef vid, std::size_t level, PTRef body) {
-    auto maySummaryComponents = over.getComponents(vid, level);
-    vec<PTRef> targetCandidates;
-    targetCandidates.capacity(maySummaryComponents.size());
-    vec<PTRef> activationLiterals;
-    activationLiterals.capacity(maySummaryComponents.size());
-    unsigned counter = 0;
-    for (PTRef component : maySummaryComponents) {
-        if (over.has(vid, level + 1, component)) {
-            continue;
-        }
-        std::string name = ".act" + std::to_string(counter++);
-        PTRef activationVariable = logic.mkBoolVar(name.c_str());
-        targetCandidates.push(VersionManager(logic).baseFormulaToTarget(component));
-        activationLiterals.push(activationVariable);
+    // Lemmas already pushed to a higher level are not in the delta of this level
+    auto components = over.getDelta(vid, level);
+    std::vector<Houdini::Candidate> candidates;
+    for (PTRef component : components) {
+        candidates.push_back({logic.getTerm_true(), VersionManager(logic).baseFormulaToTarget(component)});
     }
-    if (targetCandidates.size() == 0) { return true; }
+    if (candidates.empty()) { return true; }
 
-    bool allPushed = true;
-    SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::ONLY_MODEL);
-    auto & solver = solverWrapper.getCoreSolver();
-    solver.insertFormula(body);
-    vec<PTRef> queries;
-    queries.capacity(targetCandidates.size());
-    for (auto i = 0; i < targetCandidates.size(); ++i) {
-        queries.push(logic.mkAnd(activationLiterals[i], logic.mkNot(targetCandidates[i])));
+    // Components do not assume each other, so this only checks which of them follow from the body
+    auto pushed = Houdini(logic, body).filter(candidates);
+    for (auto i : pushed) {
+        addMaySummary(vid, level + 1, components[static_cast<int>(i)]);
     }
-    solver.insertFormula(logic.mkOr(queries));
+    return pushed.size() == candidates.size();
+}
+
+// *********** LEMMA GENERALIZATION *****************************
+namespace {
+/*
+ * Checks whether candidate lemmas of a vertex are inductive relative to the given representations of its incoming
+ * edges. The edges are asserted once, each guarded by a selector. A candidate is checked in a push/pop frame, where it
+ * is assumed on every source instance of the vertex itself and its negation is asserted on the target.
+ */
+class RelativeInductionChecker {
+    Logic & logic;
+    SMTSolver solverWrapper;
+    std::vector<PTRef> selectors;
+    std::vector<std::vector<unsigned>> selfInstances; // edge -> instances of the vertex among the sources of the edge
+
+public:
+    struct Counterexample {
+        std::size_t edgeIndex;
+        std::unique_ptr<Model> model;
+    };
 
-    auto disabled = 0u;
-    while (disabled < queries.size_()) {
+    RelativeInductionChecker(Logic & logic, vec<PTRef> const & edgeRepresentations,
+                             std::vector<std::vector<unsigned>> selfInstances)
+        : logic(logic), solverWrapper(logic, SMTSolver::WitnessProduction::ONLY_MODEL),
+          selfInstances(std::move(selfInstances)) {
+        auto & solver = solverWrapper.getCoreSolver();
+        vec<PTRef> anyEdge;
+        for (int i = 0; i < edgeRepresentations.size(); ++i) {
+            std::string name = ".spacer_edge" + std::to_string(i);
+            PTRef selector = logic.mkBoolVar(name.c_str());
+            solver.insertFormula(logic.mkOr(logic.mkNot(selector), edgeRepresentations[i]));
+            selectors.push_back(selector);
+            anyEdge.push(selector);
+        }
+        solver.insertFormula(logic.mkOr(std::move(anyEdge)));
+    }
+
+    /* Returns empty optional if the candidate (in base version) is relatively inductive */
+    std::optional<Counterexample> check(PTRef candidate) {
+        VersionManager versionManager(logic);
+        auto & solver = solverWrapper.getCoreSolver();
         solver.push();
-        solver.insertFormula(logic.mkAnd(activationLiterals));
-        auto res = solver.check();
-        if (res == s_False) { break; }
-        if (res != s_True) { throw std::logic_error("Solver could not solve a problem while trying to push components!"); }
-        assert(res == s_True);
-        auto model = solver.getModel();
-        for (auto i = 0; i < activationLiterals.size(); ++i) {
-            if (logic.isNot(activationLiterals[i])) { continue; } // already disabled
-            if (model->evaluate(queries[i]) == logic.getTerm_true()) {
-                ++disabled;
-                assert(not logic.isNot(activationLiterals[i]));
-                activationLiterals[i] = logic.mkNot(activationLiterals[i]);
+        for (std::size_t i = 0; i < selectors.size(); ++i) {
+            if (selfInstances[i].empty()) { continue; }
+            vec<PTRef> assumptions;
+            for (unsigned instance : selfInstances[i]) {
+                assumptions.push(versionManager.baseFormulaToSource(candidate, instance));
             }
+            solver.insertFormula(logic.mkOr(logic.mkNot(selectors[i]), logic.mkAnd(std::move(assumptions))));
+        }
+        solver.insertFormula(logic.mkNot(versionManager.baseFormulaToTarget(candidate)));
+        auto res = SMTSolver::check(solver);
+        if (res == s_False) {
+            solver.pop();
+            return std::nullopt;
         }
+        if (res != s_True) { throw std::logic_error("Spacer: Error in checking relative inductiveness of a lemma"); }
+        auto model = solver.getModel();
         solver.pop();
+        for (std::size_t i = 0; i < selectors.size(); ++i) {
+            if (model->evaluate(selectors[i]) == logic.getTerm_true()) { return Counterexample{i, std::move(model)}; }
+        }
+        throw std::logic_error("Spacer: No edge is taken in a counterexample to induction");
     }
+};
+} // namespace
 
-    for (auto i = 0; i < targetCandidates.size(); ++i) {
-        if (not logic.isNot(activationLiterals[i])) {
-            addMaySummary(vid, level + 1, VersionManager(logic).targetFormulaToBase(targetCandidates[i]));
-        } else {
-            allPushed = false;
+/*
+ * Strengthens a lemma learnt for the vertex at the given level by dropping disjuncts from its conjuncts, as long as
+ * the conjunct stays inductive relative to the may-summaries of the previous level. A stronger lemma still blocks the
+ * proof obligation it was learnt for. If a counterexample to generalization comes from a state that is not reachable
+ * at the previous level, the state is blocked there and the drop is retried (a bounded number of times).
+ */
+PTRef SpacerContext::generalizeLemma(SymRef vid, std::size_t level, PTRef lemma) {
+    assert(level > 0);
+    constexpr unsigned maxCounterexamplesToGeneralization = 3;
+    auto edges = incomingEdges(vid, graph);
+    auto makeChecker = [&]() {
+        vec<PTRef> edgeRepresentations;
+        std::vector<std::vector<unsigned>> selfInstances;
+        for (EId eid : edges) {
+            edgeRepresentations.push(getEdgeMaySummary(eid, level - 1));
+            auto const & sources = graph.getSources(eid);
+            auto & instances = selfInstances.emplace_back();
+            for (std::size_t i = 0; i < sources.size(); ++i) {
+                if (sources[i] == vid) { instances.push_back(vertexInstances.getInstanceNumber(eid, i)); }
+            }
+        }
+        return std::make_unique<RelativeInductionChecker>(logic, edgeRepresentations, std::move(selfInstances));
+    };
+    auto checker = makeChecker();
+    TermUtils utils(logic);
+    vec<PTRef> generalized;
+    for (PTRef conjunct : utils.getTopLevelConjuncts(lemma)) {
+        auto disjuncts = utils.getTopLevelDisjuncts(conjunct);
+        std::vector<PTRef> literals(disjuncts.begin(), disjuncts.end());
+        std::size_t i = 0;
+        while (literals.size() > 1 and i < literals.size()) {
+            vec<PTRef> remaining;
+            for (std::size_t j = 0; j < literals.size(); ++j) {
+                if (j != i) { remaining.push(literals[j]); }
+            }
+            PTRef candidate = logic.mkOr(std::move(remaining));
+            bool dropped = false;
+            for (unsigned ctgs = 0; ; ++ctgs) {
+                auto counterexample = checker->check(candidate);
+                if (not counterexample) {
+                    dropped = true;
+                    break;
+                }
+                if (ctgs == maxCounterexamplesToGeneralization) { break; }
+                EId eid = edges[counterexample->edgeIndex];
+                if (not blockCounterexampleToGeneralization(eid, level - 1, *counterexample->model)) { break; }
+                checker = makeChecker(); // The may-summaries of the previous level have changed
+            }
+            if (dropped) {
+                literals.erase(literals.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
         }
+        vec<PTRef> kept;
+        for (PTRef literal : literals) {
+            kept.push(literal);
+        }
+        generalized.push(logic.mkOr(std::move(kept)));
     }
-    return allPushed;
+    PTRef result = logic.mkAnd(std::move(generalized));
+    TRACE(2, "Generalized lemma " << logic.pp(lemma) << " to " << logic.pp(result))
+    return result;
+}
+
+/*
+ * Tries to block, at the given level, the state of a source of the edge in the counterexample to generalization.
+ * Returns true if a new lemma has been learnt.
+ */
+bool SpacerContext::blockCounterexampleToGeneralization(EId eid, std::size_t level, Model & model) {
+    if (level == 0) { return false; }
+    auto const & sources = graph.getSources(eid);
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        auto source = sources[i];
+        if (source == graph.getEntry()) { continue; }
+        auto instance = vertexInstances.getInstanceNumber(eid, i);
+        auto predicateVars = TermUtils(logic).getVars(graph.getStateVersion(source, instance));
+        PTRef state = projectFormula(getEdgeMaySummary(eid, level), predicateVars, model);
+        PTRef target = VersionManager(logic).sourceFormulaToTarget(state);
+        vec<PTRef> edgeRepresentations;
+        for (EId incoming : incomingEdges(source, graph)) {
+            edgeRepresentations.push(getEdgeMaySummary(incoming, level - 1));
+        }
+        auto res = interpolatingImplies(logic.mkOr(std::move(edgeRepresentations)), logic.mkNot(target));
+        if (res.answer != QueryAnswer::VALID) { return false; }
+        PTRef lemma = VersionManager(logic).targetFormulaToBase(res.interpolant);
+        TRACE(2, "Learnt lemma for " << source.x << " at level " << level << " from CTG - " << logic.pp(lemma))
+        addMaySummary(source, level, lemma);
+        if (level < lowestChangedLevel) { lowestChangedLevel = level; }
+        return true;
+    }
+    return false;
 }
 
 
@@ -726,7 +847,8 @@ PTRef SpacerContext::getEdgeMixedSummary(EId eid, std::size_t bound, std::size_t
     return logic.mkAnd(std::move(components));
 }
 
-void SpacerContext::logNewFactIntoDatabase(PTRef fact, SymRef vertex, std::size_t level, EId edgeId, Model & model) {
+DerivationDatabase::ID SpacerContext::logNewFactIntoDatabase(PTRef fact, SymRef vertex, std::size_t level, EId edgeId,
+                                                            Model & model) {
     DerivationDatabase::DerivedFact newFact = {fact, vertex};
     std::vector<DerivationDatabase::ID> premises;
     // figure out the premises
@@ -734,13 +856,16 @@ void SpacerContext::logNewFactIntoDatabase(PTRef fact, SymRef vertex, std::size_
     auto const & sourceNodes = graph.getSources(edgeId);
     for (std::size_t index = 0; index < sourceNodes.size(); ++index) {
         auto sourceNode = sourceNodes[index];
-        auto components = under.getComponents(sourceNode, level);
+        auto const & components = under.getComponents(sourceNode, level);
         auto instanceNumber = vertexInstances.getInstanceNumber(edgeId, index);
         bool found = false;
-        for (PTRef component : components) {
+        for (auto const & [component, id] : components) {
             PTRef versionedComponent = versionManager.baseFormulaToSource(component, instanceNumber);
             if (model.evaluate(versionedComponent) == logic.getTerm_true()) {
-                premises.push_back(database.getIdFor({component, sourceNode}));
+                if (id == DerivationDatabase::NoID) {
+                    throw std::logic_error("Given fact not found in the database of derived facts");
+                }
+                premises.push_back(id);
                 found = true;
                 break;
             }
@@ -750,7 +875,7 @@ void SpacerContext::logNewFactIntoDatabase(PTRef fact, SymRef vertex, std::size_
             throw std::logic_error("Unreachable!");
         }
     }
-    database.newDerivation(newFact, edgeId, std::move(premises));
+    return database.newDerivation(newFact, edgeId, std::move(premises));
 }
 
 namespace { // Helper for SpacerContext::reconstructInvalidityWitness
@@ -804,7 +929,7 @@ void computePremiseInstances(DerivationDatabase::Entry const & databaseEntry, En
         solver.insertFormula(factConstraint);
 //        std::cout << logic.pp(factConstraint) << std::endl;
     }
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res != s_True) {
         throw std::logic_error("Error in computing derivation!");
     }
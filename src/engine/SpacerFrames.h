@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_SPACERFRAMES_H
+#define GOLEM_SPACERFRAMES_H
+
+#include "graph/ChcGraph.h"
+#include "osmt_terms.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * Over-approximations stored as delta frames: each lemma is stored once, in the delta of the highest level where it is
+ * known to hold. A lemma that holds at some level holds also at all lower levels, so the summary at level k is the
+ * conjunction of all lemmas with level at least k. Summaries are cached and recomputed only when the frame changes.
+ */
+class OverApproxMap {
+public:
+    /* Records that the lemma holds at the given level (and hence at all lower levels) */
+    void insert(SymRef vid, std::size_t level, PTRef lemma) {
+        auto & frames = framesOf[vid];
+        auto [it, inserted] = frames.positions.try_emplace(lemma, Position{level, 0});
+        auto & position = it->second;
+        if (not inserted and position.level >= level) { return; }
+        std::size_t lowestChanged = 0;
+        if (not inserted) { // The lemma is moved from its current delta
+            lowestChanged = position.level + 1;
+            auto & oldDelta = frames.deltas[position.level];
+            PTRef last = oldDelta.back();
+            oldDelta[position.index] = last;
+            frames.positions.at(last).index = position.index;
+            oldDelta.pop_back();
+        }
+        if (frames.deltas.size() <= level) { frames.deltas.resize(level + 1); }
+        position = Position{level, frames.deltas[level].size()};
+        frames.deltas[level].push_back(lemma);
+        for (std::size_t i = lowestChanged; i <= level and i < frames.summaries.size(); ++i) {
+            frames.summaries[i] = PTRef_Undef;
+        }
+    }
+
+    /* Lemmas for which the given level is the highest level where they are known to hold */
+    vec<PTRef> getDelta(SymRef vid, std::size_t level) const {
+        vec<PTRef> res;
+        auto it = framesOf.find(vid);
+        if (it == framesOf.end() or it->second.deltas.size() <= level) { return res; }
+        for (PTRef lemma : it->second.deltas[level]) {
+            res.push(lemma);
+        }
+        return res;
+    }
+
+    PTRef getSummary(SymRef vid, std::size_t level, Logic & logic) const {
+        auto it = framesOf.find(vid);
+        if (it == framesOf.end()) { return logic.getTerm_true(); }
+        auto & frames = it->second;
+        if (frames.summaries.size() <= level) { frames.summaries.resize(level + 1, PTRef_Undef); }
+        PTRef & summary = frames.summaries[level];
+        if (summary == PTRef_Undef) {
+            vec<PTRef> components;
+            for (std::size_t i = level; i < frames.deltas.size(); ++i) {
+                for (PTRef lemma : frames.deltas[i]) {
+                    components.push(lemma);
+                }
+            }
+            summary = logic.mkAnd(std::move(components));
+        }
+        return summary;
+    }
+
+    /* Calls the function with each vertex, lemma and the highest level where the lemma is known to hold */
+    template<typename TFun> void forEachLemma(TFun && fun) const {
+        for (auto const & [vid, frames] : framesOf) {
+            for (auto const & [lemma, position] : frames.positions) {
+                fun(vid, lemma, position.level);
+            }
+        }
+    }
+
+private:
+    struct Position {
+        std::size_t level; // highest level where the lemma holds
+        std::size_t index; // index of the lemma in the delta of that level
+    };
+    struct Frames {
+        std::unordered_map<PTRef, Position, PTRefHash> positions;
+        std::vector<std::vector<PTRef>> deltas; // level -> lemmas whose highest level is this level
+        mutable std::vector<PTRef> summaries;   // level -> cached summary, PTRef_Undef if invalid
+    };
+    std::unordered_map<SymRef, Frames, SymRefHash> framesOf;
+};
+
+struct VertexFormulaHash {
+    std::size_t operator()(std::pair<SymRef, PTRef> key) const {
+        return SymRefHash{}(key.first) ^ (PTRefHash{}(key.second) << 1);
+    }
+};
+
+struct ProofObligation {
+    SymRef vertex;
+    std::size_t bound;
+    PTRef constraint;
+};
+
+/*
+ * Proof obligations that have been blocked, deduplicated by their vertex and constraint, together with the highest
+ * level where they are known to be blocked. Frames only get stronger, so an obligation stays blocked at that level
+ * and at all lower levels.
+ * At most the given number of obligations is kept; blocking a new obligation when the cache is full evicts the
+ * obligation blocked least recently. An evicted obligation is simply handled from scratch if it shows up again.
+ */
+class BlockedObligations {
+public:
+    explicit BlockedObligations(std::size_t capacity) : capacity(capacity) {}
+
+    [[nodiscard]] bool isBlocked(ProofObligation const & pob) const {
+        auto it = entries.find({pob.vertex, pob.constraint});
+        return it != entries.end() and it->second.level >= pob.bound;
+    }
+
+    void markBlocked(ProofObligation const & pob) {
+        Key key{pob.vertex, pob.constraint};
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            it->second.level = std::max(it->second.level, pob.bound);
+            recency.splice(recency.end(), recency, it->second.position);
+            return;
+        }
+        if (capacity == 0) { return; }
+        if (entries.size() == capacity) {
+            entries.erase(recency.front());
+            recency.pop_front();
+        }
+        recency.push_back(key);
+        entries.emplace(key, Entry{pob.bound, std::prev(recency.end())});
+    }
+
+    /* Reachable obligations can never be blocked again */
+    void forget(ProofObligation const & pob) {
+        auto it = entries.find({pob.vertex, pob.constraint});
+        if (it == entries.end()) { return; }
+        recency.erase(it->second.position);
+        entries.erase(it);
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+
+    /* Obligations blocked below the given bound, moved one level up, the least recently blocked first */
+    [[nodiscard]] std::vector<ProofObligation> pushedBelow(std::size_t bound) const {
+        std::vector<ProofObligation> res;
+        for (auto const & key : recency) {
+            std::size_t level = entries.at(key).level;
+            if (level < bound) { res.push_back(ProofObligation{key.first, level + 1, key.second}); }
+        }
+        return res;
+    }
+
+private:
+    using Key = std::pair<SymRef, PTRef>;
+    struct Entry {
+        std::size_t level;
+        std::list<Key>::iterator position;
+    };
+    std::size_t capacity;
+    std::list<Key> recency; // least recently blocked first
+    std::unordered_map<Key, Entry, VertexFormulaHash> entries;
+};
+
+class DerivationDatabase {
+public:
+    using ID = std::size_t;
+    static constexpr ID NoID = std::numeric_limits<ID>::max();
+    struct DerivedFact {
+        PTRef fact;
+        SymRef node;
+    };
+
+    [[nodiscard]] ID getIdFor(DerivedFact fact) const;
+
+    struct Entry {
+        DerivedFact derivedFact;
+        EId incomingEdge;
+        std::vector<ID> premises;
+    };
+
+    /* Returns the ID of the fact; if the fact has been derived before, this is the ID of its first derivation */
+    ID newDerivation(DerivedFact fact, EId edge, std::vector<ID> premises);
+
+    Entry const & getEntry(ID index) const { assert(index < table.size()); return table.at(index); }
+
+    // DEBUG
+    void print(Logic & logic) const {
+        for (auto const & entry : *this) {
+            std::cout << logic.printSym(entry.derivedFact.node) << " " << logic.pp(entry.derivedFact.fact) << " " << entry.incomingEdge.id << " | ";
+            for (auto premise : entry.premises) {
+                std::cout << premise << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    std::vector<Entry> table;
+    std::unordered_map<std::pair<SymRef, PTRef>, ID, VertexFormulaHash> index;
+
+public:
+    using const_iterator = decltype(table)::const_iterator;
+
+    const_iterator begin() const { return table.begin(); }
+    const_iterator end() const { return table.end(); }
+
+};
+
+inline DerivationDatabase::ID DerivationDatabase::getIdFor(DerivationDatabase::DerivedFact fact) const {
+    auto it = index.find({fact.node, fact.fact});
+    if (it != index.end()) { return it->second; }
+    throw std::logic_error("Given fact not found in the database of derived facts");
+}
+
+inline DerivationDatabase::ID DerivationDatabase::newDerivation(DerivationDatabase::DerivedFact fact, EId edge,
+                                                                std::vector<ID> premises) {
+    table.push_back({.derivedFact = fact, .incomingEdge = edge, .premises = std::move(premises)});
+    return index.try_emplace({fact.node, fact.fact}, table.size() - 1).first->second;
+}
+
+/*
+ * Under-approximations: the must-summary of a vertex at a given bound is the disjunction of its components.
+ * When derivations are logged, each component remembers the ID of its fact in the database of derived facts.
+ */
+class UnderApproxMap {
+public:
+    using Components = std::unordered_map<PTRef, DerivationDatabase::ID, PTRefHash>; // component -> ID of the fact
+
+    Components const & getComponents(SymRef vid, std::size_t bound) const {
+        static Components const empty;
+        if (innerMap.size() <= bound) { return empty; }
+        auto const & boundMap = innerMap[bound];
+        auto it = boundMap.find(vid);
+        return it != boundMap.end() ? it->second : empty;
+    }
+
+    void insert(SymRef vid, std::size_t bound, PTRef summary, DerivationDatabase::ID id = DerivationDatabase::NoID) {
+        while (innerMap.size() <= bound) {
+            innerMap.emplace_back();
+        }
+        innerMap[bound][vid].try_emplace(summary, id);
+    }
+
+private:
+    // bound -> vertex -> elements of approximation
+    std::vector<std::unordered_map<SymRef, Components, SymRefHash>> innerMap;
+};
+
+#endif // GOLEM_SPACERFRAMES_H
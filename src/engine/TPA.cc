@@ -13,32 +13,52 @@
 #include "TransformationUtils.h"
 #include "TransitionSystem.h"
 #include "transformers/BasicTransformationPipelines.h"
+#include "graph/GraphSerialization.h"
 #include "transformers/SingleLoopTransformation.h"
+#include "utils/FnvHash.h"
+#include "utils/ResourceGovernor.h"
 #include "utils/SmtSolver.h"
+#include "utils/Statistics.h"
+#include "utils/ThreadPool.h"
+#include "utils/VersionedFile.h"
+
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <optional>
 
 #define TRACE_LEVEL 0
 
 #define TRACE(l, m)                                                                                                    \
     if (TRACE_LEVEL >= l) { std::cout << m << std::endl; }
 
+namespace {
+/** 2^exponent, or nothing if it does not fit into std::size_t */
+std::optional<std::size_t> powerOfTwo(unsigned exponent) {
+    if (exponent >= std::numeric_limits<std::size_t>::digits) { return std::nullopt; }
+    return std::size_t(1) << exponent;
+}
+} // namespace
+
 const std::string TPAEngine::TPA = "tpa";
 const std::string TPAEngine::SPLIT_TPA = "split-tpa";
 
-std::unique_ptr<TPABase> TPAEngine::mkSolver() {
+std::unique_ptr<TPABase> TPAEngine::mkSolver(Logic & solverLogic) {
     assert(options.hasOption(Options::ENGINE));
     auto val = options.getOption(Options::ENGINE);
     if (val == SPLIT_TPA) {
-        return std::unique_ptr<TPABase>(new TPASplit(logic, options));
+        return std::unique_ptr<TPABase>(new TPASplit(solverLogic, options));
     } else if (val == TPA) {
-        return std::unique_ptr<TPABase>(new TPABasic(logic, options));
+        return std::unique_ptr<TPABase>(new TPABasic(solverLogic, options));
     }
     std::string tmp;
     std::stringstream ss(options.getOption(Options::ENGINE));
     while (getline(ss, tmp, ',')) {
         if (tmp == SPLIT_TPA) {
-            return std::unique_ptr<TPABase>(new TPASplit(logic, options));
+            return std::unique_ptr<TPABase>(new TPASplit(solverLogic, options));
         } else if (tmp == TPA) {
-            return std::unique_ptr<TPABase>(new TPABasic(logic, options));
+            return std::unique_ptr<TPABase>(new TPABasic(solverLogic, options));
         }
     }
 
@@ -63,7 +83,12 @@ VerificationResult TPAEngine::solve(const ChcDirectedGraph & graph) {
     if (isTransitionSystem(graph)) {
         auto ts = toTransitionSystem(graph);
         auto solver = mkSolver();
-        auto res = solver->solveTransitionSystem(*ts);
+        VerificationAnswer res;
+        try {
+            res = solver->solveTransitionSystem(*ts);
+        } catch (ResourceGovernor::LimitReached const & limit) {
+            return limitReachedResult(limit, solver->getSafeBound());
+        }
         if (not options.hasOption(Options::COMPUTE_WITNESS)) { return VerificationResult(res); }
         switch (res) {
             case VerificationAnswer::UNSAFE:
@@ -80,14 +105,24 @@ VerificationResult TPAEngine::solve(const ChcDirectedGraph & graph) {
                 throw std::logic_error("Unreachable!");
         }
     } else if (isTransitionSystemDAG(graph)) {
-        return solveTransitionSystemGraph(graph);
+        try {
+            return solveTransitionSystemGraph(graph);
+        } catch (ResourceGovernor::LimitReached const & limit) {
+            return limitReachedResult(limit);
+        }
     }
     // Translate CHCGraph into transition system
     SingleLoopTransformation transformation;
     auto [ts, backtranslator] = transformation.transform(graph);
     assert(ts);
     auto solver = mkSolver();
-    auto res = solver->solveTransitionSystem(*ts);
+    VerificationAnswer res;
+    try {
+        res = solver->solveTransitionSystem(*ts);
+    } catch (ResourceGovernor::LimitReached const & limit) {
+        // The edges from the entry and into the exit are steps of the transition system too
+        return limitReachedResult(limit, transitionsBetweenEntryAndExit(solver->getSafeBound()));
+    }
     if (not options.hasOption(Options::COMPUTE_WITNESS)) { return VerificationResult(res); }
     switch (res) {
         case VerificationAnswer::UNSAFE:
@@ -122,7 +157,7 @@ public:
         auto & solver = solverWrapper.getCoreSolver();
         solver.insertFormula(transition);
         solver.insertFormula(query);
-        lastResult = solver.check();
+        lastResult = SMTSolver::check(solver);
         if (lastResult == s_False) {
             return ReachabilityResult::UNREACHABLE;
         } else if (lastResult == s_True) {
@@ -181,7 +216,7 @@ public:
         pushed = true;
         solver().insertFormula(query);
         ++allformulasInserted;
-        lastResult = solver().check();
+        lastResult = SMTSolver::check(solver());
         if (lastResult == s_False) {
             return ReachabilityResult::UNREACHABLE;
         } else if (lastResult == s_True) {
@@ -343,6 +378,7 @@ void TPABase::resetExplanation() {
 void TPABase::resetInitialStates(PTRef fla) {
     assert(isPureStateFormula(fla));
     this->init = fla;
+    safeBound.reset();
     queryCache.clear();
     resetExplanation();
 }
@@ -350,6 +386,7 @@ void TPABase::resetInitialStates(PTRef fla) {
 void TPABase::updateQueryStates(PTRef fla) {
     assert(isPureStateFormula(fla));
     this->query = logic.mkAnd(fla, this->query);
+    safeBound.reset();
     queryCache.clear();
     resetExplanation();
 }
@@ -411,12 +448,17 @@ VerificationAnswer TPABase::solveTransitionSystem(TransitionSystem & system) {
 }
 
 VerificationAnswer TPABase::solve() {
+    ScopedTimer timer("engine.tpa");
     auto res = checkTrivialUnreachability();
     assert(res != VerificationAnswer::UNSAFE);
     if (res == VerificationAnswer::SAFE) { return res; }
     unsigned short power = 0;
     while (true) {
+        if (interrupt and interrupt->load()) { return VerificationAnswer::UNKNOWN; }
+        ResourceGovernor::checkpoint();
+        Statistics::increment("tpa.powers");
         auto res = checkPower(power);
+        saveSnapshot();
         switch (res) {
             case VerificationAnswer::UNSAFE:
             case VerificationAnswer::SAFE:
@@ -458,6 +500,7 @@ VerificationAnswer TPASplit::checkPower(unsigned short power) {
         return VerificationAnswer::UNSAFE;
     } else if (isUnreachable(res)) {
         if (verbose() > 0) { std::cout << "; System is safe up to <2^" << power + 1 << " steps" << std::endl; }
+        if (auto steps = powerOfTwo(power + 1)) { safeBound = *steps - 1; }
         bool fixedPointReached = checkLessThanFixedPoint(power + 1);
         if (fixedPointReached) { return VerificationAnswer::SAFE; }
         fixedPointReached = checkExactFixedPoint(power);
@@ -489,7 +532,7 @@ TPABase::QueryResult TPABase::reachabilityExactOneStep(PTRef from, PTRef to) {
     PTRef goal = getNextVersion(to);
     PTRef smtQuery = logic.mkAnd({from, transition, goal});
     solver.insertFormula(smtQuery);
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res == s_True) {
         { // TODO: refactor this out
             auto nextStateVars = getStateVars(1);
@@ -512,7 +555,7 @@ TPABase::QueryResult TPABase::reachabilityExactZeroStep(PTRef from, PTRef to) {
     auto & solver = solverWrapper.getCoreSolver();
     PTRef intersection = logic.mkAnd(from, to);
     solver.insertFormula(intersection);
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res == s_True) {
         result.result = ReachabilityResult::REACHABLE;
         assert(isPureStateFormula(intersection));
@@ -661,7 +704,7 @@ TPASplit::QueryResult TPASplit::reachabilityQueryLessThan(PTRef from, PTRef to,
         // TODO: assert from and to are current-state formulas
         solver.insertFormula(twoStepTransition);
         solver.insertFormula(logic.mkAnd(from, goal));
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_False) {
             TRACE(3, "Top level query was unreachable")
             auto itpContext = solver.getInterpolationContext();
@@ -826,6 +869,7 @@ PTRef TPABase::computeIdentity() const {
 }
 
 void TPABase::resetTransitionSystem(TransitionSystem const & system) {
+    safeBound.reset();
     TimeMachine timeMachine(logic);
     TermUtils utils(logic);
     this->stateVariables.clear();
@@ -861,12 +905,129 @@ void TPABase::resetTransitionSystem(TransitionSystem const & system) {
     }
     this->identity = computeIdentity();
     resetPowers();
+    restoreSnapshot();
     //    std::cout << "Init: " << logic.printTerm(init) << std::endl;
     //    std::cout << "Transition: " << logic.printTerm(transition) << std::endl;
     //    std::cout << "Transition: "; TermUtils(logic).printTermWithLets(std::cout, transition); std::cout <<
     //    std::endl; std::cout << "Query: " << logic.printTerm(query) << std::endl;
 }
 
+namespace {
+// Must be changed whenever the representation of the powers changes
+constexpr std::string_view snapshotMagic = "golem-tpa-powers-v2\n";
+constexpr std::string_view transitionFile = "transition";
+
+// Level 0 is determined by the transition relation and is not stored
+void listLevels(std::vector<std::pair<std::string, PTRef>> & powers, std::string const & prefix,
+                vec<PTRef> const & levels) {
+    for (int i = 1; i < levels.size() and levels[i] != PTRef_Undef; ++i) {
+        powers.emplace_back(prefix + std::to_string(i), levels[i]);
+    }
+}
+
+std::vector<PTRef> readLevels(std::function<PTRef(std::string const &)> const & read, std::string const & prefix) {
+    std::vector<PTRef> levels;
+    while (true) {
+        if (levels.size() + 1 >= std::numeric_limits<unsigned short>::max()) {
+            throw std::logic_error("Too many powers in snapshot");
+        }
+        PTRef level = read(prefix + std::to_string(levels.size() + 1));
+        if (level == PTRef_Undef) { return levels; }
+        levels.push_back(level);
+    }
+}
+
+// Term stored in the file, PTRef_Undef if there is no such file
+PTRef readSnapshotFile(Logic & logic, std::string const & path) {
+    VersionedFile file(path, snapshotMagic);
+    if (not file.exists()) { return PTRef_Undef; }
+    if (not file.isValid()) { throw std::logic_error("Unknown snapshot"); }
+    return GraphDeserializer(logic, file.contents()).readTerm();
+}
+} // namespace
+
+std::string TPABase::snapshotDirectory() const {
+    GraphSerializer serializer(logic);
+    for (PTRef var : stateVariables) {
+        serializer.writeTerm(var);
+    }
+    FnvHash hash;
+    hash.update(snapshotMagic);
+    hash.update(snapshotKind());
+    hash.update(serializer.finish());
+    return options.getOption(Options::TPA_SNAPSHOT_DIR) + "/" + hash.toHex() + ".tpa";
+}
+
+void TPABase::saveSnapshot() const {
+    if (not options.hasOption(Options::TPA_SNAPSHOT_DIR)) { return; }
+    auto directory = snapshotDirectory();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) { return; }
+    auto powers = snapshotPowers();
+    // The transition relation is written first, the powers in the directory must always belong to it
+    powers.emplace(powers.begin(), transitionFile, transition);
+    for (auto const & [name, power] : powers) {
+        auto saved = savedPowers.find(name);
+        if (saved != savedPowers.end() and saved->second == power) { continue; }
+        std::string data;
+        try {
+            GraphSerializer serializer(logic);
+            serializer.writeTerm(power);
+            data = serializer.finish();
+        } catch (std::logic_error const &) { // Unsupported terms
+            return;
+        }
+        if (not VersionedFile::write(directory + "/" + name, snapshotMagic, {data})) { return; }
+        Statistics::increment("tpa.snapshot-writes");
+        savedPowers.insert_or_assign(name, power);
+    }
+}
+
+void TPABase::restoreSnapshot() {
+    savedPowers.clear();
+    if (not options.hasOption(Options::TPA_SNAPSHOT_DIR)) { return; }
+    auto directory = snapshotDirectory();
+    bool sameTransition = false;
+    bool verified = true;
+    try {
+        PTRef storedTransition = readSnapshotFile(logic, directory + "/" + std::string(transitionFile));
+        if (storedTransition == PTRef_Undef) { return; }
+        sameTransition = storedTransition == transition;
+        verified = readPowers([&](std::string const & name) { return readSnapshotFile(logic, directory + "/" + name); },
+                              not sameTransition);
+    } catch (std::logic_error const &) { // Malformed snapshot, start from scratch
+        resetPowers();
+        sameTransition = false;
+    }
+    if (not verified) { Statistics::increment("tpa.snapshot-rejected"); }
+    auto powers = snapshotPowers();
+    if (not powers.empty()) { Statistics::increment("tpa.powers-restored", powers.size()); }
+    if (sameTransition) {
+        // The snapshot already contains the restored powers
+        savedPowers.emplace(transitionFile, transition);
+        for (auto const & [name, power] : powers) {
+            savedPowers.emplace(name, power);
+        }
+    } else {
+        // Powers of the other transition relation must not be restored with the current one later
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+    }
+    if (verbose() > 0 and not powers.empty()) {
+        std::cout << "; Powers of TPA restored from snapshot " << directory << std::endl;
+    }
+}
+
+bool TPABase::overApproximates(PTRef candidate, PTRef twoStepRelation) const {
+    if (not isPureTransitionFormula(candidate)) { return false; }
+    SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
+    auto & solver = solverWrapper.getCoreSolver();
+    solver.insertFormula(twoStepRelation);
+    solver.insertFormula(logic.mkNot(shiftOnlyNextVars(candidate)));
+    return SMTSolver::check(solver) == s_False;
+}
+
 PTRef TPABase::extractMidPoint(PTRef start, PTRef firstTransition, PTRef secondTransition, PTRef goal, Model & model) {
     assert(isPureStateFormula(start));
     assert(isPureTransitionFormula(firstTransition));
@@ -901,6 +1062,41 @@ void TPASplit::resetPowers() {
     lessThanPowers.push(identity);  // Atr^{<0} = Id
 }
 
+std::vector<std::pair<std::string, PTRef>> TPASplit::snapshotPowers() const {
+    std::vector<std::pair<std::string, PTRef>> powers;
+    listLevels(powers, "exact", exactPowers);
+    listLevels(powers, "less-than", lessThanPowers);
+    return powers;
+}
+
+bool TPASplit::readPowers(PowerReader const & read, bool verify) {
+    auto exact = readLevels(read, "exact");
+    auto lessThan = readLevels(read, "less-than");
+    bool verified = true;
+    for (std::size_t i = 0; i < exact.size(); ++i) {
+        auto power = static_cast<unsigned short>(i + 1);
+        PTRef previous = getExactPower(power - 1);
+        if (verify and not overApproximates(exact[i], logic.mkAnd(previous, getNextVersion(previous)))) {
+            verified = false;
+            break;
+        }
+        storeExactPower(power, exact[i]);
+    }
+    // Less-than power on level n is built from the exact power on level n - 1
+    for (std::size_t i = 0; i < lessThan.size() and static_cast<int>(i) < exactPowers.size(); ++i) {
+        auto power = static_cast<unsigned short>(i + 1);
+        PTRef previous = getLessThanPower(power - 1);
+        PTRef previousExact = getExactPower(power - 1);
+        PTRef twoStep = logic.mkOr(shiftOnlyNextVars(previous), logic.mkAnd(previous, getNextVersion(previousExact)));
+        if (verify and not overApproximates(lessThan[i], twoStep)) {
+            verified = false;
+            break;
+        }
+        storeLessThanPower(power, lessThan[i]);
+    }
+    return verified;
+}
+
 bool TPASplit::verifyPower(unsigned short power, TPAType relationType) const {
     if (relationType == TPAType::LESS_THAN) {
         return verifyLessThanPower(power);
@@ -920,7 +1116,7 @@ bool TPASplit::verifyLessThanPower(unsigned short power) const {
     // check that previous or previousExact concatenated with previous implies current
     solver.insertFormula(logic.mkOr(shiftOnlyNextVars(previous), logic.mkAnd(previous, getNextVersion(previousExact))));
     solver.insertFormula(logic.mkNot(shiftOnlyNextVars(current)));
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     return res == s_False;
 }
 
@@ -939,7 +1135,7 @@ bool TPASplit::verifyExactPower(unsigned short power) const {
     // check that previous or previousExact concatenated with previous implies current
     solver.insertFormula(logic.mkAnd(previous, getNextVersion(previous)));
     solver.insertFormula(logic.mkNot(shiftOnlyNextVars(current)));
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     return res == s_False;
 }
 
@@ -962,66 +1158,22 @@ void TPABase::houdiniCheck(PTRef invCandidates, PTRef transition, SafetyExplanat
     // LEFT:
     //   leftInvariants /\ transition /\ getNextVersion(currentLevelTransition) =>
     //     shiftOnlyNextVars(currentLevelTransition);
-    SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
-    auto & solver = solverWrapper.getCoreSolver();
-    solver.push();
+    bool const right = alignment == SafetyExplanation::FixedPointType::RIGHT;
     auto candidates = topLevelConjuncts(logic, invCandidates);
-    if (alignment == SafetyExplanation::FixedPointType::RIGHT) {
-        solver.insertFormula(getNextVersion(transition));
-    } else {
-        if (alignment == SafetyExplanation::FixedPointType::LEFT) { solver.insertFormula(transition); }
-    }
-
-    solver.push();
     squashInvariants(candidates);
-    //    invCandidates.append(conjuncts);
-    //    Atr(x, x') /\ tr(x', x'') => Atr(x, x'')
-    //    or
-    //    Atr(x', x'') /\  tr(x, x') => Atr(x, x'')
-    //    Push transition once and for all
-    //    While loop externally, because we may drop smth important
-    PTRef goal = shiftOnlyNextVars(invCandidates);
-
-    if (alignment == SafetyExplanation::FixedPointType::RIGHT) {
-        solver.insertFormula(logic.mkAnd(invCandidates, logic.mkNot(goal)));
-    } else if (alignment == SafetyExplanation::FixedPointType::LEFT) {
-        solver.insertFormula(logic.mkAnd(getNextVersion(invCandidates), logic.mkNot(goal)));
-    }
-    while (solver.check() == s_True) {
-        for (int i = candidates.size() - 1; i >= 0; i--) {
-            PTRef cand = candidates[i];
-            solver.pop();
-            solver.push();
-            if (alignment == SafetyExplanation::FixedPointType::RIGHT) {
-                solver.insertFormula(logic.mkAnd(logic.mkAnd(candidates), logic.mkNot(shiftOnlyNextVars(cand))));
-            } else {
-                if (alignment == SafetyExplanation::FixedPointType::LEFT) {
-                    solver.insertFormula(
-                        logic.mkAnd(getNextVersion(logic.mkAnd(candidates)), logic.mkNot(shiftOnlyNextVars(cand))));
-                }
-            }
-            if (solver.check() == s_True) {
-                candidates[i] = candidates[candidates.size() - 1];
-                candidates.pop();
-            }
-        }
-        solver.pop();
-        solver.push();
-        goal = shiftOnlyNextVars(logic.mkAnd(candidates));
-        if (alignment == SafetyExplanation::FixedPointType::RIGHT) {
-            solver.insertFormula(logic.mkAnd(logic.mkAnd(candidates), logic.mkNot(goal)));
-        } else {
-            solver.insertFormula(logic.mkAnd(getNextVersion(logic.mkAnd(candidates)), logic.mkNot(goal)));
-        }
+    // The solver with the transition is kept between the calls for different powers
+    PTRef context = right ? getNextVersion(transition) : transition;
+    auto & houdini = right ? rightHoudini : leftHoudini;
+    if (not houdini or houdini->getContext() != context) { houdini = std::make_unique<Houdini>(logic, context); }
+    std::vector<Houdini::Candidate> houdiniCandidates;
+    for (PTRef cand : candidates) {
+        houdiniCandidates.push_back({right ? cand : getNextVersion(cand), shiftOnlyNextVars(cand)});
     }
-    for (auto cand : candidates) {
-        if (alignment == SafetyExplanation::FixedPointType::RIGHT) {
-            if (std::find(rightInvariants.begin(), rightInvariants.end(), cand) != rightInvariants.end()) { continue; }
-            rightInvariants.push(cand);
-        } else {
-            if (std::find(leftInvariants.begin(), leftInvariants.end(), cand) != leftInvariants.end()) { continue; }
-            leftInvariants.push(cand);
-        }
+    auto & invariants = right ? rightInvariants : leftInvariants;
+    for (auto i : houdini->filter(houdiniCandidates)) {
+        PTRef cand = candidates[static_cast<int>(i)];
+        if (std::find(invariants.begin(), invariants.end(), cand) != invariants.end()) { continue; }
+        invariants.push(cand);
     }
 }
 
@@ -1037,12 +1189,12 @@ bool TPABase::checkLessThanFixedPoint(unsigned short power) {
             solver.insertFormula(
                 logic.mkAnd({logic.mkAnd(rightInvariants), currentLevelTransition, getNextVersion(transition),
                              logic.mkNot(shiftOnlyNextVars(currentLevelTransition))}));
-            auto satres = solver.check();
+            auto satres = SMTSolver::check(solver);
             bool restrictedInvariant = false;
             if (satres != s_False) {
                 solver.push();
                 solver.insertFormula(init);
-                satres = solver.check();
+                satres = SMTSolver::check(solver);
                 if (satres == s_False) { restrictedInvariant = true; }
             }
             if (satres == s_False) {
@@ -1072,12 +1224,12 @@ bool TPABase::checkLessThanFixedPoint(unsigned short power) {
             solver.insertFormula(logic.mkAnd({transition, getNextVersion(logic.mkAnd(leftInvariants)),
                                               getNextVersion(currentLevelTransition),
                                               logic.mkNot(shiftOnlyNextVars(currentLevelTransition))}));
-            auto satres = solver.check();
+            auto satres = SMTSolver::check(solver);
             bool restrictedInvariant = false;
             if (satres != s_False) {
                 solver.push();
                 solver.insertFormula(getNextVersion(query, 2));
-                satres = solver.check();
+                satres = SMTSolver::check(solver);
                 if (satres == s_False) { restrictedInvariant = true; }
             }
             if (satres == s_False) {
@@ -1105,7 +1257,7 @@ bool TPABase::checkLessThanFixedPoint(unsigned short power) {
             solverWrapper.resetSolver();
             auto & solver = solverWrapper.getCoreSolver();
             solver.insertFormula(logic.mkAnd({init, logic.mkAnd(rightInvariants), getNextVersion(query)}));
-            auto satres = solver.check();
+            auto satres = SMTSolver::check(solver);
             if (satres == s_False) {
                 explanation.invariantType = SafetyExplanation::TransitionInvariantType::UNRESTRICTED;
                 explanation.relationType = TPAType::LESS_THAN;
@@ -1120,7 +1272,7 @@ bool TPABase::checkLessThanFixedPoint(unsigned short power) {
             solverWrapper.resetSolver();
             auto & solver = solverWrapper.getCoreSolver();
             solver.insertFormula(logic.mkAnd({init, logic.mkAnd(leftInvariants), getNextVersion(query)}));
-            auto satres = solver.check();
+            auto satres = SMTSolver::check(solver);
             if (satres == s_False) {
                 explanation.invariantType = SafetyExplanation::TransitionInvariantType::UNRESTRICTED;
                 explanation.relationType = TPAType::LESS_THAN;
@@ -1143,19 +1295,19 @@ bool TPASplit::checkExactFixedPoint(unsigned short power) {
         SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
         auto & solver = solverWrapper.getCoreSolver();
         solver.insertFormula(logic.mkAnd({currentTwoStep, logic.mkNot(shifted)}));
-        sstat satres = solver.check();
+        sstat satres = SMTSolver::check(solver);
         char restrictedInvariant = 0;
         if (satres != s_False) {
             solver.push();
             solver.insertFormula(getNextVersion(logic.mkAnd(init, getLessThanPower(i)), -1));
-            satres = solver.check();
+            satres = SMTSolver::check(solver);
             if (satres == s_False) { restrictedInvariant = 1; }
         }
         if (satres != s_False) {
             solver.pop();
             solver.push();
             solver.insertFormula(logic.mkAnd(getNextVersion(getLessThanPower(i), 2), getNextVersion(query, 3)));
-            satres = solver.check();
+            satres = SMTSolver::check(solver);
             if (satres == s_False) { restrictedInvariant = 2; }
         }
         if (satres == s_False) {
@@ -1206,7 +1358,7 @@ bool TPABase::verifyKinductiveInvariant(PTRef fla, unsigned long k) const {
             solver.insertFormula(getNextVersion(transition, i));
         }
         solver.insertFormula(logic.mkNot(getNextVersion(fla, k)));
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res != s_False) {
             std::cerr << "k-induction verification failed; induction step does not hold!" << std::endl;
             return false;
@@ -1220,7 +1372,7 @@ bool TPABase::verifyKinductiveInvariant(PTRef fla, unsigned long k) const {
         for (unsigned long i = 0; i < k; ++i) {
             solver.push();
             solver.insertFormula(logic.mkNot(getNextVersion(fla, i)));
-            auto res = solver.check();
+            auto res = SMTSolver::check(solver);
             if (res != s_False) {
                 std::cerr << "k-induction verification failed; base case " << i << " does not hold!" << std::endl;
                 return false;
@@ -1284,6 +1436,7 @@ VerificationAnswer TPABasic::checkPower(unsigned short power) {
         return VerificationAnswer::UNSAFE;
     } else if (isUnreachable(res)) {
         if (verbose() > 0) { std::cout << "; System is safe up to <=2^" << power + 1 << " steps" << std::endl; }
+        if (auto steps = powerOfTwo(power + 1)) { safeBound = steps; }
         // Check if we have not reached fixed point.
         bool fixedPointReached = checkLessThanFixedPoint(power + 1);
         if (fixedPointReached) { return VerificationAnswer::SAFE; }
@@ -1397,6 +1550,25 @@ void TPABasic::resetPowers() {
     storeLevelTransition(0, logic.mkOr(identity, transition));
 }
 
+std::vector<std::pair<std::string, PTRef>> TPABasic::snapshotPowers() const {
+    std::vector<std::pair<std::string, PTRef>> powers;
+    listLevels(powers, "level", transitionHierarchy);
+    return powers;
+}
+
+bool TPABasic::readPowers(PowerReader const & read, bool verify) {
+    auto levels = readLevels(read, "level");
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        auto power = static_cast<unsigned short>(i + 1);
+        PTRef previous = getLevelTransition(power - 1);
+        if (verify and not overApproximates(levels[i], logic.mkAnd(previous, getNextVersion(previous)))) {
+            return false;
+        }
+        storeLevelTransition(power, levels[i]);
+    }
+    return true;
+}
+
 bool TPABasic::verifyPower(unsigned short power, TPAType relationType) const {
     assert(relationType == TPAType::LESS_THAN);
     (void)relationType;
@@ -1412,7 +1584,7 @@ bool TPABasic::verifyPower(unsigned short level) const {
     solver.insertFormula(logic.mkAnd(previous, getNextVersion(previous)));
     solver.insertFormula(logic.mkNot(shiftOnlyNextVars(current)));
     solver.insertFormula(logic.mkNot(shiftOnlyNextVars(current)));
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     return res == s_False;
 }
 
@@ -1424,7 +1596,7 @@ PTRef TPABase::safeSupersetOfInitialStates(PTRef start, PTRef transitionInvarian
     solver.insertFormula(start);
     solver.insertFormula(transitionInvariant);
     solver.insertFormula(target);
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res != s_False) { throw std::logic_error("SMT query was suppose to be unsat, but is not!"); }
     auto itpContext = solver.getInterpolationContext();
     ipartitions_t mask = (1 << 1) + (1 << 2); // This puts transition + query into the A-part
@@ -1435,6 +1607,12 @@ PTRef TPABase::safeSupersetOfInitialStates(PTRef start, PTRef transitionInvarian
 
 /*
  * Extension for DAG of transition systems
+ *
+ * The network is explored by a depth-first search along the active path. With more than one thread (and arithmetic
+ * logic), every node gets its own solver working in a private logic. Whenever the search reaches new states of a node,
+ * the transition systems of its children are queried speculatively in parallel, and the search then picks the answers
+ * of the queries it actually asks. The solvers only see the shared logic through messages: initial states, restrictions
+ * and explanations are imported when they cross the boundary, and only in the thread running the search.
  */
 
 class TransitionSystemNetworkManager {
@@ -1442,20 +1620,36 @@ class TransitionSystemNetworkManager {
     Logic & logic;
     ChcDirectedGraph const & graph;
     AdjacencyListsGraphRepresentation adjacencyRepresentation;
+    std::size_t threads;
 
 public:
     TransitionSystemNetworkManager(TPAEngine & owner, ChcDirectedGraph const & graph)
         : owner(owner), logic(owner.logic), graph(graph),
-          adjacencyRepresentation(AdjacencyListsGraphRepresentation::from(graph)) {}
+          adjacencyRepresentation(AdjacencyListsGraphRepresentation::from(graph)),
+          threads(owner.options.hasOption(Options::THREADS) ? std::stoul(owner.options.getOption(Options::THREADS))
+                                                             : 1) {}
+
+    ~TransitionSystemNetworkManager() {
+        // Speculative queries still running are not needed anymore
+        for (auto & entry : networkMap) {
+            entry.second.cancelled = true;
+        }
+    }
 
     VerificationResult solve() &&;
 
 private:
     struct NetworkNode {
+        std::unique_ptr<ArithLogic> privateLogic{nullptr}; // Only when the nodes are queried in parallel
+        std::unique_ptr<TermImporter> toPrivate{nullptr};
+        std::unique_ptr<TermImporter> toShared{nullptr};
         std::unique_ptr<TPABase> solver{nullptr};
+        std::future<VerificationAnswer> speculation; // Query of the solver started ahead of the search
+        PTRef speculatedFrom{PTRef_Undef};           // Initial states of the speculative query
+        std::atomic<bool> cancelled{false};
         PTRef trulyReached{PTRef_Undef};
         PTRef trulySafe{PTRef_Undef};
-        PTRef accumulatedRestrictions;
+        std::deque<PTRef> restrictions; // Messages for the solver: states that must be removed from its query
         vec<EId> children;
         int blocked_children;
         vec<EId> parents;
@@ -1465,6 +1659,9 @@ private:
 
     std::unordered_map<SymRef, NetworkNode, SymRefHash> networkMap;
 
+    // Must be declared after the network: the pool must finish all queries before the solvers are destroyed
+    std::unique_ptr<ThreadPool> pool;
+
     struct QueryResult {
         ReachabilityResult reachabilityResult;
         PTRef explanation;
@@ -1474,9 +1671,13 @@ private:
 
     void initNetwork();
 
-    std::unique_ptr<TPABase> mkSolver() const { return owner.mkSolver(); }
+    void initSolver(NetworkNode & node, TransitionSystem const & system);
+
+    TransitionSystem constructTransitionSystemFor(SymRef vid, PTRef init, PTRef query) const;
 
-    TransitionSystem constructTransitionSystemFor(SymRef vid) const;
+    PTRef toSolver(NetworkNode & node, PTRef fla) { return node.toPrivate ? node.toPrivate->import(fla) : fla; }
+
+    PTRef fromSolver(NetworkNode & node, PTRef fla) { return node.toShared ? node.toShared->import(fla) : fla; }
 
     NetworkNode & getNode(SymRef vid) { return networkMap.at(vid); }
     NetworkNode const & getNode(SymRef vid) const { return networkMap.at(vid); }
@@ -1505,28 +1706,86 @@ private:
 
     const vec<EId> & getOutgoingEdges(SymRef vid) const { return getNode(vid).children; }
 
-    PTRef getInitialStates(SymRef vid) const { return networkMap.at(vid).solver->getInit(); }
-
-    PTRef getQueryStates(SymRef vid) const { return networkMap.at(vid).solver->getQuery(); }
-
     QueryResult queryEdge(EId eid, PTRef sourceCondition, PTRef targetCondition);
 
     QueryResult queryTransitionSystem(NetworkNode & node);
 
     InvalidityWitness computeInvalidityWitness() const;
 
+    std::optional<ValidityWitness> computeValidityWitness();
+
+    PTRef reusableInvariant(SymRef vid, PTRef initialStates, PTRef badStates);
+
+    PTRef edgeImage(EId eid, PTRef sourceStates) const;
+
+    PTRef edgePreimage(EId eid, PTRef targetStates) const;
+
     void addRestrictions(SymRef node, PTRef fla);
 
     void updateRestrictions(SymRef node);
+
+    void resetInitialStates(SymRef node, PTRef fla);
+
+    void speculate(SymRef node, PTRef reached);
+
+    void cancelSpeculation(NetworkNode & node);
 };
 
 void TransitionSystemNetworkManager::addRestrictions(SymRef node, PTRef fla) {
-    getNode(node).accumulatedRestrictions = logic.mkAnd(fla, getNode(node).accumulatedRestrictions);
+    getNode(node).restrictions.push_back(fla);
+}
+
+void TransitionSystemNetworkManager::updateRestrictions(SymRef vid) {
+    auto & node = getNode(vid);
+    vec<PTRef> messages;
+    for (PTRef restriction : node.restrictions) {
+        messages.push(restriction);
+    }
+    node.restrictions.clear();
+    cancelSpeculation(node);
+    node.solver->updateQueryStates(toSolver(node, logic.mkAnd(std::move(messages))));
 }
 
-void TransitionSystemNetworkManager::updateRestrictions(SymRef node) {
-    getNode(node).solver->updateQueryStates(getNode(node).accumulatedRestrictions);
-    getNode(node).accumulatedRestrictions = logic.getTerm_true();
+void TransitionSystemNetworkManager::resetInitialStates(SymRef vid, PTRef fla) {
+    auto & node = getNode(vid);
+    // The speculative query already runs from these states
+    if (node.speculation.valid() and node.speculatedFrom == fla) { return; }
+    cancelSpeculation(node);
+    node.solver->resetInitialStates(toSolver(node, fla));
+}
+
+void TransitionSystemNetworkManager::cancelSpeculation(NetworkNode & node) {
+    if (not node.speculation.valid()) { return; }
+    node.cancelled = true;
+    node.speculation.wait();
+    node.cancelled = false;
+    node.speculation = {};
+    node.speculatedFrom = PTRef_Undef;
+}
+
+/*
+ * Queries the transition systems of the children of the node, which are independent of each other, in parallel.
+ * The search continues with the first child and gets to the other children only if the first one turns out to be
+ * blocked; by then, the answers for them are (hopefully) known.
+ */
+void TransitionSystemNetworkManager::speculate(SymRef vid, PTRef reached) {
+    if (not pool) { return; }
+    auto const & node = getNode(vid);
+    std::vector<EId> candidates;
+    for (int i = node.blocked_children; i < node.children.size(); ++i) {
+        if (graph.getTarget(node.children[i]) != graph.getExit()) { candidates.push_back(node.children[i]); }
+    }
+    if (candidates.size() < 2) { return; } // Nothing to do in parallel with the search
+    for (EId edge : candidates) {
+        auto target = graph.getTarget(edge);
+        auto [edgeRes, edgeExplanation] = queryEdge(edge, reached, logic.mkNot(getNode(target).trulySafe));
+        if (not reachable(edgeRes)) { continue; }
+        resetInitialStates(target, edgeExplanation);
+        auto & targetNode = getNode(target);
+        if (targetNode.speculation.valid()) { continue; }
+        targetNode.speculatedFrom = edgeExplanation;
+        targetNode.speculation = pool->submit([&solver = *targetNode.solver]() { return solver.solve(); });
+    }
 }
 
 VerificationResult TPAEngine::solveTransitionSystemGraph(const ChcDirectedGraph & graph) {
@@ -1535,27 +1794,24 @@ VerificationResult TPAEngine::solveTransitionSystemGraph(const ChcDirectedGraph
 
 void TransitionSystemNetworkManager::initNetwork() {
     assert(networkMap.empty());
+    if (threads > 1 and dynamic_cast<ArithLogic *>(&logic)) { pool = std::make_unique<ThreadPool>(threads); }
     for (auto vid : graph.getVertices()) {
-        if (vid == graph.getEntry() or vid == graph.getExit()) {
-            networkMap.insert({vid, NetworkNode()});
-            continue;
-        }
-        networkMap.insert({vid, NetworkNode()});
-        auto & node = networkMap.at(vid);
-        node.solver = mkSolver();
+        // Nodes are constructed in place, they are not movable
+        auto & node = networkMap.try_emplace(vid).first->second;
+        if (vid == graph.getEntry() or vid == graph.getExit()) { continue; }
         node.blocked_children = 0;
-        TransitionSystem ts = constructTransitionSystemFor(vid);
-        node.solver->resetTransitionSystem(ts);
+        TransitionSystem ts = constructTransitionSystemFor(vid, logic.getTerm_true(), logic.getTerm_true());
+        initSolver(node, ts);
         node.trulySafe = logic.getTerm_false();
     }
     TimeMachine tm(logic);
     for (EId eid : adjacencyRepresentation.getOutgoingEdgesFor(graph.getEntry())) {
         auto target = graph.getTarget(eid);
-        getNode(target).solver->resetInitialStates(logic.getTerm_true());
+        resetInitialStates(target, logic.getTerm_true());
     }
     for (EId eid : adjacencyRepresentation.getIncomingEdgesFor(graph.getExit())) {
-        auto source = graph.getSource(eid);
-        networkMap.at(source).solver->updateQueryStates(logic.getTerm_true());
+        auto & source = getNode(graph.getSource(eid));
+        source.solver->updateQueryStates(toSolver(source, logic.getTerm_true()));
     }
     // Connect the network
     for (auto vid : reversePostOrder(graph, adjacencyRepresentation)) {
@@ -1583,14 +1839,22 @@ void TransitionSystemNetworkManager::initNetwork() {
 }
 
 VerificationResult TransitionSystemNetworkManager::solve() && {
+    ScopedTimer timer("engine.tpa-network");
     initNetwork();
     auto current = graph.getEntry();
     activePath.clear();
     while (true) {
+        ResourceGovernor::checkpoint();
         if (getNode(current).blocked_children == getNode(current).children.size()) {
             if (current == graph.getEntry()) {
-                // TODO: Compute witness
-                return {VerificationAnswer::SAFE, NoWitness{"Unable to compute witness from TPA for DAG of TSs yet"}};
+                if (not owner.options.hasOption(Options::COMPUTE_WITNESS)) {
+                    return VerificationResult(VerificationAnswer::SAFE);
+                }
+                auto witness = computeValidityWitness();
+                if (not witness) {
+                    return {VerificationAnswer::SAFE, NoWitness{"Unable to compute witness from TPA for DAG of TSs"}};
+                }
+                return {VerificationAnswer::SAFE, std::move(witness.value())};
             }
             getNode(current).trulyReached = PTRef_Undef;
             getNode(current).blocked_children = 0;
@@ -1598,6 +1862,7 @@ VerificationResult TransitionSystemNetworkManager::solve() && {
         }
         if (current == graph.getEntry()) {
             getNode(current).trulyReached = logic.getTerm_true();
+            speculate(current, logic.getTerm_true());
             while (getNode(current).blocked_children < getNode(current).children.size()) {
                 EId nextEdge = getOutgoingEdge(current, getNode(current).blocked_children);
                 PTRef nextConditions = logic.getTerm_true();
@@ -1611,7 +1876,7 @@ VerificationResult TransitionSystemNetworkManager::solve() && {
                         return {VerificationAnswer::UNSAFE, computeInvalidityWitness()};
                     }
                     auto next = graph.getTarget(nextEdge);
-                    networkMap.at(next).solver->resetInitialStates(edgeExplanation);
+                    resetInitialStates(next, edgeExplanation);
                     activePath.push(nextEdge);
                     current = next;
                     break; // Information has been propagated to the next node, switch to the new node
@@ -1623,9 +1888,11 @@ VerificationResult TransitionSystemNetworkManager::solve() && {
             }
             continue;
         }
+        Statistics::increment("tpa-network.queries");
         auto [res, explanation] = queryTransitionSystem(networkMap.at(current));
         if (reachable(res)) {
             getNode(current).trulyReached = explanation;
+            speculate(current, explanation);
             while (getNode(current).blocked_children < getNode(current).children.size()) {
                 EId nextEdge = getOutgoingEdge(current, getNode(current).blocked_children);
                 PTRef nextConditions = logic.getTerm_true();
@@ -1639,7 +1906,7 @@ VerificationResult TransitionSystemNetworkManager::solve() && {
                         return {VerificationAnswer::UNSAFE, computeInvalidityWitness()};
                     }
                     auto next = graph.getTarget(nextEdge);
-                    networkMap.at(next).solver->resetInitialStates(edgeExplanation);
+                    resetInitialStates(next, edgeExplanation);
                     activePath.push(nextEdge);
                     current = next;
                     break; // Information has been propagated to the next node, switch to the new node
@@ -1658,7 +1925,7 @@ VerificationResult TransitionSystemNetworkManager::solve() && {
             PTRef updatedConditions = logic.mkNot(getNode(current).trulySafe);
             auto [edgeRes, edgeExplanation] = queryEdge(previousEdge, previousNode.trulyReached, updatedConditions);
             if (reachable(edgeRes)) { // New reached, not refuted yet, states
-                getNode(current).solver->resetInitialStates(edgeExplanation);
+                resetInitialStates(current, edgeExplanation);
                 continue; // Repeat the query for the same TS with new initial states
             } else {      // Cannot continue from currently computed truly reached states
                 previousNode.trulyReached = PTRef_Undef;
@@ -1691,13 +1958,137 @@ InvalidityWitness TransitionSystemNetworkManager::computeInvalidityWitness() con
     return InvalidityWitness::fromErrorPath(path, graph);
 }
 
-TransitionSystem TransitionSystemNetworkManager::constructTransitionSystemFor(SymRef vid) const {
+void TransitionSystemNetworkManager::initSolver(NetworkNode & node, TransitionSystem const & system) {
+    if (not pool) {
+        node.solver = owner.mkSolver();
+        node.solver->resetTransitionSystem(system);
+        return;
+    }
+    auto & arithLogic = dynamic_cast<ArithLogic &>(logic);
+    auto const logicType = arithLogic.hasReals() ? opensmt::Logic_t::QF_LRA : opensmt::Logic_t::QF_LIA;
+    node.privateLogic = std::make_unique<ArithLogic>(logicType);
+    node.toPrivate = std::make_unique<TermImporter>(arithLogic, *node.privateLogic);
+    node.toShared = std::make_unique<TermImporter>(*node.privateLogic, arithLogic);
+    auto exportVars = [&](std::vector<PTRef> vars) {
+        for (PTRef & var : vars) {
+            var = toSolver(node, var);
+        }
+        return vars;
+    };
+    auto systemType = std::make_unique<SystemType>(exportVars(system.getStateVars()),
+                                                   exportVars(system.getAuxiliaryVars()), *node.privateLogic);
+    TransitionSystem privateSystem(*node.privateLogic, std::move(systemType), toSolver(node, system.getInit()),
+                                   toSolver(node, system.getTransition()), toSolver(node, system.getQuery()));
+    node.solver = owner.mkSolver(*node.privateLogic);
+    node.solver->setInterruptFlag(&node.cancelled);
+    node.solver->resetTransitionSystem(privateSystem);
+}
+
+/*
+ * The invariants of the nodes are computed in topological order. The initial states of a node are the images of the
+ * invariants of its parents. Its bad states are those leaving to the exit or to the states of a child that have not
+ * been proven safe by the search. Then the invariants of the parents, and with them the initial states of the children,
+ * stay within the safe states of the children, and the edges between the nodes are consistent with the invariants
+ * by construction. The invariant found by the solver of the node during the search is used if it fits these initial
+ * and bad states; only otherwise the transition system of the node is solved again.
+ */
+std::optional<ValidityWitness> TransitionSystemNetworkManager::computeValidityWitness() {
+    std::unordered_map<SymRef, PTRef, SymRefHash> invariants;
+    for (auto vid : reversePostOrder(graph, adjacencyRepresentation)) {
+        if (vid == graph.getEntry() or vid == graph.getExit()) { continue; }
+        vec<PTRef> initialStates;
+        for (EId eid : getIncomingEdges(vid)) {
+            auto source = graph.getSource(eid);
+            PTRef sourceStates = source == graph.getEntry() ? logic.getTerm_true() : invariants.at(source);
+            initialStates.push(edgeImage(eid, sourceStates));
+        }
+        vec<PTRef> badStates;
+        for (EId eid : getOutgoingEdges(vid)) {
+            auto target = graph.getTarget(eid);
+            PTRef targetStates =
+                target == graph.getExit() ? logic.getTerm_true() : logic.mkNot(getNode(target).trulySafe);
+            badStates.push(edgePreimage(eid, targetStates));
+        }
+        PTRef init = logic.mkOr(std::move(initialStates));
+        PTRef bad = logic.mkOr(std::move(badStates));
+        PTRef invariant = reusableInvariant(vid, init, bad);
+        if (invariant != PTRef_Undef) {
+            Statistics::increment("tpa-network.invariants-reused");
+            invariants.insert({vid, invariant});
+            continue;
+        }
+        Statistics::increment("tpa-network.invariants-recomputed");
+        auto system = constructTransitionSystemFor(vid, init, bad);
+        auto solver = owner.mkSolver();
+        if (solver->solveTransitionSystem(system) != VerificationAnswer::SAFE) { return std::nullopt; }
+        invariant = solver->getInductiveInvariant();
+        if (invariant == PTRef_Undef) { return std::nullopt; }
+        invariants.insert({vid, invariant});
+    }
+    TermUtils utils(logic);
+    TimeMachine timeMachine(logic);
+    ValidityWitness::definitions_t definitions;
+    for (auto const & [vid, invariant] : invariants) {
+        TermUtils::substitutions_map subs;
+        vec<PTRef> unversionedVars;
+        for (PTRef var : utils.predicateArgsInOrder(graph.getStateVersion(vid))) {
+            unversionedVars.push(timeMachine.getUnversioned(var));
+            subs.insert({var, unversionedVars.last()});
+        }
+        PTRef unversionedPredicate = logic.mkUninterpFun(vid, std::move(unversionedVars));
+        definitions.insert({unversionedPredicate, utils.varSubstitute(invariant, subs)});
+    }
+    return ValidityWitness(std::move(definitions));
+}
+
+/*
+ * Returns the inductive invariant of the last query of the node if it contains the given initial states and excludes
+ * the given bad states; returns PTRef_Undef otherwise.
+ */
+PTRef TransitionSystemNetworkManager::reusableInvariant(SymRef vid, PTRef initialStates, PTRef badStates) {
+    auto & node = getNode(vid);
+    cancelSpeculation(node);
+    if (not node.solver->hasSafetyExplanation()) { return PTRef_Undef; }
+    PTRef invariant = node.solver->getInductiveInvariant();
+    if (invariant == PTRef_Undef) { return PTRef_Undef; }
+    invariant = fromSolver(node, invariant);
+    PTRef loopLabel = graph.getEdgeLabel(getSelfLoopFor(vid, graph, adjacencyRepresentation).value());
+    PTRef nextInvariant = TimeMachine(logic).sendFlaThroughTime(invariant, 1);
+    auto unsatisfiable = [&](PTRef fla) {
+        SMTSolver solver(logic, SMTSolver::WitnessProduction::NONE);
+        solver.getCoreSolver().insertFormula(fla);
+        return solver.check() == s_False;
+    };
+    bool fits = unsatisfiable(logic.mkAnd(initialStates, logic.mkNot(invariant))) and
+                unsatisfiable(logic.mkAnd({invariant, loopLabel, logic.mkNot(nextInvariant)})) and
+                unsatisfiable(logic.mkAnd(invariant, badStates));
+    return fits ? invariant : PTRef_Undef;
+}
+
+// States of the target reachable by the edge from the given states of the source
+PTRef TransitionSystemNetworkManager::edgeImage(EId eid, PTRef sourceStates) const {
+    PTRef label = graph.getEdgeLabel(eid);
+    auto targetVars = TermUtils(logic).predicateArgsInOrder(graph.getNextStateVersion(graph.getTarget(eid)));
+    PTRef image = QuantifierElimination(logic).keepOnly(logic.mkAnd(sourceStates, label), targetVars);
+    return TimeMachine(logic).sendFlaThroughTime(image, -1);
+}
+
+// States of the source from which the edge leads to the given states of the target
+PTRef TransitionSystemNetworkManager::edgePreimage(EId eid, PTRef targetStates) const {
+    PTRef label = graph.getEdgeLabel(eid);
+    PTRef target = TimeMachine(logic).sendFlaThroughTime(targetStates, 1);
+    auto sourceVars = TermUtils(logic).predicateArgsInOrder(graph.getStateVersion(graph.getSource(eid)));
+    return QuantifierElimination(logic).keepOnly(logic.mkAnd(label, target), sourceVars);
+}
+
+TransitionSystem TransitionSystemNetworkManager::constructTransitionSystemFor(SymRef vid, PTRef init,
+                                                                              PTRef query) const {
     EId loopEdge = getSelfLoopFor(vid, graph, adjacencyRepresentation).value();
     auto edgeVars = getVariablesFromEdge(logic, graph, loopEdge);
     auto systemType = std::make_unique<SystemType>(edgeVars.stateVars, edgeVars.auxiliaryVars, logic);
     PTRef loopLabel = graph.getEdgeLabel(loopEdge);
     PTRef transitionFla = transitionFormulaInSystemType(*systemType, edgeVars, loopLabel, logic);
-    return TransitionSystem(logic, std::move(systemType), logic.getTerm_true(), transitionFla, logic.getTerm_true());
+    return TransitionSystem(logic, std::move(systemType), init, transitionFla, query);
 }
 
 TransitionSystemNetworkManager::QueryResult TransitionSystemNetworkManager::queryEdge(EId eid, PTRef sourceCondition,
@@ -1713,7 +2104,7 @@ TransitionSystemNetworkManager::QueryResult TransitionSystemNetworkManager::quer
     solver.insertFormula(sourceCondition);
     solver.insertFormula(label);
     solver.insertFormula(target);
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res == s_True) {
         auto model = solver.getModel();
         ModelBasedProjection mbp(logic);
@@ -1738,17 +2129,18 @@ TransitionSystemNetworkManager::QueryResult TransitionSystemNetworkManager::quer
 }
 
 TransitionSystemNetworkManager::QueryResult TransitionSystemNetworkManager::queryTransitionSystem(NetworkNode & node) {
-    auto res = node.solver->solve();
+    auto res = node.speculation.valid() ? node.speculation.get() : node.solver->solve();
+    node.speculatedFrom = PTRef_Undef;
     assert(res != VerificationAnswer::UNKNOWN);
     switch (res) {
         case VerificationAnswer::UNSAFE: {
-            PTRef explanation = node.solver->getReachedStates();
+            PTRef explanation = fromSolver(node, node.solver->getReachedStates());
             assert(explanation != PTRef_Undef);
             TRACE(1, "TS propagates reachable states to " << logic.pp(explanation))
             return {ReachabilityResult::REACHABLE, explanation};
         }
         case VerificationAnswer::SAFE: {
-            PTRef explanation = node.solver->getSafetyExplanation();
+            PTRef explanation = fromSolver(node, node.solver->getSafetyExplanation());
             assert(explanation != PTRef_Undef);
             TRACE(1, "TS blocks " << logic.pp(explanation))
             return {ReachabilityResult::UNREACHABLE, explanation};
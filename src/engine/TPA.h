@@ -8,6 +8,15 @@
 #define GOLEM_TPA_H
 
 #include "Engine.h"
+#include "Houdini.h"
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class TransitionSystem;
 
@@ -43,7 +52,8 @@ public:
 private:
     VerificationResult solve(const ChcDirectedGraph & system);
 
-    std::unique_ptr<TPABase> mkSolver();
+    std::unique_ptr<TPABase> mkSolver() { return mkSolver(logic); }
+    std::unique_ptr<TPABase> mkSolver(Logic & solverLogic);
 
     VerificationResult solveTransitionSystemGraph(ChcDirectedGraph const & graph);
 
@@ -82,6 +92,8 @@ protected:
     bool useQE = false;
     SafetyExplanation explanation;
     ReachedStates reachedStates;
+    std::optional<std::size_t> safeBound;
+    std::atomic<bool> const * interrupt{nullptr};
 
     // Versioned representation of the transition system
     PTRef init;
@@ -91,6 +103,8 @@ protected:
     vec<PTRef> auxiliaryVariables;
     vec<PTRef> leftInvariants;
     vec<PTRef> rightInvariants;
+    std::unique_ptr<Houdini> leftHoudini;
+    std::unique_ptr<Houdini> rightHoudini;
 
     PTRef identity{PTRef_Undef};
 
@@ -112,6 +126,12 @@ public:
 
     void updateQueryStates(PTRef);
 
+    /**
+     * The flag is checked before each power is explored. Once it is set, solve() gives up and returns UNKNOWN.
+     * The learnt powers are kept, the solver can be queried again after the flag is cleared.
+     */
+    void setInterruptFlag(std::atomic<bool> const * flag) { interrupt = flag; }
+
     PTRef getInit() const;
     PTRef getTransitionRelation() const;
     PTRef getQuery() const;
@@ -125,6 +145,15 @@ public:
     PTRef getReachedStates() const;
     unsigned getTransitionStepCount() const;
     PTRef getInductiveInvariant() const;
+    /** Returns true if the last call to solve() proved the current system safe */
+    bool hasSafetyExplanation() const {
+        return explanation.invariantType != SafetyExplanation::TransitionInvariantType::NONE;
+    }
+    /**
+     * Number of transitions up to which the current system is known to be safe, if solving has been interrupted.
+     * Split TPA rules out fewer than 2^{n+1} transitions at power n, basic TPA at most 2^{n+1} transitions.
+     */
+    std::optional<std::size_t> getSafeBound() const { return safeBound; }
 
 protected:
     virtual VerificationAnswer checkPower(unsigned short power) = 0;
@@ -134,6 +163,29 @@ protected:
     virtual PTRef getPower(unsigned short power, TPAType relationType) const = 0;
     virtual bool verifyPower(unsigned short power, TPAType relationType) const = 0;
 
+    /*
+     * Snapshots of the learnt powers, enabled by option TPA_SNAPSHOT_DIR.
+     * The snapshot is a directory keyed by the state variables of the system, with one file for the transition
+     * relation and one for each power. The powers are restored when the system is reset; after each explored power,
+     * only the powers that have changed since the last save are written. Powers learnt for a different transition
+     * relation are restored only as long as they can be verified to over-approximate the powers of the current
+     * transition relation.
+     */
+    using PowerReader = std::function<PTRef(std::string const &)>; // Returns PTRef_Undef for a missing power
+    virtual std::string_view snapshotKind() const = 0;
+    /* The learnt powers (without level 0) by the names of their files */
+    virtual std::vector<std::pair<std::string, PTRef>> snapshotPowers() const = 0;
+    /* Returns false if some power has been rejected by the verification */
+    virtual bool readPowers(PowerReader const & read, bool verify) = 0;
+
+    std::string snapshotDirectory() const;
+    void saveSnapshot() const;
+    void restoreSnapshot();
+    mutable std::unordered_map<std::string, PTRef> savedPowers; // Contents of the snapshot by the names of the files
+
+    /* Checks that the two-step relation (over current, next and next-next vars) implies the candidate power */
+    bool overApproximates(PTRef candidate, PTRef twoStepRelation) const;
+
     struct QueryResult {
         ReachabilityResult result;
         PTRef refinedTarget{PTRef_Undef};
@@ -221,6 +273,10 @@ private:
     PTRef getPower(unsigned short power, TPAType relationType) const override;
     bool verifyPower(unsigned short power, TPAType relationType) const override;
 
+    std::string_view snapshotKind() const override { return "split"; }
+    std::vector<std::pair<std::string, PTRef>> snapshotPowers() const override;
+    bool readPowers(PowerReader const & read, bool verify) override;
+
     PTRef getExactPower(unsigned short power) const;
     void storeExactPower(unsigned short power, PTRef tr);
 
@@ -257,6 +313,10 @@ private:
     PTRef getPower(unsigned short power, TPAType relationType) const override;
     bool verifyPower(unsigned short power, TPAType relationType) const override;
 
+    std::string_view snapshotKind() const override { return "basic"; }
+    std::vector<std::pair<std::string, PTRef>> snapshotPowers() const override;
+    bool readPowers(PowerReader const & read, bool verify) override;
+
     PTRef getLevelTransition(unsigned short) const;
     void storeLevelTransition(unsigned short, PTRef);
 
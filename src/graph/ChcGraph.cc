@@ -6,6 +6,7 @@
 
 #include "ChcGraph.h"
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 
@@ -538,6 +539,17 @@ bool isSimpleNode(
     return incoming.size() == 1 or outgoing.size() == 1;
 }
 
+std::unique_ptr<ChcDirectedHyperGraph>
+ChcDirectedHyperGraph::withEdgeIds(std::vector<DirectedHyperEdge> const & edges,
+                                   NonlinearCanonicalPredicateRepresentation predicates, Logic & logic) {
+    auto graph = std::make_unique<ChcDirectedHyperGraph>(std::vector<DirectedHyperEdge>{}, std::move(predicates), logic);
+    for (auto const & edge : edges) {
+        graph->edges.emplace(edge.id, edge);
+        graph->freeId = std::max(graph->freeId, edge.id.id + 1);
+    }
+    return graph;
+}
+
 std::unique_ptr<ChcDirectedHyperGraph> ChcDirectedHyperGraph::makeEmpty(Logic & logic) {
     NonlinearCanonicalPredicateRepresentation predicateRepresentation(logic);
     predicateRepresentation.addRepresentation(logic.getSym_true(), {});
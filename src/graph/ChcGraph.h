@@ -223,6 +223,14 @@ public:
 
     static std::unique_ptr<ChcDirectedHyperGraph> makeEmpty(Logic & logic);
 
+    /*
+     * Creates a graph with the given edges, keeping their identifiers (unlike the constructor, which assigns new ones).
+     * Used when restoring a graph from its serialized form.
+     */
+    static std::unique_ptr<ChcDirectedHyperGraph> withEdgeIds(std::vector<DirectedHyperEdge> const & edges,
+                                                              NonlinearCanonicalPredicateRepresentation predicates,
+                                                              Logic & logic);
+
     struct VertexContractionResult {
         std::vector<DirectedHyperEdge> incoming;
         std::vector<DirectedHyperEdge> outgoing;
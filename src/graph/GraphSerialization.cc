@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "GraphSerialization.h"
+
+#include "transformers/ConstraintSimplifier.h"
+#include "transformers/MultiEdgeMerger.h"
+#include "transformers/NodeEliminator.h"
+#include "transformers/RemoveUnreachableNodes.h"
+#include "transformers/SimpleChainSummarizer.h"
+#include "transformers/TransformationPipeline.h"
+
+#include <algorithm>
+
+namespace {
+enum class SortCode : std::uint8_t { BOOL = 0, INT = 1, REAL = 2 };
+
+enum class SymbolCode : std::uint8_t { TRUE = 0, FALSE = 1, PREDICATE = 2 };
+
+enum class TermCode : std::uint8_t { TRUE = 0, FALSE = 1, NUMBER = 2, VARIABLE = 3, PREDICATE = 4, INTERPRETED = 5 };
+
+void writeVarint(std::string & out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void writeBytes(std::string & out, std::string_view str) {
+    writeVarint(out, str.size());
+    out.append(str.data(), str.size());
+}
+
+void malformed() {
+    throw std::logic_error("Malformed serialized CHC graph");
+}
+} // namespace
+
+/********************** SERIALIZER ****************************/
+
+void GraphSerializer::writeSort(std::string & out, SRef sort) const {
+    auto & arithLogic = dynamic_cast<ArithLogic &>(logic);
+    SortCode code;
+    if (sort == arithLogic.getSort_bool()) {
+        code = SortCode::BOOL;
+    } else if (sort == arithLogic.getSort_int()) {
+        code = SortCode::INT;
+    } else if (sort == arithLogic.getSort_real()) {
+        code = SortCode::REAL;
+    } else {
+        throw std::logic_error("Unsupported sort in serialization of CHC graph");
+    }
+    out.push_back(static_cast<char>(code));
+}
+
+std::uint64_t GraphSerializer::symbolIndex(SymRef sym) {
+    auto it = symbolIndices.find(sym);
+    if (it != symbolIndices.end()) { return it->second; }
+    if (sym == logic.getSym_true()) {
+        symbols.push_back(static_cast<char>(SymbolCode::TRUE));
+    } else if (sym == logic.getSym_false()) {
+        symbols.push_back(static_cast<char>(SymbolCode::FALSE));
+    } else {
+        auto const & symbol = logic.getSym(sym);
+        symbols.push_back(static_cast<char>(SymbolCode::PREDICATE));
+        writeBytes(symbols, logic.getSymName(sym));
+        writeVarint(symbols, symbol.nargs());
+        for (SRef argSort : symbol) {
+            writeSort(symbols, argSort);
+        }
+    }
+    auto index = symbolIndices.size();
+    symbolIndices.insert({sym, index});
+    return index;
+}
+
+void GraphSerializer::writeTermEntry(PTRef term) {
+    auto & arithLogic = dynamic_cast<ArithLogic &>(logic);
+    if (term == logic.getTerm_true()) {
+        terms.push_back(static_cast<char>(TermCode::TRUE));
+    } else if (term == logic.getTerm_false()) {
+        terms.push_back(static_cast<char>(TermCode::FALSE));
+    } else if (arithLogic.isNumConst(term)) {
+        terms.push_back(static_cast<char>(TermCode::NUMBER));
+        writeSort(terms, logic.getSortRef(term));
+        writeBytes(terms, arithLogic.getNumConst(term).get_str());
+    } else if (logic.isVar(term)) {
+        terms.push_back(static_cast<char>(TermCode::VARIABLE));
+        writeSort(terms, logic.getSortRef(term));
+        writeBytes(terms, logic.getSymName(term));
+    } else {
+        auto const & pterm = logic.getPterm(term);
+        if (logic.isUP(term)) {
+            terms.push_back(static_cast<char>(TermCode::PREDICATE));
+            writeVarint(terms, symbolIndex(pterm.symb()));
+        } else {
+            terms.push_back(static_cast<char>(TermCode::INTERPRETED));
+            writeBytes(terms, logic.getSymName(term));
+        }
+        writeVarint(terms, pterm.size());
+        for (PTRef arg : pterm) {
+            writeVarint(terms, termIndices.at(arg));
+        }
+    }
+    auto index = termIndices.size();
+    termIndices.insert({term, index});
+}
+
+std::uint64_t GraphSerializer::termIndex(PTRef root) {
+    auto it = termIndices.find(root);
+    if (it != termIndices.end()) { return it->second; }
+    // Iterative post-order traversal, arguments must be stored before the term itself
+    struct QueueEntry {
+        PTRef term;
+        bool argsProcessed;
+    };
+    std::vector<QueueEntry> queue;
+    queue.push_back({root, false});
+    while (not queue.empty()) {
+        auto & entry = queue.back();
+        if (termIndices.count(entry.term) > 0) {
+            queue.pop_back();
+            continue;
+        }
+        if (not entry.argsProcessed and not logic.isVar(entry.term)) {
+            entry.argsProcessed = true;
+            PTRef term = entry.term; // Pushing to the queue invalidates the reference
+            for (PTRef arg : logic.getPterm(term)) {
+                if (termIndices.count(arg) == 0) { queue.push_back({arg, false}); }
+            }
+            continue;
+        }
+        PTRef term = entry.term;
+        queue.pop_back();
+        writeTermEntry(term);
+    }
+    return termIndices.at(root);
+}
+
+void GraphSerializer::writeUnsigned(std::uint64_t value) {
+    writeVarint(data, value);
+}
+
+void GraphSerializer::writeString(std::string_view str) {
+    writeBytes(data, str);
+}
+
+void GraphSerializer::writeTerm(PTRef term) {
+    writeVarint(data, termIndex(term));
+}
+
+void GraphSerializer::writeSymbol(SymRef sym) {
+    writeVarint(data, symbolIndex(sym));
+}
+
+void GraphSerializer::writeSymbols(std::vector<SymRef> const & syms) {
+    writeUnsigned(syms.size());
+    for (SymRef sym : syms) {
+        writeSymbol(sym);
+    }
+}
+
+void GraphSerializer::writeEdge(DirectedHyperEdge const & edge) {
+    writeUnsigned(edge.id.id);
+    writeSymbols(edge.from);
+    writeSymbol(edge.to);
+    writeTerm(edge.fla.fla);
+}
+
+void GraphSerializer::writeEdges(std::vector<DirectedHyperEdge> const & edges) {
+    writeUnsigned(edges.size());
+    for (auto const & edge : edges) {
+        writeEdge(edge);
+    }
+}
+
+void GraphSerializer::writeRepresentation(NonlinearCanonicalPredicateRepresentation const & representation) {
+    // Sort the entries so that the output does not depend on the order of the hash map
+    std::vector<std::pair<SymRef, std::vector<PTRef> const *>> entries;
+    representation.forEachRepresentation([&](SymRef sym, std::vector<PTRef> const & vars) {
+        entries.emplace_back(sym, &vars);
+    });
+    std::sort(entries.begin(), entries.end(), [](auto const & first, auto const & second) {
+        return first.first.x < second.first.x;
+    });
+    writeUnsigned(entries.size());
+    for (auto const & [sym, vars] : entries) {
+        writeSymbol(sym);
+        writeUnsigned(vars->size());
+        for (PTRef var : *vars) {
+            writeTerm(var);
+        }
+    }
+}
+
+void GraphSerializer::writeGraph(ChcDirectedHyperGraph const & graph) {
+    writeRepresentation(graph.predicateRepresentation());
+    writeEdges(graph.getEdges());
+}
+
+bool GraphSerializer::writeBackTranslator(WitnessBackTranslator const & translator) {
+    return translator.serialize(*this);
+}
+
+std::string GraphSerializer::finish() const {
+    std::string result;
+    result.reserve(symbols.size() + terms.size() + data.size() + 20);
+    writeVarint(result, symbolIndices.size());
+    result.append(symbols);
+    writeVarint(result, termIndices.size());
+    result.append(terms);
+    result.append(data);
+    return result;
+}
+
+/********************** DESERIALIZER ****************************/
+
+GraphDeserializer::GraphDeserializer(Logic & logic, std::string_view input)
+    : logic(logic), position(input.data()), end(input.data() + input.size()) {
+    readSymbolTable();
+    readTermTable();
+}
+
+std::uint64_t GraphDeserializer::readUnsigned() {
+    std::uint64_t value = 0;
+    unsigned shift = 0;
+    while (true) {
+        if (position == end or shift > 63) { malformed(); }
+        auto byte = static_cast<std::uint8_t>(*position++);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) { return value; }
+        shift += 7;
+    }
+}
+
+std::string GraphDeserializer::readString() {
+    auto length = readUnsigned();
+    if (static_cast<std::uint64_t>(end - position) < length) { malformed(); }
+    std::string result(position, length);
+    position += length;
+    return result;
+}
+
+SRef GraphDeserializer::readSort() {
+    auto & arithLogic = dynamic_cast<ArithLogic &>(logic);
+    if (position == end) { malformed(); }
+    switch (static_cast<SortCode>(*position++)) {
+        case SortCode::BOOL:
+            return arithLogic.getSort_bool();
+        case SortCode::INT:
+            return arithLogic.getSort_int();
+        case SortCode::REAL:
+            return arithLogic.getSort_real();
+    }
+    malformed();
+    return SRef_Undef;
+}
+
+void GraphDeserializer::readSymbolTable() {
+    auto count = readUnsigned();
+    symbols.reserve(count);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (position == end) { malformed(); }
+        switch (static_cast<SymbolCode>(*position++)) {
+            case SymbolCode::TRUE:
+                symbols.push_back(logic.getSym_true());
+                break;
+            case SymbolCode::FALSE:
+                symbols.push_back(logic.getSym_false());
+                break;
+            case SymbolCode::PREDICATE: {
+                auto name = readString();
+                auto arity = readUnsigned();
+                vec<SRef> argSorts;
+                for (std::uint64_t j = 0; j < arity; ++j) {
+                    argSorts.push(readSort());
+                }
+                symbols.push_back(logic.declareFun(name, logic.getSort_bool(), argSorts));
+                break;
+            }
+            default:
+                malformed();
+        }
+    }
+}
+
+void GraphDeserializer::readTermTable() {
+    auto & arithLogic = dynamic_cast<ArithLogic &>(logic);
+    auto count = readUnsigned();
+    terms.reserve(count);
+    auto readArgs = [this]() {
+        auto arity = readUnsigned();
+        vec<PTRef> args;
+        for (std::uint64_t j = 0; j < arity; ++j) {
+            auto index = readUnsigned();
+            if (index >= terms.size()) { malformed(); }
+            args.push(terms[index]);
+        }
+        return args;
+    };
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (position == end) { malformed(); }
+        switch (static_cast<TermCode>(*position++)) {
+            case TermCode::TRUE:
+                terms.push_back(logic.getTerm_true());
+                break;
+            case TermCode::FALSE:
+                terms.push_back(logic.getTerm_false());
+                break;
+            case TermCode::NUMBER: {
+                SRef sort = readSort();
+                auto value = readString();
+                terms.push_back(arithLogic.mkConst(sort, FastRational(value.c_str())));
+                break;
+            }
+            case TermCode::VARIABLE: {
+                SRef sort = readSort();
+                auto name = readString();
+                terms.push_back(logic.mkVar(sort, name.c_str()));
+                break;
+            }
+            case TermCode::PREDICATE: {
+                auto index = readUnsigned();
+                if (index >= symbols.size()) { malformed(); }
+                terms.push_back(logic.insertTerm(symbols[index], readArgs()));
+                break;
+            }
+            case TermCode::INTERPRETED: {
+                auto name = readString();
+                terms.push_back(logic.resolveTerm(name.c_str(), readArgs()));
+                break;
+            }
+            default:
+                malformed();
+        }
+    }
+}
+
+PTRef GraphDeserializer::readTerm() {
+    auto index = readUnsigned();
+    if (index >= terms.size()) { malformed(); }
+    return terms[index];
+}
+
+SymRef GraphDeserializer::readSymbol() {
+    auto index = readUnsigned();
+    if (index >= symbols.size()) { malformed(); }
+    return symbols[index];
+}
+
+std::vector<SymRef> GraphDeserializer::readSymbols() {
+    auto count = readUnsigned();
+    std::vector<SymRef> result;
+    result.reserve(count);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        result.push_back(readSymbol());
+    }
+    return result;
+}
+
+DirectedHyperEdge GraphDeserializer::readEdge() {
+    EId eid{static_cast<std::size_t>(readUnsigned())};
+    auto from = readSymbols();
+    SymRef to = readSymbol();
+    PTRef fla = readTerm();
+    return DirectedHyperEdge{.from = std::move(from), .to = to, .fla = InterpretedFla{fla}, .id = eid};
+}
+
+std::vector<DirectedHyperEdge> GraphDeserializer::readEdges() {
+    auto count = readUnsigned();
+    std::vector<DirectedHyperEdge> result;
+    result.reserve(count);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        result.push_back(readEdge());
+    }
+    return result;
+}
+
+NonlinearCanonicalPredicateRepresentation GraphDeserializer::readRepresentation() {
+    NonlinearCanonicalPredicateRepresentation representation(logic);
+    auto count = readUnsigned();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        SymRef sym = readSymbol();
+        auto varCount = readUnsigned();
+        std::vector<PTRef> vars;
+        vars.reserve(varCount);
+        for (std::uint64_t j = 0; j < varCount; ++j) {
+            vars.push_back(readTerm());
+        }
+        if (representation.hasRepresentationFor(sym)) { malformed(); }
+        representation.addRepresentation(sym, std::move(vars));
+    }
+    return representation;
+}
+
+std::unique_ptr<ChcDirectedHyperGraph> GraphDeserializer::readGraph() {
+    auto representation = readRepresentation();
+    auto edges = readEdges();
+    return ChcDirectedHyperGraph::withEdgeIds(edges, std::move(representation), logic);
+}
+
+std::unique_ptr<WitnessBackTranslator> GraphDeserializer::readBackTranslator() {
+    auto tag = readString();
+    if (tag == ConstraintSimplifier::BackTranslator::serializationTag) {
+        return std::make_unique<ConstraintSimplifier::BackTranslator>();
+    } else if (tag == SimpleChainSummarizer::BackTranslator::serializationTag) {
+        return SimpleChainSummarizer::BackTranslator::deserialize(*this, logic);
+    } else if (tag == RemoveUnreachableNodes::BackTranslator::serializationTag) {
+        return RemoveUnreachableNodes::BackTranslator::deserialize(*this, logic);
+    } else if (tag == NodeEliminator::BackTranslator::serializationTag) {
+        return NodeEliminator::BackTranslator::deserialize(*this, logic);
+    } else if (tag == MultiEdgeMerger::BackTranslator::serializationTag) {
+        return MultiEdgeMerger::BackTranslator::deserialize(*this, logic);
+    } else if (tag == TransformationPipeline::BackTranslator::serializationTag) {
+        return TransformationPipeline::BackTranslator::deserialize(*this);
+    }
+    malformed();
+    return nullptr;
+}
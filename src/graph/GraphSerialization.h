@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_GRAPHSERIALIZATION_H
+#define GOLEM_GRAPHSERIALIZATION_H
+
+#include "ChcGraph.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class WitnessBackTranslator;
+
+/**
+ * Writes CHC graphs and related data (terms, predicate representations, state of witness back-translators)
+ * into a compact binary format.
+ *
+ * All terms are stored in a single table, each term exactly once, with arguments preceding the terms that use them.
+ * Every other piece of data refers to terms and predicate symbols only by their index into the tables.
+ * Integers are stored as LEB128 variable-length numbers.
+ */
+class GraphSerializer {
+    Logic & logic;
+    std::string symbols;
+    std::string terms;
+    std::string data;
+    std::unordered_map<SymRef, std::uint64_t, SymRefHash> symbolIndices;
+    std::unordered_map<PTRef, std::uint64_t, PTRefHash> termIndices;
+
+    std::uint64_t symbolIndex(SymRef sym);
+    std::uint64_t termIndex(PTRef term);
+    void writeTermEntry(PTRef term);
+    void writeSort(std::string & out, SRef sort) const;
+
+public:
+    explicit GraphSerializer(Logic & logic) : logic(logic) {}
+
+    void writeUnsigned(std::uint64_t value);
+    void writeString(std::string_view str);
+    void writeTerm(PTRef term);
+    void writeSymbol(SymRef sym);
+    void writeEdge(DirectedHyperEdge const & edge);
+    void writeEdges(std::vector<DirectedHyperEdge> const & edges);
+    void writeSymbols(std::vector<SymRef> const & syms);
+    void writeRepresentation(NonlinearCanonicalPredicateRepresentation const & representation);
+    void writeGraph(ChcDirectedHyperGraph const & graph);
+    /** Returns false if the translator (or any of its parts) does not support serialization */
+    bool writeBackTranslator(WitnessBackTranslator const & translator);
+
+    /** Complete serialized content: symbol table, term table and the data written so far */
+    std::string finish() const;
+};
+
+/**
+ * Reads the data written by GraphSerializer, in the same order, and recreates the terms in the given logic.
+ * The input buffer (typically a memory-mapped file) must outlive the deserializer.
+ *
+ * Throws std::logic_error if the input is malformed.
+ */
+class GraphDeserializer {
+    Logic & logic;
+    char const * position;
+    char const * end;
+    std::vector<SymRef> symbols;
+    std::vector<PTRef> terms;
+
+    void readSymbolTable();
+    void readTermTable();
+    SRef readSort();
+
+public:
+    GraphDeserializer(Logic & logic, std::string_view input);
+
+    std::uint64_t readUnsigned();
+    std::string readString();
+    PTRef readTerm();
+    SymRef readSymbol();
+    DirectedHyperEdge readEdge();
+    std::vector<DirectedHyperEdge> readEdges();
+    std::vector<SymRef> readSymbols();
+    NonlinearCanonicalPredicateRepresentation readRepresentation();
+    std::unique_ptr<ChcDirectedHyperGraph> readGraph();
+    std::unique_ptr<WitnessBackTranslator> readBackTranslator();
+
+    bool atEnd() const { return position == end; }
+};
+
+#endif // GOLEM_GRAPHSERIALIZATION_H
@@ -5,335 +5,365 @@
  */
 
 #include "ProofSteps.h"
-#include <memory>
+#include "utils/ThreadPool.h"
+#include <sstream>
 #include <string>
 #include <utility>
 
-std::string Step::printStepAlethe() const {
+void Step::printStepAlethe(std::ostream & out, TermStore const & terms) const {
 
-    std::stringstream ss;
-    ss << "(";
+    out << "(";
 
     if (type == ASSUME) {
-        ss << "assume t";
+        out << "assume t";
     } else if (type == STEP) {
-        ss << "step t";
+        out << "step t";
     }
 
-    ss << stepId;
+    out << stepId;
 
-    if (type != ASSUME) { ss << " (cl"; }
+    if (type != ASSUME) { out << " (cl"; }
 
     if (not clause.empty()) {
-        ss << " ";
+        out << " ";
         for (std::size_t i = 0; i < clause.size(); i++) {
-            ss << clause[i]->printTerm();
-            if (i != clause.size() - 1) { ss << " "; }
+            terms.print(clause[i], out);
+            if (i != clause.size() - 1) { out << " "; }
         }
     }
 
-    if (type != ASSUME) { ss << ")"; }
+    if (type != ASSUME) { out << ")"; }
 
-    if (rule != " ") { ss << " :rule " << rule; }
+    if (rule != " ") { out << " :rule " << rule; }
 
     if (not premises.empty()) {
-        ss << " :premises (";
+        out << " :premises (";
         for (std::size_t i = 0; i < premises.size(); i++) {
-            ss << "t" << premises[i];
-            if (i != premises.size() - 1) { ss << " "; }
+            out << "t" << premises[i];
+            if (i != premises.size() - 1) { out << " "; }
         }
-        ss << ")";
+        out << ")";
     }
 
     if (not args.empty()) {
-        ss << " :args (";
+        out << " :args (";
         for (std::size_t i = 0; i < args.size(); i++) {
-            ss << "(:= " << args[i].first << " " << args[i].second << ")";
-            if (i != args.size() - 1) { ss << " "; }
+            out << "(:= " << args[i].first << " " << args[i].second << ")";
+            if (i != args.size() - 1) { out << " "; }
         }
-        ss << ")";
+        out << ")";
     }
 
-    ss << ")\n";
-
-    return ss.str();
+    out << ")\n";
 }
 
-std::string Step::printStepIntermediate() const {
-
-    PrintVisitor printVisitor;
-    std::stringstream ss;
+void Step::printStepIntermediate(std::ostream & out, TermStore const & terms) const {
 
-    ss << stepId << '\t';
+    out << stepId << '\t';
 
     if (not clause.empty()) {
-        ss << " ";
+        out << " ";
         for (auto const & arg : clause) {
-            ss << arg->printTerm();
-            ss << " ";
+            terms.print(arg, out);
+            out << " ";
         }
     }
 
     if (not args.empty()) {
-        ss << " :args (";
+        out << " :args (";
         for (std::size_t i = 0; i < args.size(); i++) {
-            ss << "(:= " << args[i].first << " " << args[i].second << ")";
-            if (i != args.size() - 1) { ss << " "; }
+            out << "(:= " << args[i].first << " " << args[i].second << ")";
+            if (i != args.size() - 1) { out << " "; }
         }
-        ss << ")";
+        out << ")";
     }
 
     if (not premises.empty()) {
-        ss << " :premises ";
+        out << " :premises ";
         for (auto premise : premises) {
-            ss << premise << " ";
+            out << premise << " ";
         }
     }
 
-    ss << "\n";
-
-    return ss.str();
+    out << "\n";
 }
 
-std::vector<std::shared_ptr<Term>> StepHandler::packClause(std::shared_ptr<Term> const & term) {
-    std::vector<std::shared_ptr<Term>> clause;
+std::vector<TermRef> packClause(TermRef term) {
+    std::vector<TermRef> clause;
     clause.push_back(term);
     return clause;
 }
 
-std::vector<std::shared_ptr<Term>> StepHandler::packClause(std::shared_ptr<Term> const & term1,
-                                                           std::shared_ptr<Term> const & term2) {
-    std::vector<std::shared_ptr<Term>> clause;
+std::vector<TermRef> packClause(TermRef term1, TermRef term2) {
+    std::vector<TermRef> clause;
     clause.push_back(term1);
     clause.push_back(term2);
     return clause;
 }
 
-void StepHandler::buildIntermediateProof() {
+DerivationStepInput StepHandler::prepareInput(std::size_t index) {
+    auto const & step = derivation[index];
+    DerivationStepInput input;
+    input.index = index;
+    input.clauseId = step.clauseId.id;
+    input.assertion = originalAssertions[step.clauseId.id];
+    input.instPairs = getInstPairs(index, normalizingEqualities[step.clauseId.id]);
+    input.premises = step.premises;
+    std::stringstream premises;
+    for (std::size_t j = 0; j < step.premises.size(); j++) {
+        premises << logic.printTerm(derivation[step.premises[j]].derivedFact);
+        if (j < step.premises.size() - 1) { premises << ' '; }
+    }
+    input.premiseFacts = premises.str();
+    input.derivedFact = logic.printTerm(step.derivedFact);
+    return input;
+}
 
-    auto derivationSize = derivation.size();
+void StepHandler::appendFragment(ProofFragment & fragment, std::vector<std::size_t> & conclusions,
+                                 std::size_t index) {
+    std::size_t const base = currentStep;
+    auto resolve = [&](std::size_t step) -> std::size_t {
+        if (step == ProofFragment::PRECEDING_STEP) { return base - 1; }
+        if (step == ProofFragment::TRUE_RULE_STEP) { return trueRuleStep; }
+        if (step & ProofFragment::ASSUMPTION_TAG) { return step & ~ProofFragment::ASSUMPTION_TAG; }
+        if (step & ProofFragment::DERIVED_TAG) { return conclusions[step & ~ProofFragment::DERIVED_TAG]; }
+        return base + step;
+    };
+    auto trueRule = fragment.trueRuleSteps.begin();
+    for (std::size_t i = 0; i < fragment.steps.size(); ++i) {
+        Step & step = fragment.steps[i];
+        if (trueRule != fragment.trueRuleSteps.end() and trueRule->first == i) {
+            // The true rule is stated once, later uses refer to it
+            if (trueRuleStep == 0) {
+                trueRuleStep = base + i;
+            } else {
+                step = std::move(trueRule->second);
+            }
+            ++trueRule;
+        }
+        step.renumber(resolve);
+        notifyObservers(step, fragment.terms);
+    }
+    conclusions[index] = base + fragment.conclusion;
+    currentStep += fragment.steps.size();
+}
 
-    for (std::size_t i = 0; i < derivationSize; ++i) {
+/*
+ * Builds the fragments of the derivation steps and appends them to the proof in the order of the derivation.
+ * The inputs are prepared in this thread, as they need the logic. With more than one thread the fragments are built
+ * by the workers; the number of fragments waiting to be appended is bounded, so the proof is still streamed.
+ */
+template<typename TBuild>
+void StepHandler::buildFragments(TBuild build) {
+    std::vector<std::size_t> conclusions(derivation.size());
+    std::vector<std::size_t> steps;
+    for (std::size_t i = 0; i < derivation.size(); ++i) {
+        if (not derivation[i].premises.empty()) { steps.push_back(i); }
+    }
+    // The workers only read the shared terms, nothing is added to the store until all fragments are appended
+    auto prepare = [&](std::size_t i) { return [&build, input = prepareInput(steps[i])]() { return build(input); }; };
+    parallelMap(steps.size(), threads, prepare, [&](std::size_t i, std::unique_ptr<ProofFragment> && fragment) {
+        appendFragment(*fragment, conclusions, steps[i]);
+    });
+}
 
-        auto const & step = derivation[i];
+void StepHandler::buildIntermediateProof() {
+    buildFragments(
+        [this](DerivationStepInput const & input) { return FragmentBuilder(terms).buildIntermediate(input); });
+}
 
-        if (step.premises.empty()) { continue; }
+void StepHandler::buildAletheProof() {
 
-        auto instPairs = getInstPairs(i, normalizingEqualities[step.clauseId.id]);
-        InstantiateVisitor instantiateVisitor(instPairs);
-        currTerm = originalAssertions[step.clauseId.id];
+    // Building assumptions
+    assumptionSteps();
 
-        if (not instPairs.empty()) {
+    // Iteration through derivations
+    buildFragments([this](DerivationStepInput const & input) { return FragmentBuilder(terms).buildAlethe(input); });
 
-            notifyObservers(Step(currentStep, Step::STEP, packClause(currTerm), "forall_inst", instPairs));
-            currentStep++;
+    notifyObservers(Step(currentStep, Step::STEP,
+                         packClause(terms.mkTerminal("(not false)", TerminalType::UNDECLARED)), "false"));
 
-            currTerm = currTerm->accept(&instantiateVisitor);
-        }
+    currentStep++;
+    // Get empty clause
+    notifyObservers(
+        Step(currentStep, Step::STEP, "resolution", std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
+}
 
-        notifyObservers(Step(currentStep, Step::STEP, packClause(currTerm)));
-        currentStep++;
+std::unique_ptr<ProofFragment> FragmentBuilder::buildIntermediate(DerivationStepInput const & input) && {
 
-        std::stringstream premises;
+    InstantiateVisitor instantiateVisitor(terms, input.instPairs);
+    currTerm = terms.import(sharedTerms, input.assertion);
 
-        for (std::size_t j = 0; j < step.premises.size(); j++) {
-            premises << logic.printTerm(derivation[step.premises[j]].derivedFact);
-            if (j < step.premises.size() - 1) { premises << ' '; }
-        }
+    if (not input.instPairs.empty()) {
 
-        notifyObservers(
-            Step(currentStep, Step::STEP,
-                 packClause(std::make_shared<Op>(
-                     "=>", packClause(std::make_shared<Terminal>(premises.str(), Term::VAR),
-                                      std::make_shared<Terminal>(logic.printTerm(step.derivedFact), Term::VAR))))));
+        emit(Step(currentStep, Step::STEP, packClause(currTerm), "forall_inst", input.instPairs));
         currentStep++;
 
-        std::vector<std::size_t> requiredMP;
-
-        if (!modusPonensSteps.empty()) {
-            // Get the necessary steps for modus ponens
-            for (std::size_t premise : step.premises) {
-                requiredMP.push_back(modusPonensSteps[premise - 1]);
-            }
-        }
-
-        notifyObservers(Step(currentStep, Step::STEP,
-                             packClause(std::make_shared<Terminal>(logic.printTerm(step.derivedFact), Term::VAR)),
-                             "resolution", requiredMP));
-
-        modusPonensSteps.push_back(currentStep);
-
-        currentStep++;
+        currTerm = instantiateVisitor.visit(currTerm);
     }
-}
 
-void StepHandler::buildAletheProof() {
+    emit(Step(currentStep, Step::STEP, packClause(currTerm)));
+    currentStep++;
 
-    // Building assumptions
-    assumptionSteps();
+    emit(Step(currentStep, Step::STEP,
+              packClause(terms.mkOp(OpCode::IMPLIES,
+                                    packClause(terms.mkTerminal(input.premiseFacts, TerminalType::VAR),
+                                               terms.mkTerminal(input.derivedFact, TerminalType::VAR))))));
+    currentStep++;
 
-    auto derivationSize = derivation.size();
+    // Get the necessary steps for modus ponens; the initial fact needs none
+    std::vector<std::size_t> requiredMP;
+    for (std::size_t premise : input.premises) {
+        if (premise != 0) { requiredMP.push_back(ProofFragment::derived(premise)); }
+    }
 
-    // Iteration through derivations
-    for (std::size_t i = 0; i < derivationSize; ++i) {
-        auto const & step = derivation[i];
+    emit(Step(currentStep, Step::STEP, packClause(terms.mkTerminal(input.derivedFact, TerminalType::VAR)), "resolution",
+              requiredMP));
 
-        if (step.premises.empty()) { continue; }
+    fragment->conclusion = currentStep;
 
-        std::vector<std::size_t> requiredMP;
+    currentStep++;
+    return std::move(fragment);
+}
 
-        if (!modusPonensSteps.empty()) {
-            // Get the necessary steps for modus ponens
-            for (auto premise : step.premises) {
-                requiredMP.push_back(modusPonensSteps[premise - 1]);
-            }
-        }
+std::unique_ptr<ProofFragment> FragmentBuilder::buildAlethe(DerivationStepInput const & input) && {
 
-        currTerm = originalAssertions[step.clauseId.id];
+    // Get the necessary steps for modus ponens; the initial fact needs none
+    std::vector<std::size_t> requiredMP;
+    for (std::size_t premise : input.premises) {
+        if (premise != 0) { requiredMP.push_back(ProofFragment::derived(premise)); }
+    }
 
-        // Variable instantiation
-        instantiationSteps(i); // pass the currTerm as an argument
+    currTerm = terms.import(sharedTerms, input.assertion);
+    currTermStep = ProofFragment::assumption(input.clauseId);
 
-        std::shared_ptr<Op> implication = std::dynamic_pointer_cast<Op>(currTerm);
+    // Variable instantiation
+    instantiationSteps(input);
 
-        implicationLHS = implication->getArgs()[0];
-        implicationRHS = std::make_shared<Terminal>(logic.printTerm(step.derivedFact), Term::VAR);
+    implicationLHS = terms.getArg(currTerm, 0);
+    implicationRHS = terms.mkTerminal(input.derivedFact, TerminalType::VAR);
 
-        std::shared_ptr<Term> renamedImpLHS =
-            std::make_shared<Terminal>("@impLHS" + std::to_string(i - 1), Terminal::UNDECLARED);
+    TermRef renamedImpLHS = terms.mkTerminal("@impLHS" + std::to_string(input.index - 1), TerminalType::UNDECLARED);
 
-        // Implication rule
+    // Implication rule
 
-        notifyObservers(
-            Step(currentStep, Step::STEP,
-                 packClause(std::make_shared<Op>(
-                                "not", packClause(std::make_shared<Op>(
-                                           "!", packClause(implicationLHS, std::make_shared<Terminal>(
-                                                                               ":named @impLHS" + std::to_string(i - 1),
-                                                                               Terminal::UNDECLARED))))),
-                            implicationRHS),
-                 "implies", std::vector<std::size_t>{currentStep - 1}));
+    emit(Step(currentStep, Step::STEP,
+              packClause(terms.mkOp(OpCode::NOT,
+                                    packClause(terms.mkOp(
+                                        OpCode::NAMED,
+                                        packClause(implicationLHS,
+                                                   terms.mkTerminal(":named @impLHS" + std::to_string(input.index - 1),
+                                                                    TerminalType::UNDECLARED))))),
+                         implicationRHS),
+              "implies",
+              std::vector<std::size_t>{currentStep == 0 ? ProofFragment::PRECEDING_STEP : currentStep - 1}));
 
-        std::size_t implicationStep = currentStep;
+    std::size_t implicationStep = currentStep;
 
-        currentStep++;
+    currentStep++;
 
-        CongChainVisitor congChainVisitor(currentStep);
+    CongChainVisitor congChainVisitor(terms, currentStep);
 
-        // Casting implication to an operation, getting the LHS and calling the simplification visitor
-        std::dynamic_pointer_cast<Op>(currTerm)->getArgs()[0]->accept(&congChainVisitor);
+    // Casting implication to an operation, getting the LHS and calling the simplification visitor
+    congChainVisitor.visit(terms.getArg(currTerm, 0));
 
-        // If it is empty, it means that the LHS was either a terminal or an application
-        if (not congChainVisitor.getSteps().empty()) {
-            for (std::size_t j = 0; j < congChainVisitor.getSteps().size() - 1; j++) {
-                auto simpleStep = congChainVisitor.getSteps()[j];
-                notifyObservers(Step(simpleStep.stepId, Step::STEP, packClause(simpleStep.clause), simpleStep.rule,
-                                     simpleStep.premises));
-            }
+    // If it is empty, it means that the LHS was either a terminal or an application
+    if (not congChainVisitor.getSteps().empty()) {
+        for (std::size_t j = 0; j < congChainVisitor.getSteps().size() - 1; j++) {
+            auto simpleStep = congChainVisitor.getSteps()[j];
+            emit(Step(simpleStep.stepId, Step::STEP, packClause(simpleStep.clause), simpleStep.rule,
+                      simpleStep.premises));
         }
+    }
 
-        std::shared_ptr<Term> lastClause;
-        // Checking if we are dealing with a conjunction
-        if (implicationLHS->getTermType() == Term::OP) {
-            // renaming LHS for last chain step
-            auto lastChainStep = congChainVisitor.getSteps()[congChainVisitor.getSteps().size() - 1];
-            lastClause = lastChainStep.clause;
-            notifyObservers(
-                Step(lastChainStep.stepId, Step::STEP,
-                     packClause(std::make_shared<Op>(
-                         "=", packClause(renamedImpLHS, std::dynamic_pointer_cast<Op>(lastClause)->getArgs()[1]))),
-                     lastChainStep.rule, lastChainStep.premises));
-            currentStep = lastChainStep.stepId + 1;
-            if (std::dynamic_pointer_cast<Op>(implicationLHS)->getOp() == "and") {
-                // Final parent conjunction simplification
-                conjunctionSimplification(requiredMP, lastClause, implicationStep, renamedImpLHS);
-                continue;
-            }
-        } else {
-            lastClause = implicationLHS;
+    TermRef lastClause = TermRef_Undef;
+    // Checking if we are dealing with a conjunction
+    if (terms.isOp(implicationLHS)) {
+        // renaming LHS for last chain step
+        auto lastChainStep = congChainVisitor.getSteps()[congChainVisitor.getSteps().size() - 1];
+        lastClause = lastChainStep.clause;
+        emit(Step(lastChainStep.stepId, Step::STEP,
+                  packClause(
+                      terms.mkOp(OpCode::EQ, packClause(renamedImpLHS, terms.getArg(lastClause, 1)))),
+                  lastChainStep.rule, lastChainStep.premises));
+        currentStep = lastChainStep.stepId + 1;
+        if (terms.isOp(implicationLHS, OpCode::AND)) {
+            // Final parent conjunction simplification
+            conjunctionSimplification(requiredMP, lastClause, implicationStep, renamedImpLHS);
+            return std::move(fragment);
         }
-        // If it is not, we simplify with a different procedure
-        directSimplification(requiredMP, implicationStep, lastClause, renamedImpLHS);
+    } else {
+        lastClause = implicationLHS;
     }
-
-    notifyObservers(Step(currentStep, Step::STEP,
-                         packClause(std::make_shared<Terminal>("(not false)", Term::UNDECLARED)), "false"));
-
-    currentStep++;
-    // Get empty clause
-    notifyObservers(
-        Step(currentStep, Step::STEP, "resolution", std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
+    // If it is not, we simplify with a different procedure
+    directSimplification(requiredMP, implicationStep, lastClause, renamedImpLHS);
+    return std::move(fragment);
 }
 
-void StepHandler::instantiationSteps(std::size_t i) {
-
-    auto const & step = derivation[i];
+void FragmentBuilder::instantiationSteps(DerivationStepInput const & input) {
 
-    std::shared_ptr<Term> assumptionReNamedTerm =
-        std::make_shared<Terminal>("@a" + std::to_string(step.clauseId.id), Terminal::UNDECLARED);
-    std::shared_ptr<Term> instantiationReNamedTerm =
-        std::make_shared<Terminal>("@i" + std::to_string(i - 1), Terminal::UNDECLARED);
+    TermRef assumptionReNamedTerm = terms.mkTerminal("@a" + std::to_string(input.clauseId), TerminalType::UNDECLARED);
+    TermRef instantiationReNamedTerm =
+        terms.mkTerminal("@i" + std::to_string(input.index - 1), TerminalType::UNDECLARED);
 
-    std::shared_ptr<Term> unusedRem = currTerm->accept(&removeUnusedVisitor);
-
-    std::size_t quantStep = step.clauseId.id;
+    RemoveUnusedVisitor removeUnusedVisitor(terms);
+    TermRef unusedRem = removeUnusedVisitor.visit(currTerm);
 
     // Getting the instantiated variable-value pairs
-    std::vector<std::pair<std::string, std::string>> instPairs =
-        getInstPairs(i, normalizingEqualities[step.clauseId.id]);
-    InstantiateVisitor instantiateVisitor(instPairs);
+    auto const & instPairs = input.instPairs;
+    InstantiateVisitor instantiateVisitor(terms, instPairs);
 
-    if (unusedRem->printTerm() != currTerm->printTerm()) {
+    // Terms are hash-consed, so comparing the references is enough
+    if (unusedRem != TermRef_Undef and unusedRem != currTerm) {
 
-        notifyObservers(Step(currentStep, Step::STEP,
-                             packClause(std::make_shared<Op>("=", packClause(assumptionReNamedTerm, unusedRem))),
-                             "qnt_rm_unused"));
+        emit(Step(currentStep, Step::STEP,
+                  packClause(terms.mkOp(OpCode::EQ, packClause(assumptionReNamedTerm, unusedRem))), "qnt_rm_unused"));
 
         currentStep++;
 
-        notifyObservers(Step(currentStep, Step::STEP,
-                             packClause(std::make_shared<Op>("not", packClause(assumptionReNamedTerm)), unusedRem),
-                             "equiv1", std::vector<std::size_t>{currentStep - 1}));
+        emit(Step(currentStep, Step::STEP,
+                  packClause(terms.mkOp(OpCode::NOT, packClause(assumptionReNamedTerm)), unusedRem),
+                  "equiv1", std::vector<std::size_t>{currentStep - 1}));
 
         currentStep++;
 
-        notifyObservers(Step(currentStep, Step::STEP, packClause(unusedRem), "resolution",
-                             std::vector<std::size_t>{quantStep, currentStep - 1}));
+        emit(Step(currentStep, Step::STEP, packClause(unusedRem), "resolution",
+                  std::vector<std::size_t>{currTermStep, currentStep - 1}));
 
+        currTermStep = currentStep;
         currentStep++;
 
         currTerm = unusedRem;
         assumptionReNamedTerm = unusedRem;
-        quantStep = currentStep - 1;
     }
 
     if (not instPairs.empty()) {
 
-        notifyObservers(Step(
-            currentStep, Step::STEP,
-            packClause(std::make_shared<Op>(
-                "or",
-                packClause(std::make_shared<Op>("not", packClause(assumptionReNamedTerm)),
-                           std::make_shared<Op>("!", packClause(currTerm->accept(&instantiateVisitor),
-                                                                std::make_shared<Terminal>(
-                                                                    ":named " + instantiationReNamedTerm->printTerm(),
-                                                                    Terminal::UNDECLARED)))))),
-            "forall_inst", instPairs));
+        emit(Step(currentStep, Step::STEP,
+                  packClause(terms.mkOp(
+                      OpCode::OR,
+                      packClause(terms.mkOp(OpCode::NOT, packClause(assumptionReNamedTerm)),
+                                 terms.mkOp(OpCode::NAMED,
+                                            packClause(instantiateVisitor.visit(currTerm),
+                                                       terms.mkTerminal(":named " + terms.getName(
+                                                                                        instantiationReNamedTerm),
+                                                                        TerminalType::UNDECLARED)))))),
+                  "forall_inst", instPairs));
 
         currentStep++;
 
-        notifyObservers(
-            Step(currentStep, Step::STEP,
-                 packClause(std::make_shared<Op>("not", packClause(assumptionReNamedTerm)), instantiationReNamedTerm),
-                 "or", std::vector<std::size_t>{currentStep - 1}));
+        emit(Step(currentStep, Step::STEP,
+                  packClause(terms.mkOp(OpCode::NOT, packClause(assumptionReNamedTerm)), instantiationReNamedTerm),
+                  "or", std::vector<std::size_t>{currentStep - 1}));
 
         currentStep++;
 
-        currTerm = currTerm->accept(&instantiateVisitor);
+        currTerm = instantiateVisitor.visit(currTerm);
 
-        notifyObservers(Step(currentStep, Step::STEP, packClause(instantiationReNamedTerm), "resolution",
-                             std::vector<std::size_t>{currentStep - 1, quantStep}));
+        emit(Step(currentStep, Step::STEP, packClause(instantiationReNamedTerm), "resolution",
+                  std::vector<std::size_t>{currentStep - 1, currTermStep}));
 
+        currTermStep = currentStep;
         currentStep++;
     }
 }
@@ -341,107 +371,100 @@ void StepHandler::instantiationSteps(std::size_t i) {
 void StepHandler::assumptionSteps() {
 
     for (auto & assertion : originalAssertions) {
-        Term * potentialLet = assertion->accept(&letLocatorVisitor);
-        while (potentialLet != nullptr) {
-            auto simplifiedLet = potentialLet->accept(&operateLetTermVisitor);
-            SimplifyVisitor simplifyLetTermVisitor(simplifiedLet, potentialLet);
-            assertion = assertion->accept(&simplifyLetTermVisitor);
-            potentialLet = assertion->accept(&letLocatorVisitor);
+        TermRef potentialLet = letLocatorVisitor.visit(assertion);
+        while (potentialLet != TermRef_Undef) {
+            auto simplifiedLet = operateLetTermVisitor.visit(potentialLet);
+            SimplifyVisitor simplifyLetTermVisitor(terms, simplifiedLet, potentialLet);
+            assertion = simplifyLetTermVisitor.visit(assertion);
+            potentialLet = letLocatorVisitor.visit(assertion);
         }
         notifyObservers(
             Step(currentStep, Step::ASSUME,
-                 packClause(std::make_shared<Op>(
-                     "!", packClause(assertion, std::make_shared<Terminal>(":named @a" + std::to_string(currentStep),
-                                                                           Terminal::UNDECLARED))))));
+                 packClause(terms.mkOp(
+                     OpCode::NAMED, packClause(assertion, terms.mkTerminal(":named @a" + std::to_string(currentStep),
+                                                                           TerminalType::UNDECLARED))))));
 
         currentStep++;
     }
 }
 
-void StepHandler::directSimplification(std::vector<std::size_t> requiredMP, std::size_t implicationStep,
-                                       std::shared_ptr<Term> const & lastClause,
-                                       std::shared_ptr<Term> const & renamedImpLHS) {
+void FragmentBuilder::directSimplification(std::vector<std::size_t> requiredMP, std::size_t implicationStep,
+                                           TermRef lastClause, TermRef renamedImpLHS) {
 
-    if (implicationLHS->getTermType() == Term::OP) {
+    if (terms.isOp(implicationLHS)) {
 
-        auto simplification = std::dynamic_pointer_cast<Op>(lastClause)->getArgs()[1];
+        auto simplification = terms.getArg(lastClause, 1);
 
-        notifyObservers(Step(currentStep, Step::STEP,
-                             packClause(renamedImpLHS, std::make_shared<Op>("not", packClause(simplification))),
-                             "equiv2", std::vector<std::size_t>{currentStep - 1}));
+        emit(Step(currentStep, Step::STEP,
+                  packClause(renamedImpLHS, terms.mkOp(OpCode::NOT, packClause(simplification))), "equiv2",
+                  std::vector<std::size_t>{currentStep - 1}));
 
         currentStep++;
 
-        if (simplification->getTerminalType() == Terminal::BOOL) {
-            assert(simplification->printTerm() == "true");
+        if (terms.getTerminalType(simplification) == TerminalType::BOOL) {
+            assert(terms.isTrue(simplification));
             stepReusage(simplification);
-            notifyObservers(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "resolution",
-                                 std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
+            emit(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "resolution",
+                      std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
 
             currentStep++;
-            notifyObservers(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution",
-                                 std::vector<std::size_t>{implicationStep, currentStep - 1}));
-            modusPonensSteps.push_back(currentStep);
+            emit(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution",
+                      std::vector<std::size_t>{implicationStep, currentStep - 1}));
+            fragment->conclusion = currentStep;
             currentStep++;
         }
     } else {
 
-        if (implicationLHS->getTermType() == Term::APP) {
+        if (terms.isApp(implicationLHS)) {
 
             requiredMP.push_back(currentStep - 1);
 
-            notifyObservers(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution", requiredMP));
+            emit(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution", requiredMP));
 
-            modusPonensSteps.push_back(currentStep);
+            fragment->conclusion = currentStep;
 
             currentStep++;
 
-        } else if (implicationLHS->getTermType() == Term::TERMINAL) {
+        } else if (terms.isTerminal(implicationLHS)) {
 
-            notifyObservers(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "true"));
+            emit(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "true"));
 
             currentStep++;
 
-            notifyObservers(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution",
-                                 std::vector<std::size_t>{implicationStep, currentStep - 1}));
+            emit(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution",
+                      std::vector<std::size_t>{implicationStep, currentStep - 1}));
 
-            modusPonensSteps.push_back(currentStep);
+            fragment->conclusion = currentStep;
 
             currentStep++;
         }
     }
 }
 
-void StepHandler::conjunctionSimplification(std::vector<std::size_t> requiredMP,
-                                            std::shared_ptr<Term> const & lastClause, std::size_t implicationStep,
-                                            std::shared_ptr<Term> const & renamedImpLHS) {
+void FragmentBuilder::conjunctionSimplification(std::vector<std::size_t> requiredMP, TermRef lastClause,
+                                                std::size_t implicationStep, TermRef renamedImpLHS) {
 
-    auto termToSimplify = std::dynamic_pointer_cast<Op>(lastClause)->getArgs()[0];
-    auto simplification = std::dynamic_pointer_cast<Op>(lastClause)->getArgs()[1];
+    auto termToSimplify = terms.getArg(lastClause, 0);
+    auto simplification = terms.getArg(lastClause, 1);
 
-    notifyObservers(Step(currentStep, Step::STEP,
-                         packClause(renamedImpLHS, std::make_shared<Op>("not", packClause(simplification))), "equiv2",
-                         std::vector<std::size_t>{currentStep - 1}));
+    emit(Step(currentStep, Step::STEP, packClause(renamedImpLHS, terms.mkOp(OpCode::NOT, packClause(simplification))),
+              "equiv2", std::vector<std::size_t>{currentStep - 1}));
 
     currentStep++;
 
     // Check if we are dealing with a non linear case
-    if (std::dynamic_pointer_cast<Op>(termToSimplify)->nonLinearity()) {
-        notifyObservers(Step(
-            currentStep, Step::STEP,
-            packClause(simplification,
-                       std::make_shared<Terminal>(
-                           std::dynamic_pointer_cast<Op>(simplification)->nonLinearSimplification(), Term::UNDECLARED)),
-            "and_neg"));
+    if (nonLinearity(terms, termToSimplify)) {
+        emit(Step(currentStep, Step::STEP,
+                  packClause(simplification, terms.mkTerminal(nonLinearSimplification(terms, simplification),
+                                                              TerminalType::UNDECLARED)),
+                  "and_neg"));
 
         currentStep++;
 
-        notifyObservers(
-            Step(currentStep, Step::STEP,
-                 packClause(renamedImpLHS, std::make_shared<Terminal>(
-                                               std::dynamic_pointer_cast<Op>(simplification)->nonLinearSimplification(),
-                                               Term::UNDECLARED)),
-                 "resolution", std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
+        emit(Step(currentStep, Step::STEP,
+                  packClause(renamedImpLHS, terms.mkTerminal(nonLinearSimplification(terms, simplification),
+                                                             TerminalType::UNDECLARED)),
+                  "resolution", std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
 
         requiredMP.push_back(currentStep);
 
@@ -450,26 +473,26 @@ void StepHandler::conjunctionSimplification(std::vector<std::size_t> requiredMP,
         requiredMP.push_back(currentStep - 1);
     }
 
-    if (simplification->printTerm() == "true") {
+    if (terms.isTrue(simplification)) {
 
         stepReusage(simplification);
 
-        notifyObservers(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "resolution",
-                             std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
+        emit(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "resolution",
+                  std::vector<std::size_t>{currentStep - 2, currentStep - 1}));
 
         currentStep++;
 
     } else {
 
-        notifyObservers(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "resolution", requiredMP));
+        emit(Step(currentStep, Step::STEP, packClause(renamedImpLHS), "resolution", requiredMP));
 
         currentStep++;
     }
 
-    notifyObservers(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution",
-                         std::vector<std::size_t>{implicationStep, currentStep - 1}));
+    emit(Step(currentStep, Step::STEP, packClause(implicationRHS), "resolution",
+              std::vector<std::size_t>{implicationStep, currentStep - 1}));
 
-    modusPonensSteps.push_back(currentStep);
+    fragment->conclusion = currentStep;
 
     currentStep++;
 }
@@ -554,7 +577,7 @@ StepHandler::getInstPairs(std::size_t stepIndex, vec<Normalizer::Equality> const
         // Find values for auxiliary variables
         SMTSolver solver(logic, SMTSolver::WitnessProduction::ONLY_MODEL);
         solver.getCoreSolver().insertFormula(instantiatedConstraint);
-        auto res = solver.getCoreSolver().check();
+        auto res = solver.check();
         if (res != s_True) {
             assert(false);
             throw std::logic_error("Formula should have been satisfiable");
@@ -585,15 +608,12 @@ StepHandler::getInstPairs(std::size_t stepIndex, vec<Normalizer::Equality> const
     return res;
 }
 
-void StepHandler::stepReusage(std::shared_ptr<Term> const & term) {
-    std::string strTerm = term->printTerm();
-    assert(strTerm == "true");
-    if (trueRuleStep == 0) {
-        notifyObservers(Step(currentStep, Step::STEP, packClause(term), "true"));
-        trueRuleStep = currentStep;
-    } else {
-        notifyObservers(Step(currentStep, Step::STEP, packClause(implicationLHS), "resolution",
-                             std::vector<std::size_t>{currentStep - 1, trueRuleStep}));
-    }
+void FragmentBuilder::stepReusage(TermRef term) {
+    assert(terms.isTrue(term));
+    // Whether the proof already contains the true rule is known only when the fragment is appended
+    std::vector<std::size_t> premises{currentStep - 1, ProofFragment::TRUE_RULE_STEP};
+    fragment->trueRuleSteps.emplace_back(
+        currentStep, Step(currentStep, Step::STEP, packClause(implicationLHS), "resolution", std::move(premises)));
+    emit(Step(currentStep, Step::STEP, packClause(term), "true"));
     currentStep++;
 }
@@ -10,6 +10,7 @@
 #include "Witnesses.h"
 #include "graph/ChcGraph.h"
 #include "utils/SmtSolver.h"
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -20,31 +21,39 @@ public:
 private:
     std::size_t stepId;
     stepType type;
-    std::vector<std::shared_ptr<Term>> clause;
+    std::vector<TermRef> clause;
     std::string rule;
     std::vector<std::size_t> premises;
     std::vector<std::pair<std::string, std::string>> args;
 
 public:
-    Step(std::size_t stepId, stepType type, std::vector<std::shared_ptr<Term>> clause, std::string rule,
+    Step(std::size_t stepId, stepType type, std::vector<TermRef> clause, std::string rule,
          std::vector<std::size_t> premises)
         : stepId(stepId), type(type), clause(std::move(clause)), rule(std::move(rule)), premises(std::move(premises)) {}
-    Step(std::size_t stepId, stepType type, std::vector<std::shared_ptr<Term>> clause, std::string rule,
+    Step(std::size_t stepId, stepType type, std::vector<TermRef> clause, std::string rule,
          std::vector<std::pair<std::string, std::string>> args)
         : stepId(stepId), type(type), clause(std::move(clause)), rule(std::move(rule)), args(std::move(args)) {}
-    Step(std::size_t stepId, stepType type, std::vector<std::shared_ptr<Term>> clause, std::string rule)
+    Step(std::size_t stepId, stepType type, std::vector<TermRef> clause, std::string rule)
         : stepId(stepId), type(type), clause(std::move(clause)), rule(std::move(rule)) {}
-    Step(std::size_t stepId, stepType type, std::vector<std::shared_ptr<Term>> clause)
+    Step(std::size_t stepId, stepType type, std::vector<TermRef> clause)
         : stepId(stepId), type(type), clause(std::move(clause)), rule(" ") {}
     Step(std::size_t stepId, stepType type, std::string rule, std::vector<std::size_t> premises)
         : stepId(stepId), type(type), rule(std::move(rule)), premises(std::move(premises)) {}
-    std::string printStepAlethe() const;
-    std::string printStepIntermediate() const;
+    // Maps the number of the step and the numbers of its premises
+    template<typename TMapping> void renumber(TMapping mapping) {
+        stepId = mapping(stepId);
+        for (auto & premise : premises) {
+            premise = mapping(premise);
+        }
+    }
+
+    void printStepAlethe(std::ostream & out, TermStore const & terms) const;
+    void printStepIntermediate(std::ostream & out, TermStore const & terms) const;
 };
 
 class Observer {
 public:
-    virtual void update(Step const & step) = 0;
+    virtual void update(Step const & step, TermStore const & terms) = 0;
 };
 
 class AlethePrintObserver : public Observer {
@@ -52,7 +61,7 @@ class AlethePrintObserver : public Observer {
 
 public:
     explicit AlethePrintObserver(std::ostream & out) : out(out) {}
-    void update(Step const & step) override { out << step.printStepAlethe(); }
+    void update(Step const & step, TermStore const & terms) override { step.printStepAlethe(out, terms); }
 };
 
 class IntermediatePrintObserver : public Observer {
@@ -60,56 +69,123 @@ class IntermediatePrintObserver : public Observer {
 
 public:
     explicit IntermediatePrintObserver(std::ostream & out) : out(out) {}
-    void update(Step const & step) override { out << step.printStepIntermediate(); }
+    void update(Step const & step, TermStore const & terms) override { step.printStepIntermediate(out, terms); }
+};
+
+std::vector<TermRef> packClause(TermRef term);
+std::vector<TermRef> packClause(TermRef term1, TermRef term2);
+
+/*
+ * Steps justifying a single derivation step.
+ *
+ * Fragments are built independently of each other: the steps are numbered from 0 and their terms live in the store
+ * of the fragment. Premises outside of the fragment are tagged and resolved when the fragment is appended to the proof.
+ */
+struct ProofFragment {
+    static constexpr std::size_t ASSUMPTION_TAG = std::size_t(1) << (std::numeric_limits<std::size_t>::digits - 1);
+    static constexpr std::size_t DERIVED_TAG = ASSUMPTION_TAG >> 1;
+    // Premise referring to the step preceding the fragment in the proof
+    static constexpr std::size_t PRECEDING_STEP = ASSUMPTION_TAG | DERIVED_TAG;
+    // Premise referring to the step of the true rule shared by the whole proof
+    static constexpr std::size_t TRUE_RULE_STEP = PRECEDING_STEP + 1;
+
+    // Premise referring to the assumption with the given (global) step number
+    static std::size_t assumption(std::size_t step) { return step | ASSUMPTION_TAG; }
+    // Premise referring to the conclusion of the fragment of the given derivation step
+    static std::size_t derived(std::size_t derivationStep) { return derivationStep | DERIVED_TAG; }
+
+    TermStore terms;
+    std::vector<Step> steps;
+    std::size_t conclusion = 0; // Step deriving the fact of the derivation step
+    // Steps of the true rule; if the proof already contains the true rule, each is replaced by its alternative
+    std::vector<std::pair<std::size_t, Step>> trueRuleSteps;
+};
+
+/*
+ * Everything a fragment needs from the derivation and the logic. It is computed in the thread owning the logic.
+ */
+struct DerivationStepInput {
+    std::size_t index;
+    std::size_t clauseId;
+    TermRef assertion;
+    std::vector<std::pair<std::string, std::string>> instPairs;
+    std::vector<std::size_t> premises;
+    std::string premiseFacts;
+    std::string derivedFact;
 };
 
+class FragmentBuilder {
+    TermStore const & sharedTerms;
+    std::unique_ptr<ProofFragment> fragment;
+    TermStore & terms;
+
+    std::size_t currentStep = 0;
+
+    TermRef implicationRHS = TermRef_Undef;
+    TermRef implicationLHS = TermRef_Undef;
+    TermRef currTerm = TermRef_Undef;
+    std::size_t currTermStep = 0; // Step deriving currTerm
+
+    void emit(Step step) { fragment->steps.push_back(std::move(step)); }
+
+    void instantiationSteps(DerivationStepInput const & input);
+    void directSimplification(std::vector<std::size_t> requiredMP, std::size_t implicationStep, TermRef lastClause,
+                              TermRef renamedImpLHS);
+    void conjunctionSimplification(std::vector<std::size_t> requiredMP, TermRef lastClause,
+                                   std::size_t implicationStep, TermRef renamedImpLHS);
+    void stepReusage(TermRef term);
+
+public:
+    explicit FragmentBuilder(TermStore const & sharedTerms)
+        : sharedTerms(sharedTerms), fragment(std::make_unique<ProofFragment>()), terms(fragment->terms) {}
+
+    std::unique_ptr<ProofFragment> buildAlethe(DerivationStepInput const & input) &&;
+    std::unique_ptr<ProofFragment> buildIntermediate(DerivationStepInput const & input) &&;
+};
+
+/*
+ * Builds the proof of an invalidity witness and passes its steps to the observers.
+ *
+ * The steps of each derivation step are built as a separate fragment, in parallel if more than one thread is allowed.
+ * The fragments are renumbered and passed to the observers in the order of the derivation.
+ */
 class StepHandler {
+    TermStore & terms;
 
     InvalidityWitness::Derivation derivation;
-    std::vector<std::shared_ptr<Term>> originalAssertions;
+    std::vector<TermRef> originalAssertions;
     Normalizer::Equalities const & normalizingEqualities;
     Logic & logic;
     ChcDirectedHyperGraph originalGraph;
+    std::size_t threads;
 
     std::vector<Observer *> observers;
 
     std::size_t currentStep = 0;
     std::size_t trueRuleStep = 0;
 
-    std::shared_ptr<Term> implicationRHS;
-    std::shared_ptr<Term> implicationLHS;
-    std::shared_ptr<Term> currTerm;
-    std::vector<std::size_t> modusPonensSteps; // Modus Ponens Steps to derive the next node
-
     // Visitors
-    InstantiateVisitor copyVisitor;
     OperateLetTermVisitor operateLetTermVisitor;
     LetLocatorVisitor letLocatorVisitor;
-    RemoveUnusedVisitor removeUnusedVisitor;
+
+    DerivationStepInput prepareInput(std::size_t index);
+    template<typename TBuild> void buildFragments(TBuild build);
+    void appendFragment(ProofFragment & fragment, std::vector<std::size_t> & conclusions, std::size_t index);
 
 public:
-    StepHandler(InvalidityWitness::Derivation derivation, std::vector<std::shared_ptr<Term>> originalAssertions,
+    StepHandler(TermStore & terms, InvalidityWitness::Derivation derivation, std::vector<TermRef> originalAssertions,
                 Normalizer::Equalities const & normalizingEqualities, Logic & logic,
-                ChcDirectedHyperGraph originalGraph)
-        : derivation(std::move(derivation)), originalAssertions(std::move(originalAssertions)),
-          normalizingEqualities(normalizingEqualities), logic(logic), originalGraph(std::move(originalGraph)) {}
+                ChcDirectedHyperGraph originalGraph, std::size_t threads = 1)
+        : terms(terms), derivation(std::move(derivation)), originalAssertions(std::move(originalAssertions)),
+          normalizingEqualities(normalizingEqualities), logic(logic), originalGraph(std::move(originalGraph)),
+          threads(threads), operateLetTermVisitor(terms), letLocatorVisitor(terms) {}
 
     std::vector<std::pair<std::string, std::string>> getInstPairs(std::size_t it,
                                                                   vec<Normalizer::Equality> const & stepNormEq);
-    static std::vector<std::shared_ptr<Term>> packClause(std::shared_ptr<Term> const & term);
-    static std::vector<std::shared_ptr<Term>> packClause(std::shared_ptr<Term> const & term1,
-                                                         std::shared_ptr<Term> const & term2);
     void buildAletheProof();
     void buildIntermediateProof();
 
-    void instantiationSteps(std::size_t i);
     void assumptionSteps();
-    void directSimplification(std::vector<std::size_t> requiredMP, std::size_t implicationStep,
-                              std::shared_ptr<Term> const & lastClause, std::shared_ptr<Term> const & renamedImpLHS);
-    void conjunctionSimplification(std::vector<std::size_t> requiredMP, std::shared_ptr<Term> const & finalClause,
-                                   std::size_t implicationStep, std::shared_ptr<Term> const & renamedImpLHS);
-
-    void stepReusage(std::shared_ptr<Term> const & term);
 
     void registerObserver(Observer * observer) { observers.push_back(observer); }
 
@@ -119,11 +195,13 @@ public:
         }
     }
 
-    void notifyObservers(Step const & step) {
+    void notifyObservers(Step const & step, TermStore const & stepTerms) {
         for (Observer * observer : observers) { // notify all observers
-            observer->update(step);
+            observer->update(step, stepTerms);
         }
     }
+
+    void notifyObservers(Step const & step) { notifyObservers(step, terms); }
 };
 
 #endif // GOLEM_PROOFSTEPS_H
@@ -5,163 +5,362 @@
  */
 
 #include "Term.h"
-#include "FastRational.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
-#include <memory>
+#include <sstream>
 #include <string>
 
-bool Op::nonLinearity() {
-    int predicates = 0;
-    if (operation == "and") {
-        for (auto const & arg : args) {
-            if (arg->getTermType() == Term::APP or arg->getTerminalType() == Terminal::VAR) { predicates++; }
-        }
-        if (predicates >= 2) {
-            return true;
-        } else {
-            return false;
+namespace {
+constexpr std::array<std::string_view, static_cast<std::size_t>(OpCode::OTHER)> opNames = {
+    "+", "-", "/", "*", "and", "or", "=>", "not", "=", ">=", "<=", ">", "<", "ite", "mod", "div", "!"};
+
+std::string_view nameOf(OpCode op) {
+    assert(op != OpCode::OTHER);
+    return opNames[static_cast<std::size_t>(op)];
+}
+
+std::string_view trim(std::string_view str) {
+    auto begin = str.find_first_not_of(' ');
+    if (begin == std::string_view::npos) { return {}; }
+    return str.substr(begin, str.find_last_not_of(' ') - begin + 1);
+}
+
+// Accepts numerals as written in SMT-LIB and as printed by OpenSMT: "5", "1.5", "(- 5)", "(/ 1 2)" and "1/2"
+FastRational parseNumeral(std::string_view str) {
+    str = trim(str);
+    if (str.size() > 3 and str.front() == '(' and str.back() == ')') {
+        auto inner = trim(str.substr(2, str.size() - 3));
+        if (str[1] == '-') { return -parseNumeral(inner); }
+        if (str[1] == '/') {
+            auto separator = inner.find(' ');
+            if (separator == std::string_view::npos) { throw std::logic_error("Not a numeral: " + std::string(str)); }
+            return parseNumeral(inner.substr(0, separator)) / parseNumeral(inner.substr(separator + 1));
         }
+    }
+    if (str.empty() or str.find_first_not_of("-0123456789./") != std::string_view::npos) {
+        throw std::logic_error("Not a numeral: " + std::string(str));
+    }
+    auto point = str.find('.');
+    if (point == std::string_view::npos) { return FastRational(std::string(str).c_str()); }
+    std::string digits = std::string(str.substr(0, point)) + std::string(str.substr(point + 1));
+    std::string denominator = "1" + std::string(str.size() - point - 1, '0');
+    return FastRational(digits.c_str()) / FastRational(denominator.c_str());
+}
+
+void printNumeral(std::ostream & out, FastRational const & value, TerminalType type) {
+    if (value.sign() < 0) {
+        out << "(- ";
+        printNumeral(out, -value, type);
+        out << ")";
+        return;
+    }
+    std::string str = value.get_str();
+    auto separator = str.find('/');
+    if (separator != std::string::npos) {
+        out << "(/ " << str.substr(0, separator) << " " << str.substr(separator + 1) << ")";
     } else {
-        return false;
+        out << str << (type == TerminalType::REAL ? ".0" : "");
     }
 }
+} // namespace
 
-std::string Op::nonLinearSimplification() {
-    std::stringstream ss;
-    if (operation == "and") {
-        for (std::size_t i = 0; i < args.size(); i++) {
-            ss << "(not " << args[i]->printTerm() << ")";
-            if (i != args.size() - 1) { ss << " "; }
+TermStore::TermStore() {
+    trueSymbol = intern("true");
+    falseSymbol = intern("false");
+}
+
+SymbolId TermStore::intern(std::string_view name) {
+    auto it = symbolIds.find(name);
+    if (it != symbolIds.end()) { return it->second; }
+    auto symbol = static_cast<SymbolId>(symbolNames.size());
+    symbolNames.emplace_back(name);
+    symbolIds.emplace(symbolNames.back(), symbol);
+    return symbol;
+}
+
+OpCode TermStore::opCodeOf(std::string_view name) {
+    auto it = std::find(opNames.begin(), opNames.end(), name);
+    if (it == opNames.end()) { return OpCode::OTHER; }
+    return static_cast<OpCode>(it - opNames.begin());
+}
+
+TermRef TermStore::getOrCreate(TermNode node, TermRef const * args, std::size_t count) {
+    std::size_t hash = std::hash<SymbolId>{}(node.symbol);
+    auto combine = [&hash](std::size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+    combine(static_cast<std::size_t>(node.kind));
+    combine(static_cast<std::size_t>(node.terminalType));
+    combine(static_cast<std::size_t>(node.op));
+    for (std::size_t i = 0; i < count; ++i) {
+        combine(args[i].x);
+    }
+    auto [begin, end] = table.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        auto const & candidate = nodes[it->second.x];
+        if (candidate.kind == node.kind and candidate.terminalType == node.terminalType and candidate.op == node.op and
+            candidate.symbol == node.symbol and candidate.size == count and
+            std::equal(args, args + count, children.begin() + candidate.firstChild)) {
+            return it->second;
         }
-        return ss.str();
-    } else {
-        throw std::logic_error("This is not a non-linear case!");
     }
+    node.firstChild = static_cast<std::uint32_t>(children.size());
+    node.size = static_cast<std::uint32_t>(count);
+    children.insert(children.end(), args, args + count);
+    TermRef ref{static_cast<std::uint32_t>(nodes.size())};
+    nodes.push_back(node);
+    table.emplace(hash, ref);
+    return ref;
+}
+
+TermRef TermStore::mkTerminal(std::string_view val, TerminalType type) {
+    if (type == TerminalType::INT or type == TerminalType::REAL) {
+        auto value = parseNumeral(val);
+        std::ostringstream canonical;
+        printNumeral(canonical, value, type);
+        std::string spelling(trim(val));
+        if (spelling == canonical.str()) { spelling.clear(); }
+        return mkNumeral(value, type, std::move(spelling));
+    }
+    return getOrCreate(TermNode{TermKind::TERMINAL, type, OpCode::OTHER, intern(val), 0, 0}, nullptr, 0);
+}
+
+TermRef TermStore::mkNumeral(FastRational const & value, TerminalType type) {
+    return mkNumeral(value, type, {});
 }
 
-std::string Term::printTerm() {
-    PrintVisitor printVisitor;
-    this->accept(&printVisitor);
-    return printVisitor.getString();
+TermRef TermStore::mkNumeral(FastRational const & value, TerminalType type, std::string spelling) {
+    assert(type == TerminalType::INT or type == TerminalType::REAL);
+    auto id = static_cast<std::uint32_t>(numerals.size());
+    auto [it, inserted] = numeralIds.emplace(std::make_pair(value, spelling), id);
+    if (inserted) {
+        numerals.push_back(value);
+        numeralSpellings.push_back(std::move(spelling));
+    }
+    return getOrCreate(TermNode{TermKind::TERMINAL, type, OpCode::OTHER, it->second, 0, 0}, nullptr, 0);
 }
 
-void PrintVisitor::visit(Terminal * term) {
-    ss << term->getVal();
+TermRef TermStore::mkOp(std::string_view opcode, std::vector<TermRef> const & args) {
+    return getOrCreate(
+        TermNode{TermKind::OP, TerminalType::UNDECLARED, opCodeOf(opcode), intern(opcode), 0, 0}, args.data(),
+        args.size());
 }
 
-void PrintVisitor::visit(Op * term) {
-    ss << "(" << term->getOp();
-    for (auto const & arg : term->getArgs()) {
-        ss << " ";
-        arg->accept(this);
+TermRef TermStore::mkOp(OpCode opcode, std::vector<TermRef> const & args) {
+    return getOrCreate(TermNode{TermKind::OP, TerminalType::UNDECLARED, opcode, intern(nameOf(opcode)), 0, 0},
+                       args.data(), args.size());
+}
+
+TermRef TermStore::mkApp(std::string_view fun, std::vector<TermRef> const & args) {
+    return getOrCreate(TermNode{TermKind::APP, TerminalType::UNDECLARED, OpCode::OTHER, intern(fun), 0, 0},
+                       args.data(), args.size());
+}
+
+TermRef TermStore::mkQuant(std::string_view quant, std::vector<TermRef> const & vars,
+                           std::vector<TermRef> const & sorts, TermRef coreTerm) {
+    assert(vars.size() == sorts.size());
+    std::vector<TermRef> quantChildren(vars);
+    quantChildren.insert(quantChildren.end(), sorts.begin(), sorts.end());
+    quantChildren.push_back(coreTerm);
+    return getOrCreate(TermNode{TermKind::QUANT, TerminalType::UNDECLARED, OpCode::OTHER, intern(quant), 0, 0},
+                       quantChildren.data(), quantChildren.size());
+}
+
+TermRef TermStore::mkLet(std::vector<std::string> const & termNames, std::vector<TermRef> const & declarations,
+                         TermRef application) {
+    assert(termNames.size() == declarations.size());
+    std::vector<TermRef> letChildren;
+    for (auto const & name : termNames) {
+        letChildren.push_back(mkTerminal(name, TerminalType::UNDECLARED));
     }
-    ss << ")";
+    letChildren.insert(letChildren.end(), declarations.begin(), declarations.end());
+    letChildren.push_back(application);
+    return getOrCreate(TermNode{TermKind::LET, TerminalType::UNDECLARED, OpCode::OTHER, intern("let"), 0, 0},
+                       letChildren.data(), letChildren.size());
+}
+
+TermRef TermStore::rebuild(TermRef term, std::vector<TermRef> const & newChildren) {
+    return getOrCreate(node(term), newChildren.data(), newChildren.size());
+}
+
+TermRef TermStore::import(TermStore const & source, TermRef term) {
+    std::unordered_map<TermRef, TermRef, TermRefHash> imported;
+    auto importRec = [&](auto & self, TermRef ref) -> TermRef {
+        auto it = imported.find(ref);
+        if (it != imported.end()) { return it->second; }
+        TermRef result = TermRef_Undef;
+        if (source.isNumeral(ref)) {
+            result = mkNumeral(source.getNumeral(ref), source.getTerminalType(ref),
+                               source.numeralSpellings[source.node(ref).symbol]);
+        } else {
+            std::vector<TermRef> args;
+            args.reserve(source.getArity(ref));
+            for (std::size_t i = 0; i < source.getArity(ref); ++i) {
+                args.push_back(self(self, source.getArg(ref, i)));
+            }
+            TermNode copy = source.node(ref);
+            copy.symbol = intern(source.getName(ref));
+            result = getOrCreate(copy, args.data(), args.size());
+        }
+        imported.emplace(ref, result);
+        return result;
+    };
+    return importRec(importRec, term);
 }
 
-void PrintVisitor::visit(App * term) {
-    ss << "(" << term->getFun();
-    for (std::shared_ptr<Term> const & arg : term->getArgs()) {
-        ss << " ";
-        arg->accept(this);
+std::vector<TermRef> TermStore::getArgs(TermRef ref) const {
+    auto const & termNode = node(ref);
+    return {children.begin() + termNode.firstChild, children.begin() + termNode.firstChild + termNode.size};
+}
+
+bool TermStore::isTrue(TermRef ref) const {
+    return isTerminal(ref) and getSymbol(ref) == trueSymbol;
+}
+
+bool TermStore::isFalse(TermRef ref) const {
+    return isTerminal(ref) and getSymbol(ref) == falseSymbol;
+}
+
+void TermStore::print(TermRef ref, std::ostream & out) const {
+    switch (getKind(ref)) {
+        case TermKind::TERMINAL:
+            if (isNumeral(ref)) {
+                auto const & spelling = numeralSpellings[node(ref).symbol];
+                if (spelling.empty()) {
+                    printNumeral(out, getNumeral(ref), getTerminalType(ref));
+                } else {
+                    out << spelling;
+                }
+            } else {
+                out << getName(ref);
+            }
+            return;
+        case TermKind::OP:
+        case TermKind::APP:
+            out << "(" << getName(ref);
+            for (std::size_t i = 0; i < getArity(ref); ++i) {
+                out << " ";
+                print(getArg(ref, i), out);
+            }
+            out << ")";
+            return;
+        case TermKind::QUANT:
+        case TermKind::LET: {
+            auto count = getBoundCount(ref);
+            out << "(" << getName(ref) << " (";
+            for (std::size_t i = 0; i < count; i++) {
+                out << "(";
+                print(getBoundVar(ref, i), out);
+                out << " ";
+                print(getBoundSort(ref, i), out);
+                out << ")";
+                if (i + 1 != count) { out << " "; }
+            }
+            out << ") ";
+            print(getCoreTerm(ref), out);
+            out << ")";
+            return;
+        }
     }
-    ss << ")";
-}
-
-void PrintVisitor::visit(Quant * term) {
-    ss << "(" << term->getQuant() << " (";
-    for (std::size_t i = 0; i < term->getVars().size(); i++) {
-        ss << "(";
-        term->getVars()[i]->accept(this);
-        ss << " ";
-        term->getSorts()[i]->accept(this);
-        ss << ")";
-        if (i + 1 != term->getVars().size()) { ss << " "; }
+}
+
+std::string TermStore::printTerm(TermRef ref) const {
+    std::ostringstream ss;
+    print(ref, ss);
+    return ss.str();
+}
+
+bool nonLinearity(TermStore const & terms, TermRef term) {
+    int predicates = 0;
+    if (terms.isOp(term, OpCode::AND)) {
+        for (std::size_t i = 0; i < terms.getArity(term); ++i) {
+            TermRef arg = terms.getArg(term, i);
+            if (terms.isApp(arg) or terms.getTerminalType(arg) == TerminalType::VAR) { predicates++; }
+        }
+        if (predicates >= 2) {
+            return true;
+        } else {
+            return false;
+        }
+    } else {
+        return false;
     }
-    ss << ") ";
-    term->getCoreTerm()->accept(this);
-    ss << ")";
-}
-
-void PrintVisitor::visit(Let * term) {
-    auto names = term->getTermNames();
-    ss << "(let (";
-    for (std::size_t i = 0; i < names.size(); i++) {
-        ss << "(" << names[i] << " ";
-        term->getDeclarations()[i]->accept(this);
-        ss << ")";
-        if (i + 1 != names.size()) { ss << " "; }
+}
+
+std::string nonLinearSimplification(TermStore const & terms, TermRef term) {
+    std::stringstream ss;
+    if (terms.isOp(term, OpCode::AND)) {
+        auto size = terms.getArity(term);
+        for (std::size_t i = 0; i < size; i++) {
+            ss << "(not ";
+            terms.print(terms.getArg(term, i), ss);
+            ss << ")";
+            if (i != size - 1) { ss << " "; }
+        }
+        return ss.str();
+    } else {
+        throw std::logic_error("This is not a non-linear case!");
     }
-    ss << ") ";
-    term->getApplication()->accept(this);
-    ss << ")";
 }
 
-std::shared_ptr<Term> CongChainVisitor::visit(Terminal * term) {
-    return std::make_shared<Terminal>(term->getVal(), term->getType());
+TermRef CongChainVisitor::visit(TermRef term) {
+    switch (terms.getKind(term)) {
+        case TermKind::TERMINAL:
+        case TermKind::APP:
+            return term;
+        case TermKind::OP:
+            return visitOp(term);
+        case TermKind::QUANT:
+        case TermKind::LET:
+            throw std::logic_error("This should not have happened!");
+    }
+    throw std::logic_error("Unexpected kind of proof term");
 }
 
-std::shared_ptr<Term> CongChainVisitor::visit(Op * term) {
+TermRef CongChainVisitor::visitOp(TermRef term) {
 
     transCase = 0;
-    auto args = term->getArgs();
-    bool canSimplify = true;
-
-    for (auto const & arg : args) {
-        if (not(arg->getTermType() == Term::TERMINAL or arg->getTermType() == Term::APP)) {
-            canSimplify = false;
-            break;
-        }
-    }
+    auto args = terms.getArgs(term);
+    bool canSimplify = std::all_of(args.begin(), args.end(),
+                                   [this](TermRef arg) { return terms.isTerminal(arg) or terms.isApp(arg); });
 
     if (canSimplify) {
         std::vector<std::size_t> premises;
-        auto simplification = term->operate();
-        steps.emplace_back(
-            currentStep,
-            std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{term->accept(&copyVisitor), term->operate()}),
-            premises, term->simplifyRule());
+        auto simplification = operate(terms, term);
+        steps.emplace_back(currentStep, terms.mkOp(OpCode::EQ, {term, simplification}), premises,
+                           simplifyRule(terms, term));
         currentStep++;
-        if (term->getOp() == ">") {
-            auto originalSimplification = simplification->accept(&copyVisitor);
-            auto lessOrEq = std::dynamic_pointer_cast<Op>(simplification)->getArgs()[0];
-            auto innerWorking = std::dynamic_pointer_cast<Op>(lessOrEq)->operate();
-            steps.emplace_back(currentStep,
-                               std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{lessOrEq, innerWorking}),
-                               premises, std::dynamic_pointer_cast<Op>(lessOrEq)->simplifyRule());
+        if (terms.isOp(term, OpCode::GT)) {
+            auto originalSimplification = simplification;
+            auto lessOrEq = terms.getArg(simplification, 0);
+            auto innerWorking = operate(terms, lessOrEq);
+            steps.emplace_back(currentStep, terms.mkOp(OpCode::EQ, {lessOrEq, innerWorking}), premises,
+                               simplifyRule(terms, lessOrEq));
             currentStep++;
-            std::dynamic_pointer_cast<Op>(simplification)->setArg(0, innerWorking);
-            auto cong =
-                std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{originalSimplification, simplification});
+            simplification = terms.rebuild(simplification, {innerWorking});
+            auto cong = terms.mkOp(OpCode::EQ, {originalSimplification, simplification});
 
             steps.emplace_back(currentStep, cong, std::vector<std::size_t>{currentStep - 1}, "cong");
             currentStep++;
-            auto outerWorking = std::dynamic_pointer_cast<Op>(simplification)->operate();
-            steps.emplace_back(
-                currentStep,
-                std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{simplification, outerWorking}), premises,
-                std::dynamic_pointer_cast<Op>(simplification)->simplifyRule());
+            auto outerWorking = operate(terms, simplification);
+            steps.emplace_back(currentStep, terms.mkOp(OpCode::EQ, {simplification, outerWorking}), premises,
+                               simplifyRule(terms, simplification));
 
             currentStep++;
-            auto trans =
-                std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{originalSimplification, outerWorking});
+            auto trans = terms.mkOp(OpCode::EQ, {originalSimplification, outerWorking});
             steps.emplace_back(currentStep, trans, std::vector<std::size_t>{currentStep - 2, currentStep - 1}, "trans");
             currentStep++;
-            trans =
-                std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{term->accept(&copyVisitor), outerWorking});
+            trans = terms.mkOp(OpCode::EQ, {term, outerWorking});
             steps.emplace_back(currentStep, trans, std::vector<std::size_t>{currentStep - 5, currentStep - 1}, "trans");
             currentStep++;
             simplification = outerWorking;
-        } else if (term->getOp() == ">=") {
+        } else if (terms.isOp(term, OpCode::GEQ)) {
             transCase = 1;
-            auto originalSimplification = simplification->accept(&copyVisitor);
-            simplification = std::dynamic_pointer_cast<Op>(simplification)->operate();
-            steps.emplace_back(
-                currentStep,
-                std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{originalSimplification, simplification}),
-                premises, std::dynamic_pointer_cast<Op>(originalSimplification)->simplifyRule());
+            auto originalSimplification = simplification;
+            simplification = operate(terms, simplification);
+            steps.emplace_back(currentStep, terms.mkOp(OpCode::EQ, {originalSimplification, simplification}),
+                               premises, simplifyRule(terms, originalSimplification));
             currentStep++;
-            auto trans = std::make_shared<Op>(
-                "=", std::vector<std::shared_ptr<Term>>{term->accept(&copyVisitor), simplification});
+            auto trans = terms.mkOp(OpCode::EQ, {term, simplification});
             steps.emplace_back(currentStep, trans, std::vector<std::size_t>{currentStep - 2, currentStep - 1}, "trans");
             currentStep++;
         }
@@ -169,18 +368,17 @@ std::shared_ptr<Term> CongChainVisitor::visit(Op * term) {
     } else {
 
         std::vector<std::size_t> premises;
-        auto termCopy = term->accept(&copyVisitor);
-        for (std::size_t i = 0; i < std::dynamic_pointer_cast<Op>(termCopy)->getArgs().size(); i++) {
-            auto arg = std::dynamic_pointer_cast<Op>(termCopy)->getArgs()[i];
-            std::dynamic_pointer_cast<Op>(termCopy)->setArg(int(i), arg->accept(this));
-            if (arg->getTermType() == Term::OP) { premises.push_back(currentStep - 1); }
+        std::vector<TermRef> simplifiedArgs;
+        for (TermRef arg : args) {
+            simplifiedArgs.push_back(visit(arg));
+            if (terms.isOp(arg)) { premises.push_back(currentStep - 1); }
         }
-        auto cong = std::make_shared<Op>("=", std::vector<std::shared_ptr<Term>>{term->accept(&copyVisitor), termCopy});
+        auto termCopy = terms.rebuild(term, simplifiedArgs);
+        auto cong = terms.mkOp(OpCode::EQ, {term, termCopy});
         steps.emplace_back(currentStep, cong, premises, "cong");
         currentStep++;
-        auto furtherSimplification = termCopy->accept(this);
-        auto trans = std::make_shared<Op>(
-            "=", std::vector<std::shared_ptr<Term>>{term->accept(&copyVisitor), furtherSimplification});
+        auto furtherSimplification = visit(termCopy);
+        auto trans = terms.mkOp(OpCode::EQ, {term, furtherSimplification});
         std::size_t predecessor;
         if (transCase == 1) {
             predecessor = currentStep - 4;
@@ -194,440 +392,290 @@ std::shared_ptr<Term> CongChainVisitor::visit(Op * term) {
     }
 }
 
-std::shared_ptr<Term> CongChainVisitor::visit(App * term) {
-    return std::make_shared<App>(term->getFun(), term->getArgs());
-}
-
-std::string Op::simplifyRule() {
-    std::string op = operation;
-    if (op == "=") {
-        if ((args[0]->printTerm().find_first_not_of("( )-0123456789") == std::string::npos) and
-            (args[1]->printTerm().find_first_not_of("( )-0123456789") == std::string::npos)) {
-            return "eq_simplify";
-        } else {
-            return "equiv_simplify";
-        }
-    } else if ((op == ">") or (op == "<") or (op == "<=") or (op == ">=")) {
-        return "comp_simplify";
-    } else if (op == "and") {
-        return "and_simplify";
-    } else if (op == "or") {
-        return "or_simplify";
-    } else if (op == "+") {
-        return "sum_simplify";
-    } else if (op == "-") {
-        return "minus_simplify";
-    } else if (op == "/" or op == "div") {
-        return "div_simplify";
-    } else if (op == "*") {
-        return "prod_simplify";
-    } else if (op == "not") {
-        return "not_simplify";
-    } else if (op == "ite") {
-        return "ite_simplify";
-    } else if (op == "mod") {
-        return "mod_simplify";
-    }
-    return "Error";
-}
-
-std::shared_ptr<Term> InstantiateVisitor::visit(Terminal * term) {
-    auto val = term->getVal();
-    auto type = term->getType();
-    if (type != Term::VAR) { return std::make_shared<Terminal>(val, type); }
-    for (std::pair<std::string, std::string> const & pair : instPairs) {
-        if (val == pair.first) {
-            if (pair.second == "true" or pair.second == "false") {
-                return std::make_shared<Terminal>(pair.second, Term::BOOL);
-            } else if (pair.second.find('.') != std::string::npos) {
-                return std::make_shared<Terminal>(pair.second, Term::REAL);
+std::string simplifyRule(TermStore const & terms, TermRef term) {
+    switch (terms.getOp(term)) {
+        case OpCode::EQ:
+            if (terms.isNumeral(terms.getArg(term, 0)) and terms.isNumeral(terms.getArg(term, 1))) {
+                return "eq_simplify";
             } else {
-                return std::make_shared<Terminal>(pair.second, Term::INT);
+                return "equiv_simplify";
             }
-        }
+        case OpCode::GT:
+        case OpCode::LT:
+        case OpCode::LEQ:
+        case OpCode::GEQ:
+            return "comp_simplify";
+        case OpCode::AND:
+            return "and_simplify";
+        case OpCode::OR:
+            return "or_simplify";
+        case OpCode::PLUS:
+            return "sum_simplify";
+        case OpCode::MINUS:
+            return "minus_simplify";
+        case OpCode::DIVIDE:
+        case OpCode::DIV:
+            return "div_simplify";
+        case OpCode::TIMES:
+            return "prod_simplify";
+        case OpCode::NOT:
+            return "not_simplify";
+        case OpCode::ITE:
+            return "ite_simplify";
+        case OpCode::MOD:
+            return "mod_simplify";
+        default:
+            return "Error";
     }
-    return std::make_shared<Terminal>(val, type);
-}
-
-std::shared_ptr<Term> InstantiateVisitor::visit(Op * term) {
-    std::vector<std::shared_ptr<Term>> args;
-    std::string opcode = term->getOp();
-    for (std::shared_ptr<Term> const & arg : term->getArgs()) {
-        args.push_back(arg->accept(this));
-    }
-    return std::make_shared<Op>(opcode, args);
-}
-
-std::shared_ptr<Term> InstantiateVisitor::visit(App * term) {
-    std::vector<std::shared_ptr<Term>> args;
-    std::string fun = term->getFun();
-    for (std::shared_ptr<Term> const & arg : term->getArgs()) {
-        args.push_back(arg->accept(this));
-    }
-    return std::make_shared<App>(fun, args);
-}
-
-std::shared_ptr<Term> InstantiateVisitor::visit(Quant * term) {
-    std::shared_ptr<Term> coreTerm = term->getCoreTerm()->accept(this);
-    return coreTerm;
 }
 
-std::shared_ptr<Term> InstantiateVisitor::visit(Let * term) {
-    std::vector<std::shared_ptr<Term>> declarations;
-    auto application = term->getApplication();
-    for (std::shared_ptr<Term> const & dec : term->getDeclarations()) {
-        declarations.push_back(dec->accept(this));
+InstantiateVisitor::InstantiateVisitor(TermStore & terms,
+                                       std::vector<std::pair<std::string, std::string>> const & instPairs)
+    : terms(terms) {
+    for (auto const & [var, value] : instPairs) {
+        TerminalType type = TerminalType::INT;
+        if (value == "true" or value == "false") {
+            type = TerminalType::BOOL;
+        } else if (value.find_first_of("./") != std::string::npos) {
+            type = TerminalType::REAL;
+        }
+        // The first pair for the variable takes precedence
+        substitution.emplace(terms.intern(var), terms.mkTerminal(value, type));
     }
-    application->accept(this);
-    return std::make_shared<Let>(term->getTermNames(), declarations, application);
 }
 
-std::shared_ptr<Term> RemoveUnusedVisitor::visit(Quant * term) {
-
-    auto vars = term->getVars();
-    std::vector<std::shared_ptr<Term>> newVars;
-    auto sorts = term->getSorts();
-    std::vector<std::shared_ptr<Term>> newSorts;
-    auto coreTerm = term->getCoreTerm();
-
-    coreTerm->accept(this);
-
-    for (std::size_t i = 0; i < vars.size(); i++) {
-        for (auto const & varInUse : varsInUse) {
-            if (vars[i]->printTerm() == varInUse) {
-                newVars.push_back(vars[i]);
-                newSorts.push_back(sorts[i]);
+TermRef InstantiateVisitor::visit(TermRef term) {
+    switch (terms.getKind(term)) {
+        case TermKind::TERMINAL: {
+            if (terms.getTerminalType(term) != TerminalType::VAR) { return term; }
+            auto it = substitution.find(terms.getSymbol(term));
+            return it == substitution.end() ? term : it->second;
+        }
+        case TermKind::OP:
+        case TermKind::APP: {
+            auto it = cache.find(term);
+            if (it != cache.end()) { return it->second; }
+            auto args = terms.getArgs(term);
+            for (TermRef & arg : args) {
+                arg = visit(arg);
             }
+            auto result = terms.rebuild(term, args);
+            cache.emplace(term, result);
+            return result;
+        }
+        case TermKind::QUANT:
+            return visit(terms.getCoreTerm(term));
+        case TermKind::LET: {
+            // Only the declarations are instantiated
+            auto letChildren = terms.getArgs(term);
+            auto count = terms.getBoundCount(term);
+            for (std::size_t i = 0; i < count; ++i) {
+                letChildren[count + i] = visit(letChildren[count + i]);
+            }
+            return terms.rebuild(term, letChildren);
         }
     }
-
-    if (newVars.empty()) { return term->getCoreTerm(); }
-    return std::make_shared<Quant>(term->getQuant(), newVars, newSorts, term->getCoreTerm());
-}
-
-std::shared_ptr<Term> RemoveUnusedVisitor::visit(Terminal * term) {
-    for (auto const & var : varsInUse) {
-        if (term->printTerm() == var) { return nullptr; }
-    }
-    varsInUse.push_back(term->printTerm());
-    return nullptr;
-}
-
-std::shared_ptr<Term> RemoveUnusedVisitor::visit(Op * term) {
-    auto args = term->getArgs();
-    for (auto const & arg : args) {
-        arg->accept(this);
+    throw std::logic_error("Unexpected kind of proof term");
+}
+
+void RemoveUnusedVisitor::collect(TermRef term) {
+    switch (terms.getKind(term)) {
+        case TermKind::TERMINAL:
+            if (not terms.isNumeral(term)) { varsInUse.insert(terms.getSymbol(term)); }
+            return;
+        case TermKind::OP:
+        case TermKind::APP:
+            for (std::size_t i = 0; i < terms.getArity(term); ++i) {
+                collect(terms.getArg(term, i));
+            }
+            return;
+        case TermKind::QUANT:
+            collect(terms.getCoreTerm(term));
+            return;
+        case TermKind::LET:
+            return;
     }
-    return nullptr;
 }
 
-std::shared_ptr<Term> RemoveUnusedVisitor::visit(App * term) {
-    auto args = term->getArgs();
-    for (auto const & arg : args) {
-        arg->accept(this);
+TermRef RemoveUnusedVisitor::visit(TermRef term) {
+    if (terms.getKind(term) != TermKind::QUANT) {
+        collect(term);
+        return TermRef_Undef;
     }
-    return nullptr;
-}
-
-std::shared_ptr<Term> SimplifyVisitor::visit(Terminal * term) {
-    return std::make_shared<Terminal>(term->getVal(), term->getType());
-}
-
-std::shared_ptr<Term> SimplifyVisitor::visit(Op * term) {
-
-    auto args = term->getArgs();
-    std::vector<std::shared_ptr<Term>> newArgs;
-    auto op = term->getOp();
-
-    if (operation == term) {
-        return simplification;
-    } else {
-        for (auto const & arg : args) {
-            newArgs.push_back(arg->accept(this));
+    TermRef coreTerm = terms.getCoreTerm(term);
+    collect(coreTerm);
+
+    std::vector<TermRef> newVars;
+    std::vector<TermRef> newSorts;
+    for (std::size_t i = 0; i < terms.getBoundCount(term); i++) {
+        TermRef var = terms.getBoundVar(term, i);
+        if (varsInUse.find(terms.getSymbol(var)) != varsInUse.end()) {
+            newVars.push_back(var);
+            newSorts.push_back(terms.getBoundSort(term, i));
         }
-        return std::make_shared<Op>(op, newArgs);
     }
-}
-
-std::shared_ptr<Term> SimplifyVisitor::visit(App * term) {
-    return std::make_shared<App>(term->getFun(), term->getArgs());
-}
 
-std::shared_ptr<Term> SimplifyVisitor::visit(Quant * term) {
-
-    return std::make_shared<Quant>(term->getQuant(), term->getVars(), term->getSorts(),
-                                   term->getCoreTerm()->accept(this));
-}
-
-std::shared_ptr<Term> SimplifyVisitor::visit(Let * term) {
-
-    if (operation == term) {
-        return simplification;
-    } else {
-        return std::make_shared<Let>(term->getTermNames(), term->getDeclarations(),
-                                     term->getApplication()->accept(this));
-    }
+    if (newVars.empty()) { return coreTerm; }
+    return terms.mkQuant(terms.getName(term), newVars, newSorts, coreTerm);
 }
 
-std::shared_ptr<Term> Op::operate() {
-    std::vector<std::shared_ptr<Term>> newArgs;
-    InstantiateVisitor copyVisitor;
-    std::string firstStr;
-    std::string secondStr;
-    FastRational firstTerm;
-    FastRational secondTerm;
-
-    if (operation == "<" or operation == "<=" or operation == "-" or operation == "*" or operation == "/" or
-        operation == "mod" or operation == "div") {
-        assert(args[0]->getTerminalType() != Term::VAR);
-        assert(args[1]->getTerminalType() != Term::VAR);
-        firstStr = args[0]->printTerm();
-        secondStr = args[1]->printTerm();
-        firstStr.erase(remove(firstStr.begin(), firstStr.end(), '('), firstStr.end());
-        firstStr.erase(remove(firstStr.begin(), firstStr.end(), ')'), firstStr.end());
-        firstStr.erase(remove(firstStr.begin(), firstStr.end(), ' '), firstStr.end());
-        secondStr.erase(remove(secondStr.begin(), secondStr.end(), '('), secondStr.end());
-        secondStr.erase(remove(secondStr.begin(), secondStr.end(), ')'), secondStr.end());
-        secondStr.erase(remove(secondStr.begin(), secondStr.end(), ' '), secondStr.end());
-        firstTerm = FastRational(&firstStr[0], 10);
-        secondTerm = FastRational(&secondStr[0], 10);
-    }
-
-    if (operation == "=") {
-        assert(args[0]->getTerminalType() != Term::VAR);
-        assert(args[1]->getTerminalType() != Term::VAR);
-        if (args[0]->printTerm() == args[1]->printTerm()) {
-            return std::make_shared<Terminal>("true", Term::BOOL);
-        } else {
-            return std::make_shared<Terminal>("false", Term::BOOL);
-        }
-    } else if (operation == ">") {
-        return std::make_shared<Op>("not", std::vector<std::shared_ptr<Term>>{std::make_shared<Op>("<=", args)});
-    } else if (operation == "<") {
-        if (firstTerm < secondTerm) {
-            return std::make_shared<Terminal>("true", Term::BOOL);
-        } else {
-            return std::make_shared<Terminal>("false", Term::BOOL);
-        }
-    } else if (operation == "<=") {
-        if (firstTerm <= secondTerm) {
-            return std::make_shared<Terminal>("true", Term::BOOL);
-        } else {
-            return std::make_shared<Terminal>("false", Term::BOOL);
-        }
-    } else if (operation == ">=") {
-        newArgs.push_back(args[1]);
-        newArgs.push_back(args[0]);
-        return std::make_shared<Op>("<=", newArgs);
-    } else if (operation == "and") {
-        int trues = 0;
-        std::vector<std::shared_ptr<Term>> predicates;
-
-        for (auto const & arg : args) {
-            //           assert(arg->getTerminalType() != Term::VAR);
-            if (arg->printTerm() == "false") { return std::make_shared<Terminal>("false", Term::BOOL); }
-            if (arg->printTerm() == "true") { trues++; }
-            if (arg->printTerm() != "true") { predicates.push_back(arg); }
-        }
-        if (trues == int(args.size())) { return std::make_shared<Terminal>("true", Term::BOOL); }
-        if (predicates.size() == 1) {
-            return predicates[0]->accept(&copyVisitor);
-        } else {
-            for (auto const & predicate : predicates) {
-                newArgs.push_back(predicate->accept(&copyVisitor));
+TermRef SimplifyVisitor::visit(TermRef term) {
+    switch (terms.getKind(term)) {
+        case TermKind::TERMINAL:
+        case TermKind::APP:
+            return term;
+        case TermKind::OP: {
+            if (term == operation) { return simplification; }
+            auto args = terms.getArgs(term);
+            for (TermRef & arg : args) {
+                arg = visit(arg);
             }
-            return std::make_shared<Op>("and", newArgs);
+            return terms.rebuild(term, args);
         }
-    } else if (operation == "or") {
-        for (auto const & arg : args) {
-            assert(arg->getTerminalType() != Term::VAR);
-            if (arg->printTerm() == "true") { return std::make_shared<Terminal>("true", Term::BOOL); }
-        }
-        return std::make_shared<Terminal>("false", Term::BOOL);
-    } else if (operation == "+") {
-        FastRational result = 0;
-        for (auto const & arg : args) {
-            assert(arg->getTerminalType() != Term::VAR);
-            std::string str = arg->printTerm();
-            str.erase(remove(str.begin(), str.end(), '('), str.end());
-            str.erase(remove(str.begin(), str.end(), ')'), str.end());
-            str.erase(remove(str.begin(), str.end(), ' '), str.end());
-            char * const ptr = &str[0];
-            FastRational temp(ptr, 10);
-            result += temp;
-        }
-        if (result < 0) {
-            result *= -1;
-            return std::make_shared<Terminal>("(- " + result.get_str() + ")", Term::INT);
-        } else {
-            return std::make_shared<Terminal>(result.get_str(), Term::INT);
-        }
-    } else if (operation == "-") {
-        FastRational result = firstTerm - secondTerm;
-        if (result < 0) {
-            result *= -1;
-            return std::make_shared<Terminal>("(- " + result.get_str() + ")", Term::INT);
-        } else {
-            return std::make_shared<Terminal>(result.get_str(), Term::INT);
-        }
-    } else if (operation == "/") {
-        FastRational result = firstTerm / secondTerm;
-        if (result < 0) {
-            result *= -1;
-            return std::make_shared<Terminal>("(- " + result.get_str() + ")", Term::INT);
-        } else {
-            return std::make_shared<Terminal>(result.get_str(), Term::INT);
-        }
-    } else if (operation == "*") {
-        FastRational result = firstTerm * secondTerm;
-        if (result < 0) {
-            result *= -1;
-            return std::make_shared<Terminal>("(- " + result.get_str() + ")", Term::INT);
-        } else {
-            return std::make_shared<Terminal>(result.get_str(), Term::INT);
+        case TermKind::QUANT:
+        case TermKind::LET: {
+            if (term == operation) { return simplification; }
+            auto boundChildren = terms.getArgs(term);
+            boundChildren.back() = visit(boundChildren.back());
+            return terms.rebuild(term, boundChildren);
         }
-    } else if (operation == "not") {
-        assert(args[0]->getTerminalType() != Term::VAR);
-        if (args[0]->printTerm() == "false") {
-            return std::make_shared<Terminal>("true", Term::BOOL);
-        } else {
-            return std::make_shared<Terminal>("false", Term::BOOL);
+    }
+    throw std::logic_error("Unexpected kind of proof term");
+}
+
+TermRef operate(TermStore & terms, TermRef term) {
+    auto args = terms.getArgs(term);
+    auto operation = terms.getOp(term);
+
+    auto value = [&terms](TermRef arg) -> FastRational const & {
+        assert(terms.isNumeral(arg));
+        return terms.getNumeral(arg);
+    };
+    auto mkBool = [&terms](bool value) { return terms.mkTerminal(value ? "true" : "false", TerminalType::BOOL); };
+    // The result is real if any of the operands is
+    auto resultType = std::any_of(args.begin(), args.end(), [&terms](TermRef arg) {
+        return terms.getTerminalType(arg) == TerminalType::REAL;
+    }) ? TerminalType::REAL : TerminalType::INT;
+    auto mkNumeral = [&](FastRational const & result) { return terms.mkNumeral(result, resultType); };
+
+    switch (operation) {
+        case OpCode::EQ:
+            assert(terms.getTerminalType(args[0]) != TerminalType::VAR);
+            assert(terms.getTerminalType(args[1]) != TerminalType::VAR);
+            if (terms.isNumeral(args[0]) and terms.isNumeral(args[1])) {
+                return mkBool(value(args[0]) == value(args[1]));
+            }
+            return mkBool(args[0] == args[1]);
+        case OpCode::GT:
+            return terms.mkOp(OpCode::NOT, {terms.mkOp(OpCode::LEQ, args)});
+        case OpCode::LT:
+            return mkBool(value(args[0]) < value(args[1]));
+        case OpCode::LEQ:
+            return mkBool(value(args[0]) <= value(args[1]));
+        case OpCode::GEQ:
+            return terms.mkOp(OpCode::LEQ, {args[1], args[0]});
+        case OpCode::AND: {
+            std::vector<TermRef> predicates;
+            for (TermRef arg : args) {
+                if (terms.isFalse(arg)) { return mkBool(false); }
+                if (not terms.isTrue(arg)) { predicates.push_back(arg); }
+            }
+            if (predicates.empty()) { return mkBool(true); }
+            if (predicates.size() == 1) { return predicates[0]; }
+            return terms.mkOp(OpCode::AND, predicates);
         }
-    } else if (operation == "ite") {
-        assert(args[0]->getTerminalType() != Term::VAR);
-        assert(args[1]->getTerminalType() != Term::VAR);
-        assert(args[2]->getTerminalType() != Term::VAR);
-        if (args[0]->printTerm() == "true") {
-            return args[1]->accept(&copyVisitor);
-        } else {
-            return args[2]->accept(&copyVisitor);
+        case OpCode::OR:
+            for (TermRef arg : args) {
+                assert(terms.getTerminalType(arg) != TerminalType::VAR);
+                if (terms.isTrue(arg)) { return mkBool(true); }
+            }
+            return mkBool(false);
+        case OpCode::PLUS: {
+            FastRational result = 0;
+            for (TermRef arg : args) {
+                result += value(arg);
+            }
+            return mkNumeral(result);
         }
-    } else if (operation == "mod") {
-        FastRational result = firstTerm % secondTerm;
-        if (result < 0) {
-            result *= -1;
-            return std::make_shared<Terminal>("(- " + result.get_str() + ")", Term::INT);
-        } else {
-            return std::make_shared<Terminal>(result.get_str(), Term::INT);
+        case OpCode::MINUS: {
+            if (args.size() == 1) { return mkNumeral(-value(args[0])); }
+            FastRational result = value(args[0]);
+            for (std::size_t i = 1; i < args.size(); ++i) {
+                result -= value(args[i]);
+            }
+            return mkNumeral(result);
         }
-    } else if (operation == "div") {
-        FastRational result = firstTerm / secondTerm;
-        if (result < 0) {
-            result *= -1;
-            return std::make_shared<Terminal>("(- " + result.ceil().get_str() + ")", Term::INT);
-        } else {
-            return std::make_shared<Terminal>(result.floor().get_str(), Term::INT);
+        case OpCode::DIVIDE:
+            return mkNumeral(value(args[0]) / value(args[1]));
+        case OpCode::TIMES: {
+            FastRational result = 1;
+            for (TermRef arg : args) {
+                result *= value(arg);
+            }
+            return mkNumeral(result);
         }
+        case OpCode::NOT:
+            assert(terms.getTerminalType(args[0]) != TerminalType::VAR);
+            return mkBool(terms.isFalse(args[0]));
+        case OpCode::ITE:
+            assert(terms.getTerminalType(args[0]) != TerminalType::VAR);
+            assert(terms.getTerminalType(args[1]) != TerminalType::VAR);
+            assert(terms.getTerminalType(args[2]) != TerminalType::VAR);
+            return terms.isTrue(args[0]) ? args[1] : args[2];
+        case OpCode::MOD:
+            return mkNumeral(value(args[0]) % value(args[1]));
+        case OpCode::DIV:
+            return mkNumeral((value(args[0]) / value(args[1])).floor());
+        default:
+            return terms.mkTerminal("Error", TerminalType::UNDECLARED);
     }
-
-    return std::make_shared<Terminal>("Error", Term::UNDECLARED);
 }
 
-std::shared_ptr<Term> OperateLetTermVisitor::visit(Terminal * term) {
-
-    for (std::size_t i = 0; i < terms.size(); i++) {
-        if (term->getVal() == terms[i]) { return substitutions[i]; }
-    }
-    return std::make_shared<Terminal>(term->getVal(), term->getType());
-}
-
-std::shared_ptr<Term> OperateLetTermVisitor::visit(Op * term) {
-    std::vector<std::shared_ptr<Term>> args;
-    std::string opcode = term->getOp();
-    for (std::shared_ptr<Term> const & arg : term->getArgs()) {
-        args.push_back(arg->accept(this));
-    }
-    return std::make_shared<Op>(opcode, args);
-}
-
-std::shared_ptr<Term> OperateLetTermVisitor::visit(App * term) {
-    std::vector<std::shared_ptr<Term>> args;
-    std::string fun = term->getFun();
-    for (std::shared_ptr<Term> const & arg : term->getArgs()) {
-        args.push_back(arg->accept(this));
+TermRef OperateLetTermVisitor::visit(TermRef term) {
+    switch (terms.getKind(term)) {
+        case TermKind::TERMINAL: {
+            if (terms.isNumeral(term)) { return term; }
+            auto it = substitutions.find(terms.getSymbol(term));
+            return it == substitutions.end() ? term : it->second;
+        }
+        case TermKind::OP:
+        case TermKind::APP: {
+            auto args = terms.getArgs(term);
+            for (TermRef & arg : args) {
+                arg = visit(arg);
+            }
+            return terms.rebuild(term, args);
+        }
+        case TermKind::QUANT:
+            return terms.mkTerminal("Error", TerminalType::UNDECLARED);
+        case TermKind::LET: {
+            substitutions.clear();
+            for (std::size_t i = 0; i < terms.getBoundCount(term); ++i) {
+                substitutions.emplace(terms.getSymbol(terms.getBoundVar(term, i)), terms.getBoundSort(term, i));
+            }
+            return visit(terms.getCoreTerm(term));
+        }
     }
-    return std::make_shared<App>(fun, args);
-}
-
-std::shared_ptr<Term> OperateLetTermVisitor::visit(Let * term) {
-    terms = term->getTermNames();
-    substitutions = term->getDeclarations();
-    return term->getApplication()->accept(this);
-}
-
-Term * LetLocatorVisitor::visit(Quant * term) {
-    return term->getCoreTerm()->accept(this);
-}
-
-Term * LetLocatorVisitor::visit(Op * term) {
-    auto args = term->getArgs();
-    for (auto const & arg : args) {
-        if (arg->accept(this) != nullptr) { return arg->accept(this); }
+    throw std::logic_error("Unexpected kind of proof term");
+}
+
+TermRef LetLocatorVisitor::visit(TermRef term) const {
+    switch (terms.getKind(term)) {
+        case TermKind::TERMINAL:
+        case TermKind::APP:
+            return TermRef_Undef;
+        case TermKind::QUANT:
+            return visit(terms.getCoreTerm(term));
+        case TermKind::OP:
+            for (std::size_t i = 0; i < terms.getArity(term); ++i) {
+                TermRef let = visit(terms.getArg(term, i));
+                if (let != TermRef_Undef) { return let; }
+            }
+            return TermRef_Undef;
+        case TermKind::LET: {
+            TermRef inner = visit(terms.getCoreTerm(term));
+            return inner == TermRef_Undef ? term : inner;
+        }
     }
-    return nullptr;
-}
-
-Term * LetLocatorVisitor::visit(Let * term) {
-    if (term->getApplication()->accept(this) == nullptr) { return term; }
-    return term->getApplication()->accept(this);
-}
-
-std::shared_ptr<Term> Terminal::accept(LogicVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-std::shared_ptr<Term> Op::accept(LogicVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-std::shared_ptr<Term> App::accept(LogicVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-std::shared_ptr<Term> Quant::accept(LogicVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-std::shared_ptr<Term> Let::accept(LogicVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-void Terminal::accept(VoidVisitor * visitor) {
-    visitor->visit(this);
-}
-
-void Op::accept(VoidVisitor * visitor) {
-    visitor->visit(this);
-}
-
-void App::accept(VoidVisitor * visitor) {
-    visitor->visit(this);
-}
-
-void Quant::accept(VoidVisitor * visitor) {
-    visitor->visit(this);
-}
-
-void Let::accept(VoidVisitor * visitor) {
-    visitor->visit(this);
-}
-
-Term * Terminal::accept(PointerVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-Term * Op::accept(PointerVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-Term * App::accept(PointerVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-Term * Quant::accept(PointerVisitor * visitor) {
-    return visitor->visit(this);
-}
-
-Term * Let::accept(PointerVisitor * visitor) {
-    return visitor->visit(this);
+    throw std::logic_error("Unexpected kind of proof term");
 }
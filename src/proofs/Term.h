@@ -7,247 +7,230 @@
 #ifndef GOLEM_TERM_H
 #define GOLEM_TERM_H
 #include "utils/SmtSolver.h"
-#include <memory>
+#include "FastRational.h"
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
-class Term {
-public:
-    enum termType { APP, OP, TERMINAL, QUANT, LET };
-    enum terminalType { VAR, REAL, INT, SORT, BOOL, UNDECLARED };
-    virtual termType getTermType() = 0;
-    virtual terminalType getTerminalType() = 0;
-    virtual void accept(class VoidVisitor *) = 0;
-    virtual std::shared_ptr<Term> accept(class LogicVisitor *) = 0;
-    virtual Term * accept(class PointerVisitor *) = 0;
-    virtual std::string printTerm();
-    virtual ~Term() = default;
+/*
+ * Proof terms are flat, tagged nodes stored in a TermStore and referenced by TermRef.
+ *
+ * The store hash-conses the nodes: structurally equal terms are represented by the same node, so terms can be
+ * compared by their references and they are shared between all the steps of the proof. Nodes are immutable; the
+ * names of terminals, operators, functions and quantifiers are interned as symbols, and operators are additionally
+ * coded as OpCode, so that the traversals below can dispatch on them without comparing strings.
+ *
+ * Integer and real terminals are numerals: their values are kept as rationals and are only printed when the proof is
+ * emitted, so that the arithmetic in the simplification chains does not go through strings. Numerals created from
+ * text (e.g., the literals of the input) are printed as written, results of the arithmetic in a canonical form.
+ */
+struct TermRef {
+    std::uint32_t x;
+    bool operator==(TermRef other) const { return x == other.x; }
+    bool operator!=(TermRef other) const { return x != other.x; }
 };
 
-class Terminal : public Term {
-    std::string val;
-    terminalType type;
+static constexpr TermRef TermRef_Undef = TermRef{UINT32_MAX};
 
-public:
-    Terminal(std::string val, terminalType t) : val(std::move(val)), type(t) {}
-    std::string const & getVal() { return val; }
-    terminalType const & getType() { return type; }
-    termType getTermType() override { return TERMINAL; }
-    terminalType getTerminalType() override { return type; }
-
-    std::shared_ptr<Term> accept(LogicVisitor *) override;
-    Term * accept(PointerVisitor *) override;
-    void accept(VoidVisitor *) override;
+struct TermRefHash {
+    std::size_t operator()(TermRef ref) const { return std::hash<std::uint32_t>{}(ref.x); }
 };
 
-class Op : public Term {
-    std::string operation;
-    std::vector<std::shared_ptr<Term>> args;
+using SymbolId = std::uint32_t;
 
-public:
-    Op(std::string opcode, std::vector<std::shared_ptr<Term>> args)
-        : operation(std::move(opcode)), args(std::move(args)) {}
-    std::string const & getOp() { return operation; }
-    std::vector<std::shared_ptr<Term>> const & getArgs() { return args; }
-    termType getTermType() override { return OP; }
-    terminalType getTerminalType() override { return UNDECLARED; }
-    std::string simplifyRule();
-    bool nonLinearity();
-    std::string nonLinearSimplification();
-    void setArg(int i, std::shared_ptr<Term> newArg) { args[i] = std::move(newArg); }
-    std::shared_ptr<Term> operate();
-
-    std::shared_ptr<Term> accept(LogicVisitor *) override;
-    Term * accept(PointerVisitor *) override;
-    void accept(VoidVisitor *) override;
-};
+enum class TermKind : std::uint8_t { TERMINAL, OP, APP, QUANT, LET };
 
-class App : public Term {
-    std::string fun;
-    std::vector<std::shared_ptr<Term>> args;
+enum class TerminalType : std::uint8_t { VAR, REAL, INT, SORT, BOOL, UNDECLARED };
 
-public:
-    App(std::string fun, std::vector<std::shared_ptr<Term>> args) : fun(std::move(fun)), args(std::move(args)) {}
-    std::string const & getFun() { return fun; }
-    std::vector<std::shared_ptr<Term>> const & getArgs() { return args; }
-    termType getTermType() override { return APP; }
-    terminalType getTerminalType() override { return UNDECLARED; }
-
-    std::shared_ptr<Term> accept(LogicVisitor *) override;
-    Term * accept(PointerVisitor *) override;
-    void accept(VoidVisitor *) override;
+enum class OpCode : std::uint8_t {
+    PLUS, MINUS, DIVIDE, TIMES, AND, OR, IMPLIES, NOT, EQ, GEQ, LEQ, GT, LT, ITE, MOD, DIV, NAMED, OTHER
 };
 
-class Quant : public Term {
-    std::string quant;
-    std::vector<std::shared_ptr<Term>> vars;
-    std::vector<std::shared_ptr<Term>> sorts;
-    std::shared_ptr<Term> coreTerm;
+class TermStore {
+    struct TermNode {
+        TermKind kind;
+        TerminalType terminalType;
+        OpCode op;
+        SymbolId symbol;          // Value of a terminal or name of an operator, function or quantifier; index of the
+                                  // value in `numerals` for numerals
+        std::uint32_t firstChild; // Index of the first child in `children`
+        std::uint32_t size;       // Number of children
+    };
+
+    std::deque<std::string> symbolNames; // Deque keeps the names in place, they are referenced by `symbolIds`
+    std::unordered_map<std::string_view, SymbolId> symbolIds;
+    std::vector<FastRational> numerals;
+    std::vector<std::string> numeralSpellings; // Empty if the numeral is printed in the canonical form
+    std::map<std::pair<FastRational, std::string>, std::uint32_t> numeralIds;
+    std::vector<TermNode> nodes;
+    std::vector<TermRef> children;
+    std::unordered_multimap<std::size_t, TermRef> table;
+    SymbolId trueSymbol;
+    SymbolId falseSymbol;
+
+    TermRef getOrCreate(TermNode node, TermRef const * args, std::size_t count);
+
+    TermNode const & node(TermRef ref) const { return nodes[ref.x]; }
+
+    TermRef mkNumeral(FastRational const & value, TerminalType type, std::string spelling);
 
 public:
-    Quant(std::string quant, std::vector<std::shared_ptr<Term>> vars, std::vector<std::shared_ptr<Term>> sorts,
-          std::shared_ptr<Term> coreTerm)
-        : quant(std::move(quant)), vars(std::move(vars)), sorts(std::move(sorts)), coreTerm(std::move(coreTerm)) {}
-    std::string const & getQuant() { return quant; }
-    std::vector<std::shared_ptr<Term>> const & getVars() { return vars; }
-    std::vector<std::shared_ptr<Term>> const & getSorts() { return sorts; }
-    std::shared_ptr<Term> getCoreTerm() { return coreTerm; }
-    termType getTermType() override { return QUANT; }
-    terminalType getTerminalType() override { return UNDECLARED; }
-
-    std::shared_ptr<Term> accept(LogicVisitor *) override;
-    Term * accept(PointerVisitor *) override;
-    void accept(VoidVisitor *) override;
-};
+    TermStore();
+    TermStore(TermStore const &) = delete;
+    TermStore & operator=(TermStore const &) = delete;
 
-class Let : public Term {
-    std::vector<std::string> termNames;
-    std::vector<std::shared_ptr<Term>> declarations;
-    std::shared_ptr<Term> application;
+    SymbolId intern(std::string_view name);
+    std::string const & symbolName(SymbolId symbol) const { return symbolNames[symbol]; }
 
-public:
-    Let(std::vector<std::string> termNames, std::vector<std::shared_ptr<Term>> declarations,
-        std::shared_ptr<Term> application)
-        : termNames(std::move(termNames)), declarations(std::move(declarations)), application(std::move(application)) {}
-    std::vector<std::shared_ptr<Term>> const & getDeclarations() { return declarations; }
-    std::shared_ptr<Term> const & getApplication() { return application; }
-    std::vector<std::string> const & getTermNames() { return termNames; }
-    termType getTermType() override { return LET; }
-    terminalType getTerminalType() override { return UNDECLARED; }
-
-    std::shared_ptr<Term> accept(LogicVisitor *) override;
-    Term * accept(PointerVisitor *) override;
-    void accept(VoidVisitor *) override;
-};
+    static OpCode opCodeOf(std::string_view name);
 
-// Visitors
+    // Integer and real terminals are parsed as numerals, which keep the given spelling
+    TermRef mkTerminal(std::string_view val, TerminalType type);
+    TermRef mkNumeral(FastRational const & value, TerminalType type);
+    TermRef mkOp(std::string_view opcode, std::vector<TermRef> const & args);
+    TermRef mkOp(OpCode opcode, std::vector<TermRef> const & args);
+    TermRef mkApp(std::string_view fun, std::vector<TermRef> const & args);
+    TermRef mkQuant(std::string_view quant, std::vector<TermRef> const & vars, std::vector<TermRef> const & sorts,
+                    TermRef coreTerm);
+    TermRef mkLet(std::vector<std::string> const & termNames, std::vector<TermRef> const & declarations,
+                  TermRef application);
+    // Term of the same kind, symbol and operator as the given one, but with different children
+    TermRef rebuild(TermRef term, std::vector<TermRef> const & newChildren);
+    // Copy of a term of another store; the other store is only read
+    TermRef import(TermStore const & source, TermRef term);
 
-class LogicVisitor {
-public:
-    virtual std::shared_ptr<Term> visit(Terminal *) = 0;
-    virtual std::shared_ptr<Term> visit(Quant *) = 0;
-    virtual std::shared_ptr<Term> visit(Op *) = 0;
-    virtual std::shared_ptr<Term> visit(App *) = 0;
-    virtual std::shared_ptr<Term> visit(Let *) = 0;
-};
+    TermKind getKind(TermRef ref) const { return node(ref).kind; }
+    bool isTerminal(TermRef ref) const { return getKind(ref) == TermKind::TERMINAL; }
+    bool isOp(TermRef ref) const { return getKind(ref) == TermKind::OP; }
+    bool isOp(TermRef ref, OpCode op) const { return isOp(ref) and node(ref).op == op; }
+    bool isApp(TermRef ref) const { return getKind(ref) == TermKind::APP; }
+    bool isNumeral(TermRef ref) const {
+        auto type = getTerminalType(ref);
+        return isTerminal(ref) and (type == TerminalType::INT or type == TerminalType::REAL);
+    }
+    // UNDECLARED for terms that are not terminals
+    TerminalType getTerminalType(TermRef ref) const { return node(ref).terminalType; }
+    OpCode getOp(TermRef ref) const { return node(ref).op; }
+    SymbolId getSymbol(TermRef ref) const { return node(ref).symbol; }
+    // Value of a terminal or name of an operator, function or quantifier; numerals have no name
+    std::string const & getName(TermRef ref) const {
+        assert(not isNumeral(ref));
+        return symbolName(node(ref).symbol);
+    }
+    FastRational const & getNumeral(TermRef ref) const {
+        assert(isNumeral(ref));
+        return numerals[node(ref).symbol];
+    }
 
-class InstantiateVisitor : public LogicVisitor {
-    std::vector<std::pair<std::string, std::string>> instPairs;
+    // Arguments of operators and applications
+    std::size_t getArity(TermRef ref) const { return node(ref).size; }
+    TermRef getArg(TermRef ref, std::size_t i) const { return children[node(ref).firstChild + i]; }
+    std::vector<TermRef> getArgs(TermRef ref) const;
 
-public:
-    explicit InstantiateVisitor(std::vector<std::pair<std::string, std::string>> instPairs)
-        : instPairs(std::move(instPairs)) {}
-    explicit InstantiateVisitor() = default;
-
-    std::shared_ptr<Term> visit(Terminal *) override;
-    std::shared_ptr<Term> visit(Quant *) override;
-    std::shared_ptr<Term> visit(Op *) override;
-    std::shared_ptr<Term> visit(App *) override;
-    std::shared_ptr<Term> visit(Let *) override;
-};
+    // Quantifiers and let terms: variables (names) and sorts (declarations) are followed by the core (application)
+    std::size_t getBoundCount(TermRef ref) const { return node(ref).size / 2; }
+    TermRef getBoundVar(TermRef ref, std::size_t i) const { return getArg(ref, i); }
+    TermRef getBoundSort(TermRef ref, std::size_t i) const { return getArg(ref, getBoundCount(ref) + i); }
+    TermRef getCoreTerm(TermRef ref) const { return getArg(ref, node(ref).size - 1); }
 
-class RemoveUnusedVisitor : public LogicVisitor {
-    std::vector<std::string> varsInUse;
+    bool isTrue(TermRef ref) const;
+    bool isFalse(TermRef ref) const;
 
-public:
-    std::shared_ptr<Term> visit(Terminal *) override;
-    std::shared_ptr<Term> visit(Quant *) override;
-    std::shared_ptr<Term> visit(Op *) override;
-    std::shared_ptr<Term> visit(App *) override;
-    std::shared_ptr<Term> visit(Let *) override { return nullptr; }; // because we have already got rid of the let terms
+    void print(TermRef ref, std::ostream & out) const;
+    std::string printTerm(TermRef ref) const;
+
+    std::size_t size() const { return nodes.size(); }
 };
 
-class OperateLetTermVisitor : public LogicVisitor {
-    std::vector<std::string> terms;
-    std::vector<std::shared_ptr<Term>> substitutions;
+// Operations on proof terms used in simplification chains
+
+TermRef operate(TermStore & terms, TermRef term);
+std::string simplifyRule(TermStore const & terms, TermRef term);
+bool nonLinearity(TermStore const & terms, TermRef term);
+std::string nonLinearSimplification(TermStore const & terms, TermRef term);
+
+// Traversals
+
+class InstantiateVisitor {
+    TermStore & terms;
+    std::unordered_map<SymbolId, TermRef> substitution;
+    // Shared subterms are instantiated only once
+    std::unordered_map<TermRef, TermRef, TermRefHash> cache;
 
 public:
-    std::shared_ptr<Term> visit(Terminal *) override;
-    std::shared_ptr<Term> visit(Quant *) override { return std::make_shared<Terminal>("Error", Term::UNDECLARED); };
-    std::shared_ptr<Term> visit(Op *) override;
-    std::shared_ptr<Term> visit(App *) override;
-    std::shared_ptr<Term> visit(Let *) override;
+    InstantiateVisitor(TermStore & terms, std::vector<std::pair<std::string, std::string>> const & instPairs);
+    TermRef visit(TermRef term);
 };
 
-class SimplifyVisitor : public LogicVisitor {
-    std::shared_ptr<Term> simplification;
-    Term * operation;
+class RemoveUnusedVisitor {
+    TermStore & terms;
+    std::unordered_set<SymbolId> varsInUse;
+
+    void collect(TermRef term);
 
 public:
-    SimplifyVisitor(std::shared_ptr<Term> simplification, Term * operation)
-        : simplification(std::move(simplification)), operation(operation) {}
-    std::shared_ptr<Term> visit(Terminal *) override;
-    std::shared_ptr<Term> visit(Quant *) override;
-    std::shared_ptr<Term> visit(Op *) override;
-    std::shared_ptr<Term> visit(App *) override;
-    std::shared_ptr<Term> visit(Let *) override;
+    explicit RemoveUnusedVisitor(TermStore & terms) : terms(terms) {}
+    // Undefined if the term is not a quantifier
+    TermRef visit(TermRef term);
 };
 
-class VoidVisitor {
-    std::stringstream ss;
+class OperateLetTermVisitor {
+    TermStore & terms;
+    std::unordered_map<SymbolId, TermRef> substitutions;
 
 public:
-    virtual void visit(Terminal *) = 0;
-    virtual void visit(Quant *) = 0;
-    virtual void visit(Op *) = 0;
-    virtual void visit(App *) = 0;
-    virtual void visit(Let *) = 0;
+    explicit OperateLetTermVisitor(TermStore & terms) : terms(terms) {}
+    TermRef visit(TermRef term);
 };
 
-class PrintVisitor : public VoidVisitor {
-    std::stringstream ss;
+class SimplifyVisitor {
+    TermStore & terms;
+    TermRef simplification;
+    TermRef operation;
 
 public:
-    void visit(Terminal *) override;
-    void visit(Quant *) override;
-    void visit(Op *) override;
-    void visit(App *) override;
-    void visit(Let *) override;
-    std::string getString() { return ss.str(); }
+    SimplifyVisitor(TermStore & terms, TermRef simplification, TermRef operation)
+        : terms(terms), simplification(simplification), operation(operation) {}
+    TermRef visit(TermRef term);
 };
 
-class CongChainVisitor : public LogicVisitor {
+class CongChainVisitor {
     int transCase = 0; // 0 for regular case, 1 for trans after ">="
-    InstantiateVisitor copyVisitor;
+    TermStore & terms;
     std::size_t currentStep;
     class SimpleStep {
     public:
         std::size_t stepId;
-        std::shared_ptr<Term> clause;
+        TermRef clause;
         std::vector<std::size_t> premises;
         std::string rule;
-        SimpleStep(std::size_t stepId, std::shared_ptr<Term> clause, std::vector<std::size_t> premises,
-                   std::string rule)
-            : stepId(stepId), clause(std::move(clause)), premises(std::move(premises)), rule(std::move(rule)) {}
+        SimpleStep(std::size_t stepId, TermRef clause, std::vector<std::size_t> premises, std::string rule)
+            : stepId(stepId), clause(clause), premises(std::move(premises)), rule(std::move(rule)) {}
     };
     std::vector<SimpleStep> steps;
 
-public:
-    explicit CongChainVisitor(std::size_t currStep) : currentStep(currStep) {}
-    std::shared_ptr<Term> visit(Terminal *) override;
-    std::shared_ptr<Term> visit(Quant *) override { throw std::logic_error("This should not have happened!"); };
-    std::shared_ptr<Term> visit(Op *) override;
-    std::shared_ptr<Term> visit(App *) override;
-    std::shared_ptr<Term> visit(Let *) override { throw std::logic_error("This should not have happened!"); };
-
-    std::vector<SimpleStep> getSteps() { return steps; };
-};
+    TermRef visitOp(TermRef term);
 
-class PointerVisitor {
 public:
-    virtual Term * visit(Terminal *) = 0;
-    virtual Term * visit(Quant *) = 0;
-    virtual Term * visit(Op *) = 0;
-    virtual Term * visit(App *) = 0;
-    virtual Term * visit(Let *) = 0;
+    CongChainVisitor(TermStore & terms, std::size_t currStep) : terms(terms), currentStep(currStep) {}
+    TermRef visit(TermRef term);
+
+    std::vector<SimpleStep> const & getSteps() const { return steps; };
 };
 
-class LetLocatorVisitor : public PointerVisitor {
+class LetLocatorVisitor {
+    TermStore const & terms;
+
 public:
-    Term * visit(Terminal *) override { return nullptr; };
-    Term * visit(Quant *) override;
-    Term * visit(Op *) override;
-    Term * visit(App *) override { return nullptr; };
-    Term * visit(Let *) override;
+    explicit LetLocatorVisitor(TermStore const & terms) : terms(terms) {}
+    // Returns the innermost let term, or TermRef_Undef if there is none
+    TermRef visit(TermRef term) const;
 };
 
 #endif // GOLEM_TERM_H
@@ -7,15 +7,30 @@
 #ifndef GOLEM_BASICTRANSFORMATIONPIPELINES_H
 #define GOLEM_BASICTRANSFORMATIONPIPELINES_H
 
+#include "ConstraintSimplifier.h"
 #include "FalseClauseRemoval.h"
 #include "MultiEdgeMerger.h"
 #include "NodeEliminator.h"
 #include "RemoveUnreachableNodes.h"
+#include "SimpleChainSummarizer.h"
 #include "TransformationPipeline.h"
 #include "TrivialEdgePruner.h"
 
 namespace Transformations {
 
+/** Preprocessing of every CHC system before it is passed to the engine */
+inline TransformationPipeline defaultPreprocessing(std::size_t threads = 0) {
+    TransformationPipeline::pipeline_t stages;
+    stages.push_back(std::make_unique<ConstraintSimplifier>(threads));
+    stages.push_back(std::make_unique<SimpleChainSummarizer>());
+    stages.push_back(std::make_unique<RemoveUnreachableNodes>());
+    stages.push_back(std::make_unique<SimpleNodeEliminator>());
+    stages.push_back(std::make_unique<MultiEdgeMerger>());
+    // TODO: Try following MultiEdgeMerger by another round of SimpleChainSummarizer and/or SimpleNodeEliminator?
+    TransformationPipeline pipeline(std::move(stages));
+    return pipeline;
+}
+
 inline TransformationPipeline towardsTransitionSystems() {
     TransformationPipeline::pipeline_t stages;
     stages.push_back(std::make_unique<MultiEdgeMerger>());
@@ -58,7 +58,7 @@ InvalidityWitness::Derivation replaceSummarizingStep(
         solver.insertFormula(logic.mkEq(var, value));
     }
     // 2ac Compute values for summarized predicates from model
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res != s_True) { throw std::logic_error("Summarized chain should have been satisfiable!"); }
     auto model = solver.getModel();
     std::vector<PTRef> intermediatePredicateInstances;
@@ -175,7 +175,7 @@ InvalidityWitness::Derivation expandStepWithHyperEdge(
         solver.insertFormula(logic.mkEq(var, value));
     }
     // 2ac Compute values for summarized predicates from model
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     if (res != s_True) { throw std::logic_error("Proof transformation: Summarized edges should have been satisfiable!"); }
     auto model = solver.getModel();
     PTRef targetTerm = predicateRepresentation.getTargetTermFor(contractedNode);
@@ -6,6 +6,12 @@
 
 #include "ConstraintSimplifier.h"
 
+#include "graph/GraphSerialization.h"
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+#include <unordered_set>
+
 namespace helper {
 class Normalizer {
     Logic & logic;
@@ -35,35 +41,141 @@ PTRef Normalizer::eliminateDistincts(PTRef fla) {
 
 }
 
-Transformer::TransformationResult ConstraintSimplifier::transform(std::unique_ptr<ChcDirectedHyperGraph> graph) {
+namespace {
+vec<PTRef> edgeStateVars(ChcDirectedHyperGraph const & graph, DirectedHyperEdge const & edge) {
+    Logic & logic = graph.getLogic();
+    TermUtils utils(logic);
+    vec<PTRef> stateVars;
+    // TODO: Implement a helper to iterate over source vertices together with instantiation counter
+    std::unordered_map<SymRef, std::size_t, SymRefHash> instanceCounter;
+    for (auto source : edge.from) {
+        PTRef sourcePredicate = graph.getStateVersion(source, instanceCounter[source]++);
+        for (PTRef var : utils.predicateArgsInOrder(sourcePredicate)) {
+            assert(logic.isVar(var));
+            stateVars.push(var);
+        }
+    }
+
+    PTRef targetPredicate = graph.getNextStateVersion(edge.to);
+    for (PTRef var : utils.predicateArgsInOrder(targetPredicate)) {
+        assert(logic.isVar(var));
+        stateVars.push(var);
+    }
+    return stateVars;
+}
 
-    Logic & logic = graph->getLogic();
+PTRef normalizeConstraint(Logic & logic, PTRef constraint) {
+    helper::Normalizer normalizer(logic);
+    constraint = normalizer.eliminateItes(constraint);
+    constraint = normalizer.eliminateDivMod(constraint);
+    constraint = normalizer.eliminateDistincts(constraint);
+    return constraint;
+}
+
+// Number of edges simplified in one private logic
+constexpr std::size_t edgesPerBatch = 64;
+
+/*
+ * Simplifies constraint of a single edge in a private logic.
+ * Auxiliary variables introduced by the simplification (.ite, .div, .mod) are named after term identifiers of the
+ * private logic. They keep their names, with the edge id appended, so that they cannot clash with variables of other
+ * edges in the shared logic.
+ */
+PTRef simplifyInPrivateLogic(ArithLogic & logic, PTRef constraint, vec<PTRef> const & stateVars, EId eid) {
     TermUtils utils(logic);
-    graph->forEachEdge([&](auto & edge) {
-        PTRef constraint = edge.fla.fla;
-        helper::Normalizer normalizer(logic);
-        constraint = normalizer.eliminateItes(constraint);
-        constraint = normalizer.eliminateDivMod(constraint);
-        constraint = normalizer.eliminateDistincts(constraint);
-
-        vec<PTRef> stateVars;
-        // TODO: Implement a helper to iterate over source vertices together with instantiation counter
-        std::unordered_map<SymRef, std::size_t, SymRefHash> instanceCounter;
-        for (auto source : edge.from) {
-            PTRef sourcePredicate = graph->getStateVersion(source, instanceCounter[source]++);
-            for (PTRef var : utils.predicateArgsInOrder(sourcePredicate)) {
-                assert(logic.isVar(var));
-                stateVars.push(var);
-            }
+    std::unordered_set<std::string> knownNames;
+    for (PTRef var : utils.getVars(constraint)) {
+        knownNames.insert(logic.getSymName(var));
+    }
+    for (PTRef var : stateVars) {
+        knownNames.insert(logic.getSymName(var));
+    }
+    PTRef simplified = normalizeConstraint(logic, constraint);
+    simplified = TrivialQuantifierElimination(logic).tryEliminateVarsExcept(stateVars, simplified);
+    TermUtils::substitutions_map renaming;
+    for (PTRef var : utils.getVars(simplified)) {
+        std::string name = logic.getSymName(var);
+        if (knownNames.count(name) > 0) { continue; }
+        std::string const base = name + "_e" + std::to_string(eid.id);
+        std::string newName = base;
+        for (unsigned suffix = 1; knownNames.count(newName) > 0; ++suffix) {
+            newName = base + '_' + std::to_string(suffix);
         }
+        knownNames.insert(newName);
+        renaming.insert({var, logic.mkVar(logic.getSortRef(var), newName.c_str())});
+    }
+    return utils.varSubstitute(simplified, renaming);
+}
+}
 
-        PTRef targetPredicate = graph->getNextStateVersion(edge.to);
-        for (PTRef var : utils.predicateArgsInOrder(targetPredicate)) {
-            assert(logic.isVar(var));
-            stateVars.push(var);
+Transformer::TransformationResult ConstraintSimplifier::transform(std::unique_ptr<ChcDirectedHyperGraph> graph) {
+    if (threads > 0 and dynamic_cast<ArithLogic *>(&graph->getLogic())) {
+        simplifyIsolated(*graph);
+    } else {
+        simplifyInPlace(*graph);
+    }
+    return {std::move(graph), std::make_unique<BackTranslator>()};
+}
+
+void ConstraintSimplifier::simplifyInPlace(ChcDirectedHyperGraph & graph) const {
+    Logic & logic = graph.getLogic();
+    graph.forEachEdge([&](auto & edge) {
+        PTRef constraint = normalizeConstraint(logic, edge.fla.fla);
+        auto stateVars = edgeStateVars(graph, edge);
+        edge.fla.fla = TrivialQuantifierElimination(logic).tryEliminateVarsExcept(stateVars, constraint);
+    });
+}
+
+/*
+ * The shared logic is accessed only from the calling thread: It copies the constraints of a fixed-size batch of edges
+ * to a private logic, hands the batch over to a worker, and imports the simplified constraints back in the order of the
+ * edges. The batches do not depend on the number of threads, so neither does the result.
+ */
+void ConstraintSimplifier::simplifyIsolated(ChcDirectedHyperGraph & graph) const {
+    auto & logic = dynamic_cast<ArithLogic &>(graph.getLogic());
+    auto const logicType = logic.hasReals() ? opensmt::Logic_t::QF_LRA : opensmt::Logic_t::QF_LIA;
+
+    std::vector<DirectedHyperEdge *> edges;
+    graph.forEachEdge([&](auto & edge) { edges.push_back(&edge); });
+    std::size_t const batchCount = (edges.size() + edgesPerBatch - 1) / edgesPerBatch;
+    struct Batch {
+        std::unique_ptr<ArithLogic> privateLogic;
+        std::vector<PTRef> constraints;
+    };
+    auto prepare = [&](std::size_t batchIndex) {
+        std::size_t const begin = batchIndex * edgesPerBatch;
+        std::size_t const end = std::min(begin + edgesPerBatch, edges.size());
+        auto privateLogic = std::make_unique<ArithLogic>(logicType);
+        TermImporter toPrivate(logic, *privateLogic);
+        std::vector<PTRef> constraints;
+        std::vector<vec<PTRef>> stateVars;
+        std::vector<EId> ids;
+        for (std::size_t i = begin; i < end; ++i) {
+            auto const & edge = *edges[i];
+            constraints.push_back(toPrivate.import(edge.fla.fla));
+            stateVars.emplace_back();
+            for (PTRef var : edgeStateVars(graph, edge)) {
+                stateVars.back().push(toPrivate.import(var));
+            }
+            ids.push_back(edge.id);
+        }
+        return [privateLogic = std::move(privateLogic), constraints = std::move(constraints),
+                stateVars = std::move(stateVars), ids = std::move(ids)]() mutable {
+            for (std::size_t i = 0; i < constraints.size(); ++i) {
+                constraints[i] = simplifyInPrivateLogic(*privateLogic, constraints[i], stateVars[i], ids[i]);
+            }
+            return Batch{std::move(privateLogic), std::move(constraints)};
+        };
+    };
+    parallelMap(batchCount, threads, prepare, [&](std::size_t batchIndex, Batch && result) {
+        TermImporter toShared(*result.privateLogic, logic);
+        for (std::size_t i = 0; i < result.constraints.size(); ++i) {
+            edges[batchIndex * edgesPerBatch + i]->fla.fla = toShared.import(result.constraints[i]);
         }
-        constraint = TrivialQuantifierElimination(logic).tryEliminateVarsExcept(stateVars, constraint);
-        edge.fla.fla = constraint;
     });
-    return {std::move(graph), std::make_unique<BackTranslator>()};
+}
+
+bool ConstraintSimplifier::BackTranslator::serialize(GraphSerializer & serializer) const {
+    serializer.writeString(serializationTag);
+    return true;
 }
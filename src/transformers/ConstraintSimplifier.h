@@ -9,15 +9,34 @@
 
 #include "Transformer.h"
 
+/**
+ * Simplifies the constraints of all edges (eliminating ITEs, div/mod, distincts and trivially eliminable variables).
+ *
+ * By default, the edges are simplified one by one directly in the logic of the graph. With a positive number of threads,
+ * batches of edges of arithmetic graphs are simplified in parallel, each batch in a private scratch logic, and the
+ * results are imported back to the shared logic in the order of the edges. Auxiliary variables introduced there are
+ * renamed per edge. The result of the parallel mode does not depend on the number of threads used.
+ */
 class ConstraintSimplifier : public Transformer {
+    std::size_t threads{0};
+
+    void simplifyInPlace(ChcDirectedHyperGraph & graph) const;
+    void simplifyIsolated(ChcDirectedHyperGraph & graph) const;
 
 public:
+   ConstraintSimplifier() = default;
+   explicit ConstraintSimplifier(std::size_t threads) : threads(threads) {}
+
    TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+   char const * name() const override { return "constraint-simplifier"; }
 
    class BackTranslator : public WitnessBackTranslator {
    public:
        InvalidityWitness translate(InvalidityWitness witness) override { return witness; }
        ValidityWitness translate(ValidityWitness witness) override { return witness; }
+
+       static constexpr char const * serializationTag = "constraint-simplifier";
+       bool serialize(GraphSerializer & serializer) const override;
    };
 };
 
@@ -12,6 +12,7 @@
 class FalseClauseRemoval : public Transformer {
 public:
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "false-clause-removal"; }
 
     class BackTranslator : public WitnessBackTranslator {
     public:
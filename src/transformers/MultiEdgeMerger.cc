@@ -6,6 +6,7 @@
 
 #include "MultiEdgeMerger.h"
 
+#include "graph/GraphSerialization.h"
 #include "utils/SmtSolver.h"
 
 Transformer::TransformationResult MultiEdgeMerger::transform(std::unique_ptr<ChcDirectedHyperGraph> graph) {
@@ -68,7 +69,7 @@ InvalidityWitness MultiEdgeMerger::BackTranslator::translate(InvalidityWitness w
                 SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
                 auto & solver = solverWrapper.getCoreSolver();
                 solver.insertFormula(evaluatedLabels[i]);
-                if (solver.check() == s_True) { return i; }
+                if (SMTSolver::check(solver) == s_True) { return i; }
             }
             return {};
         }();
@@ -84,3 +85,26 @@ InvalidityWitness MultiEdgeMerger::BackTranslator::translate(InvalidityWitness w
 ValidityWitness MultiEdgeMerger::BackTranslator::translate(ValidityWitness witness) {
     return witness;
 }
+
+bool MultiEdgeMerger::BackTranslator::serialize(GraphSerializer & serializer) const {
+    serializer.writeString(serializationTag);
+    serializer.writeRepresentation(predicateRepresentation);
+    serializer.writeUnsigned(mergedEdges.size());
+    for (auto const & [merged, result] : mergedEdges) {
+        serializer.writeEdges(merged);
+        serializer.writeEdge(result);
+    }
+    return true;
+}
+
+std::unique_ptr<MultiEdgeMerger::BackTranslator>
+MultiEdgeMerger::BackTranslator::deserialize(GraphDeserializer & deserializer, Logic & logic) {
+    auto translator = std::make_unique<BackTranslator>(logic, deserializer.readRepresentation());
+    auto count = deserializer.readUnsigned();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        auto merged = deserializer.readEdges();
+        auto result = deserializer.readEdge();
+        translator->mergedEdges.emplace_back(std::move(merged), std::move(result));
+    }
+    return translator;
+}
@@ -12,6 +12,7 @@
 class MultiEdgeMerger : public Transformer {
 public:
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "multi-edge-merger"; }
 
     class BackTranslator : public WitnessBackTranslator {
     public:
@@ -24,6 +25,10 @@ public:
 
         using MergedEdges = ChcDirectedHyperGraph::MergedEdges;
 
+        static constexpr char const * serializationTag = "multi-edge-merger";
+        bool serialize(GraphSerializer & serializer) const override;
+        static std::unique_ptr<BackTranslator> deserialize(GraphDeserializer & deserializer, Logic & logic);
+
         MergedEdges mergedEdges{};
         Logic & logic;
         NonlinearCanonicalPredicateRepresentation predicateRepresentation;
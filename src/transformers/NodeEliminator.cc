@@ -7,6 +7,7 @@
 #include "NodeEliminator.h"
 
 #include "CommonUtils.h"
+#include "graph/GraphSerialization.h"
 #include "utils/SmtSolver.h"
 
 void NodeEliminator::BackTranslator::notifyRemovedVertex(SymRef sym, ContractionResult && contractionResult) {
@@ -181,7 +182,7 @@ ValidityWitness NodeEliminator::BackTranslator::translate(ValidityWitness witnes
         auto & solver = solverWrapper.getCoreSolver();
         solver.insertFormula(incomingPart);
         solver.insertFormula(outgoingPart);
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res != s_False) {
             throw std::logic_error("Error in backtranslating of nonloop elimination");
         }
@@ -197,4 +198,44 @@ ValidityWitness NodeEliminator::BackTranslator::translate(ValidityWitness witnes
         definitions.insert({predicate, vertexSolution});
     }
     return ValidityWitness(std::move(definitions));
-}
\ No newline at end of file
+}
+
+bool NodeEliminator::BackTranslator::serialize(GraphSerializer & serializer) const {
+    serializer.writeString(serializationTag);
+    serializer.writeRepresentation(predicateRepresentation);
+    serializer.writeUnsigned(removedNodes.size());
+    for (SymRef node : removedNodes) {
+        auto const & info = nodeInfo.at(node);
+        serializer.writeSymbol(node);
+        serializer.writeEdges(info.incoming);
+        serializer.writeEdges(info.outgoing);
+        serializer.writeUnsigned(info.replacing.size());
+        for (auto const & [edge, origin] : info.replacing) {
+            serializer.writeEdge(edge);
+            serializer.writeUnsigned(origin.first);
+            serializer.writeUnsigned(origin.second);
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<NodeEliminator::BackTranslator>
+NodeEliminator::BackTranslator::deserialize(GraphDeserializer & deserializer, Logic & logic) {
+    auto translator = std::make_unique<BackTranslator>(logic, deserializer.readRepresentation());
+    auto count = deserializer.readUnsigned();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        SymRef node = deserializer.readSymbol();
+        ContractionResult info;
+        info.incoming = deserializer.readEdges();
+        info.outgoing = deserializer.readEdges();
+        auto replacingCount = deserializer.readUnsigned();
+        for (std::uint64_t j = 0; j < replacingCount; ++j) {
+            auto edge = deserializer.readEdge();
+            auto first = deserializer.readUnsigned();
+            auto second = deserializer.readUnsigned();
+            info.replacing.push_back({std::move(edge), {first, second}});
+        }
+        translator->notifyRemovedVertex(node, std::move(info));
+    }
+    return translator;
+}
@@ -20,6 +20,7 @@ public:
     NodeEliminator(predicate_t shouldEliminateNode) : shouldEliminateNode(std::move(shouldEliminateNode)) {}
 
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "node-eliminator"; }
 
     class BackTranslator : public WitnessBackTranslator {
     public:
@@ -33,6 +34,10 @@ public:
         ValidityWitness translate(ValidityWitness witness) override;
 
         void notifyRemovedVertex(SymRef sym, ContractionResult && edges);
+
+        static constexpr char const * serializationTag = "node-eliminator";
+        bool serialize(GraphSerializer & serializer) const override;
+        static std::unique_ptr<BackTranslator> deserialize(GraphDeserializer & deserializer, Logic & logic);
     private:
         std::unordered_map<SymRef, ContractionResult, SymRefHash> nodeInfo;
         std::vector<SymRef> removedNodes;
@@ -6,6 +6,8 @@
 
 #include "RemoveUnreachableNodes.h"
 
+#include "graph/GraphSerialization.h"
+
 Transformer::TransformationResult RemoveUnreachableNodes::transform(std::unique_ptr<ChcDirectedHyperGraph> graph) {
     auto adjacencyLists = AdjacencyListsGraphRepresentation::from(*graph);
     auto allNodes = adjacencyLists.getNodes();
@@ -75,3 +77,17 @@ ValidityWitness RemoveUnreachableNodes::BackTranslator::translate(ValidityWitnes
     }
     return ValidityWitness(std::move(definitions));
 }
+
+bool RemoveUnreachableNodes::BackTranslator::serialize(GraphSerializer & serializer) const {
+    serializer.writeString(serializationTag);
+    serializer.writeRepresentation(predicateRepresentation);
+    serializer.writeSymbols(removedNodes);
+    return true;
+}
+
+std::unique_ptr<RemoveUnreachableNodes::BackTranslator>
+RemoveUnreachableNodes::BackTranslator::deserialize(GraphDeserializer & deserializer, Logic & logic) {
+    auto representation = deserializer.readRepresentation();
+    auto removedNodes = deserializer.readSymbols();
+    return std::make_unique<BackTranslator>(logic, std::move(representation), std::move(removedNodes));
+}
@@ -12,6 +12,7 @@
 class RemoveUnreachableNodes : public Transformer {
 public:
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "remove-unreachable-nodes"; }
 
     class BackTranslator : public WitnessBackTranslator {
         Logic & logic;
@@ -27,6 +28,10 @@ public:
 
         InvalidityWitness translate(InvalidityWitness witness) override { return witness; }
         ValidityWitness translate(ValidityWitness witness) override;
+
+        static constexpr char const * serializationTag = "remove-unreachable-nodes";
+        bool serialize(GraphSerializer & serializer) const override;
+        static std::unique_ptr<BackTranslator> deserialize(GraphDeserializer & deserializer, Logic & logic);
     };
 };
 
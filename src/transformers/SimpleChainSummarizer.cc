@@ -8,6 +8,8 @@
 
 #include "CommonUtils.h"
 
+#include "graph/GraphSerialization.h"
+
 #include "utils/SmtSolver.h"
 
 Transformer::TransformationResult SimpleChainSummarizer::transform(std::unique_ptr<ChcDirectedHyperGraph> graph) {
@@ -106,7 +108,7 @@ ValidityWitness SimpleChainSummarizer::BackTranslator::translate(ValidityWitness
             definitions.at(manager.sourceFormulaToBase(predicate))
         );
         solver.insertFormula(logic.mkNot(targetInterpretation));
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res != s_False) {
             //throw std::logic_error("SimpleChainBackTranslator could not recompute solution!");
             std::cerr << "; SimpleChainBackTranslator could not recompute solution! Solver could not prove UNSAT!" << std::endl;
@@ -134,3 +136,26 @@ ValidityWitness SimpleChainSummarizer::BackTranslator::translate(ValidityWitness
     }
     return ValidityWitness(std::move(definitions));
 }
+
+bool SimpleChainSummarizer::BackTranslator::serialize(GraphSerializer & serializer) const {
+    serializer.writeString(serializationTag);
+    serializer.writeRepresentation(predicateRepresentation);
+    serializer.writeUnsigned(summarizedChains.size());
+    for (auto const & [chain, summary] : summarizedChains) {
+        serializer.writeEdges(chain);
+        serializer.writeEdge(summary);
+    }
+    return true;
+}
+
+std::unique_ptr<SimpleChainSummarizer::BackTranslator>
+SimpleChainSummarizer::BackTranslator::deserialize(GraphDeserializer & deserializer, Logic & logic) {
+    auto translator = std::make_unique<BackTranslator>(logic, deserializer.readRepresentation());
+    auto count = deserializer.readUnsigned();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        auto chain = deserializer.readEdges();
+        auto summary = deserializer.readEdge();
+        translator->addSummarizedChain({std::move(chain), std::move(summary)});
+    }
+    return translator;
+}
@@ -12,6 +12,7 @@
 class SimpleChainSummarizer : public Transformer {
 public:
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "simple-chain-summarizer"; }
 
     SimpleChainSummarizer() = default;
 
@@ -28,6 +29,10 @@ public:
 
         void addSummarizedChain(SummarizedChain && chain) { summarizedChains.push_back(std::move(chain)); }
 
+        static constexpr char const * serializationTag = "simple-chain-summarizer";
+        bool serialize(GraphSerializer & serializer) const override;
+        static std::unique_ptr<BackTranslator> deserialize(GraphDeserializer & deserializer, Logic & logic);
+
     private:
         std::vector<SummarizedChain> summarizedChains;
         Logic & logic;
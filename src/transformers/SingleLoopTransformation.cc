@@ -155,7 +155,10 @@ SingleLoopTransformation::WitnessBackTranslator::translate(TransitionSystemVerif
         }
         return {VerificationAnswer::SAFE, std::get<ValidityWitness>(std::move(witness))};
     }
-    return VerificationResult(result.answer);
+    VerificationResult unknown(result.answer, NoWitness(result.reason));
+    // The edges from the entry and into the exit are steps of the transition system too
+    unknown.setSafeBound(transitionsBetweenEntryAndExit(result.safeBound));
+    return unknown;
 }
 
 SingleLoopTransformation::WitnessBackTranslator::ErrorOr<InvalidityWitness>
@@ -171,7 +174,7 @@ SingleLoopTransformation::WitnessBackTranslator::translateErrorPath(std::size_t
         solver.insertFormula(tm.sendFlaThroughTime(transition, i));
     }
     solver.insertFormula(tm.sendFlaThroughTime(transitionSystem.getQuery(), unrolling));
-    auto res = solver.check();
+    auto res = SMTSolver::check(solver);
     assert(res == s_True);
     if (res != s_True) { throw std::logic_error("Unrolling should have been satisfiable"); }
     auto model = solver.getModel();
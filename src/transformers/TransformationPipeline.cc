@@ -7,9 +7,14 @@
 
 #include "TransformationPipeline.h"
 
+#include "graph/GraphSerialization.h"
+#include "utils/Statistics.h"
+
 Transformer::TransformationResult TransformationPipeline::transform(std::unique_ptr<ChcDirectedHyperGraph> graph) {
     BackTranslator::pipeline_t backtranslators;
     for (auto const & transformer : inner) {
+        std::string timerName = std::string("transform.") + transformer->name();
+        ScopedTimer timer(timerName);
         auto result = transformer->transform(std::move(graph));
         graph = std::move(result.first);
         backtranslators.push_back(std::move(result.second));
@@ -31,3 +36,22 @@ ValidityWitness TransformationPipeline::BackTranslator::translate(ValidityWitnes
     }
     return witness;
 }
+
+bool TransformationPipeline::BackTranslator::serialize(GraphSerializer & serializer) const {
+    serializer.writeString(serializationTag);
+    serializer.writeUnsigned(inner.size());
+    for (auto const & backtranslator : inner) {
+        if (not serializer.writeBackTranslator(*backtranslator)) { return false; }
+    }
+    return true;
+}
+
+std::unique_ptr<TransformationPipeline::BackTranslator>
+TransformationPipeline::BackTranslator::deserialize(GraphDeserializer & deserializer) {
+    auto count = deserializer.readUnsigned();
+    pipeline_t backtranslators;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        backtranslators.push_back(deserializer.readBackTranslator());
+    }
+    return std::make_unique<BackTranslator>(std::move(backtranslators));
+}
@@ -20,6 +20,10 @@ public:
         InvalidityWitness translate(InvalidityWitness witness) override;
 
         ValidityWitness translate(ValidityWitness witness) override;
+
+        static constexpr char const * serializationTag = "pipeline";
+        bool serialize(GraphSerializer & serializer) const override;
+        static std::unique_ptr<BackTranslator> deserialize(GraphDeserializer & deserializer);
     private:
         pipeline_t inner;
     };
@@ -29,6 +33,7 @@ public:
     TransformationPipeline(pipeline_t && pipeline) : inner(std::move(pipeline)) {}
 
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "pipeline"; }
 
 private:
     pipeline_t inner;
@@ -13,11 +13,16 @@
 
 #include <memory>
 
+class GraphSerializer;
+class GraphDeserializer;
+
 class WitnessBackTranslator {
 public:
     virtual InvalidityWitness translate(InvalidityWitness witness) = 0;
     virtual ValidityWitness translate(ValidityWitness witness) = 0;
     virtual ~WitnessBackTranslator() = default;
+    /** Stores the state of the translator; returns false if this translator does not support serialization */
+    virtual bool serialize(GraphSerializer &) const { return false; }
     VerificationResult translate(VerificationResult && result) {
         if (not result.hasWitness()) { return std::move(result); }
         auto answer = result.getAnswer();
@@ -37,6 +42,8 @@ class Transformer {
 public:
     using TransformationResult = std::pair<std::unique_ptr<ChcDirectedHyperGraph>, std::unique_ptr<WitnessBackTranslator>>;
     virtual TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) = 0;
+    /** Short identifier of the transformation, used in statistics */
+    virtual char const * name() const = 0;
     virtual ~Transformer() = default;
 };
 
@@ -22,7 +22,7 @@ Transformer::TransformationResult TrivialEdgePruner::transform(std::unique_ptr<C
         SMTSolver solverWrapper(logic, SMTSolver::WitnessProduction::NONE);
         auto & solver = solverWrapper.getCoreSolver();
         solver.insertFormula(graph->getEdgeLabel(eid));
-        auto res = solver.check();
+        auto res = SMTSolver::check(solver);
         if (res == s_True) {
             // satisfiable direct edge, reduce the graph to this edge
             NonlinearCanonicalPredicateRepresentation predicateRepresentation(logic);
@@ -32,6 +32,7 @@ public:
     TrivialEdgePruner() = default;
 
     TransformationResult transform(std::unique_ptr<ChcDirectedHyperGraph> graph) override;
+    char const * name() const override { return "trivial-edge-pruner"; }
 };
 
 #endif // GOLEM_TRIVIALEDGEPRUNER_H
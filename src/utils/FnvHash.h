@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_FNVHASH_H
+#define GOLEM_FNVHASH_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * 64-bit FNV-1a hash, used to name the files of on-disk caches.
+ */
+struct FnvHash {
+    std::uint64_t value = 14695981039346656037ULL;
+
+    void update(std::string_view bytes) {
+        for (char c : bytes) {
+            value ^= static_cast<unsigned char>(c);
+            value *= 1099511628211ULL;
+        }
+    }
+
+    std::string toHex() const {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string result(16, '0');
+        auto remaining = value;
+        for (int i = 15; i >= 0; --i) {
+            result[i] = digits[remaining & 0xf];
+            remaining >>= 4;
+        }
+        return result;
+    }
+};
+
+#endif // GOLEM_FNVHASH_H
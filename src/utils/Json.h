@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_JSON_H
+#define GOLEM_JSON_H
+
+#include <ostream>
+#include <string_view>
+
+/**
+ * Prints the string as a JSON string literal, including the quotes.
+ * Quotes, backslashes and control characters are escaped, other bytes are printed unchanged.
+ */
+void printJsonString(std::ostream & out, std::string_view str);
+
+#endif // GOLEM_JSON_H
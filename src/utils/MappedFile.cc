@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::string const & fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) { return; }
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return;
+    }
+    size = static_cast<std::size_t>(fileStat.st_size);
+    if (size == 0) { // Mapping of an empty file is not allowed
+        close(fd);
+        valid = true;
+        return;
+    }
+    void * mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after the file descriptor is closed
+    if (mapped == MAP_FAILED) {
+        size = 0;
+        return;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<char const *>(mapped);
+    valid = true;
+}
+
+MappedFile::~MappedFile() {
+    if (data) { munmap(const_cast<char *>(data), size); }
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_MAPPEDFILE_H
+#define GOLEM_MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only memory mapping of a whole file.
+ */
+class MappedFile {
+    char const * data{nullptr};
+    std::size_t size{0};
+    bool valid{false};
+
+public:
+    explicit MappedFile(std::string const & fileName);
+    ~MappedFile();
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+
+    /** Returns false if the file could not be opened or mapped */
+    bool isValid() const { return valid; }
+
+    std::string_view contents() const { return {data, size}; }
+};
+
+#endif // GOLEM_MAPPEDFILE_H
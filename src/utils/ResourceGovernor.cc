@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ResourceGovernor.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <sys/resource.h>
+
+std::atomic<bool> ResourceGovernor::active{false};
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+/*
+ * The budgets are polled concurrently by the workers of parallel engines, so all of them are atomics. Time points are
+ * stored as ticks of the steady clock; the largest value of each type stands for a budget that is not set.
+ */
+constexpr std::int64_t noDeadline = std::numeric_limits<std::int64_t>::max();
+constexpr std::size_t noMemoryLimit = std::numeric_limits<std::size_t>::max();
+constexpr std::uint64_t noQueryLimit = std::numeric_limits<std::uint64_t>::max();
+
+std::atomic<std::int64_t> deadline{noDeadline};
+std::atomic<std::size_t> memoryLimitKB{noMemoryLimit};
+std::atomic<std::uint64_t> queryLimit{noQueryLimit};
+
+std::atomic<std::uint64_t> queries{0};
+// Deadline of the innermost time slice, set only by the main thread between the runs of the engines
+std::atomic<std::int64_t> sliceDeadline{noDeadline};
+
+// getrusage is a system call, so the memory is checked at most once per interval; the peak never decreases
+constexpr auto memoryPollInterval = std::chrono::milliseconds(10);
+std::atomic<std::int64_t> nextMemoryPoll{0};
+
+std::int64_t ticks(clock::time_point time) {
+    return time.time_since_epoch().count();
+}
+
+std::int64_t ticksAfter(std::chrono::milliseconds duration) {
+    return ticks(clock::now() + duration);
+}
+
+std::size_t peakResidentSetKB() {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss) / 1024; // Reported in bytes
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss); // Reported in kilobytes
+#endif
+}
+
+bool isPast(std::atomic<std::int64_t> const & time, std::int64_t now) {
+    auto value = time.load(std::memory_order_relaxed);
+    return value != noDeadline and now >= value;
+}
+
+bool isOverMemoryLimit() {
+    auto limit = memoryLimitKB.load(std::memory_order_relaxed);
+    return limit != noMemoryLimit and peakResidentSetKB() > limit;
+}
+} // namespace
+
+void ResourceGovernor::configure(Limits limits) {
+    deadline.store(limits.time ? ticksAfter(*limits.time) : noDeadline, std::memory_order_relaxed);
+    memoryLimitKB.store(limits.memoryMB ? *limits.memoryMB * 1024 : noMemoryLimit, std::memory_order_relaxed);
+    queryLimit.store(limits.queries.value_or(noQueryLimit), std::memory_order_relaxed);
+    queries.store(0, std::memory_order_relaxed);
+    nextMemoryPoll.store(0, std::memory_order_relaxed);
+    updateActive();
+}
+
+void ResourceGovernor::release() {
+    deadline.store(noDeadline, std::memory_order_relaxed);
+    memoryLimitKB.store(noMemoryLimit, std::memory_order_relaxed);
+    queryLimit.store(noQueryLimit, std::memory_order_relaxed);
+    sliceDeadline.store(noDeadline, std::memory_order_relaxed);
+    updateActive();
+}
+
+void ResourceGovernor::updateActive() {
+    active.store(deadline.load(std::memory_order_relaxed) != noDeadline or
+                     memoryLimitKB.load(std::memory_order_relaxed) != noMemoryLimit or
+                     queryLimit.load(std::memory_order_relaxed) != noQueryLimit or
+                     sliceDeadline.load(std::memory_order_relaxed) != noDeadline,
+                 std::memory_order_relaxed);
+}
+
+bool ResourceGovernor::isExhausted() {
+    auto limit = queryLimit.load(std::memory_order_relaxed);
+    return (limit != noQueryLimit and queries.load(std::memory_order_relaxed) > limit) or
+           isPast(deadline, ticks(clock::now())) or isOverMemoryLimit();
+}
+
+ResourceGovernor::Slice::Slice(std::chrono::milliseconds duration)
+    : previous(sliceDeadline.load(std::memory_order_relaxed)), deadline(ticksAfter(duration)) {
+    // A nested slice cannot extend the enclosing one
+    deadline = std::min(deadline, previous);
+    sliceDeadline.store(deadline, std::memory_order_relaxed);
+    updateActive();
+}
+
+ResourceGovernor::Slice::~Slice() {
+    sliceDeadline.store(previous, std::memory_order_relaxed);
+    updateActive();
+}
+
+bool ResourceGovernor::Slice::isExpired() const {
+    return ticks(clock::now()) >= deadline;
+}
+
+void ResourceGovernor::poll(bool countQuery) {
+    auto limit = queryLimit.load(std::memory_order_relaxed);
+    if (limit != noQueryLimit) {
+        auto performed = countQuery ? queries.fetch_add(1, std::memory_order_relaxed) + 1
+                                    : queries.load(std::memory_order_relaxed);
+        if (performed > limit) { throw LimitReached("query limit reached"); }
+    }
+    auto now = ticks(clock::now());
+    if (isPast(deadline, now)) { throw LimitReached("time limit reached"); }
+    if (isPast(sliceDeadline, now)) { throw LimitReached("time slice expired"); }
+    if (memoryLimitKB.load(std::memory_order_relaxed) != noMemoryLimit and
+        now >= nextMemoryPoll.load(std::memory_order_relaxed)) {
+        nextMemoryPoll.store(ticksAfter(memoryPollInterval), std::memory_order_relaxed);
+        if (isOverMemoryLimit()) { throw LimitReached("memory limit reached"); }
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_RESOURCEGOVERNOR_H
+#define GOLEM_RESOURCEGOVERNOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+/**
+ * Process-wide budgets on wall-clock time, memory (peak resident set size) and the number of SMT queries.
+ *
+ * The budgets are polled before every SMT query and at the start of every iteration of the engines' main loops.
+ * When a budget runs out, the poll throws LimitReached; engines catch it and report UNKNOWN together with the
+ * partial result they have established so far. Without configured budgets, polling is a single relaxed atomic load.
+ * Polling is thread-safe; the memory usage is read from the system at most every few milliseconds.
+ */
+class ResourceGovernor {
+public:
+    struct Limits {
+        std::optional<std::chrono::milliseconds> time;
+        std::optional<std::size_t> memoryMB;
+        std::optional<std::uint64_t> queries;
+    };
+
+    class LimitReached : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /** Sets the budgets; the time budget starts running now */
+    static void configure(Limits limits);
+
+    /** Lifts all budgets, e.g., once the answer is known and only the witness is processed */
+    static void release();
+
+    /** Returns true if any of the configured budgets (not counting time slices) has run out */
+    static bool isExhausted();
+
+    static bool isActive() { return active.load(std::memory_order_relaxed); }
+
+    /** @throws LimitReached if any budget has run out */
+    static void checkpoint() {
+        if (isActive()) { poll(false); }
+    }
+
+    /** Same as checkpoint, but also counts an SMT query towards the query budget */
+    static void checkpointQuery() {
+        if (isActive()) { poll(true); }
+    }
+
+    /**
+     * Additional time budget for a part of the work, e.g., one engine of a sequential portfolio. While the slice
+     * exists, checkpoints throw LimitReached also when the slice runs out. Slices can be nested; they must be created
+     * and destroyed while no other thread polls the governor.
+     */
+    class Slice {
+        // Deadlines in ticks of the steady clock
+        std::int64_t previous;
+        std::int64_t deadline;
+
+    public:
+        explicit Slice(std::chrono::milliseconds duration);
+        ~Slice();
+        Slice(Slice const &) = delete;
+        Slice & operator=(Slice const &) = delete;
+
+        bool isExpired() const;
+    };
+
+private:
+    static std::atomic<bool> active;
+
+    static void poll(bool countQuery);
+    static void updateActive();
+};
+
+#endif // GOLEM_RESOURCEGOVERNOR_H
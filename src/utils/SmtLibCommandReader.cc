@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "SmtLibCommandReader.h"
+
+#include <cctype>
+
+std::optional<std::string_view> SmtLibCommandReader::nextCommand() {
+    // Skip whitespace and comments between commands
+    while (position < size) {
+        char c = data[position];
+        if (c == ';') {
+            while (position < size and data[position] != '\n') { ++position; }
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            ++position;
+        } else {
+            break;
+        }
+    }
+    if (position >= size) { return std::nullopt; }
+
+    std::size_t const start = position;
+    if (data[position] != '(') { // Not a command; pass the offending token to the parser to report it
+        while (position < size and data[position] != '(' and
+               not std::isspace(static_cast<unsigned char>(data[position]))) {
+            ++position;
+        }
+        return std::string_view(data + start, position - start);
+    }
+    std::size_t depth = 0;
+    while (position < size) {
+        char c = data[position++];
+        switch (c) {
+            case '(':
+                ++depth;
+                break;
+            case ')':
+                --depth;
+                if (depth == 0) { return std::string_view(data + start, position - start); }
+                break;
+            case ';':
+                while (position < size and data[position] != '\n') { ++position; }
+                break;
+            case '"': // String literal; escaped quote "" is handled as two consecutive literals
+                while (position < size and data[position] != '"') { ++position; }
+                ++position;
+                break;
+            case '|': // Quoted symbol
+                while (position < size and data[position] != '|') { ++position; }
+                ++position;
+                break;
+            default:
+                break;
+        }
+    }
+    position = size;
+    return std::string_view(data + start, size - start);
+}
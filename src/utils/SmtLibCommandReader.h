@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_SMTLIBCOMMANDREADER_H
+#define GOLEM_SMTLIBCOMMANDREADER_H
+
+#include "MappedFile.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * Splits an SMT-LIB script into its top-level commands without parsing them.
+ *
+ * The input file is memory-mapped, so the script is never copied as a whole into memory.
+ * The returned views point into the mapped file and stay valid as long as the reader exists.
+ */
+class SmtLibCommandReader {
+    MappedFile file;
+    char const * data;
+    std::size_t size;
+    std::size_t position{0};
+
+public:
+    explicit SmtLibCommandReader(std::string const & fileName)
+        : file(fileName), data(file.contents().data()), size(file.contents().size()) {}
+
+    /** Returns false if the file could not be opened or mapped */
+    bool isValid() const { return file.isValid(); }
+
+    /** The whole script */
+    std::string_view contents() const { return file.contents(); }
+
+    /**
+     * Returns the text of the next top-level command (including the enclosing parentheses)
+     * or an empty optional if there are no more commands.
+     * Unbalanced input at the end of the file is returned as is, so that the parser can report the error.
+     */
+    std::optional<std::string_view> nextCommand();
+
+    /** Starts reading the script from the beginning again */
+    void rewind() { position = 0; }
+};
+
+#endif // GOLEM_SMTLIBCOMMANDREADER_H
@@ -6,6 +6,9 @@
 
 #include "SmtSolver.h"
 
+#include "ResourceGovernor.h"
+#include "Statistics.h"
+
 SMTSolver::SMTSolver(Logic & logic, WitnessProduction setup) {
     bool produceModel = setup == WitnessProduction::ONLY_MODEL || setup == WitnessProduction::MODEL_AND_INTERPOLANTS;
     bool produceInterpolants =
@@ -19,3 +22,16 @@ SMTSolver::SMTSolver(Logic & logic, WitnessProduction setup) {
 void SMTSolver::resetSolver() {
     solver = std::make_unique<MainSolver>(solver->getLogic(), config, "");
 }
+
+sstat SMTSolver::check(MainSolver & solver) {
+    ResourceGovernor::checkpointQuery();
+    Statistics::increment("smt.checks");
+    ScopedTimer timer("smt.check");
+    auto res = solver.check();
+    if (res == s_True) {
+        Statistics::increment("smt.sat");
+    } else if (res == s_False) {
+        Statistics::increment("smt.unsat");
+    }
+    return res;
+}
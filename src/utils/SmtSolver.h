@@ -26,6 +26,15 @@ public:
 
     SMTConfig & getConfig() { return config; }
 
+    /**
+     * Checks satisfiability of the asserted formulas; the check is recorded in the statistics.
+     * @throws ResourceGovernor::LimitReached if a resource budget has run out
+     */
+    sstat check() { return check(*solver); }
+
+    /** Same as above, for any solver */
+    static sstat check(MainSolver & solver);
+
     void resetSolver();
 };
 
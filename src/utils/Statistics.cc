@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Statistics.h"
+
+#include "Json.h"
+
+#include <array>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+std::atomic<bool> Statistics::enabledFlag{false};
+
+namespace {
+// Every name has a slot that lives as long as the process; recording only updates the atomics of the slot
+struct Counter {
+    std::atomic<std::uint64_t> value{0};
+};
+
+struct Timer {
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::int64_t> total{0}; // nanoseconds
+    std::atomic<std::int64_t> max{0};   // nanoseconds
+};
+
+// Bucket i counts the values from [2^(i-1), 2^i), bucket 0 counts zeros
+struct Histogram {
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> min{std::numeric_limits<std::uint64_t>::max()};
+    std::atomic<std::uint64_t> max{0};
+    std::array<std::atomic<std::uint64_t>, std::numeric_limits<std::uint64_t>::digits + 1> buckets{};
+};
+
+// The mutex guards only the creation of the slots and iterating over them
+struct Registry {
+    std::mutex mutex;
+    // Ordered maps so that the output is stable; nodes of std::map never move, so the slots can be cached
+    std::map<std::string, Counter, std::less<>> counters;
+    std::map<std::string, Timer, std::less<>> timers;
+    std::map<std::string, Histogram, std::less<>> histograms;
+};
+
+Registry & registry() {
+    static Registry instance;
+    return instance;
+}
+
+/*
+ * Slot of the given name. Each thread caches the slots it has used, keyed by the names stored in the registry, so the
+ * registry is locked only the first time a thread records under a name.
+ */
+template<typename TSlot> TSlot & slot(std::map<std::string, TSlot, std::less<>> & map, std::string_view name) {
+    thread_local std::unordered_map<std::string_view, TSlot *> cache;
+    auto cached = cache.find(name);
+    if (cached != cache.end()) { return *cached->second; }
+    auto & reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto it = map.find(name);
+    if (it == map.end()) { it = map.try_emplace(std::string(name)).first; }
+    cache.emplace(it->first, &it->second);
+    return it->second;
+}
+
+template<typename T> void updateMin(std::atomic<T> & target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (value < current and not target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+template<typename T> void updateMax(std::atomic<T> & target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (value > current and not target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+std::size_t bucketOf(std::uint64_t value) {
+    std::size_t bucket = 0;
+    while (value > 0) {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+double toMilliseconds(std::int64_t nanoseconds) {
+    return std::chrono::duration<double, std::milli>(std::chrono::nanoseconds(nanoseconds)).count();
+}
+} // namespace
+
+void Statistics::incrementCounter(std::string_view name, std::uint64_t by) {
+    slot(registry().counters, name).value.fetch_add(by, std::memory_order_relaxed);
+}
+
+void Statistics::recordTimer(std::string_view name, std::chrono::nanoseconds duration) {
+    auto & timer = slot(registry().timers, name);
+    timer.count.fetch_add(1, std::memory_order_relaxed);
+    timer.total.fetch_add(duration.count(), std::memory_order_relaxed);
+    updateMax<std::int64_t>(timer.max, duration.count());
+}
+
+void Statistics::recordHistogram(std::string_view name, std::uint64_t value) {
+    auto & histogram = slot(registry().histograms, name);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.sum.fetch_add(value, std::memory_order_relaxed);
+    updateMin(histogram.min, value);
+    updateMax(histogram.max, value);
+    histogram.buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// The slots are reset instead of removed, as the threads keep pointers to them; unused slots are not printed
+void Statistics::clear() {
+    auto & reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto & [name, counter] : reg.counters) {
+        counter.value = 0;
+    }
+    for (auto & [name, timer] : reg.timers) {
+        timer.count = 0;
+        timer.total = 0;
+        timer.max = 0;
+    }
+    for (auto & [name, histogram] : reg.histograms) {
+        histogram.count = 0;
+        histogram.sum = 0;
+        histogram.min = std::numeric_limits<std::uint64_t>::max();
+        histogram.max = 0;
+        for (auto & bucket : histogram.buckets) {
+            bucket = 0;
+        }
+    }
+}
+
+void Statistics::printJson(std::ostream & out) {
+    auto & reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"counters\": {";
+    char const * separator = "\n";
+    for (auto const & [name, counter] : reg.counters) {
+        auto value = counter.value.load(std::memory_order_relaxed);
+        if (value == 0) { continue; }
+        out << separator << "    ";
+        printJsonString(out, name);
+        out << ": " << value;
+        separator = ",\n";
+    }
+    out << "\n  },\n  \"timers\": {";
+    separator = "\n";
+    for (auto const & [name, timer] : reg.timers) {
+        if (timer.count == 0) { continue; }
+        out << separator << "    ";
+        printJsonString(out, name);
+        out << ": {\"count\": " << timer.count << ", \"total-ms\": " << toMilliseconds(timer.total)
+            << ", \"max-ms\": " << toMilliseconds(timer.max) << '}';
+        separator = ",\n";
+    }
+    out << "\n  },\n  \"histograms\": {";
+    separator = "\n";
+    for (auto const & [name, histogram] : reg.histograms) {
+        if (histogram.count == 0) { continue; }
+        out << separator << "    ";
+        printJsonString(out, name);
+        out << ": {\"count\": " << histogram.count << ", \"sum\": " << histogram.sum << ", \"min\": " << histogram.min
+            << ", \"max\": " << histogram.max << ", \"buckets\": {";
+        // Buckets are keyed by the smallest value they count
+        char const * bucketSeparator = "";
+        for (std::size_t i = 0; i < histogram.buckets.size(); ++i) {
+            auto bucket = histogram.buckets[i].load(std::memory_order_relaxed);
+            if (bucket == 0) { continue; }
+            std::uint64_t lowerBound = i == 0 ? 0 : std::uint64_t(1) << (i - 1);
+            out << bucketSeparator << '"' << lowerBound << "\": " << bucket;
+            bucketSeparator = ", ";
+        }
+        out << "}}";
+        separator = ",\n";
+    }
+    out << "\n  }\n}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
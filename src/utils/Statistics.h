@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_STATISTICS_H
+#define GOLEM_STATISTICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+/**
+ * Process-wide registry of counters, timers and histograms, identified by their names.
+ *
+ * Collection is disabled by default. When disabled, recording costs a single relaxed atomic load and nothing is
+ * stored. Recording is thread-safe and does not lock: each name has its own atomic slot, and every thread resolves a
+ * name to its slot only once. Names that have nothing recorded (e.g., after clear) are not printed.
+ */
+class Statistics {
+    static std::atomic<bool> enabledFlag;
+
+public:
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    static void enable() { enabledFlag.store(true, std::memory_order_relaxed); }
+    static void disable() { enabledFlag.store(false, std::memory_order_relaxed); }
+
+    static void increment(std::string_view name, std::uint64_t by = 1) {
+        if (isEnabled()) { incrementCounter(name, by); }
+    }
+
+    static void recordTime(std::string_view name, std::chrono::nanoseconds duration) {
+        if (isEnabled()) { recordTimer(name, duration); }
+    }
+
+    static void recordValue(std::string_view name, std::uint64_t value) {
+        if (isEnabled()) { recordHistogram(name, value); }
+    }
+
+    /** Prints everything recorded so far as a single JSON object */
+    static void printJson(std::ostream & out);
+
+    /** Discards everything recorded so far */
+    static void clear();
+
+private:
+    static void incrementCounter(std::string_view name, std::uint64_t by);
+    static void recordTimer(std::string_view name, std::chrono::nanoseconds duration);
+    static void recordHistogram(std::string_view name, std::uint64_t value);
+};
+
+/**
+ * Records the time spent in its scope under the given name; the name must outlive the timer.
+ */
+class ScopedTimer {
+    using clock = std::chrono::steady_clock;
+
+    std::string_view name;
+    bool active;
+    clock::time_point start;
+
+public:
+    explicit ScopedTimer(std::string_view name) : name(name), active(Statistics::isEnabled()) {
+        if (active) { start = clock::now(); }
+    }
+
+    ~ScopedTimer() {
+        if (active) { Statistics::recordTime(name, clock::now() - start); }
+    }
+
+    ScopedTimer(ScopedTimer const &) = delete;
+    ScopedTimer & operator=(ScopedTimer const &) = delete;
+};
+
+#endif // GOLEM_STATISTICS_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_THREADPOOL_H
+#define GOLEM_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Simple fixed-size pool of worker threads executing tasks in FIFO order.
+ *
+ * Note that OpenSMT's Logic is not thread-safe. Tasks must not create terms in a shared Logic;
+ * they should work either with read-only access to it or with their own private Logic.
+ */
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(std::size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool & operator=(ThreadPool const &) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    template<typename TTask>
+    std::future<std::invoke_result_t<TTask>> submit(TTask task) {
+        using result_t = std::invoke_result_t<TTask>;
+        auto packaged = std::make_shared<std::packaged_task<result_t()>>(std::move(task));
+        auto future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    /**
+     * Number of threads to use when the user does not specify it explicitly.
+     */
+    static std::size_t defaultThreadCount();
+};
+
+/**
+ * Executes action(i) for every i in [0, count) using at most 'threads' threads.
+ * With less than two threads (or less than two items) the actions are executed sequentially in the calling thread.
+ *
+ * Exceptions thrown by the actions are rethrown in the calling thread; the one for the lowest index wins.
+ */
+template<typename TAction>
+void parallelFor(std::size_t count, std::size_t threads, TAction action) {
+    if (threads < 2 or count < 2) {
+        for (std::size_t i = 0; i < count; ++i) {
+            action(i);
+        }
+        return;
+    }
+    ThreadPool pool(std::min(threads, count));
+    std::vector<std::future<void>> results;
+    results.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        results.push_back(pool.submit([&action, i]() { action(i); }));
+    }
+    for (auto & result : results) {
+        result.wait();
+    }
+    for (auto & result : results) {
+        result.get();
+    }
+}
+
+/**
+ * Ordered parallel map over [0, count) using at most 'threads' threads.
+ *
+ * For every index, prepare(i) is called in the calling thread and returns a task; the task is executed by a worker
+ * and its result is passed to finish(i, result), again in the calling thread and in the order of the indices. The
+ * number of tasks in flight is bounded, so results do not pile up while waiting for an earlier one. The tasks must
+ * own the data they work with (e.g., a private Logic, which they can hand back in their result).
+ * With less than two threads (or less than two items) every task is executed in the calling thread right away.
+ *
+ * If finish returns a bool, returning false stops the map: no further tasks are prepared, the tasks in flight are
+ * completed, but their results are discarded. Exceptions are rethrown in the calling thread from finish's position.
+ */
+template<typename TPrepare, typename TFinish>
+void parallelMap(std::size_t count, std::size_t threads, TPrepare prepare, TFinish finish) {
+    using task_t = std::invoke_result_t<TPrepare &, std::size_t>;
+    using result_t = std::invoke_result_t<task_t &>;
+    auto finishOne = [&finish](std::size_t index, result_t && result) -> bool {
+        if constexpr (std::is_same_v<std::invoke_result_t<TFinish &, std::size_t, result_t &&>, bool>) {
+            return finish(index, std::move(result));
+        } else {
+            finish(index, std::move(result));
+            return true;
+        }
+    };
+    if (threads < 2 or count < 2) {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto task = prepare(i);
+            if (not finishOne(i, task())) { return; }
+        }
+        return;
+    }
+    ThreadPool pool(std::min(threads, count));
+    std::size_t const maxInFlight = 2 * pool.size();
+    std::deque<std::pair<std::size_t, std::future<result_t>>> inFlight;
+    auto finishOldest = [&]() {
+        auto [index, result] = std::move(inFlight.front());
+        inFlight.pop_front();
+        return finishOne(index, result.get());
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        inFlight.emplace_back(i, pool.submit(prepare(i)));
+        if (inFlight.size() > maxInFlight and not finishOldest()) { return; }
+    }
+    while (not inFlight.empty()) {
+        if (not finishOldest()) { return; }
+    }
+}
+
+#endif // GOLEM_THREADPOOL_H
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "VersionedFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+
+VersionedFile::VersionedFile(std::string const & path, std::string_view magic) : file(path) {
+    if (not file.isValid()) { return; }
+    auto contents = file.contents();
+    if (contents.substr(0, magic.size()) != magic) { return; }
+    body = contents.substr(magic.size());
+    valid = true;
+}
+
+bool VersionedFile::write(std::string const & path, std::string_view magic,
+                          std::initializer_list<std::string_view> parts) {
+    // Several threads of the same process may write files at once, e.g., solvers of a network of transition systems
+    std::string temporaryPath = path + ".tmp" + std::to_string(getpid()) + "-" +
+                                std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (not out) { return false; }
+        out.write(magic.data(), static_cast<std::streamsize>(magic.size()));
+        for (auto part : parts) {
+            out.write(part.data(), static_cast<std::streamsize>(part.size()));
+        }
+        if (not out) {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOLEM_VERSIONEDFILE_H
+#define GOLEM_VERSIONEDFILE_H
+
+#include "MappedFile.h"
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+/**
+ * File that starts with a magic header identifying its format and the version of the format, used for the data that
+ * Golem keeps between runs (checkpoints, preprocessing cache, TPA snapshots).
+ *
+ * Writing is atomic: the contents are written to a temporary file, unique to the process and thread, which then
+ * replaces the file. Concurrent readers therefore see either the old or the new contents, never a partial file.
+ * Reading maps the file into memory; a file with a different header (e.g., written by an older version) is not valid.
+ */
+class VersionedFile {
+    MappedFile file;
+    std::string_view body;
+    bool valid{false};
+
+public:
+    VersionedFile(std::string const & path, std::string_view magic);
+
+    /** Returns false if the file does not exist or cannot be mapped */
+    bool exists() const { return file.isValid(); }
+
+    /** Returns true if the file exists and starts with the expected header */
+    bool isValid() const { return valid; }
+
+    /** Contents after the header; valid as long as this object lives */
+    std::string_view contents() const { return body; }
+
+    /** Writes the header followed by the parts; returns false if the file could not be written */
+    static bool write(std::string const & path, std::string_view magic, std::initializer_list<std::string_view> parts);
+};
+
+#endif // GOLEM_VERSIONEDFILE_H
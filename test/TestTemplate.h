@@ -8,13 +8,17 @@
 #define GOLEM_TESTTEMPLATE_H
 
 #include "engine/Engine.h"
+#include "engine/EngineFactory.h"
 #include "graph/ChcGraphBuilder.h"
 #include "transformers/ConstraintSimplifier.h"
 #include "Validator.h"
 
 #include <gtest/gtest.h>
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 class EngineTest : public ::testing::Test {
 protected:
@@ -34,6 +38,16 @@ protected:
 
     PTRef instantiatePredicate(SymRef symbol, vec<PTRef> const & args) { return logic->mkUninterpFun(symbol, args); }
 
+    // Names of the engines created by the factory, in order of creation
+    std::vector<std::string> startedEngines;
+
+    // Creates the real engines (see makeEngine) and records their names
+    std::function<std::unique_ptr<Engine>(std::string const &, Logic &, Options const &)> factory =
+        [this](std::string const & name, Logic & engineLogic, Options const & engineOptions) {
+            startedEngines.push_back(name);
+            return makeEngine(name, engineLogic, engineOptions);
+        };
+
     void solveSystem(std::vector<ChClause> const & clauses, Engine & engine, VerificationAnswer expectedAnswer, bool validate = true) {
         for (auto const & clause : clauses) { system.addClause(clause); }
 
@@ -73,6 +87,25 @@ protected:
     PTRef mkIntVar(char const * const name) { return logic->mkIntVar(name); }
 
     SRef intSort() const { return logic->getSort_int(); }
+
+    // Safe transition system: x starts at 0 and is incremented, it never becomes negative
+    std::vector<ChClause> counterSystem() {
+        SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+        PTRef current = instantiatePredicate(s1, {x});
+        PTRef next = instantiatePredicate(s1, {xp});
+        return {{ // x' = 0 => S1(x')
+                    ChcHead{UninterpretedPredicate{next}},
+                    ChcBody{{logic->mkEq(xp, zero)}, {}}
+                },
+                { // S1(x) and x' = x + 1 => S1(x')
+                    ChcHead{UninterpretedPredicate{next}},
+                    ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{current}}}
+                },
+                { // S1(x) and x < 0 => false
+                    ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                    ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{current}}}
+                }};
+    }
 };
 
 class LRAEngineTest : public EngineTest {
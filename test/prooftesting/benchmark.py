@@ -0,0 +1,47 @@
+from subprocess import call, DEVNULL
+import os
+import resource
+import sys
+import tempfile
+import time
+
+# Measures the time and memory needed to produce Alethe proofs for counterexamples with long derivations.
+# Usage: python3 benchmark.py <golem executable> [length ...]
+
+golem_exec = sys.argv[1]
+lengths = [int(arg) for arg in sys.argv[2:]] or [100, 500, 1000, 2000]
+
+
+def long_derivation(length):
+    return f"""(set-logic HORN)
+(declare-fun Inv (Int Int) Bool)
+
+(assert (forall ((x Int) (y Int)) (=> (and (= x 0) (= y 0)) (Inv x y))))
+
+(assert (forall ((x Int) (y Int) (xp Int) (yp Int))
+    (=> (and (Inv x y) (< x {length}) (= xp (+ x 1)) (= yp (+ y 2))) (Inv xp yp))))
+
+(assert (forall ((x Int) (y Int)) (=> (and (Inv x y) (>= x {length})) false)))
+
+(check-sat)
+(exit)
+"""
+
+
+for length in lengths:
+    with tempfile.NamedTemporaryFile('w', suffix=".smt2", delete=False) as f:
+        f.write(long_derivation(length))
+        smt_file = f.name
+    before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    start = time.perf_counter()
+    ret_code = call([golem_exec, "--engine=bmc", smt_file, "--print-witness", "--proof-format=alethe"],
+                    stdout=DEVNULL)
+    elapsed = time.perf_counter() - start
+    after = resource.getrusage(resource.RUSAGE_CHILDREN)
+    os.remove(smt_file)
+    if ret_code != 0:
+        print("Golem failed on derivation of length", length)
+        continue
+    # ru_maxrss is the maximum over all children so far, in kilobytes
+    print(f"length {length}: {elapsed:.2f} s, {after.ru_utime - before.ru_utime:.2f} s user, "
+          f"max RSS {after.ru_maxrss / 1024:.1f} MB")
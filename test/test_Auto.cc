@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "TestTemplate.h"
+#include "engine/Auto.h"
+
+#include <filesystem>
+#include <fstream>
+
+class Auto_Test : public LIAEngineTest {};
+
+TEST_F(Auto_Test, test_FeaturesOfTransitionSystem) {
+    for (auto const & clause : counterSystem()) {
+        system.addClause(clause);
+    }
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    auto graph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    auto features = GraphFeatures::of(*graph);
+    EXPECT_TRUE(features.linear);
+    EXPECT_TRUE(features.transitionSystem);
+    EXPECT_FALSE(features.transitionSystemDAG);
+    EXPECT_TRUE(features.integers);
+    EXPECT_EQ(features.predicates, 1);
+    EXPECT_EQ(features.edges, 3);
+    EXPECT_EQ(features.loops, 1);
+    EXPECT_EQ(features.maxSources, 1);
+    EXPECT_EQ(features.maxVariables, 1);
+    EXPECT_EQ(features.get("transition-system"), 1);
+    EXPECT_FALSE(features.get("no-such-feature").has_value());
+}
+
+TEST_F(Auto_Test, test_FirstMatchingRuleSelected) {
+    auto rules = EngineRules::parse("# comment\n"
+                                    "linear=0 -> spacer\n"
+                                    "transition-system=1 predicates<=2 -> kind:1.5 spacer\n"
+                                    "* -> lawi\n");
+    GraphFeatures features;
+    features.linear = true;
+    features.transitionSystem = true;
+    features.predicates = 1;
+    auto schedule = rules.select(features);
+    ASSERT_EQ(schedule.size(), 2);
+    EXPECT_EQ(schedule[0].engine, "kind");
+    EXPECT_EQ(schedule[0].time, std::chrono::milliseconds(1500));
+    EXPECT_EQ(schedule[1].engine, "spacer");
+    EXPECT_FALSE(schedule[1].time.has_value());
+    features.predicates = 3;
+    schedule = rules.select(features);
+    ASSERT_EQ(schedule.size(), 1);
+    EXPECT_EQ(schedule[0].engine, "lawi");
+}
+
+TEST_F(Auto_Test, test_MalformedRules) {
+    EXPECT_THROW(EngineRules::parse("linear=1 spacer"), std::logic_error);
+    EXPECT_THROW(EngineRules::parse("unknown=1 -> spacer"), std::logic_error);
+    EXPECT_THROW(EngineRules::parse("linear=yes -> spacer"), std::logic_error);
+    EXPECT_THROW(EngineRules::parse("* -> spacer kind"), std::logic_error);
+    EXPECT_THROW(EngineRules::parse("* -> spacer:0"), std::logic_error);
+    EXPECT_THROW(EngineRules::parse("* -> auto"), std::logic_error);
+    EXPECT_NO_THROW(EngineRules::builtIn());
+}
+
+TEST_F(Auto_Test, test_NextEngineAfterTimeSlice) {
+    auto rules = std::filesystem::temp_directory_path() / "golem-auto-rules-test";
+    {
+        std::ofstream out(rules);
+        // The first slice is too short for any engine to finish
+        out << "* -> kind:0.000001 spacer\n";
+    }
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::AUTO_RULES, rules.string());
+    AutoEngine engine(*logic, options, factory);
+    solveSystem(counterSystem(), engine, VerificationAnswer::SAFE);
+    EXPECT_EQ(startedEngines, std::vector<std::string>({"kind", "spacer"}));
+    std::filesystem::remove(rules);
+}
+
+TEST_F(Auto_Test, test_BuiltInRules) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, "auto");
+    AutoEngine engine(*logic, options, factory);
+    // A transition system is scheduled to split-TPA first, which needs the engine option to select its variant
+    solveSystem(counterSystem(), engine, VerificationAnswer::SAFE);
+    ASSERT_FALSE(startedEngines.empty());
+    EXPECT_EQ(startedEngines[0], "split-tpa");
+}
+
+TEST_F(Auto_Test, test_CreatedByEngineFactory) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, "auto");
+    auto engine = makeEngine("auto", *logic, options);
+    solveSystem(counterSystem(), *engine, VerificationAnswer::SAFE);
+}
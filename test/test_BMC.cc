@@ -8,7 +8,11 @@
 #include "Validator.h"
 #include "engine/Bmc.h"
 #include "graph/ChcGraphBuilder.h"
+#include "utils/ResourceGovernor.h"
+#include <algorithm>
+#include <filesystem>
 #include <gtest/gtest.h>
+#include <sstream>
 
 class BMCTest : public LIAEngineTest {
 };
@@ -141,3 +145,98 @@ TEST_F(BMCTest, test_KIND_BeyondTransitionSystemWithAuxVar_unsafe)
     BMC engine(*logic, options);
     solveSystem(clauses, engine, VerificationAnswer::UNSAFE, true);
 }
+
+TEST_F(BMCTest, test_BMC_QueryLimit) {
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    PTRef current = instantiatePredicate(s1, {x});
+    PTRef next = instantiatePredicate(s1, {xp});
+    // x' = 0 => S1(x')
+    // S1(x) and x' = x + 1 => S1(x')
+    // S1(x) and x < 0 => false
+    system.addClause(ChcHead{UninterpretedPredicate{next}}, ChcBody{{logic->mkEq(xp, zero)}, {}});
+    system.addClause(ChcHead{UninterpretedPredicate{next}},
+                     ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{current}}});
+    system.addClause(ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                     ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{current}}});
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    auto hypergraph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    ResourceGovernor::configure({.queries = 10});
+    auto res = BMC(*logic, options).solve(*hypergraph);
+    ResourceGovernor::configure({});
+    ASSERT_EQ(res.getAnswer(), VerificationAnswer::UNKNOWN);
+    EXPECT_EQ(res.getNoWitnessReason(), "query limit reached");
+    ASSERT_TRUE(res.getSafeBound().has_value());
+    EXPECT_GT(res.getSafeBound().value(), 0u);
+}
+
+TEST_F(BMCTest, test_SafeBoundCountsTransitionsInEveryEngine) {
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    PTRef current = instantiatePredicate(s1, {x});
+    PTRef next = instantiatePredicate(s1, {xp});
+    // x' = 0 => S1(x')
+    // S1(x) and x' = x + 1 => S1(x')
+    // S1(x) and x = 4 => false, reachable with 4 transitions
+    system.addClause(ChcHead{UninterpretedPredicate{next}}, ChcBody{{logic->mkEq(xp, zero)}, {}});
+    system.addClause(ChcHead{UninterpretedPredicate{next}},
+                     ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{current}}});
+    system.addClause(ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                     ChcBody{{logic->mkEq(x, logic->mkIntConst(4))}, {UninterpretedPredicate{current}}});
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    auto hypergraph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    for (std::string engine : {"bmc", "kind", "imc", "spacer", "tpa", "split-tpa"}) {
+        Options engineOptions;
+        engineOptions.addOption(Options::ENGINE, engine);
+        std::size_t highestBound = 0;
+        for (std::uint64_t queries = 1; queries < 100; ++queries) {
+            ResourceGovernor::configure({.queries = queries});
+            auto res = makeEngine(engine, *logic, engineOptions)->solve(*hypergraph);
+            ResourceGovernor::configure({});
+            if (res.getAnswer() != VerificationAnswer::UNKNOWN) {
+                EXPECT_EQ(res.getAnswer(), VerificationAnswer::UNSAFE) << engine;
+                break;
+            }
+            if (auto bound = res.getSafeBound()) {
+                EXPECT_LE(*bound, 3u) << engine;
+                highestBound = std::max(highestBound, *bound);
+            }
+        }
+        if (engine == "bmc") { EXPECT_EQ(highestBound, 3u); }
+    }
+}
+
+TEST_F(BMCTest, test_BMC_ResumeFromCheckpoint) {
+    auto path = std::filesystem::temp_directory_path() / "golem-bmc-checkpoint-test";
+    std::filesystem::remove(path);
+    options.addOption(Options::CHECKPOINT, path.string());
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    PTRef current = instantiatePredicate(s1, {x});
+    PTRef next = instantiatePredicate(s1, {xp});
+    system.addClause(ChcHead{UninterpretedPredicate{next}}, ChcBody{{logic->mkEq(xp, zero)}, {}});
+    system.addClause(ChcHead{UninterpretedPredicate{next}},
+                     ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{current}}});
+    system.addClause(ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                     ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{current}}});
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    auto hypergraph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    auto solveChunk = [&]() {
+        ResourceGovernor::configure({.queries = 10});
+        auto res = BMC(*logic, options).solve(*hypergraph);
+        ResourceGovernor::configure({});
+        return res;
+    };
+    auto first = solveChunk();
+    ASSERT_EQ(first.getAnswer(), VerificationAnswer::UNKNOWN);
+    ASSERT_TRUE(first.getSafeBound().has_value());
+    EXPECT_TRUE(std::filesystem::exists(path));
+    // The second chunk does not repeat the queries of the first one, so it gets further with the same budget
+    auto second = solveChunk();
+    ASSERT_EQ(second.getAnswer(), VerificationAnswer::UNKNOWN);
+    ASSERT_TRUE(second.getSafeBound().has_value());
+    EXPECT_GT(second.getSafeBound().value(), first.getSafeBound().value());
+    std::stringstream json;
+    second.printJson(json, "bmc");
+    EXPECT_EQ(json.str(), "{\"engine\": \"bmc\", \"answer\": \"unknown\", \"safe-bound\": " +
+                              std::to_string(second.getSafeBound().value()) +
+                              ", \"reason\": \"query limit reached\"}\n");
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "TestTemplate.h"
+#include "engine/Houdini.h"
+
+class HoudiniTest : public LIAEngineTest {
+protected:
+    // x' = x + 1 and y' = y + x
+    PTRef transition() {
+        return logic->mkAnd(logic->mkEq(xp, logic->mkPlus(x, one)), logic->mkEq(yp, logic->mkPlus(y, x)));
+    }
+
+    Houdini::Candidate candidate(PTRef (*build)(ArithLogic &, PTRef, PTRef)) {
+        return {build(*logic, x, y), build(*logic, xp, yp)};
+    }
+};
+
+TEST_F(HoudiniTest, test_InductiveSubset) {
+    Houdini houdini(*logic, transition());
+    std::vector<Houdini::Candidate> candidates{
+        candidate([](ArithLogic & logic, PTRef x, PTRef) { return logic.mkGeq(x, logic.getTerm_IntZero()); }),
+        candidate([](ArithLogic & logic, PTRef x, PTRef) { return logic.mkLeq(x, logic.mkIntConst(5)); }),
+        // Inductive only together with the first candidate
+        candidate([](ArithLogic & logic, PTRef, PTRef y) { return logic.mkGeq(y, logic.getTerm_IntZero()); }),
+        candidate([](ArithLogic & logic, PTRef, PTRef y) { return logic.mkLeq(y, logic.mkIntConst(3)); })
+    };
+    EXPECT_EQ(houdini.filter(candidates), (std::vector<std::size_t>{0, 2}));
+}
+
+TEST_F(HoudiniTest, test_DependencyOnDroppedCandidate) {
+    Houdini houdini(*logic, transition());
+    std::vector<Houdini::Candidate> candidates{
+        candidate([](ArithLogic & logic, PTRef x, PTRef) { return logic.mkLeq(x, logic.getTerm_IntZero()); }),
+        // Inductive only together with the first candidate, which is not inductive
+        candidate([](ArithLogic & logic, PTRef, PTRef y) { return logic.mkLeq(y, logic.getTerm_IntZero()); })
+    };
+    EXPECT_TRUE(houdini.filter(candidates).empty());
+}
+
+TEST_F(HoudiniTest, test_SolverIsReused) {
+    Houdini houdini(*logic, transition());
+    std::vector<Houdini::Candidate> failing{
+        candidate([](ArithLogic & logic, PTRef x, PTRef) { return logic.mkLeq(x, logic.mkIntConst(5)); })
+    };
+    EXPECT_TRUE(houdini.filter(failing).empty());
+    // Candidates of the previous call do not affect the next one
+    std::vector<Houdini::Candidate> passing{
+        candidate([](ArithLogic & logic, PTRef x, PTRef) { return logic.mkGeq(x, logic.getTerm_IntZero()); }),
+        {logic->getTerm_true(), logic->mkGeq(xp, logic->mkPlus(x, one))}
+    };
+    EXPECT_EQ(houdini.filter(passing), (std::vector<std::size_t>{0, 1}));
+}
+
+TEST_F(HoudiniTest, test_CandidatesOfPreviousCallsAreRemoved) {
+    Houdini houdini(*logic, transition());
+    PTRef bound = logic->mkIntConst(-100);
+    std::vector<Houdini::Candidate> first{{logic->mkLeq(x, bound), logic->mkLeq(xp, logic->mkPlus(bound, one))}};
+    EXPECT_EQ(houdini.filter(first), (std::vector<std::size_t>{0}));
+    // The activation literal of the first call guards a different candidate now, the old premise must be gone
+    std::vector<Houdini::Candidate> second{{logic->getTerm_true(), logic->mkLeq(xp, logic->mkPlus(bound, one))}};
+    EXPECT_TRUE(houdini.filter(second).empty());
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "utils/Json.h"
+
+#include <sstream>
+
+namespace {
+std::string toJson(std::string_view str) {
+    std::ostringstream out;
+    printJsonString(out, str);
+    return out.str();
+}
+} // namespace
+
+TEST(JsonTest, test_PlainStringQuoted) {
+    EXPECT_EQ(toJson("spacer"), "\"spacer\"");
+    EXPECT_EQ(toJson(""), "\"\"");
+}
+
+TEST(JsonTest, test_QuotesAndBackslashesEscaped) {
+    EXPECT_EQ(toJson("a \"b\" \\c"), R"("a \"b\" \\c")");
+}
+
+TEST(JsonTest, test_ControlCharactersEscaped) {
+    EXPECT_EQ(toJson("line\nnext\r\tend"), R"("line\nnext\r\tend")");
+    EXPECT_EQ(toJson(std::string_view("\0\x01\x1f", 3)), R"("\u0000\u0001\u001f")");
+    // Other bytes, including UTF-8 sequences, are printed unchanged
+    EXPECT_EQ(toJson("\x7f\xc3\xa9"), "\"\x7f\xc3\xa9\"");
+}
@@ -91,4 +91,31 @@ TEST_F(KindTest, test_KIND_moreInductionBackward_safe)
         }};
     Kind engine(*logic, options);
     solveSystem(clauses, engine, VerificationAnswer::SAFE, true);
-}
\ No newline at end of file
+}
+TEST_F(KindTest, test_KIND_strengthenedByLemmas_safe)
+{
+    options.addOption(Options::LOGIC, "QF_LIA");
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    SymRef s1 = mkPredicateSymbol("s1", {intSort(), intSort()});
+    PTRef current = instantiatePredicate(s1, {x, y});
+    PTRef next = instantiatePredicate(s1, {xp, yp});
+    // x = 0 and y >= 1 => S1(x, y)
+    // S1(x, y) and x' = x + y and y' = y => S1(x', y')
+    // S1(x, y) and x < 0 => false
+    // x >= 0 is not k-inductive for any k, it is inductive together with the lemma y >= 1
+    std::vector<ChClause> clauses{
+        {
+            ChcHead{UninterpretedPredicate{next}},
+            ChcBody{{logic->mkAnd(logic->mkEq(xp, zero), logic->mkGeq(yp, one))}, {}}
+        },
+        {
+            ChcHead{UninterpretedPredicate{next}},
+            ChcBody{{logic->mkAnd(logic->mkEq(xp, logic->mkPlus(x, y)), logic->mkEq(yp, y))}, {UninterpretedPredicate{current}}}
+        },
+        {
+            ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+            ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{current}}}
+        }};
+    Kind engine(*logic, options);
+    solveSystem(clauses, engine, VerificationAnswer::SAFE, true);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "TestTemplate.h"
+#include "engine/Modular.h"
+#include "engine/Spacer.h"
+
+class Modular_Test : public LIAEngineTest {
+protected:
+    ModularEngine::EngineFactory spacerFactory = [](Logic & logic, Options const & options) {
+        return std::make_unique<Spacer>(logic, options);
+    };
+
+    std::vector<ChClause> chainOfLoops(PTRef queryConstraint, bool queryInFirstLoop) {
+        SymRef inv1_sym = mkPredicateSymbol("Inv1", {intSort()});
+        SymRef inv2_sym = mkPredicateSymbol("Inv2", {intSort()});
+        PTRef inv1 = instantiatePredicate(inv1_sym, {x});
+        PTRef inv1p = instantiatePredicate(inv1_sym, {xp});
+        PTRef inv2 = instantiatePredicate(inv2_sym, {x});
+        PTRef inv2p = instantiatePredicate(inv2_sym, {xp});
+        std::vector<ChClause> clauses{
+            { // x' = 0 => Inv1(x')
+                ChcHead{UninterpretedPredicate{inv1p}},
+                ChcBody{{logic->mkEq(xp, zero)}, {}}
+            },
+            { // Inv1(x) & x' = x + 1 => Inv1(x')
+                ChcHead{UninterpretedPredicate{inv1p}},
+                ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{inv1}}}
+            },
+            { // Inv1(x) & x' = x => Inv2(x')
+                ChcHead{UninterpretedPredicate{inv2p}},
+                ChcBody{{logic->mkEq(xp, x)}, {UninterpretedPredicate{inv1}}}
+            },
+            { // Inv2(x) & x' = x + 2 => Inv2(x')
+                ChcHead{UninterpretedPredicate{inv2p}},
+                ChcBody{{logic->mkEq(xp, logic->mkPlus(x, two))}, {UninterpretedPredicate{inv2}}}
+            },
+            { // Inv2(x) & query => false
+                ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                ChcBody{{queryConstraint}, {UninterpretedPredicate{inv2}}}
+            }
+        };
+        if (queryInFirstLoop) {
+            clauses.push_back({ // Inv1(x) & x < 0 => false
+                ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{inv1}}}
+            });
+        }
+        return clauses;
+    }
+
+    // Inv1 counts up from 0; Inv2 and Inv3 continue independently of each other, each with its own query
+    std::vector<ChClause> diamond(PTRef query2, PTRef query3) {
+        SymRef inv1_sym = mkPredicateSymbol("Inv1", {intSort()});
+        SymRef inv2_sym = mkPredicateSymbol("Inv2", {intSort()});
+        SymRef inv3_sym = mkPredicateSymbol("Inv3", {intSort()});
+        PTRef inv1 = instantiatePredicate(inv1_sym, {x});
+        std::vector<ChClause> clauses{
+            { // x' = 0 => Inv1(x')
+                ChcHead{UninterpretedPredicate{instantiatePredicate(inv1_sym, {xp})}},
+                ChcBody{{logic->mkEq(xp, zero)}, {}}
+            },
+            { // Inv1(x) & x' = x + 1 => Inv1(x')
+                ChcHead{UninterpretedPredicate{instantiatePredicate(inv1_sym, {xp})}},
+                ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{inv1}}}
+            }
+        };
+        for (auto [sym, query] : {std::make_pair(inv2_sym, query2), std::make_pair(inv3_sym, query3)}) {
+            PTRef inv = instantiatePredicate(sym, {x});
+            PTRef invp = instantiatePredicate(sym, {xp});
+            clauses.push_back({ // Inv1(x) & x' = x => Inv(x')
+                ChcHead{UninterpretedPredicate{invp}},
+                ChcBody{{logic->mkEq(xp, x)}, {UninterpretedPredicate{inv1}}}
+            });
+            clauses.push_back({ // Inv(x) & x' = x + 2 => Inv(x')
+                ChcHead{UninterpretedPredicate{invp}},
+                ChcBody{{logic->mkEq(xp, logic->mkPlus(x, two))}, {UninterpretedPredicate{inv}}}
+            });
+            clauses.push_back({ // Inv(x) & query => false
+                ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                ChcBody{{query}, {UninterpretedPredicate{inv}}}
+            });
+        }
+        return clauses;
+    }
+};
+
+TEST_F(Modular_Test, test_ComponentsInTopologicalOrder) {
+    for (auto const & clause : chainOfLoops(logic->mkLt(x, zero), false)) {
+        system.addClause(clause);
+    }
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    auto graph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    auto components = ModularEngine::stronglyConnectedComponents(*graph);
+    ASSERT_EQ(components.size(), 2);
+    ASSERT_EQ(components[0].size(), 1);
+    ASSERT_EQ(components[1].size(), 1);
+    EXPECT_EQ(logic->getSymName(components[0][0]), std::string("Inv1"));
+    EXPECT_EQ(logic->getSymName(components[1][0]), std::string("Inv2"));
+}
+
+TEST_F(Modular_Test, test_SummaryOfPredecessor_Safe) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    ModularEngine engine(*logic, options, spacerFactory);
+    solveSystem(chainOfLoops(logic->mkLt(x, zero), true), engine, VerificationAnswer::SAFE);
+}
+
+TEST_F(Modular_Test, test_SolvedWithPredecessors_Safe) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::THREADS, "2");
+    ModularEngine engine(*logic, options, spacerFactory);
+    solveSystem(chainOfLoops(logic->mkLt(x, zero), false), engine, VerificationAnswer::SAFE);
+}
+
+TEST_F(Modular_Test, test_SolvedWithPredecessors_Unsafe) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    ModularEngine engine(*logic, options, spacerFactory);
+    solveSystem(chainOfLoops(logic->mkGeq(x, logic->mkIntConst(3)), false), engine, VerificationAnswer::UNSAFE);
+}
+
+TEST_F(Modular_Test, test_ComponentWithoutQuerySummarized) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    std::size_t solved = 0;
+    ModularEngine engine(*logic, options, [&solved](Logic & logic, Options const & options) {
+        ++solved;
+        return std::make_unique<Spacer>(logic, options);
+    });
+    // The summary of Inv1 (x >= 0) suffices for the query on Inv2, no component is solved again with its predecessors
+    solveSystem(chainOfLoops(logic->mkLt(x, zero), false), engine, VerificationAnswer::SAFE);
+    EXPECT_EQ(solved, 1);
+}
+
+TEST_F(Modular_Test, test_IndependentComponentsInThreads_Safe) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::THREADS, "4");
+    ModularEngine engine(*logic, options, spacerFactory);
+    auto clauses = diamond(logic->mkLt(x, zero), logic->mkEq(x, logic->mkIntConst(-1)));
+    solveSystem(clauses, engine, VerificationAnswer::SAFE);
+}
+
+TEST_F(Modular_Test, test_IndependentComponentsInThreads_Unsafe) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::THREADS, "4");
+    ModularEngine engine(*logic, options, spacerFactory);
+    auto clauses = diamond(logic->mkLt(x, zero), logic->mkEq(x, logic->mkIntConst(5)));
+    solveSystem(clauses, engine, VerificationAnswer::UNSAFE);
+}
@@ -9,6 +9,8 @@
 #include "Normalizer.h"
 #include "graph/ChcGraphBuilder.h"
 
+#include <algorithm>
+
 
 TEST(NormalizerTest, test_boolean_equal_to_constant) {
     ArithLogic logic {opensmt::Logic_t::QF_LIA};
@@ -67,3 +69,69 @@ TEST(NormalizerTest, test_ModConstraint) {
 //    auto graph = ChcGraphBuilder(logic).buildGraph(normalizedSystem)->toNormalGraph(logic);
 //    graph->toDot(std::cout, logic);
 }
+
+TEST(NormalizerTest, test_ParallelNormalizationIsDeterministic) {
+    ArithLogic logic {opensmt::Logic_t::QF_LIA};
+
+    SymRef s1 = logic.declareFun("s1", logic.getSort_bool(), {logic.getSort_int()});
+    SymRef s2 = logic.declareFun("s2", logic.getSort_bool(), {logic.getSort_int(), logic.getSort_int()});
+    PTRef x = logic.mkIntVar("x");
+    PTRef y = logic.mkIntVar("y");
+    PTRef c = logic.mkIntVar("c");
+    PTRef zero = logic.getTerm_IntZero();
+    PTRef one = logic.getTerm_IntOne();
+    ChcSystem system;
+    system.addUninterpretedPredicate(s1);
+    system.addUninterpretedPredicate(s2);
+
+    system.addClause(
+        ChcHead{UninterpretedPredicate{logic.mkUninterpFun(s1, {x})}},
+        ChcBody{{logic.mkEq(x, logic.mkPlus(c, c))}, {}}
+    );
+    // Enough clauses to be normalized in several batches
+    for (int k = 1; k <= 150; ++k) {
+        system.addClause(
+            ChcHead{UninterpretedPredicate{logic.mkUninterpFun(s1, {y})}},
+            ChcBody{{logic.mkEq(y, logic.mkPlus(x, logic.mkTimes(c, logic.mkIntConst(k))))},
+                    {UninterpretedPredicate{logic.mkUninterpFun(s1, {x})}}}
+        );
+    }
+    system.addClause(
+        ChcHead{UninterpretedPredicate{logic.mkUninterpFun(s2, {x, logic.mkPlus(x, one)})}},
+        ChcBody{{logic.mkGeq(c, zero)}, {UninterpretedPredicate{logic.mkUninterpFun(s1, {logic.mkMinus(x, c)})}}}
+    );
+    system.addClause(
+        ChcHead{UninterpretedPredicate{logic.mkUninterpFun(s2, {y, x})}},
+        ChcBody{{logic.getTerm_true()}, {UninterpretedPredicate{logic.mkUninterpFun(s2, {x, y})},
+                                        UninterpretedPredicate{logic.mkUninterpFun(s2, {x, c})}}}
+    );
+    system.addClause(
+        ChcHead{UninterpretedPredicate{logic.getTerm_false()}},
+        ChcBody{{logic.mkLt(y, x)}, {UninterpretedPredicate{logic.mkUninterpFun(s2, {x, y})}}}
+    );
+
+    Normalizer sequentialNormalizer(logic, 1);
+    Normalizer parallelNormalizer(logic, 4);
+    auto sequential = sequentialNormalizer.normalize(system);
+    auto parallel = parallelNormalizer.normalize(system);
+    auto const & sequentialClauses = sequential.normalizedSystem->getClauses();
+    auto const & parallelClauses = parallel.normalizedSystem->getClauses();
+    ASSERT_EQ(sequentialClauses.size(), parallelClauses.size());
+    TermUtils utils(logic);
+    for (std::size_t i = 0; i < sequentialClauses.size(); ++i) {
+        EXPECT_EQ(sequentialClauses[i], parallelClauses[i]);
+        auto const & sequentialEqualities = sequentialNormalizer.getNormalizingEqualities()[i];
+        auto const & parallelEqualities = parallelNormalizer.getNormalizingEqualities()[i];
+        ASSERT_EQ(sequentialEqualities.size(), parallelEqualities.size());
+        for (int j = 0; j < sequentialEqualities.size(); ++j) {
+            EXPECT_EQ(sequentialEqualities[j].normalizedVar, parallelEqualities[j].normalizedVar);
+            EXPECT_EQ(sequentialEqualities[j].originalArg, parallelEqualities[j].originalArg);
+        }
+        // Every variable of the constraint is a normalized variable with a known original
+        for (PTRef var : utils.getVars(parallelClauses[i].body.interpretedPart.fla)) {
+            auto known = std::find_if(parallelEqualities.begin(), parallelEqualities.end(),
+                                      [&](auto const & equality) { return equality.normalizedVar == var; });
+            EXPECT_NE(known, parallelEqualities.end()) << logic.printTerm(var);
+        }
+    }
+}
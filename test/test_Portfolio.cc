@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "TestTemplate.h"
+#include "engine/Portfolio.h"
+
+#include <algorithm>
+
+class Portfolio_Test : public LIAEngineTest {
+protected:
+    // Safe nonlinear system, on which TPA gives up immediately
+    std::vector<ChClause> nonlinearSystem() {
+        SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+        return {{ // x' = 0 => S1(x')
+                    ChcHead{UninterpretedPredicate{instantiatePredicate(s1, {xp})}},
+                    ChcBody{{logic->mkEq(xp, zero)}, {}}
+                },
+                { // S1(x) and S1(y) and x' = x + y => S1(x')
+                    ChcHead{UninterpretedPredicate{instantiatePredicate(s1, {xp})}},
+                    ChcBody{{logic->mkEq(xp, logic->mkPlus(x, y))},
+                            {UninterpretedPredicate{instantiatePredicate(s1, {x})},
+                             UninterpretedPredicate{instantiatePredicate(s1, {y})}}}
+                },
+                { // S1(x) and x < 0 => false
+                    ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                    ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{instantiatePredicate(s1, {x})}}}
+                }};
+    }
+};
+
+TEST_F(Portfolio_Test, test_PreemptedEngineYieldsToNext) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::PORTFOLIO_SLICE, "0.01");
+    // BMC never finishes on a safe system, it must not block Spacer
+    SequentialPortfolio engine(*logic, options, {"bmc", "spacer"}, factory);
+    solveSystem(counterSystem(), engine, VerificationAnswer::SAFE);
+    ASSERT_GE(startedEngines.size(), 2);
+    EXPECT_EQ(startedEngines[0], "bmc");
+    EXPECT_EQ(startedEngines[1], "spacer");
+    EXPECT_EQ(startedEngines.back(), "spacer");
+}
+
+TEST_F(Portfolio_Test, test_EngineThatGivesUpIsDropped) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::PORTFOLIO_SLICE, "0.01");
+    SequentialPortfolio engine(*logic, options, {"tpa", "spacer"}, factory);
+    solveSystem(nonlinearSystem(), engine, VerificationAnswer::SAFE);
+    EXPECT_EQ(std::count(startedEngines.begin(), startedEngines.end(), "tpa"), 1);
+}
+
+TEST_F(Portfolio_Test, test_EngineOptionSetForEachEngine) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    // TPA selects its variant by the engine option, which the portfolio sets for each of its engines
+    SequentialPortfolio engine(*logic, options, {"split-tpa", "spacer"}, factory);
+    solveSystem(counterSystem(), engine, VerificationAnswer::SAFE);
+    EXPECT_EQ(startedEngines, std::vector<std::string>({"split-tpa"}));
+}
+
+TEST_F(Portfolio_Test, test_InvalidTimeSlice) {
+    options.addOption(Options::PORTFOLIO_SLICE, "0");
+    EXPECT_THROW(SequentialPortfolio(*logic, options, {"spacer"}, factory), std::logic_error);
+}
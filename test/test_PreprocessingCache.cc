@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "PreprocessingCache.h"
+
+class PreprocessingCacheTest : public ::testing::Test {
+protected:
+    static constexpr std::string_view input = "(set-logic HORN)\n(check-sat)\n";
+
+    static std::string pathWith(Options const & options) { return PreprocessingCache("dir", input, options).getPath(); }
+};
+
+TEST_F(PreprocessingCacheTest, test_KeyIgnoresSolvingOptions) {
+    Options options;
+    auto path = pathWith(options);
+    options.addOption(Options::ENGINE, "kind");
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    EXPECT_EQ(pathWith(options), path);
+    EXPECT_EQ(path.substr(0, 4), "dir/");
+}
+
+TEST_F(PreprocessingCacheTest, test_KeyDependsOnPreprocessingOptions) {
+    Options options;
+    auto path = pathWith(options);
+    Options withThreads;
+    withThreads.addOption(Options::THREADS, "4");
+    EXPECT_NE(pathWith(withThreads), path);
+    Options withLogic;
+    withLogic.addOption(Options::LOGIC, "QF_LIA");
+    EXPECT_NE(pathWith(withLogic), path);
+    EXPECT_NE(pathWith(withLogic), pathWith(withThreads));
+    Options emptyThreads;
+    emptyThreads.addOption(Options::THREADS, "");
+    EXPECT_NE(pathWith(emptyThreads), path);
+}
+
+TEST_F(PreprocessingCacheTest, test_KeyDependsOnInput) {
+    Options options;
+    EXPECT_NE(PreprocessingCache("dir", "(check-sat)\n", options).getPath(), pathWith(options));
+}
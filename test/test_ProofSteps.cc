@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "ChcInterpreter.h"
+#include "utils/SmtLibCommandReader.h"
+
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+class ProofSteps_Test : public ::testing::Test {
+protected:
+    // Unsafe counter: x starts at 0, is incremented and must stay below 3
+    static constexpr char const * counter = R"(
+(set-logic HORN)
+(declare-fun inv (Int) Bool)
+(assert (forall ((x Int)) (=> (= x 0) (inv x))))
+(assert (forall ((x Int) (y Int)) (=> (and (inv x) (= y (+ x 1))) (inv y))))
+(assert (forall ((x Int)) (=> (and (inv x) (>= x 3)) false)))
+(check-sat)
+)";
+
+    // Solves the input and returns the printed output, including the proof
+    static std::string solve(std::string const & input, std::string const & format, std::string const & threads) {
+        auto path = std::filesystem::temp_directory_path() / "golem-proof-steps-test.smt2";
+        {
+            std::ofstream out(path);
+            out << input;
+        }
+        Options options;
+        options.addOption(Options::ENGINE, "bmc");
+        options.addOption(Options::PRINT_WITNESS, "true");
+        options.addOption(Options::PROOF_FORMAT, format);
+        options.addOption(Options::THREADS, threads);
+        ArithLogic logic{opensmt::Logic_t::QF_LIA};
+        SmtLibCommandReader reader(path.string());
+        testing::internal::CaptureStdout();
+        ChcInterpreter(options).interpretSystemStream(logic, reader);
+        std::filesystem::remove(path);
+        return testing::internal::GetCapturedStdout();
+    }
+};
+
+TEST_F(ProofSteps_Test, test_ThreadedAletheProofEqualsSequential) {
+    auto sequential = solve(counter, "alethe", "1");
+    ASSERT_EQ(sequential.substr(0, 6), "unsat\n");
+    EXPECT_EQ(solve(counter, "alethe", "4"), sequential);
+}
+
+TEST_F(ProofSteps_Test, test_ThreadedIntermediateProofEqualsSequential) {
+    auto sequential = solve(counter, "intermediate", "1");
+    ASSERT_EQ(sequential.substr(0, 6), "unsat\n");
+    EXPECT_EQ(solve(counter, "intermediate", "4"), sequential);
+}
+
+TEST_F(ProofSteps_Test, test_AletheStepsReferToPreviousSteps) {
+    std::istringstream proof(solve(counter, "alethe", "4"));
+    std::regex const stepPattern(R"(^\((?:assume|step) t(\d+))");
+    std::regex const premisesPattern(R"(:premises \(([^)]*)\))");
+    std::regex const premisePattern(R"(t(\d+))");
+    std::size_t steps = 0;
+    std::size_t trueRules = 0;
+    std::string line;
+    while (std::getline(proof, line)) {
+        std::smatch match;
+        if (not std::regex_search(line, match, stepPattern)) { continue; }
+        std::size_t id = std::stoul(match[1]);
+        EXPECT_EQ(id, steps++);
+        if (line.find(":rule true)") != std::string::npos) { ++trueRules; }
+        if (std::regex_search(line, match, premisesPattern)) {
+            std::string premises = match[1];
+            for (std::sregex_iterator it(premises.begin(), premises.end(), premisePattern), end; it != end; ++it) {
+                EXPECT_LT(std::stoul((*it)[1]), id) << line;
+            }
+        }
+    }
+    EXPECT_GT(steps, 0u);
+    // The true rule is stated once and reused by all derivation steps
+    EXPECT_EQ(trueRules, 1u);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "proofs/Term.h"
+
+#include <sstream>
+
+class ProofTerms_Test : public ::testing::Test {
+protected:
+    TermStore terms;
+    TermRef x = terms.mkTerminal("x", TerminalType::VAR);
+    TermRef zero = terms.mkTerminal("0", TerminalType::INT);
+    TermRef one = terms.mkTerminal("1", TerminalType::INT);
+};
+
+TEST_F(ProofTerms_Test, test_StructurallyEqualTermsAreShared) {
+    auto first = terms.mkOp("<=", {x, terms.mkOp("+", {x, one})});
+    auto second =
+        terms.mkOp(OpCode::LEQ, {terms.mkTerminal("x", TerminalType::VAR), terms.mkOp(OpCode::PLUS, {x, one})});
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, terms.mkOp("<=", {x, terms.mkOp("+", {one, x})}));
+    // Same value, different kind of terminal
+    EXPECT_NE(x, terms.mkTerminal("x", TerminalType::UNDECLARED));
+    // Same name, different kind of term
+    EXPECT_NE(terms.mkOp("and", {x, x}), terms.mkApp("and", {x, x}));
+}
+
+TEST_F(ProofTerms_Test, test_OperatorsAreCoded) {
+    auto sum = terms.mkOp("+", {x, one});
+    EXPECT_TRUE(terms.isOp(sum, OpCode::PLUS));
+    EXPECT_EQ(terms.getName(sum), "+");
+    EXPECT_TRUE(terms.isOp(terms.mkOp("!", {x, terms.mkTerminal(":named a", TerminalType::UNDECLARED)}),
+                           OpCode::NAMED));
+    EXPECT_EQ(terms.getOp(terms.mkOp("distinct", {x, one})), OpCode::OTHER);
+    EXPECT_FALSE(terms.isOp(terms.mkApp("P", {x}), OpCode::OTHER));
+}
+
+TEST_F(ProofTerms_Test, test_QuantifierLayout) {
+    auto sort = terms.mkTerminal("Int", TerminalType::SORT);
+    auto core = terms.mkOp("=>", {terms.mkOp("=", {x, zero}), terms.mkApp("P", {x})});
+    auto quant = terms.mkQuant("forall", {x}, {sort}, core);
+    EXPECT_EQ(terms.getBoundCount(quant), 1u);
+    EXPECT_EQ(terms.getBoundVar(quant, 0), x);
+    EXPECT_EQ(terms.getBoundSort(quant, 0), sort);
+    EXPECT_EQ(terms.getCoreTerm(quant), core);
+    EXPECT_EQ(terms.printTerm(quant), "(forall ((x Int)) (=> (= x 0) (P x)))");
+}
+
+TEST_F(ProofTerms_Test, test_InstantiationSharesSubterms) {
+    auto sum = terms.mkOp("+", {x, one});
+    auto term = terms.mkOp("and", {terms.mkOp("<=", {zero, sum}), terms.mkOp("<=", {sum, one})});
+    InstantiateVisitor instantiate(terms, {{"x", "0"}});
+    auto instantiated = instantiate.visit(term);
+    EXPECT_EQ(terms.printTerm(instantiated), "(and (<= 0 (+ 0 1)) (<= (+ 0 1) 1))");
+    auto left = terms.getArg(instantiated, 0);
+    auto right = terms.getArg(instantiated, 1);
+    EXPECT_EQ(terms.getArg(left, 1), terms.getArg(right, 0));
+    // Terms without variables are left unchanged
+    EXPECT_EQ(instantiate.visit(terms.getArg(left, 1)), terms.getArg(left, 1));
+}
+
+TEST_F(ProofTerms_Test, test_PrintToStream) {
+    auto term = terms.mkOp("not", {terms.mkOp("<=", {x, terms.mkOp("+", {x, one})})});
+    std::stringstream ss;
+    terms.print(term, ss);
+    EXPECT_EQ(ss.str(), "(not (<= x (+ x 1)))");
+    EXPECT_EQ(ss.str(), terms.printTerm(term));
+}
+
+TEST_F(ProofTerms_Test, test_NumeralsAreSharedByValue) {
+    EXPECT_EQ(terms.mkTerminal("(- 1)", TerminalType::INT), terms.mkNumeral(-FastRational(1), TerminalType::INT));
+    EXPECT_EQ(terms.mkTerminal("(/ 1 2)", TerminalType::REAL),
+              terms.mkNumeral(FastRational(1) / FastRational(2), TerminalType::REAL));
+    EXPECT_EQ(terms.mkTerminal("1.0", TerminalType::REAL), terms.mkNumeral(FastRational(1), TerminalType::REAL));
+    EXPECT_NE(one, terms.mkTerminal("1.0", TerminalType::REAL));
+    EXPECT_EQ(terms.printTerm(terms.mkNumeral(-FastRational(3), TerminalType::INT)), "(- 3)");
+    EXPECT_EQ(terms.printTerm(terms.mkNumeral(-FastRational(1) / FastRational(2), TerminalType::REAL)), "(- (/ 1 2))");
+}
+
+TEST_F(ProofTerms_Test, test_LiteralsKeepTheirSpelling) {
+    // Assumptions of the proof must match the input literally
+    auto decimal = terms.mkTerminal("1.5", TerminalType::REAL);
+    auto fraction = terms.mkTerminal("(/ 3 2)", TerminalType::REAL);
+    EXPECT_NE(decimal, fraction);
+    EXPECT_EQ(terms.getNumeral(decimal), terms.getNumeral(fraction));
+    EXPECT_EQ(terms.printTerm(decimal), "1.5");
+    EXPECT_EQ(terms.printTerm(fraction), "(/ 3 2)");
+    EXPECT_EQ(terms.printTerm(terms.mkTerminal("(- 0.5)", TerminalType::REAL)), "(- 0.5)");
+    EXPECT_EQ(terms.printTerm(terms.mkOp(OpCode::LEQ, {x, decimal})), "(<= x 1.5)");
+    // Results of the arithmetic are printed in the canonical form
+    auto sum = operate(terms, terms.mkOp(OpCode::PLUS, {decimal, decimal}));
+    EXPECT_EQ(terms.printTerm(sum), "3.0");
+    EXPECT_TRUE(terms.isTrue(operate(terms, terms.mkOp(OpCode::EQ, {decimal, fraction}))));
+    TermStore other;
+    EXPECT_EQ(other.printTerm(other.import(terms, decimal)), "1.5");
+}
+
+TEST_F(ProofTerms_Test, test_ConstantFolding) {
+    auto two = terms.mkTerminal("2", TerminalType::INT);
+    auto minusThree = terms.mkTerminal("(- 3)", TerminalType::INT);
+    EXPECT_EQ(operate(terms, terms.mkOp(OpCode::PLUS, {one, two, minusThree})), zero);
+    EXPECT_EQ(operate(terms, terms.mkOp(OpCode::MINUS, {minusThree})), terms.mkTerminal("3", TerminalType::INT));
+    EXPECT_EQ(operate(terms, terms.mkOp(OpCode::TIMES, {two, minusThree})),
+              terms.mkTerminal("(- 6)", TerminalType::INT));
+    EXPECT_EQ(operate(terms, terms.mkOp(OpCode::DIV, {minusThree, two})), terms.mkTerminal("(- 2)", TerminalType::INT));
+    EXPECT_TRUE(terms.isTrue(operate(terms, terms.mkOp(OpCode::LEQ, {minusThree, zero}))));
+    EXPECT_TRUE(terms.isFalse(operate(terms, terms.mkOp(OpCode::EQ, {one, two}))));
+    auto half = operate(terms, terms.mkOp(OpCode::DIVIDE, {one, two}));
+    EXPECT_EQ(terms.getNumeral(half), FastRational(1) / FastRational(2));
+    EXPECT_EQ(simplifyRule(terms, terms.mkOp(OpCode::EQ, {one, half})), "eq_simplify");
+}
+
+TEST_F(ProofTerms_Test, test_DivisionKeepsTypeOfOperands) {
+    auto two = terms.mkTerminal("2", TerminalType::INT);
+    auto realTwo = terms.mkTerminal("2.0", TerminalType::REAL);
+    auto integers = operate(terms, terms.mkOp(OpCode::DIVIDE, {terms.mkTerminal("4", TerminalType::INT), two}));
+    EXPECT_EQ(terms.getTerminalType(integers), TerminalType::INT);
+    EXPECT_EQ(terms.printTerm(integers), "2");
+    auto reals = operate(terms, terms.mkOp(OpCode::DIVIDE, {terms.mkTerminal("4.0", TerminalType::REAL), realTwo}));
+    EXPECT_EQ(terms.getTerminalType(reals), TerminalType::REAL);
+    EXPECT_EQ(terms.printTerm(reals), "2.0");
+}
+
+TEST_F(ProofTerms_Test, test_ImportFromAnotherStore) {
+    auto sum = terms.mkOp("+", {x, terms.mkTerminal("(- 2)", TerminalType::INT)});
+    auto term = terms.mkQuant("forall", {x}, {terms.mkTerminal("Int", TerminalType::SORT)},
+                              terms.mkOp("=>", {terms.mkOp("<=", {sum, sum}), terms.mkApp("P", {x})}));
+    TermStore other;
+    auto otherOne = other.mkTerminal("1", TerminalType::INT);
+    auto imported = other.import(terms, term);
+    EXPECT_EQ(other.printTerm(imported), terms.printTerm(term));
+    EXPECT_EQ(other.import(terms, term), imported);
+    EXPECT_EQ(other.import(terms, one), otherOne);
+    auto comparison = other.getArg(other.getCoreTerm(imported), 0);
+    EXPECT_EQ(other.getArg(comparison, 0), other.getArg(comparison, 1));
+}
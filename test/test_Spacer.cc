@@ -6,6 +6,7 @@
 
 #include "TestTemplate.h"
 #include "engine/Spacer.h"
+#include "engine/SpacerFrames.h"
 
 class Spacer_LRA_Test : public LRAEngineTest {
 };
@@ -222,3 +223,200 @@ TEST_F(Spacer_LRA_Test, test_UnsatProof_FactWithNoConstraints)
     solveSystem(clauses, engine, VerificationAnswer::UNSAFE, true);
 }
 
+
+TEST_F(Spacer_LRA_Test, test_GeneralizeLemmas_Safe)
+{
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::SPACER_GENERALIZE_LEMMAS, "true");
+    SymRef inv_sym = mkPredicateSymbol("Inv", {realSort(), realSort()});
+    PTRef y = mkRealVar("y");
+    PTRef yp = mkRealVar("yp");
+    PTRef inv = instantiatePredicate(inv_sym, {x, y});
+    PTRef invp = instantiatePredicate(inv_sym, {xp, yp});
+    std::vector<ChClause> clauses{
+        { // x' = 0 & y' = 0 => Inv(x', y')
+            ChcHead{UninterpretedPredicate{invp}},
+            ChcBody{{logic->mkAnd(logic->mkEq(xp, zero), logic->mkEq(yp, zero))}, {}}
+        },
+        { // Inv(x, y) & x' = x + 1 & y' = y + x' => Inv(x', y')
+            ChcHead{UninterpretedPredicate{invp}},
+            ChcBody{{logic->mkAnd(logic->mkEq(xp, logic->mkPlus(x, one)), logic->mkEq(yp, logic->mkPlus(y, xp)))},
+                    {UninterpretedPredicate{inv}}}
+        },
+        { // Inv(x, y) & (x < 0 | y < 0) => false
+            ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+            ChcBody{{logic->mkOr(logic->mkLt(x, zero), logic->mkLt(y, zero))}, {UninterpretedPredicate{inv}}}
+        }
+    };
+    Spacer engine(*logic, options);
+    solveSystem(clauses, engine, VerificationAnswer::SAFE);
+}
+
+TEST_F(Spacer_LRA_Test, test_GeneralizeLemmas_Unsafe)
+{
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::SPACER_GENERALIZE_LEMMAS, "true");
+    SymRef inv_sym = mkPredicateSymbol("Inv", {realSort()});
+    PTRef inv = instantiatePredicate(inv_sym, {x});
+    PTRef invp = instantiatePredicate(inv_sym, {xp});
+    std::vector<ChClause> clauses{
+        { // x' = 0 => Inv(x')
+            ChcHead{UninterpretedPredicate{invp}},
+            ChcBody{{logic->mkEq(xp, zero)}, {}}
+        },
+        { // Inv(x) & x' = x + 1 => Inv(x')
+            ChcHead{UninterpretedPredicate{invp}},
+            ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{inv}}}
+        },
+        { // Inv(x) & x = 3 => false
+            ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+            ChcBody{{logic->mkEq(x, logic->mkRealConst(FastRational(3)))}, {UninterpretedPredicate{inv}}}
+        }
+    };
+    Spacer engine(*logic, options);
+    solveSystem(clauses, engine, VerificationAnswer::UNSAFE, true);
+}
+
+class SpacerFrames_Test : public LRAEngineTest {
+protected:
+    SymRef s1 = mkPredicateSymbol("s1", {realSort()});
+    SymRef s2 = mkPredicateSymbol("s2", {realSort()});
+    PTRef lower = logic->mkLeq(zero, x);
+    PTRef upper = logic->mkLeq(x, two);
+};
+
+TEST_F(SpacerFrames_Test, test_OverApprox_LemmaPropagatedAcrossBounds) {
+    OverApproxMap over;
+    over.insert(s1, 1, lower);
+    over.insert(s1, 1, upper);
+    EXPECT_EQ(over.getSummary(s1, 0, *logic), logic->mkAnd(lower, upper));
+    EXPECT_EQ(over.getSummary(s1, 1, *logic), logic->mkAnd(lower, upper));
+    EXPECT_EQ(over.getSummary(s1, 2, *logic), logic->getTerm_true());
+    // Pushing the lemma moves it from the delta of level 1 to the delta of level 3
+    over.insert(s1, 3, lower);
+    ASSERT_EQ(over.getDelta(s1, 1).size(), 1);
+    EXPECT_EQ(over.getDelta(s1, 1)[0], upper);
+    EXPECT_EQ(over.getDelta(s1, 2).size(), 0);
+    ASSERT_EQ(over.getDelta(s1, 3).size(), 1);
+    EXPECT_EQ(over.getDelta(s1, 3)[0], lower);
+    // The cached summaries of the levels the lemma reached are recomputed
+    EXPECT_EQ(over.getSummary(s1, 1, *logic), logic->mkAnd(lower, upper));
+    EXPECT_EQ(over.getSummary(s1, 2, *logic), lower);
+    EXPECT_EQ(over.getSummary(s1, 3, *logic), lower);
+    EXPECT_EQ(over.getSummary(s1, 4, *logic), logic->getTerm_true());
+    // Other vertices are not affected
+    EXPECT_EQ(over.getSummary(s2, 1, *logic), logic->getTerm_true());
+    EXPECT_EQ(over.getDelta(s2, 3).size(), 0);
+}
+
+TEST_F(SpacerFrames_Test, test_OverApprox_LowerLevelIgnored) {
+    OverApproxMap over;
+    over.insert(s1, 2, lower);
+    EXPECT_EQ(over.getSummary(s1, 2, *logic), lower);
+    over.insert(s1, 1, lower);
+    EXPECT_EQ(over.getDelta(s1, 1).size(), 0);
+    ASSERT_EQ(over.getDelta(s1, 2).size(), 1);
+    EXPECT_EQ(over.getSummary(s1, 1, *logic), lower);
+    EXPECT_EQ(over.getSummary(s1, 2, *logic), lower);
+    std::size_t lemmas = 0;
+    over.forEachLemma([&](SymRef vid, PTRef lemma, std::size_t level) {
+        EXPECT_EQ(vid, s1);
+        EXPECT_EQ(lemma, lower);
+        EXPECT_EQ(level, 2);
+        ++lemmas;
+    });
+    EXPECT_EQ(lemmas, 1);
+}
+
+TEST_F(SpacerFrames_Test, test_OverApprox_PushedLemmaStoredOnce) {
+    OverApproxMap over;
+    PTRef middle = logic->mkLeq(x, one);
+    over.insert(s1, 1, lower);
+    over.insert(s1, 1, middle);
+    over.insert(s1, 1, upper);
+    // Pushing a lemma from the middle of a delta keeps the other lemmas of that delta
+    for (std::size_t level = 2; level <= 10; ++level) {
+        over.insert(s1, level, middle);
+    }
+    auto delta = over.getDelta(s1, 1);
+    ASSERT_EQ(delta.size(), 2);
+    EXPECT_TRUE((delta[0] == lower and delta[1] == upper) or (delta[0] == upper and delta[1] == lower));
+    for (std::size_t level = 2; level < 10; ++level) {
+        EXPECT_EQ(over.getDelta(s1, level).size(), 0);
+    }
+    ASSERT_EQ(over.getDelta(s1, 10).size(), 1);
+    EXPECT_EQ(over.getDelta(s1, 10)[0], middle);
+    EXPECT_EQ(over.getSummary(s1, 1, *logic), logic->mkAnd({lower, middle, upper}));
+    EXPECT_EQ(over.getSummary(s1, 5, *logic), middle);
+    // Pushing the last lemma of a delta
+    over.insert(s1, 2, upper);
+    ASSERT_EQ(over.getDelta(s1, 1).size(), 1);
+    EXPECT_EQ(over.getDelta(s1, 1)[0], lower);
+    EXPECT_EQ(over.getSummary(s1, 2, *logic), logic->mkAnd(middle, upper));
+}
+
+TEST_F(SpacerFrames_Test, test_DerivationDatabase_IndexedByFact) {
+    DerivationDatabase database;
+    auto entry = database.newDerivation({logic->getTerm_true(), s1}, EId{0}, {});
+    auto first = database.newDerivation({lower, s1}, EId{1}, {entry});
+    auto other = database.newDerivation({lower, s2}, EId{2}, {entry});
+    EXPECT_NE(first, other);
+    // A repeated derivation is stored, but the fact keeps the ID of its first derivation
+    EXPECT_EQ(database.newDerivation({lower, s1}, EId{3}, {first}), first);
+    EXPECT_EQ(database.getIdFor({lower, s1}), first);
+    EXPECT_EQ(database.getIdFor({lower, s2}), other);
+    EXPECT_EQ(database.getEntry(first).incomingEdge.id, 1);
+    EXPECT_EQ(std::distance(database.begin(), database.end()), 4);
+    EXPECT_THROW(database.getIdFor({upper, s1}), std::logic_error);
+}
+
+TEST_F(SpacerFrames_Test, test_UnderApprox_ComponentsRememberTheirFact) {
+    UnderApproxMap under;
+    under.insert(s1, 1, lower, 7);
+    under.insert(s1, 1, upper);
+    under.insert(s1, 1, lower, 8);
+    auto const & components = under.getComponents(s1, 1);
+    ASSERT_EQ(components.size(), 2);
+    EXPECT_EQ(components.at(lower), 7);
+    EXPECT_EQ(components.at(upper), DerivationDatabase::NoID);
+    EXPECT_TRUE(under.getComponents(s1, 0).empty());
+    EXPECT_TRUE(under.getComponents(s2, 1).empty());
+    EXPECT_TRUE(under.getComponents(s1, 5).empty());
+}
+
+TEST_F(SpacerFrames_Test, test_BlockedObligations_PushedToNextLevel) {
+    BlockedObligations blocked(10);
+    blocked.markBlocked({s1, 1, lower});
+    blocked.markBlocked({s1, 3, lower});
+    blocked.markBlocked({s2, 2, upper});
+    EXPECT_TRUE(blocked.isBlocked({s1, 2, lower}));
+    EXPECT_FALSE(blocked.isBlocked({s1, 4, lower}));
+    EXPECT_FALSE(blocked.isBlocked({s1, 1, upper}));
+    auto pushed = blocked.pushedBelow(3);
+    ASSERT_EQ(pushed.size(), 1);
+    EXPECT_EQ(pushed[0].vertex, s2);
+    EXPECT_EQ(pushed[0].bound, 3);
+    EXPECT_EQ(pushed[0].constraint, upper);
+    blocked.forget({s2, 3, upper});
+    EXPECT_FALSE(blocked.isBlocked({s2, 1, upper}));
+    EXPECT_EQ(blocked.size(), 1);
+}
+
+TEST_F(SpacerFrames_Test, test_BlockedObligations_LeastRecentlyBlockedEvicted) {
+    BlockedObligations blocked(2);
+    PTRef other = logic->mkLeq(x, one);
+    blocked.markBlocked({s1, 1, lower});
+    blocked.markBlocked({s1, 1, upper});
+    // Blocking again makes the obligation the most recent one
+    blocked.markBlocked({s1, 2, lower});
+    blocked.markBlocked({s1, 1, other});
+    EXPECT_EQ(blocked.size(), 2);
+    EXPECT_TRUE(blocked.isBlocked({s1, 2, lower}));
+    EXPECT_FALSE(blocked.isBlocked({s1, 1, upper}));
+    EXPECT_TRUE(blocked.isBlocked({s1, 1, other}));
+    for (std::size_t i = 0; i < 100; ++i) {
+        blocked.markBlocked({s2, 1, logic->mkLeq(x, logic->mkRealConst(FastRational(static_cast<int>(i))))});
+    }
+    EXPECT_EQ(blocked.size(), 2);
+    EXPECT_EQ(blocked.pushedBelow(5).size(), 2);
+}
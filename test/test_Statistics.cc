@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "utils/Statistics.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+class StatisticsTest : public ::testing::Test {
+protected:
+    void SetUp() override { Statistics::clear(); }
+    void TearDown() override {
+        Statistics::disable();
+        Statistics::clear();
+    }
+
+    static std::string dump() {
+        std::stringstream ss;
+        Statistics::printJson(ss);
+        return ss.str();
+    }
+};
+
+TEST_F(StatisticsTest, test_DisabledRecordsNothing) {
+    Statistics::increment("counter");
+    Statistics::recordValue("histogram", 3);
+    { ScopedTimer timer("timer"); }
+    EXPECT_EQ(dump(), "{\n  \"counters\": {\n  },\n  \"timers\": {\n  },\n  \"histograms\": {\n  }\n}\n");
+}
+
+TEST_F(StatisticsTest, test_Counters) {
+    Statistics::enable();
+    Statistics::increment("b");
+    Statistics::increment("a", 2);
+    Statistics::increment("b");
+    auto json = dump();
+    // Counters are printed ordered by their names
+    EXPECT_NE(json.find("\"a\": 2,\n    \"b\": 2\n"), std::string::npos);
+}
+
+TEST_F(StatisticsTest, test_Timers) {
+    Statistics::enable();
+    { ScopedTimer timer("timer"); }
+    { ScopedTimer timer("timer"); }
+    auto json = dump();
+    EXPECT_NE(json.find("\"timer\": {\"count\": 2, \"total-ms\": "), std::string::npos);
+}
+
+TEST_F(StatisticsTest, test_Histograms) {
+    Statistics::enable();
+    for (std::uint64_t value : {0, 1, 2, 3, 8}) {
+        Statistics::recordValue("histogram", value);
+    }
+    auto json = dump();
+    EXPECT_NE(json.find("\"histogram\": {\"count\": 5, \"sum\": 14, \"min\": 0, \"max\": 8, "
+                        "\"buckets\": {\"0\": 1, \"1\": 1, \"2\": 2, \"8\": 1}}"),
+              std::string::npos);
+}
+
+TEST_F(StatisticsTest, test_ClearedNamesNotPrinted) {
+    Statistics::enable();
+    Statistics::increment("counter");
+    Statistics::recordValue("histogram", 3);
+    { ScopedTimer timer("timer"); }
+    Statistics::clear();
+    EXPECT_EQ(dump(), "{\n  \"counters\": {\n  },\n  \"timers\": {\n  },\n  \"histograms\": {\n  }\n}\n");
+    // Recording continues after clearing
+    Statistics::increment("counter", 3);
+    EXPECT_NE(dump().find("\"counter\": 3\n"), std::string::npos);
+}
+
+TEST_F(StatisticsTest, test_ConcurrentRecording) {
+    Statistics::enable();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (std::uint64_t value = 0; value < 1000; ++value) {
+                Statistics::increment("counter");
+                Statistics::recordValue("histogram", value);
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    auto json = dump();
+    EXPECT_NE(json.find("\"counter\": 4000\n"), std::string::npos);
+    EXPECT_NE(json.find("\"histogram\": {\"count\": 4000, \"sum\": 1998000, \"min\": 0, \"max\": 999, "),
+              std::string::npos);
+}
@@ -7,8 +7,37 @@
 #include "TestTemplate.h"
 
 #include "engine/TPA.h"
+#include "utils/Statistics.h"
+
+#include <filesystem>
+#include <sstream>
 
 class TPATest : public LIAEngineTest {
+protected:
+    // Counter x starting at 0 and changed by the given step in each transition
+    std::vector<ChClause> counter(SymRef s1, PTRef step, PTRef bad) {
+        PTRef current = instantiatePredicate(s1, {x});
+        PTRef next = instantiatePredicate(s1, {xp});
+        return {{ // x' = 0 => S1(x')
+                    ChcHead{UninterpretedPredicate{next}},
+                    ChcBody{{logic->mkEq(xp, zero)}, {}}
+                },
+                { // S1(x) and x' = x + step => S1(x')
+                    ChcHead{UninterpretedPredicate{next}},
+                    ChcBody{{logic->mkEq(xp, logic->mkPlus(x, step))}, {UninterpretedPredicate{current}}}
+                },
+                { // S1(x) and bad(x) => false
+                    ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                    ChcBody{{bad}, {UninterpretedPredicate{current}}}
+                }};
+    }
+
+    static std::string recordedStatistics() {
+        std::stringstream out;
+        Statistics::printJson(out);
+        Statistics::clear();
+        return out.str();
+    }
 };
 
 TEST_F(TPATest, test_TPA_simple_safe)
@@ -261,6 +290,114 @@ TEST_F(TPATest, test_TPA_graph_of_three_unsafe) {
     solveSystem(clauses, engine, VerificationAnswer::UNSAFE, true);
 }
 
+TEST_F(TPATest, test_TPA_graph_of_three_unsafe_Parallel) {
+    Options options;
+    options.addOption(Options::LOGIC, "QF_LIA");
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, TPAEngine::SPLIT_TPA);
+    options.addOption(Options::THREADS, "4");
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    SymRef s2 = mkPredicateSymbol("s2", {intSort()});
+    SymRef s3 = mkPredicateSymbol("s3", {intSort()});
+    PTRef predS1Current = instantiatePredicate(s1, {x});
+    PTRef predS1Next = instantiatePredicate(s1, {xp});
+    PTRef predS2Current = instantiatePredicate(s2, {x});
+    PTRef predS2Next = instantiatePredicate(s2, {xp});
+    PTRef predS3Current = instantiatePredicate(s3, {x});
+    PTRef predS3Next = instantiatePredicate(s3, {xp});
+    std::vector<ChClause> clauses{{ // x = 0 => S1(x)
+                                          ChcHead{UninterpretedPredicate{predS1Current}},
+                                          ChcBody{{logic->mkEq(x, zero)}, {}}
+                                  },
+                                  { // S1(x) & x' = x + 1 => S1(x')
+                                          ChcHead{UninterpretedPredicate{predS1Next}},
+                                          ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))},
+                                                  {UninterpretedPredicate{predS1Current}}}
+                                  },
+                                  { // S1(x) => S2(x)
+                                          ChcHead{UninterpretedPredicate{predS2Current}},
+                                          ChcBody{{}, {UninterpretedPredicate{predS1Current}}}
+                                  },
+                                  { // S1(x) => S3(x)
+                                          ChcHead{UninterpretedPredicate{predS3Current}},
+                                          ChcBody{{},{UninterpretedPredicate{predS1Current}}}
+                                  },
+                                  { // S2(x) & x' = x + 1 => S2(x')
+                                          ChcHead{UninterpretedPredicate{predS2Next}},
+                                          ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))},
+                                                  {UninterpretedPredicate{predS2Current}}}
+                                  },
+                                  { // S3(x) & x' = x + 1 => S3(x')
+                                          ChcHead{UninterpretedPredicate{predS3Next}},
+                                          ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))},
+                                                  {UninterpretedPredicate{predS3Current}}}
+                                  },
+                                  { // S2(x) & x < 0 => false
+                                          ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                                          ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{predS2Current}}}
+                                  },
+                                  { // S3(x) & x > 5 => false
+                                          ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                                          ChcBody{{logic->mkGt(x, logic->mkIntConst(5))}, {UninterpretedPredicate{predS3Current}}}
+                                  }};
+    TPAEngine engine(*logic, options);
+    solveSystem(clauses, engine, VerificationAnswer::UNSAFE, true);
+}
+
+TEST_F(TPATest, test_TPA_graph_of_three_safe_Parallel) {
+    Options options;
+    options.addOption(Options::LOGIC, "QF_LIA");
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, TPAEngine::SPLIT_TPA);
+    options.addOption(Options::THREADS, "4");
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    SymRef s2 = mkPredicateSymbol("s2", {intSort()});
+    SymRef s3 = mkPredicateSymbol("s3", {intSort()});
+    PTRef predS1Current = instantiatePredicate(s1, {x});
+    PTRef predS1Next = instantiatePredicate(s1, {xp});
+    PTRef predS2Current = instantiatePredicate(s2, {x});
+    PTRef predS2Next = instantiatePredicate(s2, {xp});
+    PTRef predS3Current = instantiatePredicate(s3, {x});
+    PTRef predS3Next = instantiatePredicate(s3, {xp});
+    std::vector<ChClause> clauses{{ // x = 0 => S1(x)
+                                          ChcHead{UninterpretedPredicate{predS1Current}},
+                                          ChcBody{{logic->mkEq(x, zero)}, {}}
+                                  },
+                                  { // S1(x) & x' = x + 1 => S1(x')
+                                          ChcHead{UninterpretedPredicate{predS1Next}},
+                                          ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))},
+                                                  {UninterpretedPredicate{predS1Current}}}
+                                  },
+                                  { // S1(x) => S2(x)
+                                          ChcHead{UninterpretedPredicate{predS2Current}},
+                                          ChcBody{{}, {UninterpretedPredicate{predS1Current}}}
+                                  },
+                                  { // S1(x) => S3(x)
+                                          ChcHead{UninterpretedPredicate{predS3Current}},
+                                          ChcBody{{},{UninterpretedPredicate{predS1Current}}}
+                                  },
+                                  { // S2(x) & x' = x + 1 => S2(x')
+                                          ChcHead{UninterpretedPredicate{predS2Next}},
+                                          ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))},
+                                                  {UninterpretedPredicate{predS2Current}}}
+                                  },
+                                  { // S3(x) & x' = x + 2 => S3(x')
+                                          ChcHead{UninterpretedPredicate{predS3Next}},
+                                          ChcBody{{logic->mkEq(xp, logic->mkPlus(x, logic->mkIntConst(2)))},
+                                                  {UninterpretedPredicate{predS3Current}}}
+                                  },
+                                  { // S2(x) & x < 0 => false
+                                          ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                                          ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{predS2Current}}}
+                                  },
+                                  { // S3(x) & x < 0 => false
+                                          ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                                          ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{predS3Current}}}
+                                  }};
+    TPAEngine engine(*logic, options);
+    solveSystem(clauses, engine, VerificationAnswer::SAFE, true);
+}
+
 TEST_F(TPATest, test_TPA_chain_of_two_safe) {
     Options options;
     options.addOption(Options::LOGIC, "QF_LIA");
@@ -294,7 +431,48 @@ TEST_F(TPATest, test_TPA_chain_of_two_safe) {
             ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{predS2Current}}}
         }};
     TPAEngine engine(*logic, options);
-    solveSystem(clauses, engine, VerificationAnswer::SAFE, false);
+    solveSystem(clauses, engine, VerificationAnswer::SAFE, true);
+}
+
+TEST_F(TPATest, test_TPA_chain_of_two_safe_InvariantsReused) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, TPAEngine::SPLIT_TPA);
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    SymRef s2 = mkPredicateSymbol("s2", {intSort()});
+    PTRef predS1Current = instantiatePredicate(s1, {x});
+    PTRef predS1Next = instantiatePredicate(s1, {xp});
+    PTRef predS2Current = instantiatePredicate(s2, {x});
+    PTRef predS2Next = instantiatePredicate(s2, {xp});
+    std::vector<ChClause> clauses{{ // x = 0 => S1(x)
+            ChcHead{UninterpretedPredicate{predS1Next}},
+            ChcBody{{logic->mkEq(xp, zero)}, {}}
+        },
+        { // S1(x) & x' = x + 1 => S1(x')
+            ChcHead{UninterpretedPredicate{predS1Next}},
+            ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{predS1Current}}}
+        },
+        { // S1(x) => S2(x)
+            ChcHead{UninterpretedPredicate{predS2Current}},
+            ChcBody{{logic->getTerm_true()}, {UninterpretedPredicate{predS1Current}}}
+        },
+        { // S2(x) & x' = x + 2 => S2(x')
+            ChcHead{UninterpretedPredicate{predS2Next}},
+            ChcBody{{logic->mkEq(xp, logic->mkPlus(x, two))}, {UninterpretedPredicate{predS2Current}}}
+        },
+        { // S2(x) & x < 0 => false
+            ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+            ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{predS2Current}}}
+        }};
+    Statistics::clear();
+    Statistics::enable();
+    TPAEngine engine(*logic, options);
+    solveSystem(clauses, engine, VerificationAnswer::SAFE, true);
+    std::stringstream stats;
+    Statistics::printJson(stats);
+    Statistics::disable();
+    Statistics::clear();
+    // The invariants found by the search are used for the witness instead of solving the nodes again
+    EXPECT_NE(stats.str().find("\"tpa-network.invariants-reused\""), std::string::npos);
 }
 
 TEST_F(TPATest, test_TPA_chain_regression) {
@@ -672,4 +850,56 @@ TEST_F(TPATest, test_TPA_BeyondTransitionSystemDAG_Safe)
     TPAEngine engine(*logic, options);
     // TODO: Enable validation once we deal with alien variables in vertex invariants properly
     solveSystem(clauses, engine, VerificationAnswer::SAFE, false);
-}
\ No newline at end of file
+}
+
+TEST_F(TPATest, test_TPA_snapshot_restored) {
+    auto directory = std::filesystem::temp_directory_path() / "golem-tpa-snapshot-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, TPAEngine::SPLIT_TPA);
+    options.addOption(Options::TPA_SNAPSHOT_DIR, directory.string());
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    Statistics::clear();
+    Statistics::enable();
+    {
+        TPAEngine engine(*logic, options);
+        solveSystem(counter(s1, one, logic->mkEq(x, logic->mkIntConst(6))), engine, VerificationAnswer::UNSAFE, true);
+    }
+    EXPECT_FALSE(std::filesystem::is_empty(directory));
+    EXPECT_EQ(recordedStatistics().find("\"tpa.powers-restored\""), std::string::npos);
+    // The second run resumes from the stored powers and must reach the same answer
+    TPAEngine engine(*logic, options);
+    solveSystem({}, engine, VerificationAnswer::UNSAFE, true);
+    auto statistics = recordedStatistics();
+    Statistics::disable();
+    EXPECT_NE(statistics.find("\"tpa.powers-restored\""), std::string::npos);
+    EXPECT_EQ(statistics.find("\"tpa.snapshot-rejected\""), std::string::npos);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(TPATest, test_TPA_snapshot_of_other_transition_rejected) {
+    auto directory = std::filesystem::temp_directory_path() / "golem-tpa-snapshot-rejected-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    options.addOption(Options::ENGINE, TPAEngine::SPLIT_TPA);
+    options.addOption(Options::TPA_SNAPSHOT_DIR, directory.string());
+    SymRef s1 = mkPredicateSymbol("s1", {intSort()});
+    {
+        TPAEngine engine(*logic, options);
+        solveSystem(counter(s1, one, logic->mkEq(x, logic->mkIntConst(6))), engine, VerificationAnswer::UNSAFE, true);
+    }
+    EXPECT_FALSE(std::filesystem::is_empty(directory));
+    // Same state variables, so the same snapshot, but the powers bounding the increase of x do not hold anymore
+    system = ChcSystem{};
+    system.addUninterpretedPredicate(s1);
+    Statistics::clear();
+    Statistics::enable();
+    TPAEngine engine(*logic, options);
+    solveSystem(counter(s1, logic->mkIntConst(10), logic->mkLt(x, zero)), engine, VerificationAnswer::SAFE, true);
+    auto statistics = recordedStatistics();
+    Statistics::disable();
+    EXPECT_NE(statistics.find("\"tpa.snapshot-rejected\""), std::string::npos);
+    std::filesystem::remove_all(directory);
+}
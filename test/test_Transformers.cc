@@ -12,9 +12,11 @@
 #include "engine/IMC.h"
 #include "engine/Spacer.h"
 #include "graph/ChcGraphBuilder.h"
+#include "graph/GraphSerialization.h"
 #include "transformers/ConstraintSimplifier.h"
 #include "transformers/MultiEdgeMerger.h"
 #include "transformers/NodeEliminator.h"
+#include "transformers/RemoveUnreachableNodes.h"
 #include "transformers/SimpleChainSummarizer.h"
 #include "transformers/TransformationPipeline.h"
 
@@ -166,6 +168,127 @@ TEST_F(Transformer_test, test_OutputFromEngine) {
     EXPECT_EQ(validator.validate(originalGraph, res), Validator::Result::VALIDATED);
 }
 
+TEST_F(Transformer_test, test_ConstraintSimplifier_ParallelIsDeterministic) {
+    ChcSystem system;
+    Options options;
+    system.addUninterpretedPredicate(s1);
+    system.addUninterpretedPredicate(s2);
+    system.addUninterpretedPredicate(s3);
+    system.addClause( // x' >= -2 => S1(x')
+        ChcHead{UninterpretedPredicate{nextS1}},
+        ChcBody{{logic.mkGeq(xp, logic.mkIntConst(-2))}, {}});
+    system.addClause( // S1(x) and x' = ite(x > 0, x, x + 2) => S2(x')
+        ChcHead{UninterpretedPredicate{nextS2}},
+        ChcBody{{logic.mkEq(xp, logic.mkIte(logic.mkGt(x, zero), x, logic.mkPlus(x, two)))},
+                {UninterpretedPredicate{currentS1}}}
+    );
+    system.addClause( // S2(x) and x' = x + 1 => S2(x')
+        ChcHead{UninterpretedPredicate{nextS2}},
+        ChcBody{{logic.mkEq(xp, logic.mkPlus(x, one))}, {UninterpretedPredicate{currentS2}}}
+    );
+    system.addClause( // S2(x) => S3(x/2)
+        ChcHead{UninterpretedPredicate{logic.mkUninterpFun(s3, {logic.mkIntDiv(x, two)})}},
+        ChcBody{{logic.getTerm_true()}, {UninterpretedPredicate{currentS2}}}
+    );
+    system.addClause( // S3(y) and y < 0 => false
+        ChcHead{UninterpretedPredicate{logic.getTerm_false()}},
+        ChcBody{{logic.mkLt(y, logic.getTerm_IntZero())}, {UninterpretedPredicate{logic.mkUninterpFun(s3, {y})}}}
+    );
+    // Enough edges to be simplified in several batches
+    for (int k = 1; k <= 150; ++k) { // S2(x) and x' = ite(x > k, x, x + k) => S2(x')
+        PTRef constant = logic.mkIntConst(k);
+        system.addClause(
+            ChcHead{UninterpretedPredicate{nextS2}},
+            ChcBody{{logic.mkEq(xp, logic.mkIte(logic.mkGt(x, constant), x, logic.mkPlus(x, constant)))},
+                    {UninterpretedPredicate{currentS2}}}
+        );
+    }
+    auto originalGraph = *systemToGraph(system);
+    auto [defaultGraph, defaultTranslator] = ConstraintSimplifier{}.transform(systemToGraph(system));
+    auto [sequentialGraph, sequentialTranslator] = ConstraintSimplifier(1).transform(systemToGraph(system));
+    auto [parallelGraph, parallelTranslator] = ConstraintSimplifier(4).transform(systemToGraph(system));
+    auto sequentialEdges = sequentialGraph->getEdges();
+    auto parallelEdges = parallelGraph->getEdges();
+    ASSERT_EQ(sequentialEdges.size(), parallelEdges.size());
+    for (std::size_t i = 0; i < sequentialEdges.size(); ++i) {
+        EXPECT_EQ(sequentialEdges[i].fla.fla, parallelEdges[i].fla.fla);
+    }
+    // Without threads, the auxiliary variables keep the names given to them in the shared logic
+    for (auto const & edge : defaultGraph->getEdges()) {
+        for (PTRef var : TermUtils(logic).getVars(edge.fla.fla)) {
+            std::string name = logic.getSymName(var);
+            if (name.front() == '.') { EXPECT_EQ(name.find("_e"), std::string::npos) << name; }
+        }
+    }
+    // Auxiliary variables must be legal SMT-LIB simple symbols
+    for (auto const & edge : parallelEdges) {
+        for (PTRef var : TermUtils(logic).getVars(edge.fla.fla)) {
+            std::string name = logic.getSymName(var);
+            EXPECT_EQ(name.find('\''), std::string::npos) << name;
+            if (name.front() == '.') { EXPECT_EQ(name.find('#'), std::string::npos) << name; }
+        }
+    }
+    auto res = Spacer(logic, options).solve(*parallelGraph);
+    ASSERT_EQ(res.getAnswer(), VerificationAnswer::SAFE);
+    res = parallelTranslator->translate(std::move(res));
+    Validator validator(logic);
+    EXPECT_EQ(validator.validate(originalGraph, res), Validator::Result::VALIDATED);
+}
+
+TEST_F(Transformer_test, test_SerializedPipeline_Unsafe) {
+    ChcSystem system;
+    system.addUninterpretedPredicate(s1);
+    system.addUninterpretedPredicate(s2);
+    system.addClause( // x' = 0 => S1(x')
+        ChcHead{UninterpretedPredicate{nextS1}},
+        ChcBody{{logic.mkEq(xp, zero)}, {}});
+    system.addClause( // S1(x) and x' = x + 1 => S2(x')
+        ChcHead{UninterpretedPredicate{nextS2}},
+        ChcBody{{logic.mkEq(xp, logic.mkPlus(x, one))}, {UninterpretedPredicate{currentS1}}}
+    );
+    system.addClause( // S2(x) and x' = x + 1 => S2(x')
+        ChcHead{UninterpretedPredicate{nextS2}},
+        ChcBody{{logic.mkEq(xp, logic.mkPlus(x, one))}, {UninterpretedPredicate{currentS2}}}
+    );
+    system.addClause( // S2(y) and y >= 3 => false
+        ChcHead{UninterpretedPredicate{logic.getTerm_false()}},
+        ChcBody{{logic.mkGeq(y, logic.mkIntConst(3))}, {UninterpretedPredicate{logic.mkUninterpFun(s2, {y})}}}
+    );
+    auto hyperGraph = systemToGraph(system);
+    auto originalGraph = *hyperGraph;
+    TransformationPipeline::pipeline_t transformations;
+    transformations.push_back(std::make_unique<ConstraintSimplifier>());
+    transformations.push_back(std::make_unique<SimpleChainSummarizer>());
+    transformations.push_back(std::make_unique<RemoveUnreachableNodes>());
+    transformations.push_back(std::make_unique<SimpleNodeEliminator>());
+    transformations.push_back(std::make_unique<MultiEdgeMerger>());
+    auto [graph, translator] = TransformationPipeline(std::move(transformations)).transform(std::move(hyperGraph));
+
+    GraphSerializer serializer(logic);
+    serializer.writeGraph(originalGraph);
+    serializer.writeGraph(*graph);
+    ASSERT_TRUE(serializer.writeBackTranslator(*translator));
+    std::string data = serializer.finish();
+
+    // Restore everything in a fresh logic
+    ArithLogic freshLogic{opensmt::Logic_t::QF_LIA};
+    GraphDeserializer deserializer(freshLogic, data);
+    auto restoredOriginal = deserializer.readGraph();
+    auto restoredGraph = deserializer.readGraph();
+    auto restoredTranslator = deserializer.readBackTranslator();
+    EXPECT_TRUE(deserializer.atEnd());
+    EXPECT_EQ(restoredOriginal->getEdges().size(), originalGraph.getEdges().size());
+    EXPECT_EQ(restoredGraph->getEdges().size(), graph->getEdges().size());
+
+    Options options;
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    auto res = Spacer(freshLogic, options).solve(*restoredGraph);
+    ASSERT_EQ(res.getAnswer(), VerificationAnswer::UNSAFE);
+    res = restoredTranslator->translate(std::move(res));
+    Validator validator(freshLogic);
+    EXPECT_EQ(validator.validate(*restoredOriginal, res), Validator::Result::VALIDATED);
+}
+
 TEST_F(Transformer_test, test_ChainSummarizer_TwoStepChain_Unsafe) {
     ChcSystem system;
     system.addUninterpretedPredicate(s1);
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "TestTemplate.h"
+#include "engine/Spacer.h"
+
+class Validator_Test : public LIAEngineTest {
+protected:
+    SymRef inv_sym;
+    std::unique_ptr<ChcDirectedHyperGraph> graph;
+
+    void buildCounter() {
+        inv_sym = mkPredicateSymbol("Inv", {intSort()});
+        PTRef inv = instantiatePredicate(inv_sym, {x});
+        PTRef invp = instantiatePredicate(inv_sym, {xp});
+        std::vector<ChClause> clauses{
+            { // x' = 0 => Inv(x')
+                ChcHead{UninterpretedPredicate{invp}},
+                ChcBody{{logic->mkEq(xp, zero)}, {}}
+            },
+            { // Inv(x) & x' = x + 1 => Inv(x')
+                ChcHead{UninterpretedPredicate{invp}},
+                ChcBody{{logic->mkEq(xp, logic->mkPlus(x, one))}, {UninterpretedPredicate{inv}}}
+            },
+            { // Inv(x) & x < 0 => false
+                ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                ChcBody{{logic->mkLt(x, zero)}, {UninterpretedPredicate{inv}}}
+            }
+        };
+        for (auto const & clause : clauses) { system.addClause(clause); }
+        auto normalizedSystem = Normalizer(*logic).normalize(system);
+        graph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    }
+
+    VerificationResult witnessFor(PTRef (*definition)(ArithLogic &, PTRef)) {
+        PTRef predicate = graph->getStateVersion(inv_sym);
+        PTRef var = logic->getPterm(predicate)[0];
+        ValidityWitness::definitions_t definitions{{predicate, definition(*logic, var)}};
+        return VerificationResult(VerificationAnswer::SAFE, ValidityWitness(std::move(definitions)));
+    }
+};
+
+TEST_F(Validator_Test, test_ValidWitness_Parallel) {
+    buildCounter();
+    auto result = witnessFor([](ArithLogic & logic, PTRef var) { return logic.mkGeq(var, logic.getTerm_IntZero()); });
+    EXPECT_EQ(Validator(*logic, 4).validate(*graph, result), Validator::Result::VALIDATED);
+}
+
+TEST_F(Validator_Test, test_InvalidWitness_Parallel) {
+    buildCounter();
+    // Not inductive: The edge of the loop fails
+    auto result = witnessFor([](ArithLogic & logic, PTRef var) { return logic.mkLeq(var, logic.mkIntConst(5)); });
+    EXPECT_EQ(Validator(*logic, 4).validate(*graph, result), Validator::Result::NOT_VALIDATED);
+    EXPECT_EQ(Validator(*logic).validate(*graph, result), Validator::Result::NOT_VALIDATED);
+}
+
+TEST_F(Validator_Test, test_Counterexample_Parallel) {
+    options.addOption(Options::COMPUTE_WITNESS, "true");
+    buildCounter();
+    // Make the system unsafe by adding a reachable query
+    PTRef inv = instantiatePredicate(inv_sym, {x});
+    system.addClause(ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                     ChcBody{{logic->mkGeq(x, logic->mkIntConst(3))}, {UninterpretedPredicate{inv}}});
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    graph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    auto result = Spacer(*logic, options).solve(*graph);
+    ASSERT_EQ(result.getAnswer(), VerificationAnswer::UNSAFE);
+    EXPECT_EQ(Validator(*logic, 4).validate(*graph, result), Validator::Result::VALIDATED);
+}
+
+TEST_F(Validator_Test, test_CompactedCounterexample) {
+    buildCounter();
+    PTRef inv = instantiatePredicate(inv_sym, {x});
+    system.addClause(ChcHead{UninterpretedPredicate{logic->getTerm_false()}},
+                     ChcBody{{logic->mkGeq(x, logic->mkIntConst(1))}, {UninterpretedPredicate{inv}}});
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    graph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    std::optional<EId> init, loop, query;
+    for (auto const & edge : graph->getEdges()) {
+        if (edge.from[0] == graph->getEntry()) {
+            init = edge.id;
+        } else if (edge.to == graph->getExit()) {
+            query = edge.id;
+        } else if (edge.to == edge.from[0]) {
+            loop = edge.id;
+        }
+    }
+    ASSERT_TRUE(init and loop and query);
+    auto fact = [&](int value) { return instantiatePredicate(inv_sym, {logic->mkIntConst(value)}); };
+    using Step = InvalidityWitness::Derivation::DerivationStep;
+    InvalidityWitness::Derivation derivation(std::vector<Step>{
+        Step{0, {}, logic->getTerm_true(), EId{static_cast<std::size_t>(-1)}},
+        Step{1, {0}, fact(0), *init},
+        Step{2, {1}, fact(1), *loop},
+        Step{3, {2}, fact(2), *loop}, // Not needed
+        Step{4, {0}, fact(0), *init}, // Duplicate
+        Step{5, {4}, fact(1), *loop}, // Duplicate
+        Step{6, {5}, logic->getTerm_false(), *query}
+    });
+    InvalidityWitness witness;
+    witness.setDerivation(std::move(derivation));
+    witness.compact();
+    auto const & compacted = witness.getDerivation();
+    ASSERT_EQ(compacted.size(), 4u);
+    EXPECT_EQ(compacted[2].derivedFact, fact(1));
+    EXPECT_EQ(compacted.last().premises, std::vector<std::size_t>{2});
+    VerificationResult result(VerificationAnswer::UNSAFE, std::move(witness));
+    EXPECT_EQ(Validator(*logic).validate(*graph, result), Validator::Result::VALIDATED);
+}
+
+TEST_F(Validator_Test, test_InvalidWitness_FirstFailingEdgeReported) {
+    inv_sym = mkPredicateSymbol("Inv", {intSort()});
+    PTRef invp = instantiatePredicate(inv_sym, {xp});
+    // x' = k => Inv(x'), the witness fails for every k > 0
+    for (int k = 0; k < 32; ++k) {
+        system.addClause(ChcHead{UninterpretedPredicate{invp}}, ChcBody{{logic->mkEq(xp, logic->mkIntConst(k))}, {}});
+    }
+    auto normalizedSystem = Normalizer(*logic).normalize(system);
+    graph = ChcGraphBuilder(*logic).buildGraph(normalizedSystem);
+    auto result = witnessFor([](ArithLogic & logic, PTRef var) { return logic.mkLeq(var, logic.getTerm_IntZero()); });
+    auto diagnostics = [&](std::size_t threads) {
+        testing::internal::CaptureStderr();
+        EXPECT_EQ(Validator(*logic, threads).validate(*graph, result), Validator::Result::NOT_VALIDATED);
+        return testing::internal::GetCapturedStderr();
+    };
+    auto sequential = diagnostics(1);
+    EXPECT_NE(sequential.find("not validated!"), std::string::npos);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(diagnostics(4), sequential);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023, Martin Blicha <martin.blicha@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "utils/VersionedFile.h"
+
+#include <filesystem>
+#include <fstream>
+
+class VersionedFileTest : public ::testing::Test {
+protected:
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "golem-versioned-file-test";
+
+    void SetUp() override { std::filesystem::remove(path); }
+    void TearDown() override { std::filesystem::remove(path); }
+};
+
+TEST_F(VersionedFileTest, test_WrittenPartsReadBack) {
+    ASSERT_TRUE(VersionedFile::write(path.string(), "format-v1\n", {"first\n", "", "second"}));
+    VersionedFile file(path.string(), "format-v1\n");
+    EXPECT_TRUE(file.exists());
+    ASSERT_TRUE(file.isValid());
+    EXPECT_EQ(file.contents(), "first\nsecond");
+    // No temporary file is left behind
+    for (auto const & entry : std::filesystem::directory_iterator(path.parent_path())) {
+        EXPECT_EQ(entry.path().string().find(path.string() + ".tmp"), std::string::npos);
+    }
+}
+
+TEST_F(VersionedFileTest, test_OtherVersionNotValid) {
+    ASSERT_TRUE(VersionedFile::write(path.string(), "format-v1\n", {"data"}));
+    VersionedFile file(path.string(), "format-v2\n");
+    EXPECT_TRUE(file.exists());
+    EXPECT_FALSE(file.isValid());
+    EXPECT_TRUE(file.contents().empty());
+}
+
+TEST_F(VersionedFileTest, test_MissingFile) {
+    VersionedFile file(path.string(), "format-v1\n");
+    EXPECT_FALSE(file.exists());
+    EXPECT_FALSE(file.isValid());
+}
+
+TEST_F(VersionedFileTest, test_RewriteReplacesContents) {
+    ASSERT_TRUE(VersionedFile::write(path.string(), "format-v1\n", {"old contents"}));
+    {
+        // A reader that mapped the old contents keeps seeing them
+        VersionedFile old(path.string(), "format-v1\n");
+        ASSERT_TRUE(VersionedFile::write(path.string(), "format-v1\n", {"new"}));
+        EXPECT_EQ(old.contents(), "old contents");
+    }
+    VersionedFile file(path.string(), "format-v1\n");
+    EXPECT_EQ(file.contents(), "new");
+}
+
+TEST_F(VersionedFileTest, test_UnwritableDirectory) {
+    auto missing = path / "no-such-directory" / "file";
+    EXPECT_FALSE(VersionedFile::write(missing.string(), "format-v1\n", {"data"}));
+}